@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+/**
+ * @file bench_common.h
+ * @brief Minimal timing helpers shared by the benchmark programs.
+ * @brief 基准测试程序共用的简单计时工具。
+ *
+ * The benchmarks are plain executables (no framework dependency) so they can be
+ * built anywhere the library builds. Each one prints a small table to stdout.
+ */
+
+namespace http2_bench {
+
+class Stopwatch {
+public:
+    Stopwatch() : start_(std::chrono::steady_clock::now()) {}
+
+    void restart() { start_ = std::chrono::steady_clock::now(); }
+
+    double elapsed_seconds() const {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point start_;
+};
+
+// Prints one result row: name, operations per second and (optionally) MiB per second.
+inline void print_result(const std::string& name, uint64_t operations, uint64_t bytes, double seconds) {
+    double ops_per_sec = seconds > 0 ? operations / seconds : 0.0;
+    double mib_per_sec = seconds > 0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0.0;
+    std::printf("%-44s %12.0f ops/s %10.1f MiB/s  (%.3f s)\n", name.c_str(), ops_per_sec, mib_per_sec, seconds);
+}
+
+// Keeps the optimizer from discarding a computed value.
+template <typename T>
+inline void do_not_optimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+} // namespace http2_bench
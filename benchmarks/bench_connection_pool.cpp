@@ -0,0 +1,115 @@
+#include "bench_common.h"
+#include "http2_connection.h"
+#include "http2_connection_pool.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_connection_pool.cpp
+ * @brief Request throughput through Http2ConnectionPool for different pool sizes.
+ * @brief 不同连接池大小下经由 Http2ConnectionPool 的请求吞吐量。
+ *
+ * Each pooled client connection talks to its own in-process origin, which answers every GET with
+ * a HEADERS-only 200. The driver keeps `pool size * streams per connection` requests outstanding,
+ * so larger pools spread the same load over more connections (and more HPACK contexts), and the
+ * placement scan has more candidates to compare.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr uint32_t STREAMS_PER_CONNECTION = 100;
+
+struct Origin {
+    Http2Connection server{true};
+    Http2Connection* client = nullptr;
+    std::vector<std::byte> to_server, to_client;
+    std::vector<stream_id_t> requests;
+};
+
+struct PoolLoopback {
+    std::vector<std::unique_ptr<Origin>> origins;
+    uint64_t responses = 0;
+
+    Http2ConnectionPool::ConnectionFactory factory() {
+        return [this](Http2ConnectionPool::ConnectionId, const std::string&) {
+            auto client = std::make_unique<Http2Connection>(false);
+            auto origin = std::make_unique<Origin>();
+            Origin* o = origin.get();
+            o->client = client.get();
+            client->set_on_send_bytes([o](std::vector<std::byte> b) { o->to_server.insert(o->to_server.end(), b.begin(), b.end()); });
+            o->server.set_on_send_bytes([o](std::vector<std::byte> b) { o->to_client.insert(o->to_client.end(), b.begin(), b.end()); });
+            o->server.set_frame_callback([o](const AnyHttp2Frame& frame) {
+                const auto* hf = frame.get_if<HeadersFrame>();
+                if (hf && hf->has_end_stream_flag()) o->requests.push_back(hf->header.stream_id);
+            });
+            client->set_frame_callback([this](const AnyHttp2Frame& frame) {
+                const auto* hf = frame.get_if<HeadersFrame>();
+                if (hf && hf->has_end_stream_flag()) ++responses;
+            });
+            origins.push_back(std::move(origin));
+            return client;
+        };
+    }
+
+    void pump() {
+        std::vector<std::byte> scratch;
+        for (auto& o : origins) {
+            if (!o->to_server.empty()) {
+                scratch.swap(o->to_server);
+                o->server.process_incoming_data(scratch);
+                scratch.clear();
+            }
+            for (stream_id_t sid : o->requests) {
+                o->server.send_headers(sid, {{":status", "200"}, {"content-length", "0"}}, true);
+            }
+            o->requests.clear();
+            if (!o->to_client.empty()) {
+                scratch.swap(o->to_client);
+                o->client->process_incoming_data(scratch);
+                scratch.clear();
+            }
+        }
+    }
+};
+
+void run_case(size_t pool_size, uint64_t total_requests) {
+    PoolLoopback loop;
+    Http2ConnectionPool pool(loop.factory(), {.max_connections = pool_size, .max_streams_per_connection = STREAMS_PER_CONNECTION});
+
+    const std::vector<HttpHeader> request = {
+        {":method", "GET"}, {":scheme", "https"}, {":path", "/api/items"}, {":authority", "example.com"},
+        {"accept", "application/json"}, {"user-agent", "bench/1.0"}};
+    const uint64_t window = pool_size * STREAMS_PER_CONNECTION;
+
+    http2_bench::Stopwatch watch;
+    uint64_t submitted = 0;
+    while (loop.responses < total_requests) {
+        while (submitted < total_requests && submitted - loop.responses < window) {
+            pool.submit(request);
+            ++submitted;
+        }
+        loop.pump();
+        pool.maintain();
+    }
+    double seconds = watch.elapsed_seconds();
+
+    std::string name = "pool size " + std::to_string(pool_size);
+    http2_bench::print_result(name, total_requests, 0, seconds);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- Http2ConnectionPool request throughput (loopback, "
+              << STREAMS_PER_CONNECTION << " streams per connection) ---" << std::endl;
+    const uint64_t total = 200000;
+    for (size_t pool_size : {1, 2, 4, 8}) {
+        run_case(pool_size, total);
+    }
+    return 0;
+}
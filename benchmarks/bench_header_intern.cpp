@@ -0,0 +1,102 @@
+#include "bench_common.h"
+#include "hpack_decoder.h"
+#include "hpack_intern_pool.h"
+
+#include <malloc.h>
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_header_intern.cpp
+ * @brief Memory held by HPACK dynamic tables across 100k connections, with and without HeaderInternPool.
+ * @brief 10 万连接下 HPACK 动态表占用的内存：使用与不使用 HeaderInternPool 的对比。
+ *
+ * Each simulated connection has its own HpackDecoder and receives the first request of one of a
+ * few client profiles, whose headers go into the dynamic table with incremental indexing, as real
+ * clients do. The heap in use is read from the allocator (mallinfo2) after all decoders are built,
+ * so the figures include the decoders themselves, the table entries and every string copy. With
+ * the pool, a table entry refers to the pool's copy of each string instead of owning one.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr size_t CONNECTIONS = 100000;
+
+struct ClientProfile {
+    std::vector<HttpHeader> headers;
+};
+
+const std::vector<ClientProfile> PROFILES = {
+    {{{"content-type", "application/grpc"}, {"te", "trailers"}, {"grpc-accept-encoding", "identity, deflate, gzip"},
+      {"user-agent", "grpc-go/1.62.0"}, {"grpc-timeout", "9999m"}}},
+    {{{"content-type", "application/grpc"}, {"te", "trailers"}, {"grpc-accept-encoding", "identity,deflate,gzip"},
+      {"user-agent", "grpc-java-netty/1.63.0"}, {"accept-encoding", "gzip"}}},
+    {{{"user-agent", "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/124.0.0.0 Safari/537.36"},
+      {"accept", "text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8"},
+      {"accept-encoding", "gzip, deflate, br, zstd"}, {"accept-language", "en-US,en;q=0.9"},
+      {"sec-ch-ua-platform", "\"Windows\""}, {"sec-fetch-mode", "navigate"}}},
+    {{{"user-agent", "okhttp/4.12.0"}, {"accept-encoding", "gzip"}, {"accept", "application/json"}}},
+};
+
+void append_string(std::vector<std::byte>& out, const std::string& s) {
+    out.push_back(static_cast<std::byte>(s.size())); // All strings here are shorter than 127 bytes
+    for (char c : s) out.push_back(static_cast<std::byte>(c));
+}
+
+std::vector<std::byte> first_request_block(const ClientProfile& profile) {
+    std::vector<std::byte> block = {std::byte{0x83}, std::byte{0x87}, std::byte{0x84}};
+    block.push_back(std::byte{0x41}); // :authority (static name 1), incremental indexing
+    append_string(block, "api.example.com");
+    for (const auto& h : profile.headers) {
+        block.push_back(std::byte{0x40});
+        append_string(block, h.name);
+        append_string(block, h.value);
+    }
+    return block;
+}
+
+size_t heap_in_use() { return mallinfo2().uordblks; }
+
+void run_case(const std::string& name, HeaderInternPool* pool) {
+    std::vector<std::vector<std::byte>> blocks;
+    for (const auto& profile : PROFILES) blocks.push_back(first_request_block(profile));
+
+    size_t heap_before = heap_in_use();
+    std::vector<std::unique_ptr<HpackDecoder>> decoders;
+    decoders.reserve(CONNECTIONS);
+    http2_bench::Stopwatch watch;
+    for (size_t i = 0; i < CONNECTIONS; ++i) {
+        auto decoder = std::make_unique<HpackDecoder>();
+        decoder->set_intern_pool(pool);
+        auto result = decoder->decode(blocks[i % blocks.size()]);
+        http2_bench::do_not_optimize(result);
+        decoders.push_back(std::move(decoder));
+    }
+    double seconds = watch.elapsed_seconds();
+    size_t heap = heap_in_use() - heap_before;
+
+    http2_bench::print_result(name, CONNECTIONS, 0, seconds);
+    std::printf("    %.1f MiB in use, %.0f B per connection\n", heap / (1024.0 * 1024.0),
+                static_cast<double>(heap) / CONNECTIONS);
+    if (pool) {
+        std::printf("    pool: %zu strings, %zu B pooled, %.1f MiB of copies avoided, %.1f%% hits\n",
+                    pool->get_entry_count(), pool->get_pooled_bytes(), pool->get_saved_bytes() / (1024.0 * 1024.0),
+                    100.0 * pool->get_hit_count() / pool->get_lookup_count());
+    }
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- HPACK dynamic table memory (" << CONNECTIONS << " connections, "
+              << PROFILES.size() << " client profiles) ---" << std::endl;
+    run_case("private copies per connection", nullptr);
+    HeaderInternPool pool;
+    run_case("HeaderInternPool", &pool);
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include "bench_common.h"
+#include "hpack_decoder.h"
+#include "hpack_encoder.h"
+#include "http2_header_list.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_header_list.cpp
+ * @brief HPACK decoding into std::vector<HttpHeader> against the compact HeaderList.
+ * @brief HPACK 解码：std::vector<HttpHeader> 与紧凑的 HeaderList 的对比。
+ *
+ * A typical browser request is encoded once per case, then decoded repeatedly. The vector cases
+ * build a fresh std::vector<HttpHeader> per block, as decode() does for every HEADERS frame; the
+ * HeaderList cases decode into a fresh list and into one reused list. Both a cold block (first
+ * request, literals with incremental indexing) and a warm one (every header indexed) are run; the
+ * decoder's dynamic table is reset for the cold case by decoding with a new decoder each time.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr uint64_t ITERATIONS = 500000;
+
+const std::vector<HttpHeader> REQUEST = {
+    {":method", "GET"},
+    {":scheme", "https"},
+    {":path", "/assets/app.3f9c2e.js"},
+    {":authority", "www.example.com"},
+    {"user-agent", "Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0"},
+    {"accept", "*/*"},
+    {"accept-language", "en-US,en;q=0.5"},
+    {"accept-encoding", "gzip, deflate, br"},
+    {"referer", "https://www.example.com/"},
+    {"cookie", "session=7f3a9c0e1b2d4f6a8c0e; theme=dark"},
+    {"sec-fetch-mode", "no-cors"},
+    {"cache-control", "no-cache"}};
+
+template <typename Decode>
+void run_case(const std::string& name, size_t block_size, Decode decode) {
+    size_t headers = 0;
+    http2_bench::Stopwatch watch;
+    for (uint64_t i = 0; i < ITERATIONS; ++i) headers += decode();
+    double seconds = watch.elapsed_seconds();
+    http2_bench::print_result(name, ITERATIONS, ITERATIONS * block_size, seconds);
+    std::printf("    %zu B block, %zu headers per block\n", block_size, headers / ITERATIONS);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- HPACK decode: vector<HttpHeader> vs HeaderList (" << ITERATIONS << " blocks) ---" << std::endl;
+
+    HpackEncoder encoder;
+    auto [cold_block, cold_err] = encoder.encode(REQUEST);
+    auto [warm_block, warm_err] = encoder.encode(REQUEST);
+    if (cold_err != HpackEncodingError::OK || warm_err != HpackEncodingError::OK) return 1;
+
+    run_case("cold block -> vector<HttpHeader>", cold_block.size(), [&] {
+        HpackDecoder decoder;
+        auto result = decoder.decode(cold_block);
+        http2_bench::do_not_optimize(result);
+        return result.first.size();
+    });
+    run_case("cold block -> new HeaderList", cold_block.size(), [&] {
+        HpackDecoder decoder;
+        HeaderList list;
+        decoder.decode_into(cold_block, list);
+        http2_bench::do_not_optimize(list);
+        return list.size();
+    });
+
+    HpackDecoder warm;
+    warm.decode(cold_block);
+    run_case("warm block -> vector<HttpHeader>", warm_block.size(), [&] {
+        auto result = warm.decode(warm_block);
+        http2_bench::do_not_optimize(result);
+        return result.first.size();
+    });
+    run_case("warm block -> new HeaderList", warm_block.size(), [&] {
+        HeaderList list;
+        warm.decode_into(warm_block, list);
+        http2_bench::do_not_optimize(list);
+        return list.size();
+    });
+    HeaderList reused;
+    run_case("warm block -> reused HeaderList", warm_block.size(), [&] {
+        reused.clear();
+        warm.decode_into(warm_block, reused);
+        http2_bench::do_not_optimize(reused);
+        return reused.size();
+    });
+
+    HeaderList sample(REQUEST);
+    size_t vector_bytes = REQUEST.size() * sizeof(HttpHeader);
+    for (const auto& h : REQUEST) {
+        // Strings past the small-string buffer get their own heap block.
+        if (h.name.size() >= sizeof(std::string) - 8) vector_bytes += h.name.capacity() + 1;
+        if (h.value.size() >= sizeof(std::string) - 8) vector_bytes += h.value.capacity() + 1;
+    }
+    std::printf("request storage: vector %zu B, HeaderList %zu B (%zu B strings + %zu B index)\n",
+                vector_bytes, sample.get_byte_size() + REQUEST.size() * 16, sample.get_byte_size(),
+                REQUEST.size() * 16);
+    return 0;
+}
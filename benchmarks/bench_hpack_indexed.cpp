@@ -0,0 +1,85 @@
+#include "bench_common.h"
+#include "hpack_decoder.h"
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_hpack_indexed.cpp
+ * @brief HPACK decoding of fully-indexed header blocks against blocks that carry literals.
+ * @brief HPACK 解码：完全索引的头部块与包含字面量的头部块的对比。
+ *
+ * Once a client has sent a few requests, its encoder has every header of a typical request in the
+ * dynamic table and each later request becomes a run of one-byte Indexed Header Fields. The warm
+ * case decodes such a block (static and dynamic indices); the literal case decodes the same
+ * headers sent as literals without indexing, which is what every block costs when nothing is
+ * indexed. Each iteration returns a fresh header list, as the parser does for every HEADERS frame.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr uint64_t ITERATIONS = 1000000;
+
+void append_string(std::vector<std::byte>& out, const std::string& s) {
+    out.push_back(static_cast<std::byte>(s.size())); // All strings here are shorter than 127 bytes
+    for (char c : s) out.push_back(static_cast<std::byte>(c));
+}
+
+// Request headers beyond the pseudo-headers, as a browser would send them.
+const std::vector<HttpHeader> REGULAR_HEADERS = {
+    {":authority", "www.example.com"},
+    {"user-agent", "Mozilla/5.0 (X11; Linux x86_64; rv:128.0) Gecko/20100101 Firefox/128.0"},
+    {"accept", "text/html,application/xhtml+xml"},
+    {"accept-language", "en-US,en;q=0.5"},
+    {"cookie", "session=7f3a9c0e1b2d4f6a8c0e"},
+    {"cache-control", "no-cache"}};
+
+void run_case(const std::string& name, HpackDecoder& decoder, const std::vector<std::byte>& block) {
+    size_t headers = 0;
+    http2_bench::Stopwatch watch;
+    for (uint64_t i = 0; i < ITERATIONS; ++i) {
+        auto result = decoder.decode(block);
+        headers += result.first.size();
+        http2_bench::do_not_optimize(result);
+    }
+    double seconds = watch.elapsed_seconds();
+    http2_bench::print_result(name, ITERATIONS, ITERATIONS * block.size(), seconds);
+    std::printf("    %zu B block, %zu headers per block\n", block.size(), headers / ITERATIONS);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- HPACK indexed header blocks (" << ITERATIONS << " blocks) ---" << std::endl;
+
+    // Warm-up request: pseudo-headers from the static table, the rest added to the dynamic table.
+    HpackDecoder warm;
+    std::vector<std::byte> first = {std::byte{0x82}, std::byte{0x87}, std::byte{0x84}};
+    for (const auto& h : REGULAR_HEADERS) {
+        first.push_back(std::byte{0x40});
+        append_string(first, h.name);
+        append_string(first, h.value);
+    }
+    warm.decode(first);
+
+    // Every later request: :method GET, :scheme https, :path /, then the dynamic entries (62..67).
+    std::vector<std::byte> indexed = {std::byte{0x82}, std::byte{0x87}, std::byte{0x84}};
+    for (size_t i = REGULAR_HEADERS.size(); i > 0; --i) indexed.push_back(static_cast<std::byte>(0x80 | (61 + i)));
+    run_case("fully indexed block (static + dynamic)", warm, indexed);
+
+    std::vector<std::byte> static_only = {std::byte{0x82}, std::byte{0x87}, std::byte{0x84}, std::byte{0x90}};
+    run_case("fully indexed block (static only)", warm, static_only);
+
+    HpackDecoder cold;
+    std::vector<std::byte> literal = {std::byte{0x82}, std::byte{0x87}, std::byte{0x84}};
+    for (const auto& h : REGULAR_HEADERS) {
+        literal.push_back(std::byte{0x00});
+        append_string(literal, h.name);
+        append_string(literal, h.value);
+    }
+    run_case("same headers as literals (no indexing)", cold, literal);
+    return 0;
+}
@@ -0,0 +1,110 @@
+#include "bench_common.h"
+#include "hpack_decoder.h"
+
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_hpack_startup.cpp
+ * @brief HPACK static tables: allocations before main, process start-up and cold-cache decoding.
+ * @brief HPACK 静态表：main 之前的堆分配、进程启动时间与冷缓存解码。
+ *
+ * The static table and the Huffman tables are needed by the very first header block a process
+ * decodes. This program counts the heap allocations made before main() (by replacing operator
+ * new), times fresh processes that decode one Huffman-coded request block and exit, and times the
+ * same decode after the CPU caches were flushed by streaming over a large buffer, which is what a
+ * connection woken up after a quiet period sees.
+ */
+
+namespace {
+
+size_t g_allocations = 0;
+
+} // namespace
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+using namespace http2;
+
+namespace {
+
+constexpr int PROCESSES = 200;
+constexpr int COLD_ITERATIONS = 2000;
+constexpr size_t CACHE_FLUSH_BYTES = 32 << 20;
+
+// RFC 7541 C.4.1: :method GET, :scheme http, :path /, :authority www.example.com (Huffman).
+const std::vector<std::byte> REQUEST_BLOCK = [] {
+    const uint8_t bytes[] = {0x82, 0x86, 0x84, 0x41, 0x8c, 0xf1, 0xe3, 0xc2, 0xe5, 0xf2, 0x3a, 0x6b, 0xa0, 0xab, 0x90, 0xf4, 0xff};
+    std::vector<std::byte> block(sizeof(bytes));
+    std::memcpy(block.data(), bytes, sizeof(bytes));
+    return block;
+}();
+
+int decode_once() {
+    HpackDecoder decoder;
+    auto [headers, err] = decoder.decode(REQUEST_BLOCK);
+    return err == HpackError::OK && headers.size() == 4 ? 0 : 1;
+}
+
+void run_process_startup(const char* self) {
+    char child_arg[] = "--child";
+    char* argv[] = {const_cast<char*>(self), child_arg, nullptr};
+    http2_bench::Stopwatch watch;
+    for (int i = 0; i < PROCESSES; ++i) {
+        pid_t pid;
+        if (posix_spawn(&pid, self, nullptr, nullptr, argv, environ) != 0) {
+            std::perror("posix_spawn");
+            return;
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) std::cerr << "child failed" << std::endl;
+    }
+    double seconds = watch.elapsed_seconds();
+    http2_bench::print_result("spawn, decode one block, exit", PROCESSES, 0, seconds);
+    std::printf("    %.1f us per process\n", seconds * 1e6 / PROCESSES);
+}
+
+void run_decode(const std::string& name, bool flush_caches) {
+    std::vector<char> flush(flush_caches ? CACHE_FLUSH_BYTES : 0);
+    HpackDecoder decoder;
+    double seconds = 0;
+    for (int i = 0; i < COLD_ITERATIONS; ++i) {
+        for (size_t j = 0; j < flush.size(); j += 64) flush[j] = static_cast<char>(flush[j] + i);
+        http2_bench::do_not_optimize(flush.data());
+        http2_bench::Stopwatch watch;
+        auto result = decoder.decode(REQUEST_BLOCK);
+        seconds += watch.elapsed_seconds();
+        http2_bench::do_not_optimize(result);
+    }
+    http2_bench::print_result(name, COLD_ITERATIONS, COLD_ITERATIONS * REQUEST_BLOCK.size(), seconds);
+    std::printf("    %.0f ns per block\n", seconds * 1e9 / COLD_ITERATIONS);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t allocations_before_main = g_allocations; // Includes REQUEST_BLOCK below
+    if (argc > 1 && std::strcmp(argv[1], "--child") == 0) return decode_once();
+
+    std::cout << "--- HPACK static tables: start-up and cold-cache decoding ---" << std::endl;
+    std::printf("heap allocations before main(): %zu\n", allocations_before_main);
+    run_process_startup(argv[0]);
+    run_decode("decode after flushing caches (32 MiB)", true);
+    run_decode("decode with warm caches", false);
+    return 0;
+}
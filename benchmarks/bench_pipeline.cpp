@@ -0,0 +1,150 @@
+#include "bench_common.h"
+#include "http2_connection.h"
+#include "http2_pipeline.h"
+
+#include <algorithm>
+#include <iostream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+/**
+ * @file bench_pipeline.cpp
+ * @brief Server receive path on one thread against the two-stage Http2Pipeline.
+ * @brief 服务器接收路径：单线程处理与两级 Http2Pipeline 的对比。
+ *
+ * A client generates REQUESTS uploads up front (distinct :path and request id, a 1 KiB body);
+ * the server is fed the bytes in 16 KiB reads, as from a socket. Each request is "handled" by
+ * hashing its headers and body a few times, then answered with a 200. Inline, framing, HPACK
+ * decoding and the handler all run inside process_incoming_data(); pipelined, the I/O thread only
+ * frames and hands over, and decoding plus handling run on the pipeline's thread, with responses
+ * coming back as commands. Besides wall time the I/O thread's busy time is reported: the share of
+ * each read it is no longer available for other connections. Gains need at least two cores.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr size_t REQUESTS = 20000;
+constexpr size_t BODY_BYTES = 1024;
+constexpr size_t READ_BYTES = 16 * 1024;
+constexpr int APP_WORK_ROUNDS = 8;
+
+std::vector<std::byte> make_client_bytes() {
+    Http2Connection client{false};
+    std::vector<std::byte> bytes;
+    client.set_on_send_bytes([&](std::vector<std::byte> b) { bytes.insert(bytes.end(), b.begin(), b.end()); });
+    // Open the client's send windows (the server's side is opened in ServerCase) for the whole run.
+    client.apply_remote_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, MAX_ALLOWED_WINDOW_SIZE});
+    Http2Connection window_source{true};
+    std::vector<std::byte> window_update;
+    window_source.set_on_send_bytes([&](std::vector<std::byte> b) { window_update = std::move(b); });
+    window_source.send_window_update_action(0, MAX_ALLOWED_WINDOW_SIZE - DEFAULT_INITIAL_WINDOW_SIZE);
+    client.process_incoming_data(window_update);
+
+    std::vector<std::byte> body(BODY_BYTES, std::byte{'x'});
+    for (size_t i = 0; i < REQUESTS; ++i) {
+        stream_id_t stream_id = static_cast<stream_id_t>(2 * i + 1);
+        client.send_headers(stream_id, {{":method", "POST"}, {":scheme", "https"},
+                                        {":path", "/api/v1/items/" + std::to_string(i)}, {":authority", "api.example.com"},
+                                        {"content-type", "application/json"}, {"user-agent", "bench-client/1.0"},
+                                        {"x-request-id", std::to_string(1000000 + i)}}, false);
+        client.send_data(stream_id, body, true);
+    }
+    return bytes;
+}
+
+// Stand-in for request handling.
+uint64_t app_work(uint64_t hash, std::string_view text) {
+    for (int round = 0; round < APP_WORK_ROUNDS; ++round) {
+        for (char c : text) hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t app_work(uint64_t hash, std::span<const std::byte> data) {
+    return app_work(hash, std::string_view(reinterpret_cast<const char*>(data.data()), data.size()));
+}
+
+struct ServerCase {
+    Http2Connection server{true};
+    uint64_t hash = 14695981039346656037ull;
+    uint64_t responses = 0;
+    double io_busy_seconds = 0;
+
+    ServerCase() {
+        server.set_on_send_bytes([](std::vector<std::byte>) {});
+        server.apply_local_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, MAX_ALLOWED_WINDOW_SIZE});
+        server.update_local_connection_window(MAX_ALLOWED_WINDOW_SIZE - DEFAULT_INITIAL_WINDOW_SIZE);
+    }
+
+    // `respond` sends the 200, directly or via the pipeline.
+    template <typename Respond>
+    StreamEvents make_events(Respond respond) {
+        return {
+            .on_headers = [this](stream_id_t, void*, const std::vector<HttpHeader>& headers, bool) {
+                for (const auto& h : headers) hash = app_work(app_work(hash, h.name), h.value);
+            },
+            .on_data = [this, respond](stream_id_t stream_id, void*, std::vector<std::byte>&& data, bool end_stream) {
+                hash = app_work(hash, data);
+                if (end_stream) respond(stream_id);
+            },
+        };
+    }
+};
+
+template <typename Feed>
+void feed_reads(ServerCase& c, const std::vector<std::byte>& input, Feed feed) {
+    for (size_t offset = 0; offset < input.size(); offset += READ_BYTES) {
+        http2_bench::Stopwatch read;
+        feed(std::span<const std::byte>(input).subspan(offset, std::min(READ_BYTES, input.size() - offset)));
+        c.io_busy_seconds += read.elapsed_seconds();
+    }
+}
+
+void report(const std::string& name, const ServerCase& c, size_t input_bytes, double seconds) {
+    http2_bench::print_result(name, REQUESTS, input_bytes, seconds);
+    std::printf("    I/O thread busy %.3f s (%.0f%%), %llu responses\n", c.io_busy_seconds,
+                100.0 * c.io_busy_seconds / seconds, static_cast<unsigned long long>(c.responses));
+    http2_bench::do_not_optimize(c.hash);
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- Server receive path: inline vs two-stage pipeline (" << REQUESTS << " requests, "
+              << BODY_BYTES << " B bodies, " << std::thread::hardware_concurrency() << " cores) ---" << std::endl;
+    const std::vector<std::byte> input = make_client_bytes();
+
+    {
+        ServerCase c;
+        c.server.set_stream_events(c.make_events([&c](stream_id_t stream_id) {
+            c.server.consume_data(stream_id, BODY_BYTES);
+            c.server.send_headers(stream_id, {{":status", "200"}}, true);
+            ++c.responses;
+        }));
+        http2_bench::Stopwatch watch;
+        feed_reads(c, input, [&](std::span<const std::byte> read) { c.server.process_incoming_data(read); });
+        report("inline (one thread)", c, input.size(), watch.elapsed_seconds());
+    }
+    {
+        ServerCase c;
+        Http2Pipeline* pipeline_ptr = nullptr;
+        Http2Pipeline pipeline(c.server, c.make_events([&c, &pipeline_ptr](stream_id_t stream_id) {
+            pipeline_ptr->post([&c, stream_id](Http2Connection& conn) {
+                conn.consume_data(stream_id, BODY_BYTES);
+                conn.send_headers(stream_id, {{":status", "200"}}, true);
+                ++c.responses;
+            });
+        }));
+        pipeline_ptr = &pipeline;
+        http2_bench::Stopwatch watch;
+        feed_reads(c, input, [&](std::span<const std::byte> read) { pipeline.process_incoming_data(read); });
+        pipeline.drain();
+        report("pipelined (I/O + handler thread)", c, input.size(), watch.elapsed_seconds());
+    }
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include "bench_common.h"
+#include "http2_connection.h"
+#include "http2_executor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @file bench_stream_executor.cpp
+ * @brief Handler latency under skewed load: connection affinity with and without work stealing.
+ * @brief 倾斜负载下的处理延迟：连接亲和性与工作窃取的对比。
+ *
+ * CONNECTIONS server connections are spread over the executor's workers (assign_home()). The I/O
+ * thread submits handler tasks open loop, at a fixed rate, with HOT_SHARE of them for connection 0,
+ * so its home worker gets several times its fair share. Each task burns TASK_MICROS of CPU and
+ * posts its result to the connection's SubmissionQueue, which the I/O thread runs between
+ * submissions; latency is measured from submit() to that command running. Cases: affinity only
+ * (stealing disabled), stealing above a backlog of 4 (the default), and stealing anything.
+ * The gap between the first case and the others needs several cores to show.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr size_t WORKERS = 4;
+constexpr size_t CONNECTIONS = 8;
+constexpr size_t TASKS = 20000;
+constexpr double HOT_SHARE = 0.6;
+constexpr auto TASK_MICROS = std::chrono::microseconds(20);
+// Arrivals are paced for about 60% of the workers' total capacity.
+constexpr auto ARRIVAL_INTERVAL = std::chrono::nanoseconds(20000 * 10 / (6 * WORKERS));
+
+void burn(std::chrono::microseconds duration) {
+    auto until = std::chrono::steady_clock::now() + duration;
+    uint64_t x = 0;
+    while (std::chrono::steady_clock::now() < until) http2_bench::do_not_optimize(++x);
+}
+
+void run_case(const std::string& name, size_t steal_threshold) {
+    StreamExecutor executor({.worker_count = WORKERS, .steal_threshold = steal_threshold});
+    std::vector<std::unique_ptr<Http2Connection>> connections;
+    std::vector<std::unique_ptr<SubmissionQueue>> submissions;
+    std::vector<size_t> homes;
+    for (size_t i = 0; i < CONNECTIONS; ++i) {
+        connections.push_back(std::make_unique<Http2Connection>(true));
+        submissions.push_back(std::make_unique<SubmissionQueue>());
+        homes.push_back(executor.assign_home());
+    }
+
+    std::vector<double> latencies_us; // I/O thread only
+    latencies_us.reserve(TASKS);
+    auto run_submissions = [&] {
+        for (size_t i = 0; i < CONNECTIONS; ++i) submissions[i]->run(*connections[i]);
+    };
+
+    uint64_t rng = 0x9E3779B97F4A7C15ull;
+    http2_bench::Stopwatch watch;
+    auto next_arrival = std::chrono::steady_clock::now();
+    for (size_t task = 0; task < TASKS; ++task) {
+        while (std::chrono::steady_clock::now() < next_arrival) run_submissions();
+        next_arrival += ARRIVAL_INTERVAL;
+
+        rng ^= rng << 13; rng ^= rng >> 7; rng ^= rng << 17;
+        double draw = static_cast<double>(rng % 1000000) / 1000000.0;
+        size_t conn = draw < HOT_SHARE ? 0 : 1 + rng % (CONNECTIONS - 1);
+        auto submitted = std::chrono::steady_clock::now();
+        SubmissionQueue* queue = submissions[conn].get();
+        executor.submit(homes[conn], [queue, submitted, &latencies_us] {
+            burn(TASK_MICROS);
+            queue->post([submitted, &latencies_us](Http2Connection&) {
+                latencies_us.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submitted).count());
+            });
+        });
+    }
+    while (latencies_us.size() < TASKS) run_submissions();
+    double seconds = watch.elapsed_seconds();
+
+    std::sort(latencies_us.begin(), latencies_us.end());
+    http2_bench::print_result(name, TASKS, 0, seconds);
+    std::printf("    latency p50 %.0f us, p99 %.0f us, max %.0f us; %llu steals; per worker:",
+                latencies_us[TASKS / 2], latencies_us[TASKS * 99 / 100], latencies_us.back(),
+                static_cast<unsigned long long>(executor.get_steal_count()));
+    for (size_t w = 0; w < WORKERS; ++w) std::printf(" %llu", static_cast<unsigned long long>(executor.get_executed_count(w)));
+    std::printf("\n");
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- Stream handlers under skewed load (" << TASKS << " tasks of " << TASK_MICROS.count() << " us, "
+              << WORKERS << " workers, " << HOT_SHARE * 100 << "% on one connection, "
+              << std::thread::hardware_concurrency() << " cores) ---" << std::endl;
+    run_case("affinity only (no stealing)", static_cast<size_t>(-1));
+    run_case("work stealing, threshold 4", 4);
+    run_case("work stealing, threshold 0", 0);
+    return 0;
+}
@@ -0,0 +1,125 @@
+#include "bench_common.h"
+#include "http2_connection.h"
+#include "http2_stream_splicer.h"
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @file bench_stream_splice.cpp
+ * @brief Reverse-proxy throughput: copy-forwarding vs. StreamSplicer between two Http2Connections.
+ * @brief 反向代理吞吐量：在两个 Http2Connection 之间复制转发与 StreamSplicer 拼接的对比。
+ *
+ * client --> [proxy_down | proxy_up] --> origin, all in-process. The client pushes a request body
+ * through the proxy; the origin returns credit for everything it receives.
+ *  - copy:   the proxy copies DataFrame::data out of the frame callback into send_data and
+ *            returns credit to the client immediately (upstream windows are opened wide so
+ *            nothing is dropped).
+ *  - splice: the proxy moves payload buffers into the upstream send queue and returns credit
+ *            only as the upstream sends.
+ */
+
+using namespace http2;
+
+namespace {
+
+constexpr size_t CHUNK_BYTES = 64 * 1024;
+
+struct ProxyLoopback {
+    Http2Connection client{false};
+    Http2Connection proxy_down{true};
+    Http2Connection proxy_up{false};
+    Http2Connection origin{true};
+    std::vector<std::byte> client_to_proxy, proxy_to_client, proxy_to_origin, origin_to_proxy;
+    uint64_t origin_bytes = 0;
+
+    ProxyLoopback() {
+        client.set_on_send_bytes([this](std::vector<std::byte> b) { append(client_to_proxy, b); });
+        proxy_down.set_on_send_bytes([this](std::vector<std::byte> b) { append(proxy_to_client, b); });
+        proxy_up.set_on_send_bytes([this](std::vector<std::byte> b) { append(proxy_to_origin, b); });
+        origin.set_on_send_bytes([this](std::vector<std::byte> b) { append(origin_to_proxy, b); });
+        origin.set_data_callback([this](stream_id_t sid, std::vector<std::byte>&& data, bool) {
+            origin_bytes += data.size();
+            if (!data.empty()) origin.consume_data(sid, static_cast<uint32_t>(data.size()));
+        });
+
+        // Wide upstream windows so the copy-forwarding baseline is never blocked.
+        proxy_up.apply_local_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, MAX_ALLOWED_WINDOW_SIZE});
+        origin.apply_remote_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, MAX_ALLOWED_WINDOW_SIZE});
+        origin.send_window_update_action(0, MAX_ALLOWED_WINDOW_SIZE - DEFAULT_INITIAL_WINDOW_SIZE);
+    }
+
+    static void append(std::vector<std::byte>& pipe, const std::vector<std::byte>& bytes) {
+        pipe.insert(pipe.end(), bytes.begin(), bytes.end());
+    }
+
+    static bool deliver(std::vector<std::byte>& pipe, std::vector<std::byte>& scratch, Http2Connection& to) {
+        if (pipe.empty()) return false;
+        scratch.swap(pipe);
+        to.process_incoming_data(scratch);
+        scratch.clear();
+        return true;
+    }
+
+    void pump() {
+        std::vector<std::byte> scratch;
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            progress |= deliver(client_to_proxy, scratch, proxy_down);
+            progress |= deliver(proxy_to_client, scratch, client);
+            progress |= deliver(proxy_to_origin, scratch, origin);
+            progress |= deliver(origin_to_proxy, scratch, proxy_up);
+        }
+    }
+
+    void open_streams() {
+        std::vector<HttpHeader> headers = {{":method", "POST"}, {":scheme", "http"}, {":path", "/"}};
+        client.send_headers(1, headers, false);
+        proxy_up.send_headers(1, headers, false);
+        pump();
+    }
+};
+
+void run_case(bool use_splicer, size_t total_bytes) {
+    ProxyLoopback loop;
+    std::unique_ptr<StreamSplicer> splicer;
+    if (use_splicer) {
+        splicer = std::make_unique<StreamSplicer>(loop.proxy_down, loop.proxy_up);
+    } else {
+        loop.proxy_down.set_frame_callback([&loop](const AnyHttp2Frame& frame) {
+            if (const auto* df = frame.get_if<DataFrame>()) {
+                loop.proxy_up.send_data(1, df->data, df->has_end_stream_flag());
+                if (!df->data.empty()) loop.proxy_down.consume_data(1, static_cast<uint32_t>(df->data.size()));
+            }
+        });
+    }
+    loop.open_streams();
+    if (splicer) splicer->splice(1, 1);
+
+    std::vector<std::byte> chunk(CHUNK_BYTES, std::byte{0x7e});
+    http2_bench::Stopwatch watch;
+    for (size_t sent = 0; sent < total_bytes; sent += CHUNK_BYTES) {
+        loop.client.queue_data(1, chunk, sent + CHUNK_BYTES >= total_bytes);
+        loop.pump();
+    }
+    double seconds = watch.elapsed_seconds();
+
+    std::string name = use_splicer ? "proxy, splice" : "proxy, copy + send_data";
+    http2_bench::print_result(name, total_bytes / CHUNK_BYTES, loop.origin_bytes, seconds);
+    if (loop.origin_bytes != total_bytes) {
+        std::printf("    origin received %llu of %zu bytes\n", static_cast<unsigned long long>(loop.origin_bytes), total_bytes);
+    }
+}
+
+} // namespace
+
+int main() {
+    std::cout << "--- Reverse-proxy DATA forwarding (loopback, 64 KiB writes) ---" << std::endl;
+    const size_t total = 256 * 1024 * 1024;
+    run_case(false, total);
+    run_case(true, total);
+    return 0;
+}
@@ -32,6 +32,9 @@ const char* frame_type_to_string_parser(http2::FrameType type) {
         case http2::FrameType::GOAWAY: return "GOAWAY";
         case http2::FrameType::WINDOW_UPDATE: return "WINDOW_UPDATE";
         case http2::FrameType::CONTINUATION: return "CONTINUATION";
+        case http2::FrameType::ALTSVC: return "ALTSVC";
+        case http2::FrameType::ORIGIN: return "ORIGIN";
+        case http2::FrameType::PRIORITY_UPDATE: return "PRIORITY_UPDATE";
         default: return "UNKNOWN";
     }
 }
@@ -0,0 +1,166 @@
+#include "grpc_message.h"
+#include <algorithm> // For std::copy_n, std::min
+
+namespace http2 {
+
+namespace {
+
+uint32_t read_message_length(const std::byte* buffer) {
+    return (static_cast<uint32_t>(buffer[0]) << 24) |
+           (static_cast<uint32_t>(buffer[1]) << 16) |
+           (static_cast<uint32_t>(buffer[2]) << 8)  |
+           (static_cast<uint32_t>(buffer[3]));
+}
+
+} // namespace
+
+// --- GrpcMessageDecoder Implementation ---
+
+GrpcMessageDecoder::GrpcMessageDecoder(uint32_t max_message_size)
+    : max_message_size_(max_message_size) {
+}
+
+void GrpcMessageDecoder::reset() {
+    prefix_bytes_ = 0;
+    pending_compressed_ = false;
+    pending_length_ = 0;
+    reassembly_buffer_.clear();
+}
+
+GrpcError GrpcMessageDecoder::begin_message() {
+    uint8_t flag = static_cast<uint8_t>(prefix_[0]);
+    if (flag > 1) return GrpcError::INVALID_COMPRESSED_FLAG;
+    pending_compressed_ = (flag == 1);
+    pending_length_ = read_message_length(prefix_.data() + 1);
+    if (pending_length_ > max_message_size_) return GrpcError::MESSAGE_TOO_LARGE;
+    // The buffer grows as the body arrives: reserving the announced length up front would let a
+    // 5-byte prefix alone make us allocate up to max_message_size_.
+    reassembly_buffer_.clear();
+    return GrpcError::OK;
+}
+
+GrpcError GrpcMessageDecoder::feed(std::span<const std::byte> data) {
+    while (!data.empty()) {
+        if (prefix_bytes_ == 0 && data.size() >= GRPC_MESSAGE_PREFIX_SIZE) {
+            // Fast path: the whole message is inside this DATA payload, hand out a view of it.
+            uint8_t flag = static_cast<uint8_t>(data[0]);
+            uint32_t length = read_message_length(data.data() + 1);
+            if (flag > 1) { reset(); return GrpcError::INVALID_COMPRESSED_FLAG; }
+            if (length > max_message_size_) { reset(); return GrpcError::MESSAGE_TOO_LARGE; }
+
+            if (data.size() - GRPC_MESSAGE_PREFIX_SIZE >= length) {
+                ++messages_decoded_;
+                if (message_cb_) {
+                    message_cb_(GrpcMessage{flag == 1, data.subspan(GRPC_MESSAGE_PREFIX_SIZE, length)});
+                }
+                data = data.subspan(GRPC_MESSAGE_PREFIX_SIZE + length);
+                continue;
+            }
+        }
+
+        // Slow path: the message straddles DATA frames and has to be reassembled.
+        if (prefix_bytes_ < GRPC_MESSAGE_PREFIX_SIZE) {
+            size_t n = std::min(GRPC_MESSAGE_PREFIX_SIZE - prefix_bytes_, data.size());
+            std::copy_n(data.begin(), n, prefix_.begin() + prefix_bytes_);
+            prefix_bytes_ += n;
+            data = data.subspan(n);
+            if (prefix_bytes_ < GRPC_MESSAGE_PREFIX_SIZE) break; // Wait for the rest of the prefix
+
+            GrpcError err = begin_message();
+            if (err != GrpcError::OK) { reset(); return err; }
+        }
+
+        size_t needed = pending_length_ - reassembly_buffer_.size();
+        size_t n = std::min(needed, data.size());
+        reassembly_buffer_.insert(reassembly_buffer_.end(), data.begin(), data.begin() + n);
+        bytes_copied_ += n;
+        data = data.subspan(n);
+
+        if (reassembly_buffer_.size() == pending_length_) {
+            ++messages_decoded_;
+            ++messages_reassembled_;
+            if (message_cb_) {
+                message_cb_(GrpcMessage{pending_compressed_, reassembly_buffer_});
+            }
+            prefix_bytes_ = 0;
+            reassembly_buffer_.clear();
+        }
+    }
+    return GrpcError::OK;
+}
+
+GrpcError GrpcMessageDecoder::finish() const {
+    return has_partial_message() ? GrpcError::INCOMPLETE_MESSAGE : GrpcError::OK;
+}
+
+// --- GrpcStreamReader Implementation ---
+
+GrpcStreamReader::GrpcStreamReader(uint32_t max_message_size)
+    : max_message_size_(max_message_size) {
+}
+
+GrpcError GrpcStreamReader::on_data_frame(const DataFrame& frame) {
+    return on_data(frame.header.get_stream_id(), frame.data, frame.has_end_stream_flag());
+}
+
+GrpcError GrpcStreamReader::on_data(stream_id_t stream_id, std::span<const std::byte> data, bool end_stream) {
+    auto it = decoders_.find(stream_id);
+    if (it == decoders_.end()) {
+        it = decoders_.try_emplace(stream_id, max_message_size_).first;
+        it->second.set_message_callback([this, stream_id](const GrpcMessage& message) {
+            if (message_cb_ && !feeding_stream_closed_) message_cb_(stream_id, message);
+        });
+    }
+
+    feeding_stream_ = stream_id;
+    feeding_stream_closed_ = false;
+    GrpcError err = it->second.feed(data);
+    feeding_stream_.reset();
+    if (feeding_stream_closed_) {
+        decoders_.erase(it);
+        return GrpcError::OK;
+    }
+    if (err == GrpcError::OK && end_stream) {
+        err = it->second.finish();
+    }
+    if (err != GrpcError::OK || end_stream) {
+        decoders_.erase(it);
+    }
+    return err;
+}
+
+void GrpcStreamReader::close_stream(stream_id_t stream_id) {
+    if (feeding_stream_ == stream_id) {
+        feeding_stream_closed_ = true; // on_data() erases the decoder once feed() has returned
+        return;
+    }
+    decoders_.erase(stream_id);
+}
+
+// --- GrpcMessageEncoder Implementation ---
+
+namespace GrpcMessageEncoder {
+
+void write_message_prefix(std::vector<std::byte>& buffer, bool compressed, uint32_t message_length) {
+    buffer.push_back(static_cast<std::byte>(compressed ? 1 : 0));
+    buffer.push_back(static_cast<std::byte>((message_length >> 24) & 0xFF));
+    buffer.push_back(static_cast<std::byte>((message_length >> 16) & 0xFF));
+    buffer.push_back(static_cast<std::byte>((message_length >> 8) & 0xFF));
+    buffer.push_back(static_cast<std::byte>(message_length & 0xFF));
+}
+
+void encode_message_into(std::vector<std::byte>& buffer, std::span<const std::byte> message, bool compressed) {
+    buffer.reserve(buffer.size() + GRPC_MESSAGE_PREFIX_SIZE + message.size());
+    write_message_prefix(buffer, compressed, static_cast<uint32_t>(message.size()));
+    buffer.insert(buffer.end(), message.begin(), message.end());
+}
+
+std::vector<std::byte> encode_message(std::span<const std::byte> message, bool compressed) {
+    std::vector<std::byte> buffer;
+    encode_message_into(buffer, message, compressed);
+    return buffer;
+}
+
+} // namespace GrpcMessageEncoder
+
+} // namespace http2
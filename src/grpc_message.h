@@ -0,0 +1,120 @@
+#pragma once
+
+#include "http2_types.h"
+#include "http2_frame.h" // For DataFrame
+
+#include <array>
+#include <vector>
+#include <map>
+#include <optional>
+#include <functional>
+#include <span>
+
+namespace http2 {
+
+// gRPC Length-Prefixed-Message framing (gRPC over HTTP/2, "Length-Prefixed-Message").
+// Every message carried in DATA frames is prefixed by a 5-byte header:
+//   Compressed-Flag (1 byte) | Message-Length (4 bytes, big-endian)
+// The prefix and the message body may straddle DATA frame boundaries.
+constexpr size_t GRPC_MESSAGE_PREFIX_SIZE = 5;
+constexpr uint32_t GRPC_DEFAULT_MAX_MESSAGE_SIZE = 4 * 1024 * 1024; // gRPC default receive limit
+
+enum class GrpcError {
+    OK,
+    INVALID_COMPRESSED_FLAG, // Compressed-Flag other than 0 or 1
+    MESSAGE_TOO_LARGE,       // Message-Length exceeds the configured limit
+    INCOMPLETE_MESSAGE,      // Stream ended in the middle of a message
+};
+
+// A decoded message. `payload` is only valid for the duration of the callback:
+// it points either into the DATA payload that was fed to the decoder (zero-copy)
+// or into the decoder's reassembly buffer (message straddled frames).
+struct GrpcMessage {
+    bool compressed = false;
+    std::span<const std::byte> payload;
+};
+
+class GrpcMessageDecoder {
+public:
+    using MessageCallback = std::function<void(const GrpcMessage& message)>;
+
+    explicit GrpcMessageDecoder(uint32_t max_message_size = GRPC_DEFAULT_MAX_MESSAGE_SIZE);
+
+    void set_message_callback(MessageCallback cb) { message_cb_ = std::move(cb); }
+
+    // Feeds the payload of one DATA frame. Messages that lie entirely inside `data`
+    // are delivered as spans into `data`; only messages split across calls are copied.
+    GrpcError feed(std::span<const std::byte> data);
+
+    // Called when the stream ends (END_STREAM). Fails if a message is still incomplete.
+    GrpcError finish() const;
+
+    bool has_partial_message() const { return prefix_bytes_ != 0; }
+    void reset();
+
+    // Accounting, mainly for benchmarks and tests.
+    uint64_t get_messages_decoded() const { return messages_decoded_; }
+    uint64_t get_messages_reassembled() const { return messages_reassembled_; }
+    uint64_t get_bytes_copied() const { return bytes_copied_; }
+    // Grows with the bytes of a split message actually received, not with its announced length.
+    size_t get_reassembly_capacity() const { return reassembly_buffer_.capacity(); }
+
+private:
+    GrpcError begin_message();
+
+    uint32_t max_message_size_;
+    MessageCallback message_cb_;
+
+    // State of the message currently being reassembled (only used when it straddles feeds).
+    std::array<std::byte, GRPC_MESSAGE_PREFIX_SIZE> prefix_{};
+    size_t prefix_bytes_ = 0;      // Prefix bytes collected so far (0 = between messages)
+    bool pending_compressed_ = false;
+    uint32_t pending_length_ = 0;  // Valid once prefix_bytes_ == GRPC_MESSAGE_PREFIX_SIZE
+    std::vector<std::byte> reassembly_buffer_;
+
+    uint64_t messages_decoded_ = 0;
+    uint64_t messages_reassembled_ = 0;
+    uint64_t bytes_copied_ = 0;
+};
+
+// Demultiplexes DATA frames of many streams into per-stream GrpcMessageDecoders.
+// Typically driven from Http2Connection's frame callback.
+class GrpcStreamReader {
+public:
+    using StreamMessageCallback = std::function<void(stream_id_t stream_id, const GrpcMessage& message)>;
+
+    explicit GrpcStreamReader(uint32_t max_message_size = GRPC_DEFAULT_MAX_MESSAGE_SIZE);
+
+    void set_message_callback(StreamMessageCallback cb) { message_cb_ = std::move(cb); }
+
+    // Feeds a received DATA frame. On END_STREAM the stream's decoder is released.
+    GrpcError on_data_frame(const DataFrame& frame);
+    GrpcError on_data(stream_id_t stream_id, std::span<const std::byte> data, bool end_stream);
+
+    // Drops per-stream state, e.g. after RST_STREAM. May be called from the message callback; the
+    // stream's remaining messages in the DATA being fed are then not delivered.
+    void close_stream(stream_id_t stream_id);
+    size_t get_active_stream_count() const { return decoders_.size(); }
+
+private:
+    uint32_t max_message_size_;
+    StreamMessageCallback message_cb_;
+    std::map<stream_id_t, GrpcMessageDecoder> decoders_;
+    // Stream whose decoder is inside feed(); closing it is deferred until feed() returns.
+    std::optional<stream_id_t> feeding_stream_;
+    bool feeding_stream_closed_ = false;
+};
+
+namespace GrpcMessageEncoder {
+
+// Appends the 5-byte Length-Prefixed-Message header.
+void write_message_prefix(std::vector<std::byte>& buffer, bool compressed, uint32_t message_length);
+
+// Appends prefix + message to `buffer`, so several messages can be batched into one send_data call.
+void encode_message_into(std::vector<std::byte>& buffer, std::span<const std::byte> message, bool compressed = false);
+
+std::vector<std::byte> encode_message(std::span<const std::byte> message, bool compressed = false);
+
+} // namespace GrpcMessageEncoder
+
+} // namespace http2
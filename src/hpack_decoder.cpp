@@ -32,123 +32,139 @@ HpackDecoder::HpackDecoder(uint32_t max_dynamic_table_size)
     // Static table is globally defined in hpack_static_table.cpp
 }
 
+namespace {
+
+// Output adapters for HpackDecoder::decode_block.
+struct HeaderVectorSink {
+    std::vector<HttpHeader>& headers;
+
+    void add(std::string_view name, std::string_view value, bool sensitive) {
+        headers.push_back({std::string(name), std::string(value), sensitive});
+    }
+    void reserve_more(size_t count) { headers.reserve(headers.size() + count); }
+    size_t size() const { return headers.size(); }
+};
+
+struct HeaderListSink {
+    HeaderList& headers;
+
+    void add(std::string_view name, std::string_view value, bool sensitive) { headers.add(name, value, sensitive); }
+    void reserve_more(size_t count) { headers.reserve(headers.size() + count, headers.get_byte_size()); }
+    size_t size() const { return headers.size(); }
+};
+
+} // namespace
+
 std::pair<std::vector<HttpHeader>, HpackError> HpackDecoder::decode(std::span<const std::byte> data) {
     std::vector<HttpHeader> headers;
-    HpackError error_status = HpackError::OK;
+    HeaderVectorSink sink{headers};
+    HpackError error_status = decode_block(data, sink);
+    return {std::move(headers), error_status};
+}
+
+HpackError HpackDecoder::decode_into(std::span<const std::byte> data, HeaderList& headers) {
+    HeaderListSink sink{headers};
+    return decode_block(data, sink);
+}
+
+template <typename Sink>
+HpackError HpackDecoder::decode_block(std::span<const std::byte> data, Sink& sink) {
+    const size_t first_header = sink.size();
+    // Huffman-coded strings are decoded here; raw ones are viewed in place.
+    std::string name_scratch;
+    std::string value_scratch;
 
     while (!data.empty()) {
         uint8_t first_byte = static_cast<uint8_t>(data[0]);
 
-        if ((first_byte & 0b10000000) == 0b10000000) { // Indexed Header Field: 1xxxxxxx
+        if (first_byte > 0x80 && first_byte < 0xFF) { // One-byte Indexed Header Field(s)
+            HpackError err = decode_indexed_run(data, sink);
+            if (err != HpackError::OK) return err;
+        } else if ((first_byte & 0b10000000) == 0b10000000) { // Indexed Header Field: 1xxxxxxx
             auto [index, err] = decode_integer(data, 7); // 7-bit prefix
-            if (err != HpackError::OK) { error_status = err; break; }
-
-            if (index == 0) { // Index 0 is not allowed
-                error_status = HpackError::INDEX_OUT_OF_BOUNDS; break;
-            }
-            auto header_opt = get_header_from_tables(index);
-            if (!header_opt) {
-                error_status = HpackError::INDEX_OUT_OF_BOUNDS; break;
-            }
-            headers.push_back(header_opt.value());
-
-        } else if ((first_byte & 0b11000000) == 0b01000000) { // Literal Header Field with Incremental Indexing: 01xxxxxx
-            uint8_t prefix_bits = 6;
+            if (err != HpackError::OK) return err;
+
+            // Index 0 is not allowed
+            auto header_opt = get_view_from_tables(index);
+            if (!header_opt) return HpackError::INDEX_OUT_OF_BOUNDS;
+            sink.add(header_opt->name, header_opt->value, false);
+
+        } else if ((first_byte & 0b11000000) == 0b01000000 || // Literal Header Field with Incremental Indexing: 01xxxxxx
+                   (first_byte & 0b11100000) == 0b00000000) { // Literal without Indexing 0000xxxx / Never Indexed 0001xxxx
+            bool incremental_indexing = (first_byte & 0b01000000) != 0;
+            bool never_indexed = !incremental_indexing && (first_byte & 0b00010000) != 0;
+            uint8_t prefix_bits = incremental_indexing ? 6 : 4;
             auto [index, err_idx] = decode_integer(data, prefix_bits); // Consumes first byte with prefix
-             if (err_idx != HpackError::OK) { error_status = err_idx; break; }
+            if (err_idx != HpackError::OK) return err_idx;
 
-            HttpHeader header;
+            std::string_view name;
             if (index == 0) { // Literal name, literal value
-                auto [name_str, err_name] = decode_string(data);
-                if (err_name != HpackError::OK) { error_status = err_name; break; }
-                header.name = std::move(name_str);
+                auto [name_str, err_name] = decode_string_view(data, name_scratch);
+                if (err_name != HpackError::OK) return err_name;
+                name = name_str;
             } else {
-                auto indexed_header_opt = get_header_from_tables(index);
-                if (!indexed_header_opt) { error_status = HpackError::INDEX_OUT_OF_BOUNDS; break; }
-                header.name = indexed_header_opt.value().name;
+                auto indexed_header_opt = get_view_from_tables(index);
+                if (!indexed_header_opt) return HpackError::INDEX_OUT_OF_BOUNDS;
+                name = indexed_header_opt->name;
             }
 
-            auto [value_str, err_val] = decode_string(data);
-            if (err_val != HpackError::OK) { error_status = err_val; break; }
-            header.value = std::move(value_str);
-
-            headers.push_back(header);
-            add_to_dynamic_table(header);
+            auto [value, err_val] = decode_string_view(data, value_scratch);
+            if (err_val != HpackError::OK) return err_val;
 
-        } else if ((first_byte & 0b11110000) == 0b00000000) { // Literal Header Field without Indexing: 0000xxxx
-            uint8_t prefix_bits = 4;
-            auto [index, err_idx] = decode_integer(data, prefix_bits);
-            if (err_idx != HpackError::OK) { error_status = err_idx; break; }
-
-            HttpHeader header;
-            if (index == 0) {
-                auto [name_str, err_name] = decode_string(data);
-                if (err_name != HpackError::OK) { error_status = err_name; break; }
-                header.name = std::move(name_str);
-            } else {
-                auto indexed_header_opt = get_header_from_tables(index);
-                if (!indexed_header_opt) { error_status = HpackError::INDEX_OUT_OF_BOUNDS; break; }
-                header.name = indexed_header_opt.value().name;
-            }
-
-            auto [value_str, err_val] = decode_string(data);
-            if (err_val != HpackError::OK) { error_status = err_val; break; }
-            header.value = std::move(value_str);
-            header.sensitive = false; // By default for this type
-            headers.push_back(header);
-
-        } else if ((first_byte & 0b11110000) == 0b00010000) { // Literal Header Field Never Indexed: 0001xxxx
-            uint8_t prefix_bits = 4;
-            auto [index, err_idx] = decode_integer(data, prefix_bits);
-             if (err_idx != HpackError::OK) { error_status = err_idx; break; }
-
-            HttpHeader header;
-            if (index == 0) {
-                auto [name_str, err_name] = decode_string(data);
-                if (err_name != HpackError::OK) { error_status = err_name; break; }
-                header.name = std::move(name_str);
-            } else {
-                auto indexed_header_opt = get_header_from_tables(index);
-                if (!indexed_header_opt) { error_status = HpackError::INDEX_OUT_OF_BOUNDS; break; }
-                header.name = indexed_header_opt.value().name;
-            }
-
-            auto [value_str, err_val] = decode_string(data);
-            if (err_val != HpackError::OK) { error_status = err_val; break; }
-            header.value = std::move(value_str);
-            header.sensitive = true;
-            headers.push_back(header);
+            sink.add(name, value, never_indexed);
+            // `name` may view a dynamic table entry; add_to_dynamic_table copies before evicting.
+            if (incremental_indexing) add_to_dynamic_table(name, value);
 
         } else if ((first_byte & 0b11100000) == 0b00100000) { // Dynamic Table Size Update: 001xxxxx
             auto [size, err] = decode_integer(data, 5);
-            if (err != HpackError::OK) { error_status = err; break; }
+            if (err != HpackError::OK) return err;
 
             // RFC 7541 Section 6.3: "A dynamic table size update MUST occur at the beginning
             // of a header block. It is an error if this is not the case."
-            // This check should ideally be done by the caller or Http2Parser.
-            // For now, we process it. If headers are already decoded, it's a protocol violation.
-            if (!headers.empty()) {
-                 error_status = HpackError::COMPRESSION_ERROR; // Or a more specific error
-                 break;
-            }
+            // If headers are already decoded, it's a protocol violation.
+            if (sink.size() != first_header) return HpackError::COMPRESSION_ERROR;
 
             if (size > HpackDecoder::DEFAULT_DYNAMIC_TABLE_SIZE) { // Using own default as a sanity check, though spec says max_dynamic_table_size_
                  // The spec says an encoder MUST NOT cause a dynamic table capacity to exceed this.
                  // If it does, "the decoder MUST treat this as a compression error."
-                 error_status = HpackError::COMPRESSION_ERROR;
-                 break;
+                 return HpackError::COMPRESSION_ERROR;
             }
             set_max_dynamic_table_size(static_cast<uint32_t>(size));
 
         } else {
             // Should not happen if HPACK stream is valid
-            error_status = HpackError::COMPRESSION_ERROR;
-            break;
+            return HpackError::COMPRESSION_ERROR;
         }
-        if (error_status != HpackError::OK) break;
     }
 
-    return {headers, error_status};
+    return HpackError::OK;
+}
+
+template <typename Sink>
+HpackError HpackDecoder::decode_indexed_run(std::span<const std::byte>& data, Sink& sink) {
+    size_t run = 0;
+    while (run < data.size() && static_cast<uint8_t>(data[run]) > 0x80 && static_cast<uint8_t>(data[run]) < 0xFF) ++run;
+    sink.reserve_more(run);
+
+    const size_t static_size = Hpack::STATIC_TABLE.size();
+    size_t consumed = 0;
+    for (; consumed < run; ++consumed) {
+        size_t index = static_cast<uint8_t>(data[consumed]) & 0x7F;
+        if (index <= static_size) {
+            const Hpack::StaticTableEntry& entry = Hpack::STATIC_TABLE[index - 1];
+            sink.add(entry.name, entry.value, false);
+            continue;
+        }
+        size_t dynamic_index = index - static_size - 1; // 0 is the newest entry
+        if (dynamic_index >= dynamic_table_.size()) {
+            data = data.subspan(consumed + 1);
+            return HpackError::INDEX_OUT_OF_BOUNDS;
+        }
+        const DynamicTableEntry& entry = dynamic_table_[dynamic_index];
+        sink.add(entry.name(), entry.value(), false);
+    }
+    data = data.subspan(consumed);
+    return HpackError::OK;
 }
 
 void HpackDecoder::set_max_dynamic_table_size(uint32_t max_size) {
@@ -251,8 +267,35 @@ std::pair<std::string, HpackError> HpackDecoder::decode_string(std::span<const s
 }
 
 
-void HpackDecoder::add_to_dynamic_table(HttpHeader header) {
-    size_t entry_size = header.name.length() + header.value.length() + 32;
+std::pair<std::string_view, HpackError> HpackDecoder::decode_string_view(std::span<const std::byte>& data, std::string& scratch) {
+    if (data.empty()) {
+        return {{}, HpackError::BUFFER_TOO_SMALL};
+    }
+
+    bool huffman_encoded = (static_cast<uint8_t>(data[0]) & 0b10000000) != 0;
+    auto [length, err_len] = decode_integer(data, 7);
+    if (err_len != HpackError::OK) {
+        return {{}, err_len};
+    }
+    if (length > data.size()) {
+        return {{}, HpackError::BUFFER_TOO_SMALL};
+    }
+
+    std::span<const std::byte> string_data = data.first(static_cast<size_t>(length));
+    data = data.subspan(static_cast<size_t>(length));
+
+    if (huffman_encoded) {
+        if (Hpack::huffman_decode_into(scratch, string_data) != Hpack::HuffmanError::OK) {
+            return {{}, HpackError::INVALID_HUFFMAN_CODE};
+        }
+        return {scratch, HpackError::OK};
+    }
+    return {std::string_view(reinterpret_cast<const char*>(string_data.data()), string_data.size()), HpackError::OK};
+}
+
+
+void HpackDecoder::add_to_dynamic_table(std::string_view name, std::string_view value) {
+    size_t entry_size = name.length() + value.length() + 32;
 
     if (entry_size > max_dynamic_table_size_) {
         // Entry is larger than the entire table capacity, so just clear the table.
@@ -261,9 +304,12 @@ void HpackDecoder::add_to_dynamic_table(HttpHeader header) {
         return;
     }
 
+    // Built before evicting: `name` and `value` may view an entry about to be evicted.
+    DynamicTableEntry entry = intern_pool_
+        ? DynamicTableEntry(intern_pool_->intern(name), intern_pool_->intern(value))
+        : DynamicTableEntry(std::string(name), std::string(value));
     evict_from_dynamic_table(static_cast<uint32_t>(entry_size));
-
-    dynamic_table_.push_front(DynamicTableEntry(std::move(header.name), std::move(header.value)));
+    dynamic_table_.push_front(std::move(entry));
     current_dynamic_table_size_ += static_cast<uint32_t>(entry_size);
 }
 
@@ -274,6 +320,18 @@ void HpackDecoder::evict_from_dynamic_table(uint32_t required_space) {
     }
 }
 
+std::optional<HeaderView> HpackDecoder::get_view_from_tables(uint64_t index) const {
+    if (index == 0) return std::nullopt;
+    if (index <= Hpack::STATIC_TABLE.size()) {
+        const Hpack::StaticTableEntry& entry = Hpack::STATIC_TABLE[index - 1];
+        return HeaderView{entry.name, entry.value};
+    }
+    uint64_t dynamic_index = index - Hpack::STATIC_TABLE.size();
+    if (dynamic_index > dynamic_table_.size()) return std::nullopt;
+    const DynamicTableEntry& entry = dynamic_table_[dynamic_index - 1];
+    return HeaderView{entry.name(), entry.value()};
+}
+
 std::optional<HttpHeader> HpackDecoder::get_header_from_tables(uint64_t index) {
     if (index == 0) return std::nullopt; // Index 0 is invalid
 
@@ -289,7 +347,8 @@ std::optional<HttpHeader> HpackDecoder::get_header_from_tables(uint64_t index) {
     }
 
     // Dynamic table indices are 1-based from the most recent entry
-    return {{dynamic_table_[dynamic_index - 1].name, dynamic_table_[dynamic_index - 1].value}};
+    const DynamicTableEntry& entry = dynamic_table_[dynamic_index - 1];
+    return {{std::string(entry.name()), std::string(entry.value())}};
 }
 
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "http2_types.h"
+#include "hpack_intern_pool.h"
+#include "http2_header_list.h"
 #include <vector>
 #include <string>
 #include <deque>
@@ -33,6 +35,11 @@ public:
     // Returns a pair: a vector of decoded headers and an HpackError.
     // In C++23, this could return std::expected<std::vector<HttpHeader>, HpackError>.
     std::pair<std::vector<HttpHeader>, HpackError> decode(std::span<const std::byte> data);
+    // Same, appended to `headers`. Literal strings are copied once, straight from `data` into the
+    // list's buffer, so decoding a block costs no allocation per header; reusing one list across
+    // blocks (clear() keeps its capacity) usually costs none at all. On error `headers` holds the
+    // fields decoded before the bad one.
+    HpackError decode_into(std::span<const std::byte> data, HeaderList& headers);
 
     // Updates the maximum size of the dynamic table.
     // This can be signaled by the peer via SETTINGS_HEADER_TABLE_SIZE.
@@ -40,37 +47,65 @@ public:
     uint32_t get_current_dynamic_table_size() const;
     uint32_t get_max_dynamic_table_size() const;
 
+    // Strings entering the dynamic table are taken from `pool` instead of being copied (nullptr:
+    // private copies). Entries already in the table are left as they are. The pool must outlive
+    // the decoder.
+    void set_intern_pool(HeaderInternPool* pool) { intern_pool_ = pool; }
+
 
 // private:
     struct DynamicTableEntry {
-        std::string name;
-        std::string value;
+        // Own copies of the strings, or references into a HeaderInternPool.
+        std::string own_name;
+        std::string own_value;
+        HeaderInternPool::Handle pooled_name;
+        HeaderInternPool::Handle pooled_value;
         size_t size; // Size as defined by HPACK (name_len + value_len + 32)
 
         DynamicTableEntry(std::string n, std::string v) :
-            name(std::move(n)), value(std::move(v)) {
-            size = name.length() + value.length() + 32;
+            own_name(std::move(n)), own_value(std::move(v)) {
+            size = own_name.length() + own_value.length() + 32;
+        }
+        DynamicTableEntry(HeaderInternPool::Handle n, HeaderInternPool::Handle v) :
+            pooled_name(std::move(n)), pooled_value(std::move(v)) {
+            size = pooled_name->length() + pooled_value->length() + 32;
         }
+
+        std::string_view name() const { return pooled_name ? std::string_view(*pooled_name) : std::string_view(own_name); }
+        std::string_view value() const { return pooled_value ? std::string_view(*pooled_value) : std::string_view(own_value); }
     };
 
     // Dynamic Table (RFC 7541 - Section 2.3)
     std::deque<DynamicTableEntry> dynamic_table_;
     uint32_t current_dynamic_table_size_ = 0; // Current sum of entry sizes
     uint32_t max_dynamic_table_size_;         // Max allowed size
+    HeaderInternPool* intern_pool_ = nullptr;
 
-    // Static Table (RFC 7541 - Appendix A)
-    // This can be a static constexpr array or similar.
-    static const std::vector<HttpHeader> STATIC_TABLE;
+    // Static Table (RFC 7541 - Appendix A): Hpack::STATIC_TABLE in hpack_static_table.h
 
     // Helper methods for parsing different integer and string representations
     std::pair<uint64_t, HpackError> decode_integer(std::span<const std::byte>& data, uint8_t prefix_bits);
     std::pair<std::string, HpackError> decode_string(std::span<const std::byte>& data);
     std::pair<std::string, HpackError> huffman_decode(std::span<const std::byte> data);
+    // Like decode_string, but a raw string is returned as a view into `data` and a Huffman-coded
+    // one is decoded into `scratch`. The view is valid until `scratch` is next used.
+    std::pair<std::string_view, HpackError> decode_string_view(std::span<const std::byte>& data, std::string& scratch);
+
+    // Shared by decode() and decode_into(); Sink adapts the output container (see the .cpp).
+    template <typename Sink>
+    HpackError decode_block(std::span<const std::byte> data, Sink& sink);
+
+    // Fast path for a run of one-byte Indexed Header Fields (0x81-0xFE), which is what most
+    // request blocks turn into once the dynamic table is warm. Consumes the run from `data`.
+    template <typename Sink>
+    HpackError decode_indexed_run(std::span<const std::byte>& data, Sink& sink);
 
     // Dynamic table management
-    void add_to_dynamic_table(HttpHeader header);
+    void add_to_dynamic_table(std::string_view name, std::string_view value);
     void evict_from_dynamic_table(uint32_t required_space);
     std::optional<HttpHeader> get_header_from_tables(uint64_t index);
+    // Same without copying; the views are valid until the dynamic table changes.
+    std::optional<HeaderView> get_view_from_tables(uint64_t index) const;
 
 
     // --- Placeholder for Huffman Tree/Table ---
@@ -31,118 +31,97 @@ void HpackEncoder::encode_integer(std::vector<std::byte>& buffer, uint8_t prefix
 }
 
 // Helper to encode a string (RFC 7541, Section 5.2)
-void HpackEncoder::encode_string(std::vector<std::byte>& buffer, const std::string& str, bool try_huffman) {
-    std::vector<std::byte> huffman_encoded_bytes;
-    bool use_huffman_actual = false;
-
-    if (try_huffman) {
-        auto [encoded_res, huff_err] = Hpack::huffman_encode(str);
-        if (huff_err == Hpack::HuffmanError::OK) {
-            // Simple heuristic: use Huffman if it's shorter.
-            // More complex heuristics could be used (e.g. considering CPU cost).
-            if (encoded_res.size() < str.length()) {
-                huffman_encoded_bytes = std::move(encoded_res);
-                use_huffman_actual = true;
-            }
-        }
-    }
+void HpackEncoder::encode_string(std::vector<std::byte>& buffer, std::string_view str, bool try_huffman) {
+    // Simple heuristic: use Huffman if it's shorter.
+    // More complex heuristics could be used (e.g. considering CPU cost).
+    // The length is known up front, so the code is written straight into `buffer`.
+    size_t huffman_length = try_huffman ? Hpack::get_huffman_encoded_length(str) : str.length();
+    bool use_huffman_actual = huffman_length < str.length();
 
     uint8_t prefix = use_huffman_actual ? 0x80 : 0x00; // H bit (1 for Huffman, 0 for literal)
-    size_t length = use_huffman_actual ? huffman_encoded_bytes.size() : str.length();
+    size_t length = use_huffman_actual ? huffman_length : str.length();
 
     encode_integer(buffer, prefix, 7, length); // 7-bit prefix for length
 
     if (use_huffman_actual) {
-        buffer.insert(buffer.end(), huffman_encoded_bytes.begin(), huffman_encoded_bytes.end());
+        Hpack::huffman_encode_into(buffer, str);
     } else {
-        for (char c : str) {
-            buffer.push_back(static_cast<std::byte>(c));
-        }
+        const auto* bytes = reinterpret_cast<const std::byte*>(str.data());
+        buffer.insert(buffer.end(), bytes, bytes + str.size());
     }
 }
 
 
 std::pair<std::vector<std::byte>, HpackEncodingError> HpackEncoder::encode(const std::vector<HttpHeader>& headers) {
     std::vector<std::byte> output_buffer;
+    HpackEncodingError err = encode_into(output_buffer, headers);
+    return {std::move(output_buffer), err};
+}
 
-    for (const auto& header : headers) {
-        // Strategy:
-        // 1. Try full match (name and value) in static table.
-        // 2. Try full match in dynamic table.
-        // 3. Try name match in static table.
-        // 4. Try name match in dynamic table.
-        // 5. If sensitive, use Literal Never Indexed.
-        // 6. Else, use Literal With Incremental Indexing (if it fits in dynamic table).
-        // 7. Else, use Literal Without Indexing.
+HpackEncodingError HpackEncoder::encode_into(std::vector<std::byte>& output_buffer, const std::vector<HttpHeader>& headers) {
+    for (const auto& header : headers) encode_field(output_buffer, header.name, header.value, header.sensitive);
+    return HpackEncodingError::OK;
+}
+
+HpackEncodingError HpackEncoder::encode_into(std::vector<std::byte>& output_buffer, const HeaderList& headers) {
+    for (HeaderView header : headers) encode_field(output_buffer, header.name, header.value, header.sensitive);
+    return HpackEncodingError::OK;
+}
+
+void HpackEncoder::encode_field(std::vector<std::byte>& output_buffer, std::string_view name, std::string_view value, bool sensitive) {
+    // Strategy:
+    // 1. Try full match (name and value) in static table.
+    // 2. Try full match in dynamic table.
+    // 3. Try name match in static table.
+    // 4. Try name match in dynamic table.
+    // 5. If sensitive, use Literal Never Indexed.
+    // 6. Else, use Literal With Incremental Indexing (if it fits in dynamic table).
+    // 7. Else, use Literal Without Indexing.
 
     // Step 1 & 2: Check for exact match (name and value) in static or dynamic table.
     // Static table indices are 1 to STATIC_TABLE.size().
     // Dynamic table indices are STATIC_TABLE.size() + 1 to STATIC_TABLE.size() + dynamic_table_.size().
-    auto [static_idx, static_value_match] = Hpack::find_in_static_table(header);
+    auto [static_idx, static_value_match] = Hpack::find_in_static_table(name, value);
     if (static_idx != 0 && static_value_match) {
         encode_integer(output_buffer, 0x80, 7, static_idx); // Indexed Header Field: 1xxxxxxx
-            continue;
-        }
+        return;
+    }
 
-    auto [dyn_idx, dyn_value_match] = find_in_dynamic_table(header); // dyn_idx is 1-based for dynamic part
+    auto [dyn_idx, dyn_value_match] = find_in_dynamic_table(name, value); // dyn_idx is 1-based for dynamic part
     if (dyn_idx != 0 && dyn_value_match) {
         encode_integer(output_buffer, 0x80, 7, Hpack::STATIC_TABLE.size() + dyn_idx);
-            continue;
-        }
+        return;
+    }
 
-        // Determine indexing strategy
-    size_t entry_size = header.name.length() + header.value.length() + 32;
+    // Step 3 & 4: Name match (static first) for the indexed name part of a literal.
+    int name_table_idx = 0;
+    if (static_idx != 0) { // Name matched in static table (value didn't or was empty)
+        name_table_idx = static_idx;
+    } else if (dyn_idx != 0) { // Name matched in dynamic table
+        name_table_idx = static_cast<int>(Hpack::STATIC_TABLE.size()) + dyn_idx;
+    }
+
+    // Determine indexing strategy
+    size_t entry_size = name.length() + value.length() + 32;
     bool can_be_added_to_dynamic_table = entry_size <= own_max_dynamic_table_size_;
 
-    // Step 5: If sensitive, use Literal Never Indexed.
-    if (header.sensitive) {
-        // Try to find name in static or dynamic table for indexed name part
-        int name_table_idx = 0;
-        if (static_idx != 0) { // Name matched in static table (value didn't or was empty)
-            name_table_idx = static_idx;
-        } else if (dyn_idx != 0) { // Name matched in dynamic table
-            name_table_idx = static_cast<int>(Hpack::STATIC_TABLE.size()) + dyn_idx;
-            }
-
-        encode_integer(output_buffer, 0x10, 4, name_table_idx); // Literal Never Indexed: 0001xxxx
-        if (name_table_idx == 0) { // Name is also literal
-            encode_string(output_buffer, header.name, true); // try_huffman = true
-            }
-        encode_string(output_buffer, header.value, true);
+    if (sensitive) {
+        // Step 5: Literal Never Indexed: 0001xxxx
+        encode_integer(output_buffer, 0x10, 4, name_table_idx);
+    } else if (can_be_added_to_dynamic_table) {
+        // Step 6: Literal With Incremental Indexing: 01xxxxxx
+        encode_integer(output_buffer, 0x40, 6, name_table_idx);
+    } else {
+        // Step 7: Literal Without Indexing: 0000xxxx
+        encode_integer(output_buffer, 0x00, 4, name_table_idx);
     }
-    // Step 6: Else, if it can be added, use Literal With Incremental Indexing.
-    else if (can_be_added_to_dynamic_table) {
-        int name_table_idx = 0;
-        if (static_idx != 0) {
-            name_table_idx = static_idx;
-        } else if (dyn_idx != 0) {
-            name_table_idx = static_cast<int>(Hpack::STATIC_TABLE.size()) + dyn_idx;
-            }
-
-        encode_integer(output_buffer, 0x40, 6, name_table_idx); // Literal With Incremental Indexing: 01xxxxxx
-        if (name_table_idx == 0) {
-                encode_string(output_buffer, header.name, true);
-            }
-            encode_string(output_buffer, header.value, true);
-            add_to_dynamic_table(header); // Add to our dynamic table
+    if (name_table_idx == 0) { // Name is also literal
+        encode_string(output_buffer, name, true); // try_huffman = true
     }
-    // Step 7: Else (cannot be added or not sensitive and not chosen for indexing), use Literal Without Indexing.
-    else {
-        int name_table_idx = 0;
-        if (static_idx != 0) {
-            name_table_idx = static_idx;
-        } else if (dyn_idx != 0) {
-            name_table_idx = static_cast<int>(Hpack::STATIC_TABLE.size()) + dyn_idx;
-            }
-
-        encode_integer(output_buffer, 0x00, 4, name_table_idx); // Literal Without Indexing: 0000xxxx
-        if (name_table_idx == 0) {
-                encode_string(output_buffer, header.name, true);
-            }
-            encode_string(output_buffer, header.value, true);
-        }
+    encode_string(output_buffer, value, true);
+    if (!sensitive && can_be_added_to_dynamic_table) {
+        add_to_dynamic_table(name, value); // Add to our dynamic table
     }
-    return {output_buffer, HpackEncodingError::OK};
 }
 
 
@@ -164,8 +143,8 @@ uint32_t HpackEncoder::get_current_dynamic_table_size() const {
 }
 
 
-void HpackEncoder::add_to_dynamic_table(const HttpHeader& header) {
-    size_t entry_size = header.name.length() + header.value.length() + 32;
+void HpackEncoder::add_to_dynamic_table(std::string_view name, std::string_view value) {
+    size_t entry_size = name.length() + value.length() + 32;
 
     if (entry_size > own_max_dynamic_table_size_) {
         dynamic_table_.clear();
@@ -175,7 +154,7 @@ void HpackEncoder::add_to_dynamic_table(const HttpHeader& header) {
 
     evict_from_dynamic_table(static_cast<uint32_t>(entry_size));
 
-    dynamic_table_.push_front(DynamicTableEntry(header.name, header.value));
+    dynamic_table_.push_front(DynamicTableEntry(std::string(name), std::string(value)));
     current_dynamic_table_size_ += static_cast<uint32_t>(dynamic_table_.front().size);
 }
 
@@ -186,10 +165,10 @@ void HpackEncoder::evict_from_dynamic_table(uint32_t required_space) {
     }
 }
 
-std::pair<int, bool> HpackEncoder::find_in_dynamic_table(const HttpHeader& header) {
+std::pair<int, bool> HpackEncoder::find_in_dynamic_table(std::string_view name, std::string_view value) {
     for (size_t i = 0; i < dynamic_table_.size(); ++i) {
-        if (dynamic_table_[i].name == header.name) {
-            bool value_matches = (dynamic_table_[i].value == header.value);
+        if (dynamic_table_[i].name == name) {
+            bool value_matches = (dynamic_table_[i].value == value);
             return {static_cast<int>(i + 1), value_matches};
         }
     }
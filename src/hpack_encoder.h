@@ -1,8 +1,10 @@
 #pragma once
 
 #include "http2_types.h"
+#include "http2_header_list.h"
 #include <vector>
 #include <string>
+#include <string_view>
 #include <deque>
 #include <map> // For reverse lookup in dynamic table, if needed for optimization
 
@@ -29,6 +31,9 @@ public:
     // Returns a pair: a vector of bytes and an HpackEncodingError.
     // In C++23, this could return std::expected<std::vector<std::byte>, HpackEncodingError>.
     std::pair<std::vector<std::byte>, HpackEncodingError> encode(const std::vector<HttpHeader>& headers);
+    // Same, appended to `out`, e.g. straight into a frame buffer after its header.
+    HpackEncodingError encode_into(std::vector<std::byte>& out, const std::vector<HttpHeader>& headers);
+    HpackEncodingError encode_into(std::vector<std::byte>& out, const HeaderList& headers);
 
     // Updates the maximum size of the dynamic table that the peer supports.
     // This is received via SETTINGS_HEADER_TABLE_SIZE from the peer.
@@ -72,13 +77,14 @@ private:
 
     // Helper methods for encoding integers and strings
     void encode_integer(std::vector<std::byte>& buffer, uint8_t prefix_mask, uint8_t prefix_bits, uint64_t value);
-    void encode_string(std::vector<std::byte>& buffer, const std::string& str, bool try_huffman);
+    void encode_string(std::vector<std::byte>& buffer, std::string_view str, bool try_huffman);
+    void encode_field(std::vector<std::byte>& buffer, std::string_view name, std::string_view value, bool sensitive);
 
 
     // Dynamic table management
-    void add_to_dynamic_table(const HttpHeader& header);
+    void add_to_dynamic_table(std::string_view name, std::string_view value);
     void evict_from_dynamic_table(uint32_t required_space);
-    std::pair<int, bool> find_in_dynamic_table(const HttpHeader& header);
+    std::pair<int, bool> find_in_dynamic_table(std::string_view name, std::string_view value);
 
     // --- Placeholder for Huffman Encoding logic ---
     // std::vector<std::byte> huffman_encode(const std::string& str); // In hpack_huffman.h
@@ -1,7 +1,7 @@
 #include "hpack_huffman.h"
-#include <map>
+#include <array>
+#include <cstdint>
 #include <vector>
-#include <algorithm> // For std::fill
 
 // This is a large file. The actual Huffman codes and tree structure
 // are taken directly from RFC 7541, Appendix B.
@@ -9,146 +9,127 @@
 namespace http2 {
 namespace Hpack {
 
-// Huffman Codes (RFC 7541, Appendix B)
-// Pair: <code, number_of_bits>
-static const std::map<uint8_t, std::pair<uint32_t, uint8_t>> HUFFMAN_CODES = {
-    {0, {0x1ff8, 13}}, {1, {0x7fffd8, 23}}, {2, {0xfffffe2, 28}}, {3, {0xfffffe3, 28}},
-    {4, {0xfffffe4, 28}}, {5, {0xfffffe5, 28}}, {6, {0xfffffe6, 28}}, {7, {0xfffffe7, 28}},
-    {8, {0xfffffe8, 28}}, {9, {0xffffea, 24}}, {10, {0x3ffffffc, 30}}, {11, {0xfffffe9, 28}},
-    {12, {0xfffffea, 28}}, {13, {0x3ffffffd, 30}}, {14, {0xfffffeb, 28}}, {15, {0xfffffec, 28}},
-    {16, {0xfffffed, 28}}, {17, {0xfffffee, 28}}, {18, {0xfffffef, 28}}, {19, {0xffffff0, 28}},
-    {20, {0xffffff1, 28}}, {21, {0xffffff2, 28}}, {22, {0x3ffffffe, 30}}, {23, {0xffffff3, 28}},
-    {24, {0xffffff4, 28}}, {25, {0xffffff5, 28}}, {26, {0xffffff6, 28}}, {27, {0xffffff7, 28}},
-    {28, {0xffffff8, 28}}, {29, {0xffffff9, 28}}, {30, {0xffffffa, 28}}, {31, {0xffffffb, 28}},
-    {32, {0x14, 6}}, {33, {0x3f8, 10}}, {34, {0x3f9, 10}}, {35, {0x3fa, 10}},
-    {36, {0x3fb, 10}}, {37, {0x3fc, 10}}, {38, {0x7fa, 11}}, {39, {0x3fd, 10}},
-    {40, {0x3fe, 10}}, {41, {0x3ff, 10}}, {42, {0x7fb, 11}}, {43, {0x7fc, 11}},
-    {44, {0x7fd, 11}}, {45, {0x7fe, 11}}, {46, {0x7ff0, 15}}, {47, {0x7ff1, 15}},
-    {48, {0x0, 5}}, {49, {0x1, 5}}, {50, {0x2, 5}}, {51, {0x15, 6}},
-    {52, {0x16, 6}}, {53, {0x17, 6}}, {54, {0x18, 6}}, {55, {0x19, 6}},
-    {56, {0x1a, 6}}, {57, {0x1b, 6}}, {58, {0x1c, 6}}, {59, {0x1d, 6}},
-    {60, {0x1e, 6}}, {61, {0x1f, 6}}, {62, {0x5c, 7}}, {63, {0x5d, 7}},
-    {64, {0x5e, 7}}, {65, {0x5f, 7}}, {66, {0x60, 7}}, {67, {0x61, 7}},
-    {68, {0x62, 7}}, {69, {0x63, 7}}, {70, {0x64, 7}}, {71, {0x65, 7}},
-    {72, {0x66, 7}}, {73, {0x67, 7}}, {74, {0x68, 7}}, {75, {0x69, 7}},
-    {76, {0x6a, 7}}, {77, {0x6b, 7}}, {78, {0x6c, 7}}, {79, {0x6d, 7}},
-    {80, {0x6e, 7}}, {81, {0x6f, 7}}, {82, {0x70, 7}}, {83, {0x71, 7}},
-    {84, {0x72, 7}}, {85, {0x7f1, 11}}, {86, {0x7f2, 11}}, {87, {0x7f3, 11}},
-    {88, {0x7f4, 11}}, {89, {0x7f5, 11}}, {90, {0x7f6, 11}}, {91, {0x7f7, 11}},
-    {92, {0x7f8, 11}}, {93, {0x7f9, 11}}, {94, {0x7fa0, 15}}, {95, {0x7fa1, 15}},
-    {96, {0x7fa2, 15}}, {97, {0x3, 5}}, {98, {0x20, 6}}, {99, {0x21, 6}},
-    {100, {0x22, 6}}, {101, {0x4, 5}}, {102, {0x23, 6}}, {103, {0x24, 6}},
-    {104, {0x25, 6}}, {105, {0x5, 5}}, {106, {0x26, 6}}, {107, {0x27, 6}},
-    {108, {0x28, 6}}, {109, {0x29, 6}}, {110, {0x2a, 6}}, {111, {0x2b, 6}},
-    {112, {0x2c, 6}}, {113, {0x2d, 6}}, {114, {0x2e, 6}}, {115, {0x6, 5}},
-    {116, {0x7, 5}}, {117, {0x2f, 6}}, {118, {0x73, 7}}, {119, {0x74, 7}},
-    {120, {0x30, 6}}, {121, {0x31, 6}}, {122, {0x32, 6}}, {123, {0x7fa3, 15}},
-    {124, {0x7fa4, 15}}, {125, {0x7fa5, 15}}, {126, {0x7fa6, 15}}, {127, {0x7fa7, 15}},
-    {128, {0x7fa8, 15}}, {129, {0x7fa9, 15}}, {130, {0x7faa, 15}}, {131, {0x7fab, 15}},
-    {132, {0x7fac, 15}}, {133, {0x7fad, 15}}, {134, {0x7fae, 15}}, {135, {0x7faf, 15}},
-    {136, {0x7fb0, 15}}, {137, {0x7fb1, 15}}, {138, {0x7fb2, 15}}, {139, {0x7fb3, 15}},
-    {140, {0x7fb4, 15}}, {141, {0x7fb5, 15}}, {142, {0x7fb6, 15}}, {143, {0x7fb7, 15}},
-    {144, {0x7fb8, 15}}, {145, {0x7fb9, 15}}, {146, {0x7fba, 15}}, {147, {0x7fbb, 15}},
-    {148, {0x7fbc, 15}}, {149, {0x7fbd, 15}}, {150, {0x7fbe, 15}}, {151, {0x7fbf, 15}},
-    {152, {0x7fc0, 15}}, {153, {0x7fc1, 15}}, {154, {0x7fc2, 15}}, {155, {0x7fc3, 15}},
-    {156, {0x7fc4, 15}}, {157, {0x7fc5, 15}}, {158, {0x7fc6, 15}}, {159, {0x7fc7, 15}},
-    {160, {0x7fc8, 15}}, {161, {0x7fc9, 15}}, {162, {0x7fca, 15}}, {163, {0x7fcb, 15}},
-    {164, {0x7fcc, 15}}, {165, {0x7fcd, 15}}, {166, {0x7fce, 15}}, {167, {0x7fcf, 15}},
-    {168, {0x7fd0, 15}}, {169, {0x7fd1, 15}}, {170, {0x7fd2, 15}}, {171, {0x7fd3, 15}},
-    {172, {0x7fd4, 15}}, {173, {0x7fd5, 15}}, {174, {0x7fd6, 15}}, {175, {0x7fd7, 15}},
-    {176, {0x7fd8, 15}}, {177, {0x7fd9, 15}}, {178, {0x7fda, 15}}, {179, {0x7fdb, 15}},
-    {180, {0x7fdc, 15}}, {181, {0x7fdd, 15}}, {182, {0x7fde, 15}}, {183, {0x7fdf, 15}},
-    {184, {0x7fe0, 15}}, {185, {0x7fe1, 15}}, {186, {0x7fe2, 15}}, {187, {0x7fe3, 15}},
-    {188, {0x7fe4, 15}}, {189, {0x7fe5, 15}}, {190, {0x7fe6, 15}}, {191, {0x7fe7, 15}},
-    {192, {0x7fe8, 15}}, {193, {0x7fe9, 15}}, {194, {0x7fea, 15}}, {195, {0x7feb, 15}},
-    {196, {0x7fec, 15}}, {197, {0x7fed, 15}}, {198, {0x7fee, 15}}, {199, {0x7fef, 15}},
-    {200, {0x7ff2, 15}}, {201, {0x7ff3, 15}}, {202, {0x7ff4, 15}}, {203, {0x7ff5, 15}},
-    {204, {0x7ff6, 15}}, {205, {0x7ff7, 15}}, {206, {0x7ff80, 19}}, {207, {0x7ff81, 19}},
-    {208, {0x7ff82, 19}}, {209, {0x7ff83, 19}}, {210, {0x7ff84, 19}}, {211, {0x7ff85, 19}},
-    {212, {0x7ff86, 19}}, {213, {0x7ff87, 19}}, {214, {0x7ff88, 19}}, {215, {0x7ff89, 19}},
-    {216, {0x7ff8a, 19}}, {217, {0x7ff8b, 19}}, {218, {0x7ff8c, 19}}, {219, {0x7ff8d, 19}},
-    {220, {0x7ff8e, 19}}, {221, {0x7ff8f, 19}}, {222, {0x7ff90, 19}}, {223, {0x7ff91, 19}},
-    {224, {0x7ff92, 19}}, {225, {0x7ff93, 19}}, {226, {0x7ff94, 19}}, {227, {0x7ff95, 19}},
-    {228, {0x7ff96, 19}}, {229, {0x7ff97, 19}}, {230, {0x7ff98, 19}}, {231, {0x7ff99, 19}},
-    {232, {0x7ff9a, 19}}, {233, {0x7ff9b, 19}}, {234, {0x7ff9c, 19}}, {235, {0x7ff9d, 19}},
-    {236, {0x7ff9e, 19}}, {237, {0x7ff9f, 19}}, {238, {0x7ffa0, 19}}, {239, {0x7ffa1, 19}},
-    {240, {0x7ffa2, 19}}, {241, {0x7ffa3, 19}}, {242, {0x7ffa4, 19}}, {243, {0x7ffa5, 19}},
-    {244, {0x7ffa6, 19}}, {245, {0x7ffa7, 19}}, {246, {0x7ffa8, 19}}, {247, {0x7ffa9, 19}},
-    {248, {0x7ffaa, 19}}, {249, {0x7ffab, 19}}, {250, {0x7ffac, 19}}, {251, {0x7ffad, 19}},
-    {252, {0x7ffae, 19}}, {253, {0x7ffaf, 19}}, {254, {0x7ffb0, 19}}, {255, {0x7ffb1, 19}},
-    {256, {0x7ffb2, 19}} // EOS (End of String) - Not used for encoding actual chars
-    // The actual EOS for padding is all 1s up to 30 bits.
+// Huffman Codes (RFC 7541, Appendix B), indexed by symbol; 256 is EOS.
+// Everything below is constexpr, so the tables sit in read-only data and nothing is built at startup.
+struct HuffmanCode {
+    uint32_t code;
+    uint8_t bits;
 };
-const uint32_t HUFFMAN_EOS = 0x3fffffff; // 30 bits of 1s
 
-// For decoding, a tree or a multi-level array lookup is more efficient.
-// For decoding, a tree or a multi-level array lookup is more efficient.
-// A more optimized version would use a prebuilt static tree, possibly with state for faster lookup.
+static constexpr std::array<HuffmanCode, 257> HUFFMAN_CODES = {{
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28}, // 0
+    {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28}, // 4
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28}, // 8
+    {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28}, // 12
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28}, // 16
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28}, // 20
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28}, // 24
+    {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28}, // 28
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12}, // 32
+    {0x1ff9, 13}, {0x15, 6}, {0xf8, 8}, {0x7fa, 11}, // 36
+    {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11}, // 40
+    {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6}, // 44
+    {0x0, 5}, {0x1, 5}, {0x2, 5}, {0x19, 6}, // 48
+    {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6}, // 52
+    {0x1e, 6}, {0x1f, 6}, {0x5c, 7}, {0xfb, 8}, // 56
+    {0x7ffc, 15}, {0x20, 6}, {0xffb, 12}, {0x3fc, 10}, // 60
+    {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7}, // 64
+    {0x5f, 7}, {0x60, 7}, {0x61, 7}, {0x62, 7}, // 68
+    {0x63, 7}, {0x64, 7}, {0x65, 7}, {0x66, 7}, // 72
+    {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7}, // 76
+    {0x6b, 7}, {0x6c, 7}, {0x6d, 7}, {0x6e, 7}, // 80
+    {0x6f, 7}, {0x70, 7}, {0x71, 7}, {0x72, 7}, // 84
+    {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13}, // 88
+    {0x7fff0, 19}, {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6}, // 92
+    {0x7ffd, 15}, {0x3, 5}, {0x23, 6}, {0x4, 5}, // 96
+    {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6}, // 100
+    {0x27, 6}, {0x6, 5}, {0x74, 7}, {0x75, 7}, // 104
+    {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5}, // 108
+    {0x2b, 6}, {0x76, 7}, {0x2c, 6}, {0x8, 5}, // 112
+    {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7}, // 116
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15}, // 120
+    {0x7fc, 11}, {0x3ffd, 14}, {0x1ffd, 13}, {0xffffffc, 28}, // 124
+    {0xfffe6, 20}, {0x3fffd2, 22}, {0xfffe7, 20}, {0xfffe8, 20}, // 128
+    {0x3fffd3, 22}, {0x3fffd4, 22}, {0x3fffd5, 22}, {0x7fffd9, 23}, // 132
+    {0x3fffd6, 22}, {0x7fffda, 23}, {0x7fffdb, 23}, {0x7fffdc, 23}, // 136
+    {0x7fffdd, 23}, {0x7fffde, 23}, {0xffffeb, 24}, {0x7fffdf, 23}, // 140
+    {0xffffec, 24}, {0xffffed, 24}, {0x3fffd7, 22}, {0x7fffe0, 23}, // 144
+    {0xffffee, 24}, {0x7fffe1, 23}, {0x7fffe2, 23}, {0x7fffe3, 23}, // 148
+    {0x7fffe4, 23}, {0x1fffdc, 21}, {0x3fffd8, 22}, {0x7fffe5, 23}, // 152
+    {0x3fffd9, 22}, {0x7fffe6, 23}, {0x7fffe7, 23}, {0xffffef, 24}, // 156
+    {0x3fffda, 22}, {0x1fffdd, 21}, {0xfffe9, 20}, {0x3fffdb, 22}, // 160
+    {0x3fffdc, 22}, {0x7fffe8, 23}, {0x7fffe9, 23}, {0x1fffde, 21}, // 164
+    {0x7fffea, 23}, {0x3fffdd, 22}, {0x3fffde, 22}, {0xfffff0, 24}, // 168
+    {0x1fffdf, 21}, {0x3fffdf, 22}, {0x7fffeb, 23}, {0x7fffec, 23}, // 172
+    {0x1fffe0, 21}, {0x1fffe1, 21}, {0x3fffe0, 22}, {0x1fffe2, 21}, // 176
+    {0x7fffed, 23}, {0x3fffe1, 22}, {0x7fffee, 23}, {0x7fffef, 23}, // 180
+    {0xfffea, 20}, {0x3fffe2, 22}, {0x3fffe3, 22}, {0x3fffe4, 22}, // 184
+    {0x7ffff0, 23}, {0x3fffe5, 22}, {0x3fffe6, 22}, {0x7ffff1, 23}, // 188
+    {0x3ffffe0, 26}, {0x3ffffe1, 26}, {0xfffeb, 20}, {0x7fff1, 19}, // 192
+    {0x3fffe7, 22}, {0x7ffff2, 23}, {0x3fffe8, 22}, {0x1ffffec, 25}, // 196
+    {0x3ffffe2, 26}, {0x3ffffe3, 26}, {0x3ffffe4, 26}, {0x7ffffde, 27}, // 200
+    {0x7ffffdf, 27}, {0x3ffffe5, 26}, {0xfffff1, 24}, {0x1ffffed, 25}, // 204
+    {0x7fff2, 19}, {0x1fffe3, 21}, {0x3ffffe6, 26}, {0x7ffffe0, 27}, // 208
+    {0x7ffffe1, 27}, {0x3ffffe7, 26}, {0x7ffffe2, 27}, {0xfffff2, 24}, // 212
+    {0x1fffe4, 21}, {0x1fffe5, 21}, {0x3ffffe8, 26}, {0x3ffffe9, 26}, // 216
+    {0xffffffd, 28}, {0x7ffffe3, 27}, {0x7ffffe4, 27}, {0x7ffffe5, 27}, // 220
+    {0xfffec, 20}, {0xfffff3, 24}, {0xfffed, 20}, {0x1fffe6, 21}, // 224
+    {0x3fffe9, 22}, {0x1fffe7, 21}, {0x1fffe8, 21}, {0x7ffff3, 23}, // 228
+    {0x3fffea, 22}, {0x3fffeb, 22}, {0x1ffffee, 25}, {0x1ffffef, 25}, // 232
+    {0xfffff4, 24}, {0xfffff5, 24}, {0x3ffffea, 26}, {0x7ffff4, 23}, // 236
+    {0x3ffffeb, 26}, {0x7ffffe6, 27}, {0x3ffffec, 26}, {0x3ffffed, 26}, // 240
+    {0x7ffffe7, 27}, {0x7ffffe8, 27}, {0x7ffffe9, 27}, {0x7ffffea, 27}, // 244
+    {0x7ffffeb, 27}, {0xffffffe, 28}, {0x7ffffec, 27}, {0x7ffffed, 27}, // 248
+    {0x7ffffee, 27}, {0x7ffffef, 27}, {0x7fffff0, 27}, {0x3ffffee, 26}, // 252
+    {0x3fffffff, 30} // 256: EOS
+}};
+constexpr uint16_t HUFFMAN_EOS_SYMBOL = 256;
+
+// Decoding walks a binary tree over the codes, stored as a flat array of nodes (a full binary tree
+// with 257 leaves has 513 nodes). Node 0 is the root, so a child index of 0 means "no child".
 struct HuffmanDecodeNode {
-    std::unique_ptr<HuffmanDecodeNode> children[2]; // 0 and 1
-    std::optional<uint8_t> symbol = std::nullopt;   // Decoded symbol if this is a leaf
-    bool is_eos_prefix = false; // True if this node represents a prefix of the EOS symbol
-
-    HuffmanDecodeNode() = default;
+    uint16_t children[2] = {0, 0};
+    int16_t symbol = -1;        // Decoded symbol if this is a leaf
+    bool is_eos_prefix = false; // True if this node lies on the EOS code path
 };
 
-static std::unique_ptr<HuffmanDecodeNode> HUFFMAN_DECODE_TREE_ROOT_INSTANCE = nullptr;
-
-// Function to build the Huffman decoding tree (RFC 7541, Appendix B)
-static void initialize_huffman_decode_tree() {
-    if (HUFFMAN_DECODE_TREE_ROOT_INSTANCE) return;
-
-    HUFFMAN_DECODE_TREE_ROOT_INSTANCE = std::make_unique<HuffmanDecodeNode>();
-
-    for (uint32_t i = 0; i <= 256; ++i) { // Iterate through all possible symbols (0-255 for chars, 256 for EOS)
-        if (HUFFMAN_CODES.count(static_cast<uint8_t>(i)) == 0 && i != 256) { // EOS (256) is not in HUFFMAN_CODES map directly
-            continue;
-        }
-
-        uint32_t code;
-        uint8_t bits;
-
-        if (i == 256) { // EOS symbol
-            code = HUFFMAN_EOS; // 0x3fffffff (30 bits of 1s)
-            bits = 30;
-        } else {
-            const auto& entry = HUFFMAN_CODES.at(static_cast<uint8_t>(i));
-            code = entry.first;
-            bits = entry.second;
-        }
-
-        HuffmanDecodeNode* current = HUFFMAN_DECODE_TREE_ROOT_INSTANCE.get();
-        for (int j = bits - 1; j >= 0; --j) {
-            int bit = (code >> j) & 1;
-            if (!current->children[bit]) {
-                current->children[bit] = std::make_unique<HuffmanDecodeNode>();
-            }
-            current = current->children[bit].get();
-            if (i == 256) { // Mark all nodes on EOS path as EOS prefixes
-                current->is_eos_prefix = true;
-            }
-        }
-        if (i != 256) { // Don't store EOS as a decodable symbol in the same way
-            current->symbol = static_cast<uint8_t>(i);
+using HuffmanDecodeTree = std::array<HuffmanDecodeNode, 2 * HUFFMAN_CODES.size() - 1>;
+
+static constexpr HuffmanDecodeTree build_huffman_decode_tree() {
+    HuffmanDecodeTree tree{};
+    uint16_t node_count = 1;
+    for (uint16_t symbol = 0; symbol < HUFFMAN_CODES.size(); ++symbol) {
+        const HuffmanCode& entry = HUFFMAN_CODES[symbol];
+        uint16_t current = 0;
+        for (int j = entry.bits - 1; j >= 0; --j) {
+            int bit = (entry.code >> j) & 1;
+            if (!tree[current].children[bit]) tree[current].children[bit] = node_count++;
+            current = tree[current].children[bit];
+            if (symbol == HUFFMAN_EOS_SYMBOL) tree[current].is_eos_prefix = true;
         }
+        // EOS is never decoded as a symbol; reaching its leaf is an error.
+        if (symbol != HUFFMAN_EOS_SYMBOL) tree[current].symbol = static_cast<int16_t>(symbol);
     }
+    return tree;
 }
 
+static constexpr HuffmanDecodeTree HUFFMAN_DECODE_TREE = build_huffman_decode_tree();
+
 
 std::pair<std::vector<std::byte>, HuffmanError> huffman_encode(const std::string& input) {
     std::vector<std::byte> encoded_data;
+    huffman_encode_into(encoded_data, input);
+    return {encoded_data, HuffmanError::OK};
+}
+
+void huffman_encode_into(std::vector<std::byte>& encoded_data, std::string_view input) {
     uint64_t current_byte_accumulator = 0;
     int bits_in_accumulator = 0;
 
     for (char ch_signed : input) {
         uint8_t ch = static_cast<uint8_t>(ch_signed);
-        auto it = HUFFMAN_CODES.find(ch);
-        if (it == HUFFMAN_CODES.end()) {
-            return {{}, HuffmanError::INVALID_INPUT}; // Character not in Huffman table
-        }
-
-        uint32_t code = it->second.first;
-        uint8_t num_bits = it->second.second;
+        uint32_t code = HUFFMAN_CODES[ch].code;
+        uint8_t num_bits = HUFFMAN_CODES[ch].bits;
 
         current_byte_accumulator <<= num_bits;
         current_byte_accumulator |= code;
@@ -166,90 +147,85 @@ std::pair<std::vector<std::byte>, HuffmanError> huffman_encode(const std::string
         // "...any bits of the EOS symbol not consumed are padding and MUST be set to 1"
         uint8_t remaining_bits_in_byte = 8 - bits_in_accumulator;
         // Get the required number of MSBs from the EOS code.
-        // HUFFMAN_EOS is 30 bits of 1s.
+        // EOS is 30 bits of 1s.
         uint32_t eos_prefix_mask = (1 << remaining_bits_in_byte) - 1; // e.g., if remaining_bits_in_byte is 3, mask is 0b111
-        uint32_t eos_prefix = (HUFFMAN_EOS >> (30 - remaining_bits_in_byte)) & eos_prefix_mask;
+        uint32_t eos_prefix = (HUFFMAN_CODES[HUFFMAN_EOS_SYMBOL].code >> (30 - remaining_bits_in_byte)) & eos_prefix_mask;
         // Since EOS is all 1s, this prefix will also be all 1s.
 
         current_byte_accumulator <<= remaining_bits_in_byte;
         current_byte_accumulator |= eos_prefix;
         encoded_data.push_back(static_cast<std::byte>(current_byte_accumulator & 0xFF));
     }
-
-    return {encoded_data, HuffmanError::OK};
 }
 
 std::pair<std::string, HuffmanError> huffman_decode(std::span<const std::byte> input, size_t max_output_length) {
-    if (!HUFFMAN_DECODE_TREE_ROOT_INSTANCE) {
-        initialize_huffman_decode_tree();
-    }
-
     std::string output;
+    HuffmanError err = huffman_decode_into(output, input, max_output_length);
+    if (err != HuffmanError::OK) return {"", err};
+    return {std::move(output), HuffmanError::OK};
+}
+
+HuffmanError huffman_decode_into(std::string& output, std::span<const std::byte> input, size_t max_output_length) {
+    output.clear();
     output.reserve(input.size() * 2); // Pre-allocate, common heuristic
 
-    const HuffmanDecodeNode* current_node = HUFFMAN_DECODE_TREE_ROOT_INSTANCE.get();
-    if (!current_node) return { "", HuffmanError::INVALID_INPUT}; // Should not happen
+    uint16_t current_node = 0; // Root
+    int bits_since_symbol = 0; // Length of the code prefix currently being walked
 
     for (const auto& byte : input) {
         for (int i = 7; i >= 0; --i) {
             bool bit = (static_cast<uint8_t>(byte) >> i) & 1;
             
-            if (bit) {
-                current_node = current_node->children[1].get();
-            } else {
-                current_node = current_node->children[0].get();
-            }
+            current_node = HUFFMAN_DECODE_TREE[current_node].children[bit];
+
+            ++bits_since_symbol;
 
             if (!current_node) {
                  // This indicates a sequence of bits that does not map to any valid Huffman code.
                  // It's a protocol error in the compressed data.
-                return { "", HuffmanError::INVALID_INPUT}; // Should not happen with valid input
+                return HuffmanError::INVALID_INPUT; // Should not happen with valid input
             }
 
-            if (current_node->symbol) {
-                output += static_cast<char>(current_node->symbol.value());
+            if (HUFFMAN_DECODE_TREE[current_node].symbol >= 0) {
+                output += static_cast<char>(HUFFMAN_DECODE_TREE[current_node].symbol);
 
                 if (output.length() > max_output_length) {
-                    return { "", HuffmanError::BUFFER_TOO_SMALL };
+                    return HuffmanError::BUFFER_TOO_SMALL;
                 }
 
-                current_node = HUFFMAN_DECODE_TREE_ROOT_INSTANCE.get(); // Reset for the next character
-            } else if (current_node->is_eos_prefix) {
-                // The bit sequence matches a prefix of the EOS. This is only valid
-                // if it's the end of the input stream. We can return here.
-                return { output, HuffmanError::OK };
+                current_node = 0; // Reset for the next character
+                bits_since_symbol = 0;
             }
+            // A prefix of EOS is not a symbol: many codes start with 1-bits, so it can only be
+            // judged as padding once the input is exhausted (below).
         }
     }
 
+    // RFC 7541 Section 5.2: padding is the most significant bits of EOS, strictly shorter than 8 bits.
+    if (current_node != 0 && HUFFMAN_DECODE_TREE[current_node].is_eos_prefix && bits_since_symbol <= 7) {
+        return HuffmanError::OK;
+    }
+
     // After iterating through all bytes, if we are not in a state that represents
     // the end of a character, it means the code is incomplete.
     // However, HPACK specifies that padding for the last byte is the prefix of EOS.
     // If we end up here, it means the last byte was fully consumed without reaching
     // a terminal symbol and without being an EOS prefix. This is only valid if the
     // final state is the root, implying an empty input.
-    // A more strict check would be `if (current_node != HUFFMAN_DECODE_TREE_ROOT_INSTANCE.get())`.
     // The spec implies any non-terminal state at the end is an error.
-    if (current_node != HUFFMAN_DECODE_TREE_ROOT_INSTANCE.get()) {
-         return { "", HuffmanError::INCOMPLETE_CODE };
+    if (current_node != 0) {
+         return HuffmanError::INCOMPLETE_CODE;
     }
 
-    return { output, HuffmanError::OK };
+    return HuffmanError::OK;
 }
 
 
-size_t get_huffman_encoded_length(const std::string& input) {
+size_t get_huffman_encoded_length(std::string_view input) {
     size_t total_bits = 0;
     for (char ch_signed : input) {
         uint8_t ch = static_cast<uint8_t>(ch_signed);
-        auto it = HUFFMAN_CODES.find(ch);
-        if (it == HUFFMAN_CODES.end()) {
-            // This case should ideally not happen if input is valid.
-            // Or, it means this character cannot be Huffman encoded.
-            // For length calculation, this is problematic. Assume error or very large length.
-            return std::string::npos; // Indicate error or unsuitability
-        }
-        total_bits += it->second.second;
+        total_bits += HUFFMAN_CODES[ch].bits; // Every octet has a code
     }
     return (total_bits + 7) / 8; // Round up to the nearest byte
 }
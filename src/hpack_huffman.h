@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <string>
+#include <string_view>
 #include <span> // C++20
 #include <optional>
 
@@ -22,6 +23,8 @@ enum class HuffmanError {
 // Returns a pair: encoded data and HuffmanError.
 // In C++23, std::expected<std::vector<std::byte>, HuffmanError> would be better.
 std::pair<std::vector<std::byte>, HuffmanError> huffman_encode(const std::string& input);
+// Same, appended to `out`. Every octet has a code, so this cannot fail.
+void huffman_encode_into(std::vector<std::byte>& out, std::string_view input);
 
 // Decodes a string using the HPACK Huffman code.
 // RFC 7541, Section 5.2 and Appendix B.
@@ -29,11 +32,14 @@ std::pair<std::vector<std::byte>, HuffmanError> huffman_encode(const std::string
 // In C++23, std::expected<std::string, HuffmanError> would be better.
 // The 'max_output_length' is a safeguard against decompression bombs.
 std::pair<std::string, HuffmanError> huffman_decode(std::span<const std::byte> input, size_t max_output_length = 16384 * 4); // Default max e.g. 4x typical max header list size
+// Same, into `output` (cleared first), so a caller decoding many strings can reuse one buffer.
+// On error `output` holds an unspecified prefix.
+HuffmanError huffman_decode_into(std::string& output, std::span<const std::byte> input, size_t max_output_length = 16384 * 4);
 
 
 // Helper function to get the length of the Huffman encoded version of a string.
 // Useful for deciding whether to use Huffman encoding or literal representation.
-size_t get_huffman_encoded_length(const std::string& input);
+size_t get_huffman_encoded_length(std::string_view input);
 
 } // namespace Hpack
 } // namespace http2
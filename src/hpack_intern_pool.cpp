@@ -0,0 +1,71 @@
+#include "hpack_intern_pool.h"
+
+#include <mutex>
+
+namespace http2 {
+
+HeaderInternPool::HeaderInternPool(HeaderInternPoolOptions options) : options_(options) {}
+
+HeaderInternPool::Handle HeaderInternPool::intern(std::string_view str) {
+    lookups_.fetch_add(1, std::memory_order_relaxed);
+    if (str.size() > options_.max_string_length) return std::make_shared<const std::string>(str);
+    {
+        std::shared_lock lock(mutex_);
+        auto it = strings_.find(str);
+        if (it != strings_.end()) {
+            hits_.fetch_add(1, std::memory_order_relaxed);
+            return it->second;
+        }
+    }
+
+    std::unique_lock lock(mutex_);
+    auto it = strings_.find(str); // Another thread may have added it in between
+    if (it != strings_.end()) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        return it->second;
+    }
+    auto handle = std::make_shared<const std::string>(str);
+    if (strings_.size() >= options_.max_entries) return handle;
+    strings_.emplace(std::string_view(*handle), handle);
+    pooled_bytes_ += handle->size();
+    return handle;
+}
+
+size_t HeaderInternPool::collect() {
+    std::unique_lock lock(mutex_);
+    // With the lock held nobody can obtain a new reference to an entry that only the pool holds,
+    // so a use count of 1 is final.
+    size_t dropped = 0;
+    for (auto it = strings_.begin(); it != strings_.end();) {
+        if (it->second.use_count() == 1) {
+            pooled_bytes_ -= it->second->size();
+            it = strings_.erase(it);
+            ++dropped;
+        } else {
+            ++it;
+        }
+    }
+    return dropped;
+}
+
+size_t HeaderInternPool::get_entry_count() const {
+    std::shared_lock lock(mutex_);
+    return strings_.size();
+}
+
+size_t HeaderInternPool::get_pooled_bytes() const {
+    std::shared_lock lock(mutex_);
+    return pooled_bytes_;
+}
+
+size_t HeaderInternPool::get_saved_bytes() const {
+    std::shared_lock lock(mutex_);
+    size_t saved = 0;
+    for (const auto& [view, handle] : strings_) {
+        long users = handle.use_count() - 1; // Not counting the pool's own reference
+        if (users > 1) saved += static_cast<size_t>(users - 1) * view.size();
+    }
+    return saved;
+}
+
+} // namespace http2
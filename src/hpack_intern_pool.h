@@ -0,0 +1,65 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace http2 {
+
+// Shares the strings held by HPACK dynamic tables between connections.
+//
+// Every connection keeps its own copy of each header its peer indexed, so 100k gRPC clients
+// store "content-type: application/grpc", their user-agent and the like 100k times. A decoder
+// given a pool (HpackDecoder::set_intern_pool, Http2Connection::set_header_intern_pool) stores
+// references to the pool's single copy instead. Header lists returned by decode() are unchanged:
+// they still own their strings.
+//
+// Lookups take a shared lock and only insertions of new strings take the exclusive one, so the
+// pool can be shared by the threads of a shard (or the whole process); lookups for strings that
+// are already pooled do not serialize. Strings are reference counted: collect() drops the ones no
+// dynamic table refers to any more, and is meant to be called from a periodic timer.
+struct HeaderInternPoolOptions {
+    size_t max_string_length = 256; // Longer strings are kept per connection
+    size_t max_entries = 1u << 16;  // Once full, new strings are kept per connection until collect()
+};
+
+class HeaderInternPool {
+public:
+    using Handle = std::shared_ptr<const std::string>;
+
+    explicit HeaderInternPool(HeaderInternPoolOptions options = {});
+
+    HeaderInternPool(const HeaderInternPool&) = delete;
+    HeaderInternPool& operator=(const HeaderInternPool&) = delete;
+
+    // Returns the pooled copy of `str`, adding it if needed. Strings the pool does not take (too
+    // long, pool full) get a private copy, so the result is always usable.
+    Handle intern(std::string_view str);
+
+    // Drops strings that only the pool refers to. Returns how many were dropped.
+    size_t collect();
+
+    size_t get_entry_count() const;
+    // String bytes held by the pool (one copy each).
+    size_t get_pooled_bytes() const;
+    // String bytes that would exist if every reference had its own copy, minus the pooled ones.
+    size_t get_saved_bytes() const;
+    uint64_t get_lookup_count() const { return lookups_.load(std::memory_order_relaxed); }
+    uint64_t get_hit_count() const { return hits_.load(std::memory_order_relaxed); }
+
+private:
+    HeaderInternPoolOptions options_;
+    mutable std::shared_mutex mutex_;
+    // Keys view the string owned by the mapped handle.
+    std::unordered_map<std::string_view, Handle> strings_;
+    size_t pooled_bytes_ = 0;
+    std::atomic<uint64_t> lookups_{0};
+    std::atomic<uint64_t> hits_{0};
+};
+
+} // namespace http2
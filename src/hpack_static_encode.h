@@ -0,0 +1,132 @@
+#pragma once
+
+#include "hpack_static_table.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+
+namespace http2 {
+namespace Hpack {
+
+// Compile-time HPACK encoding of header lists that never change, e.g. the fixed part of every
+// gRPC request. Pseudo-header fields have to precede regular fields (RFC 9113 Section 8.3), so
+// the fixed fields of each kind go on their own side of the per-request ones:
+//
+//   constexpr auto GRPC_PSEUDO = Hpack::static_encode<
+//       Hpack::StaticHeader<":method", "POST">, Hpack::StaticHeader<":scheme", "https">>();
+//   constexpr auto GRPC_FIELDS = Hpack::static_encode<
+//       Hpack::StaticHeader<"content-type", "application/grpc">, Hpack::StaticHeader<"te", "trailers">>();
+//   connection.send_headers(stream_id, GRPC_PSEUDO, {{":path", path}, {":authority", host}}, GRPC_FIELDS, false);
+//
+// Only representations that leave the dynamic table alone are used: an Indexed Header Field for
+// a static table match, otherwise a Literal Header Field without Indexing (static name index when
+// there is one, literal name otherwise). Strings are not Huffman-coded. The block therefore means
+// the same thing in front of any header block on any connection, and can be concatenated with the
+// output of HpackEncoder. It can not carry a Dynamic Table Size Update, which HpackEncoder never
+// emits either.
+
+// A string literal usable as a template argument.
+template <size_t N>
+struct FixedString {
+    char chars[N]{};
+
+    constexpr FixedString(const char (&str)[N]) { std::copy_n(str, N, chars); }
+    constexpr std::string_view view() const { return {chars, N - 1}; }
+};
+
+template <FixedString Name, FixedString Value>
+struct StaticHeader {
+    static constexpr std::string_view name = Name.view();
+    static constexpr std::string_view value = Value.view();
+
+    static_assert(std::none_of(name.begin(), name.end(), [](char c) { return c >= 'A' && c <= 'Z'; }),
+                  "HTTP/2 header names must be lowercase (RFC 9113 Section 8.2.1)");
+};
+
+template <size_t N>
+struct StaticHeaderBlock {
+    std::array<std::byte, N> bytes{};
+
+    constexpr size_t size() const { return N; }
+    constexpr std::span<const std::byte> span() const { return bytes; }
+    constexpr operator std::span<const std::byte>() const { return bytes; }
+};
+
+namespace detail {
+
+constexpr size_t integer_size(uint64_t value, uint8_t prefix_bits) {
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) return 1;
+    size_t size = 2;
+    for (value -= max_prefix; value >= 128; value /= 128) ++size;
+    return size;
+}
+
+constexpr void write_integer(std::byte* out, size_t& pos, uint8_t prefix_mask, uint8_t prefix_bits, uint64_t value) {
+    uint64_t max_prefix = (1u << prefix_bits) - 1;
+    if (value < max_prefix) {
+        out[pos++] = static_cast<std::byte>(prefix_mask | value);
+        return;
+    }
+    out[pos++] = static_cast<std::byte>(prefix_mask | max_prefix);
+    for (value -= max_prefix; value >= 128; value /= 128) {
+        out[pos++] = static_cast<std::byte>(0x80 | (value % 128));
+    }
+    out[pos++] = static_cast<std::byte>(value);
+}
+
+constexpr bool pseudo_headers_first(std::initializer_list<std::string_view> names) {
+    bool regular_seen = false;
+    for (std::string_view name : names) {
+        bool pseudo = !name.empty() && name.front() == ':';
+        if (pseudo && regular_seen) return false;
+        regular_seen = regular_seen || !pseudo;
+    }
+    return true;
+}
+
+constexpr size_t field_size(std::string_view name, std::string_view value) {
+    auto [index, value_matches] = find_in_static_table(name, value);
+    if (value_matches) return integer_size(index, 7);
+    size_t size = integer_size(index, 4) + integer_size(value.size(), 7) + value.size();
+    if (index == 0) size += integer_size(name.size(), 7) + name.size();
+    return size;
+}
+
+constexpr void write_field(std::byte* out, size_t& pos, std::string_view name, std::string_view value) {
+    auto [index, value_matches] = find_in_static_table(name, value);
+    if (value_matches) {
+        write_integer(out, pos, 0x80, 7, index); // Indexed Header Field
+        return;
+    }
+    write_integer(out, pos, 0x00, 4, index); // Literal Header Field without Indexing
+    if (index == 0) {
+        write_integer(out, pos, 0x00, 7, name.size());
+        for (char c : name) out[pos++] = static_cast<std::byte>(c);
+    }
+    write_integer(out, pos, 0x00, 7, value.size());
+    for (char c : value) out[pos++] = static_cast<std::byte>(c);
+}
+
+} // namespace detail
+
+template <typename... Headers>
+constexpr auto static_encode() {
+    static_assert(detail::pseudo_headers_first({Headers::name...}),
+                  "Pseudo-header fields must precede regular fields (RFC 9113 Section 8.3)");
+    constexpr size_t size = (detail::field_size(Headers::name, Headers::value) + ... + 0);
+    StaticHeaderBlock<size> block;
+    if constexpr (size > 0) {
+        size_t pos = 0;
+        (detail::write_field(block.bytes.data(), pos, Headers::name, Headers::value), ...);
+    }
+    return block;
+}
+
+} // namespace Hpack
+} // namespace http2
@@ -1,9 +1,10 @@
 #pragma once
 
 #include "http2_types.h" // For HttpHeader
-#include <vector>
-#include <string>
+#include <array>
 #include <optional>
+#include <string_view>
+#include <utility>
 
 namespace http2 {
 namespace Hpack {
@@ -12,7 +13,77 @@ namespace Hpack {
 // The static table consists of a predefined list of common header fields.
 // Entries are identified by a 1-based index.
 
-const extern std::vector<HttpHeader> STATIC_TABLE;
+struct StaticTableEntry {
+    std::string_view name;
+    std::string_view value;
+};
+
+// A constexpr array of views into string literals: it lives in read-only data, needs no
+// initialization at startup and can be used in constant expressions.
+// Note: Index is 1-based. STATIC_TABLE[0] corresponds to index 1.
+inline constexpr std::array<StaticTableEntry, 61> STATIC_TABLE = {{
+    {":authority", ""}, // 1
+    {":method", "GET"}, // 2
+    {":method", "POST"}, // 3
+    {":path", "/"}, // 4
+    {":path", "/index.html"}, // 5
+    {":scheme", "http"}, // 6
+    {":scheme", "https"}, // 7
+    {":status", "200"}, // 8
+    {":status", "204"}, // 9
+    {":status", "206"}, // 10
+    {":status", "304"}, // 11
+    {":status", "400"}, // 12
+    {":status", "404"}, // 13
+    {":status", "500"}, // 14
+    {"accept-charset", ""}, // 15
+    {"accept-encoding", "gzip, deflate"}, // 16
+    {"accept-language", ""}, // 17
+    {"accept-ranges", ""}, // 18
+    {"accept", ""}, // 19
+    {"access-control-allow-origin", ""}, // 20
+    {"age", ""}, // 21
+    {"allow", ""}, // 22
+    {"authorization", ""}, // 23
+    {"cache-control", ""}, // 24
+    {"content-disposition", ""}, // 25
+    {"content-encoding", ""}, // 26
+    {"content-language", ""}, // 27
+    {"content-length", ""}, // 28
+    {"content-location", ""}, // 29
+    {"content-range", ""}, // 30
+    {"content-type", ""}, // 31
+    {"cookie", ""}, // 32
+    {"date", ""}, // 33
+    {"etag", ""}, // 34
+    {"expect", ""}, // 35
+    {"expires", ""}, // 36
+    {"from", ""}, // 37
+    {"host", ""}, // 38
+    {"if-match", ""}, // 39
+    {"if-modified-since", ""}, // 40
+    {"if-none-match", ""}, // 41
+    {"if-range", ""}, // 42
+    {"if-unmodified-since", ""}, // 43
+    {"last-modified", ""}, // 44
+    {"link", ""}, // 45
+    {"location", ""}, // 46
+    {"max-forwards", ""}, // 47
+    {"proxy-authenticate", ""}, // 48
+    {"proxy-authorization", ""}, // 49
+    {"range", ""}, // 50
+    {"referer", ""}, // 51
+    {"refresh", ""}, // 52
+    {"retry-after", ""}, // 53
+    {"server", ""}, // 54
+    {"set-cookie", ""}, // 55
+    {"strict-transport-security", ""}, // 56
+    {"transfer-encoding", ""}, // 57
+    {"user-agent", ""}, // 58
+    {"vary", ""}, // 59
+    {"via", ""}, // 60
+    {"www-authenticate", ""}, // 61
+}};
 
 // Function to get a header from the static table by its 1-based index.
 // Returns std::nullopt if the index is invalid.
@@ -21,9 +92,20 @@ std::optional<HttpHeader> get_static_header(uint64_t index);
 // Function to find a header in the static table.
 // Returns a pair: <index, value_matches>.
 // If name doesn't match, index is 0.
-// If name matches but value doesn't, index is the entry's index and value_matches is false.
+// If name matches but value doesn't, index is the entry's first index and value_matches is false.
 // If both name and value match, index is the entry's index and value_matches is true.
-std::pair<int, bool> find_in_static_table(const std::string& name, const std::string& value);
+constexpr std::pair<int, bool> find_in_static_table(std::string_view name, std::string_view value) {
+    int first_name_match = 0;
+    for (size_t i = 0; i < STATIC_TABLE.size(); ++i) {
+        if (STATIC_TABLE[i].name != name) {
+            if (first_name_match) break; // Entries with the same name are adjacent
+            continue;
+        }
+        if (STATIC_TABLE[i].value == value) return {static_cast<int>(i + 1), true};
+        if (!first_name_match) first_name_match = static_cast<int>(i + 1);
+    }
+    return {first_name_match, false};
+}
 std::pair<int, bool> find_in_static_table(const HttpHeader& header);
 
 
@@ -0,0 +1,709 @@
+#include "http1_gateway.h"
+#include "http2_stream.h"
+
+#include <algorithm> // For std::min, std::find_if
+#include <cctype>    // For std::tolower
+#include <charconv>  // For std::to_chars, std::from_chars
+
+namespace http2 {
+
+namespace {
+
+void append(std::vector<std::byte>& buffer, std::string_view text) {
+    const auto* bytes = reinterpret_cast<const std::byte*>(text.data());
+    buffer.insert(buffer.end(), bytes, bytes + text.size());
+}
+
+std::string_view trim_ows(std::string_view s) {
+    while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    return s;
+}
+
+bool iequals(std::string_view a, std::string_view b) {
+    return a.size() == b.size() &&
+           std::equal(a.begin(), a.end(), b.begin(), [](char x, char y) {
+               return std::tolower(static_cast<unsigned char>(x)) == std::tolower(static_cast<unsigned char>(y));
+           });
+}
+
+// True if the comma-separated `list` contains `token` (case-insensitive).
+bool list_contains_token(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (iequals(trim_ows(list.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+bool is_tchar(char c) {
+    if (std::isalnum(static_cast<unsigned char>(c))) return true;
+    return std::string_view("!#$%&'*+-.^_`|~").find(c) != std::string_view::npos;
+}
+
+// CR, LF and NUL may not appear in a field value (RFC 9112 Section 5.5, RFC 9113 Section 8.2.1);
+// forwarded into HTTP/2 they would split one field into several.
+bool has_forbidden_value_char(std::string_view value) {
+    return value.find_first_of(std::string_view("\r\n\0", 3)) != std::string_view::npos;
+}
+
+// Hop-by-hop fields that must not be forwarded into HTTP/2 (RFC 9113 Section 8.2.2).
+bool is_connection_specific_header(std::string_view lowercase_name) {
+    return lowercase_name == "connection" || lowercase_name == "keep-alive" ||
+           lowercase_name == "proxy-connection" || lowercase_name == "transfer-encoding" ||
+           lowercase_name == "upgrade";
+}
+
+} // namespace
+
+std::optional<std::string_view> Http1RequestHead::find_header(std::string_view lowercase_name) const {
+    for (const auto& h : headers) {
+        if (h.name == lowercase_name) return h.value;
+    }
+    return std::nullopt;
+}
+
+// --- Http1RequestParser Implementation ---
+
+Http1RequestParser::Http1RequestParser(size_t max_head_size)
+    : max_head_size_(max_head_size) {
+}
+
+void Http1RequestParser::reset() {
+    state_ = State::REQUEST_HEAD;
+    head_buffer_.clear();
+    header_views_.clear();
+    head_terminator_match_ = 0;
+    body_remaining_ = 0;
+    chunk_size_seen_digit_ = false;
+    chunk_in_extension_ = false;
+    chunk_line_cr_ = false;
+    trailer_line_length_ = 0;
+}
+
+std::pair<size_t, Http1Error> Http1RequestParser::feed(std::span<const std::byte> data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        switch (state_) {
+            case State::REQUEST_HEAD: {
+                // Empty lines before a request line are ignored (RFC 9112 Section 2.2).
+                if (head_buffer_.empty()) {
+                    while (offset < data.size() && (data[offset] == std::byte('\r') || data[offset] == std::byte('\n'))) {
+                        ++offset;
+                    }
+                }
+                size_t start = offset;
+                while (offset < data.size() && head_terminator_match_ < 4) {
+                    char c = static_cast<char>(data[offset++]);
+                    if (c == '\r') {
+                        head_terminator_match_ = (head_terminator_match_ == 2) ? 3 : 1;
+                    } else if (c == '\n' && (head_terminator_match_ == 1 || head_terminator_match_ == 3)) {
+                        ++head_terminator_match_;
+                    } else {
+                        head_terminator_match_ = 0;
+                    }
+                }
+                head_buffer_.append(reinterpret_cast<const char*>(data.data()) + start, offset - start);
+                if (head_buffer_.size() > max_head_size_) {
+                    return {offset, Http1Error::HEAD_TOO_LARGE};
+                }
+                if (head_terminator_match_ == 4) {
+                    Http1Error err = parse_head();
+                    if (err != Http1Error::OK) return {offset, err};
+                }
+                break;
+            }
+            case State::BODY_IDENTITY:
+            case State::CHUNK_DATA: {
+                size_t n = static_cast<size_t>(std::min<uint64_t>(body_remaining_, data.size() - offset));
+                if (body_cb_ && n > 0) body_cb_(data.subspan(offset, n));
+                offset += n;
+                body_remaining_ -= n;
+                if (body_remaining_ == 0) {
+                    if (state_ == State::BODY_IDENTITY) {
+                        finish_message();
+                    } else {
+                        state_ = State::CHUNK_DATA_END;
+                        trailer_line_length_ = 0;
+                    }
+                }
+                break;
+            }
+            case State::CHUNK_SIZE: {
+                char c = static_cast<char>(data[offset++]);
+                if (chunk_line_cr_ && c != '\n') {
+                    return {offset, Http1Error::INVALID_CHUNK}; // A CR elsewhere would let peers disagree on the size
+                }
+                if (c == '\n') {
+                    if (!chunk_size_seen_digit_) return {offset, Http1Error::INVALID_CHUNK};
+                    state_ = (body_remaining_ == 0) ? State::TRAILERS : State::CHUNK_DATA;
+                    chunk_size_seen_digit_ = false;
+                    chunk_in_extension_ = false;
+                    chunk_line_cr_ = false;
+                    trailer_line_length_ = 0;
+                } else if (c == '\r') {
+                    chunk_line_cr_ = true;
+                } else if (chunk_in_extension_) {
+                    // chunk-ext is ignored.
+                } else if ((c == ';' || c == ' ' || c == '\t') && chunk_size_seen_digit_) {
+                    chunk_in_extension_ = true;
+                } else {
+                    int digit = -1;
+                    if (c >= '0' && c <= '9') digit = c - '0';
+                    else if (c >= 'a' && c <= 'f') digit = c - 'a' + 10;
+                    else if (c >= 'A' && c <= 'F') digit = c - 'A' + 10;
+                    if (digit < 0 || body_remaining_ > (UINT64_MAX >> 4)) return {offset, Http1Error::INVALID_CHUNK};
+                    body_remaining_ = (body_remaining_ << 4) | static_cast<uint64_t>(digit);
+                    chunk_size_seen_digit_ = true;
+                }
+                break;
+            }
+            case State::CHUNK_DATA_END: {
+                // Exactly CRLF; trailer_line_length_ counts the bytes seen.
+                char c = static_cast<char>(data[offset++]);
+                char expected = (trailer_line_length_ == 0) ? '\r' : '\n';
+                if (c != expected) return {offset, Http1Error::INVALID_CHUNK};
+                if (++trailer_line_length_ == 2) {
+                    state_ = State::CHUNK_SIZE;
+                    body_remaining_ = 0;
+                }
+                break;
+            }
+            case State::TRAILERS: {
+                // Trailer fields are skipped; the request ends at the first empty line.
+                char c = static_cast<char>(data[offset++]);
+                if (c == '\n') {
+                    if (trailer_line_length_ == 0) {
+                        finish_message();
+                    }
+                    trailer_line_length_ = 0;
+                } else if (c != '\r') {
+                    if (++trailer_line_length_ > max_head_size_) return {offset, Http1Error::HEAD_TOO_LARGE};
+                }
+                break;
+            }
+        }
+    }
+    return {offset, Http1Error::OK};
+}
+
+Http1Error Http1RequestParser::parse_head() {
+    // head_buffer_ holds "request-line CRLF *(field-line CRLF) CRLF". It is parsed in place.
+    std::string_view head(head_buffer_);
+    size_t line_end = head.find("\r\n");
+    std::string_view request_line = head.substr(0, line_end);
+
+    Http1RequestHead request;
+    size_t sp1 = request_line.find(' ');
+    size_t sp2 = (sp1 == std::string_view::npos) ? sp1 : request_line.find(' ', sp1 + 1);
+    if (sp1 == 0 || sp2 == std::string_view::npos || sp2 == sp1 + 1) {
+        return Http1Error::INVALID_REQUEST_LINE;
+    }
+    request.method = request_line.substr(0, sp1);
+    request.target = request_line.substr(sp1 + 1, sp2 - sp1 - 1);
+    std::string_view version = request_line.substr(sp2 + 1);
+    if (version == "HTTP/1.1") {
+        request.version_minor = 1;
+    } else if (version == "HTTP/1.0") {
+        request.version_minor = 0;
+    } else {
+        return Http1Error::INVALID_REQUEST_LINE;
+    }
+    if (!std::all_of(request.method.begin(), request.method.end(), is_tchar)) {
+        return Http1Error::INVALID_REQUEST_LINE;
+    }
+    if (has_forbidden_value_char(request.target)) {
+        return Http1Error::INVALID_REQUEST_LINE; // Copied into :path as is
+    }
+
+    header_views_.clear();
+    size_t pos = line_end + 2;
+    while (pos < head.size()) {
+        size_t end = head.find("\r\n", pos);
+        if (end == pos) break; // Empty line: end of head
+        std::string_view line = head.substr(pos, end - pos);
+        if (line.front() == ' ' || line.front() == '\t') {
+            return Http1Error::INVALID_HEADER; // obs-fold is rejected (RFC 9112 Section 5.2)
+        }
+        size_t colon = line.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            return Http1Error::INVALID_HEADER;
+        }
+        // Lowercase the field name inside head_buffer_; no copy is made.
+        char* name_begin = head_buffer_.data() + pos;
+        for (size_t i = 0; i < colon; ++i) {
+            if (!is_tchar(name_begin[i])) return Http1Error::INVALID_HEADER;
+            name_begin[i] = static_cast<char>(std::tolower(static_cast<unsigned char>(name_begin[i])));
+        }
+        std::string_view value = trim_ows(line.substr(colon + 1));
+        if (has_forbidden_value_char(value)) return Http1Error::INVALID_HEADER;
+        header_views_.push_back({line.substr(0, colon), value});
+        pos = end + 2;
+    }
+    request.headers = header_views_;
+
+    // Message body length (RFC 9112 Section 6).
+    bool has_transfer_encoding = false;
+    bool connection_close = false;
+    bool connection_keep_alive = false;
+    for (const auto& h : header_views_) {
+        if (h.name == "content-length") {
+            uint64_t length = 0;
+            auto [ptr, ec] = std::from_chars(h.value.data(), h.value.data() + h.value.size(), length);
+            if (ec != std::errc() || ptr != h.value.data() + h.value.size() || h.value.empty()) {
+                return Http1Error::INVALID_CONTENT_LENGTH;
+            }
+            if (request.content_length.has_value() && *request.content_length != length) {
+                return Http1Error::INVALID_CONTENT_LENGTH;
+            }
+            request.content_length = length;
+        } else if (h.name == "transfer-encoding") {
+            has_transfer_encoding = true;
+            size_t comma = h.value.rfind(',');
+            std::string_view last = trim_ows(comma == std::string_view::npos ? h.value : h.value.substr(comma + 1));
+            request.chunked = iequals(last, "chunked");
+        } else if (h.name == "connection") {
+            connection_close = connection_close || list_contains_token(h.value, "close");
+            connection_keep_alive = connection_keep_alive || list_contains_token(h.value, "keep-alive");
+        }
+    }
+    if (has_transfer_encoding && request.content_length.has_value()) {
+        return Http1Error::AMBIGUOUS_BODY_LENGTH;
+    }
+    if (has_transfer_encoding && !request.chunked) {
+        return Http1Error::UNSUPPORTED_TRANSFER_ENCODING;
+    }
+    request.keep_alive = (request.version_minor == 1) ? !connection_close : connection_keep_alive;
+
+    if (head_cb_) head_cb_(request);
+    return begin_body(request);
+}
+
+Http1Error Http1RequestParser::begin_body(const Http1RequestHead& head) {
+    body_remaining_ = 0;
+    if (head.chunked) {
+        state_ = State::CHUNK_SIZE;
+        chunk_size_seen_digit_ = false;
+        chunk_in_extension_ = false;
+        chunk_line_cr_ = false;
+    } else if (head.content_length.value_or(0) > 0) {
+        state_ = State::BODY_IDENTITY;
+        body_remaining_ = *head.content_length;
+    } else {
+        finish_message();
+    }
+    return Http1Error::OK;
+}
+
+void Http1RequestParser::finish_message() {
+    state_ = State::REQUEST_HEAD;
+    head_buffer_.clear();   // Keeps capacity for the next request
+    header_views_.clear();
+    head_terminator_match_ = 0;
+    if (complete_cb_) complete_cb_();
+}
+
+// --- Http1Serializer Implementation ---
+
+namespace Http1Serializer {
+
+std::string_view reason_phrase(int status) {
+    switch (status) {
+        case 100: return "Continue";
+        case 101: return "Switching Protocols";
+        case 200: return "OK";
+        case 201: return "Created";
+        case 202: return "Accepted";
+        case 204: return "No Content";
+        case 206: return "Partial Content";
+        case 301: return "Moved Permanently";
+        case 302: return "Found";
+        case 303: return "See Other";
+        case 304: return "Not Modified";
+        case 307: return "Temporary Redirect";
+        case 308: return "Permanent Redirect";
+        case 400: return "Bad Request";
+        case 401: return "Unauthorized";
+        case 403: return "Forbidden";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 408: return "Request Timeout";
+        case 413: return "Content Too Large";
+        case 429: return "Too Many Requests";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 502: return "Bad Gateway";
+        case 503: return "Service Unavailable";
+        case 504: return "Gateway Timeout";
+        default: return "";
+    }
+}
+
+void write_response_head(std::vector<std::byte>& buffer, int status, const std::vector<HttpHeader>& headers, bool chunked,
+                         bool connection_close) {
+    char status_digits[8];
+    auto [end, ec] = std::to_chars(std::begin(status_digits), std::end(status_digits), status);
+    append(buffer, "HTTP/1.1 ");
+    append(buffer, std::string_view(status_digits, end - status_digits));
+    append(buffer, " ");
+    append(buffer, reason_phrase(status));
+    append(buffer, "\r\n");
+    for (const auto& h : headers) {
+        if (!h.name.empty() && h.name.front() == ':') continue; // Pseudo-headers
+        if (is_connection_specific_header(h.name)) continue;
+        append(buffer, h.name);
+        append(buffer, ": ");
+        append(buffer, h.value);
+        append(buffer, "\r\n");
+    }
+    if (chunked) {
+        append(buffer, "transfer-encoding: chunked\r\n");
+    }
+    if (connection_close) {
+        append(buffer, "connection: close\r\n");
+    }
+    append(buffer, "\r\n");
+}
+
+void write_chunk_header(std::vector<std::byte>& buffer, size_t chunk_size) {
+    char digits[20];
+    auto [end, ec] = std::to_chars(std::begin(digits), std::end(digits), chunk_size, 16);
+    append(buffer, std::string_view(digits, end - digits));
+    append(buffer, "\r\n");
+}
+
+void write_chunk_trailer(std::vector<std::byte>& buffer) {
+    append(buffer, "\r\n");
+}
+
+void write_last_chunk(std::vector<std::byte>& buffer, const std::vector<HttpHeader>& trailers) {
+    append(buffer, "0\r\n");
+    for (const auto& h : trailers) {
+        if (!h.name.empty() && h.name.front() == ':') continue;
+        append(buffer, h.name);
+        append(buffer, ": ");
+        append(buffer, h.value);
+        append(buffer, "\r\n");
+    }
+    append(buffer, "\r\n");
+}
+
+} // namespace Http1Serializer
+
+// --- Http1Gateway Implementation ---
+
+Http1Gateway::Http1Gateway(Http2Connection& upstream, std::string scheme)
+    : upstream_(upstream), scheme_(std::move(scheme)) {
+    upstream_.set_frame_callback([this](const AnyHttp2Frame& frame) {
+        on_upstream_frame(frame);
+    });
+    upstream_.set_data_callback([this](stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream) {
+        on_upstream_data(stream_id, std::move(data), end_stream);
+    });
+    // Header blocks come from the stream events, which report them once any CONTINUATION is in.
+    upstream_.set_stream_events({
+        .on_open = {},
+        .on_headers = [this](stream_id_t stream_id, void*, const std::vector<HttpHeader>& headers, bool end_stream) {
+            on_response_headers(stream_id, headers, end_stream);
+        },
+        .on_data = {}, // Response bodies keep coming through the data callback
+        .on_trailers = [this](stream_id_t stream_id, void*, const std::vector<HttpHeader>& trailers) {
+            on_upstream_trailers(stream_id, trailers);
+        },
+        .on_reset = {},
+        .on_close = {},
+    });
+}
+
+Http1Gateway::~Http1Gateway() {
+    upstream_.set_frame_callback(nullptr);
+    upstream_.set_data_callback(nullptr);
+    upstream_.set_stream_events({});
+}
+
+Http1Gateway::SessionId Http1Gateway::open_session() {
+    SessionId id = next_session_id_++;
+    Session& session = sessions_[id]; // std::map nodes are stable, so capturing &session is safe
+    session.parser.set_request_head_callback([this, id, &session](const Http1RequestHead& head) {
+        on_request_head(id, session, head);
+    });
+    session.parser.set_body_callback([this, &session](std::span<const std::byte> data) {
+        on_request_body(session, data);
+    });
+    session.parser.set_message_complete_callback([this, &session]() {
+        on_request_complete(session);
+    });
+    return id;
+}
+
+Http1Error Http1Gateway::on_client_data(SessionId session_id, std::span<const std::byte> data) {
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end()) return Http1Error::UNKNOWN_SESSION;
+    Session& session = it->second;
+    if (session.error != Http1Error::OK) return session.error;
+
+    auto [consumed, err] = session.parser.feed(data);
+    if (err != Http1Error::OK && session.error == Http1Error::OK) {
+        session.error = err;
+    }
+    return session.error;
+}
+
+void Http1Gateway::close_session(SessionId session_id) {
+    auto it = sessions_.find(session_id);
+    if (it == sessions_.end()) return;
+    for (const auto& response : it->second.responses) {
+        if (!response.complete) {
+            upstream_.send_rst_stream_frame_action(response.stream_id, ErrorCode::CANCEL);
+            stream_to_session_.erase(response.stream_id);
+        }
+    }
+    sessions_.erase(it);
+}
+
+void Http1Gateway::on_request_head(SessionId session_id, Session& session, const Http1RequestHead& head) {
+    // Nothing after a request without keep-alive is answered (RFC 9112 Section 9.6).
+    if (session.error != Http1Error::OK || session.closing) return;
+
+    stream_id_t stream_id = upstream_.get_next_available_stream_id();
+    if (stream_id == 0) {
+        session.error = Http1Error::UPSTREAM_REFUSED;
+        return;
+    }
+
+    // Reuse the HttpHeader strings of the previous request; their buffers are the only
+    // per-field storage, and send_headers() needs owned strings.
+    size_t count = 0;
+    auto add = [this, &count](std::string_view name, std::string_view value) {
+        if (count == scratch_headers_.size()) scratch_headers_.emplace_back();
+        scratch_headers_[count].name.assign(name);
+        scratch_headers_[count].value.assign(value);
+        scratch_headers_[count].sensitive = false;
+        ++count;
+    };
+
+    // Request pseudo-header fields (RFC 9113 Section 8.3.1).
+    std::string_view authority = head.find_header("host").value_or("");
+    std::string_view path = head.target;
+    add(":method", head.method);
+    if (head.method == "CONNECT") {
+        add(":authority", head.target);
+    } else {
+        // absolute-form ("http://host/path") carries the authority itself.
+        size_t scheme_end = path.find("://");
+        if (scheme_end != std::string_view::npos && path.front() != '/') {
+            std::string_view rest = path.substr(scheme_end + 3);
+            size_t slash = rest.find('/');
+            authority = rest.substr(0, slash);
+            path = (slash == std::string_view::npos) ? std::string_view("/") : rest.substr(slash);
+        }
+        add(":scheme", scheme_);
+        add(":path", path);
+        if (!authority.empty()) add(":authority", authority);
+    }
+
+    std::string_view connection_options = head.find_header("connection").value_or("");
+    for (const auto& h : head.headers) {
+        if (h.name == "host" || is_connection_specific_header(h.name)) continue;
+        if (h.name == "te" && !iequals(h.value, "trailers")) continue;
+        if (list_contains_token(connection_options, h.name)) continue; // Nominated by Connection
+        add(h.name, h.value);
+    }
+    scratch_headers_.resize(count);
+
+    bool end_stream = !head.has_body();
+    if (!upstream_.send_headers(stream_id, scratch_headers_, end_stream)) {
+        session.error = Http1Error::UPSTREAM_REFUSED;
+        return;
+    }
+
+    stream_to_session_[stream_id] = session_id;
+    PendingResponse response;
+    response.stream_id = stream_id;
+    response.head_request = (head.method == "HEAD");
+    response.http1_0 = (head.version_minor == 0);
+    response.close_connection = !head.keep_alive;
+    session.closing = !head.keep_alive;
+    session.responses.push_back(std::move(response));
+    session.request_stream_id = end_stream ? 0 : stream_id;
+}
+
+void Http1Gateway::on_request_body(Session& session, std::span<const std::byte> data) {
+    stream_id_t stream_id = session.request_stream_id;
+    if (session.error != Http1Error::OK || stream_id == 0) return;
+    Http2Stream* stream = upstream_.get_stream(stream_id);
+    if (!stream) return;
+
+    // Send what the windows allow straight from the client's buffer...
+    int32_t window = std::min(stream->get_remote_window_size(), upstream_.get_remote_connection_window());
+    if (!stream->has_outgoing_data() && window > 0) {
+        size_t n = std::min(static_cast<size_t>(window), data.size());
+        upstream_.send_data(stream_id, data.first(n), false);
+        data = data.subspan(n);
+    }
+    // ...and copy only the remainder, which has to outlive this call.
+    if (!data.empty()) {
+        upstream_.queue_data(stream_id, std::vector<std::byte>(data.begin(), data.end()), false);
+    }
+}
+
+void Http1Gateway::on_request_complete(Session& session) {
+    if (session.error != Http1Error::OK || session.request_stream_id == 0) return;
+    upstream_.queue_data(session.request_stream_id, {}, true);
+    session.request_stream_id = 0;
+}
+
+void Http1Gateway::on_upstream_frame(const AnyHttp2Frame& frame) {
+    if (const auto* rst = frame.get_if<RstStreamFrame>()) {
+        SessionId session_id = 0;
+        Session* session = nullptr;
+        PendingResponse* response = find_response(rst->header.get_stream_id(), &session_id, &session);
+        if (!response) return;
+        if (!response->head_written) {
+            scratch_output_.clear();
+            Http1Serializer::write_response_head(scratch_output_, 502, {{"content-length", "0"}}, false,
+                                                 response->close_connection);
+            response->head_written = true;
+            emit(session_id, *session, *response, scratch_output_);
+        }
+        // A reset in the middle of a chunked body leaves it without its last chunk, which
+        // tells the client the response is incomplete.
+        response->chunked = false;
+        finish_response(session_id, *session, *response, {});
+    }
+}
+
+void Http1Gateway::on_response_headers(stream_id_t stream_id, const std::vector<HttpHeader>& headers, bool end_stream) {
+    SessionId session_id = 0;
+    Session* session = nullptr;
+    PendingResponse* response = find_response(stream_id, &session_id, &session);
+    if (!response) return;
+
+    int status = 0;
+    bool has_content_length = false;
+    for (const auto& h : headers) {
+        if (h.name == ":status") {
+            std::from_chars(h.value.data(), h.value.data() + h.value.size(), status);
+        } else if (h.name == "content-length") {
+            has_content_length = true;
+        }
+    }
+    if (status < 100 || status > 999) status = 502;
+
+    scratch_output_.clear();
+    if (status < 200) {
+        // Interim response (e.g. 100 Continue): forwarded as-is, the final head follows.
+        Http1Serializer::write_response_head(scratch_output_, status, headers, false);
+        emit(session_id, *session, *response, scratch_output_);
+        return;
+    }
+
+    bool body_allowed = !response->head_request && status != 204 && status != 304;
+    if (body_allowed && !has_content_length) {
+        // Unknown length: chunked, or for HTTP/1.0 delimited by closing the connection.
+        response->chunked = !response->http1_0;
+        response->close_connection = response->close_connection || response->http1_0;
+    }
+    response->head_written = true;
+    Http1Serializer::write_response_head(scratch_output_, status, headers, response->chunked, response->close_connection);
+    emit(session_id, *session, *response, scratch_output_);
+
+    if (end_stream) {
+        finish_response(session_id, *session, *response, {});
+    }
+}
+
+void Http1Gateway::on_upstream_trailers(stream_id_t stream_id, const std::vector<HttpHeader>& trailers) {
+    SessionId session_id = 0;
+    Session* session = nullptr;
+    PendingResponse* response = find_response(stream_id, &session_id, &session);
+    if (!response) return;
+    // Only representable with chunked framing; otherwise they just end the response.
+    finish_response(session_id, *session, *response, trailers);
+}
+
+void Http1Gateway::on_upstream_data(stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream) {
+    SessionId session_id = 0;
+    Session* session = nullptr;
+    PendingResponse* response = find_response(stream_id, &session_id, &session);
+    if (!response) return;
+
+    if (!data.empty() && !response->head_request) {
+        if (response->chunked) {
+            scratch_output_.clear();
+            Http1Serializer::write_chunk_header(scratch_output_, data.size());
+            emit(session_id, *session, *response, scratch_output_);
+            emit(session_id, *session, *response, data);
+            scratch_output_.clear();
+            Http1Serializer::write_chunk_trailer(scratch_output_);
+            emit(session_id, *session, *response, scratch_output_);
+        } else {
+            emit(session_id, *session, *response, data);
+        }
+    }
+    if (!data.empty()) {
+        upstream_.consume_data(stream_id, static_cast<uint32_t>(data.size()));
+    }
+    if (end_stream) {
+        finish_response(session_id, *session, *response, {});
+    }
+}
+
+void Http1Gateway::finish_response(SessionId session_id, Session& session, PendingResponse& response,
+                                   const std::vector<HttpHeader>& trailers) {
+    if (response.complete) return;
+    if (response.chunked) {
+        scratch_output_.clear();
+        Http1Serializer::write_last_chunk(scratch_output_, trailers);
+        emit(session_id, session, response, scratch_output_);
+    }
+    response.complete = true;
+    stream_to_session_.erase(response.stream_id);
+    advance_pipeline(session_id, session);
+}
+
+void Http1Gateway::emit(SessionId session_id, Session& session, PendingResponse& response, std::span<const std::byte> bytes) {
+    if (bytes.empty()) return;
+    if (&response == &session.responses.front()) {
+        if (client_send_cb_) client_send_cb_(session_id, bytes);
+    } else {
+        // HTTP/1.1 responses must go out in request order.
+        response.buffered.insert(response.buffered.end(), bytes.begin(), bytes.end());
+    }
+}
+
+void Http1Gateway::advance_pipeline(SessionId session_id, Session& session) {
+    while (!session.responses.empty()) {
+        PendingResponse& front = session.responses.front();
+        if (!front.buffered.empty()) {
+            if (client_send_cb_) client_send_cb_(session_id, front.buffered);
+            front.buffered.clear();
+        }
+        if (!front.complete) break;
+        bool close_connection = front.close_connection;
+        session.responses.pop_front();
+        if (close_connection) {
+            if (client_close_cb_) client_close_cb_(session_id);
+            return;
+        }
+    }
+}
+
+Http1Gateway::PendingResponse* Http1Gateway::find_response(stream_id_t stream_id, SessionId* session_id_out, Session** session_out) {
+    auto sit = stream_to_session_.find(stream_id);
+    if (sit == stream_to_session_.end()) return nullptr;
+    auto it = sessions_.find(sit->second);
+    if (it == sessions_.end()) return nullptr;
+    for (auto& response : it->second.responses) {
+        if (response.stream_id == stream_id) {
+            *session_id_out = it->first;
+            *session_out = &it->second;
+            return &response;
+        }
+    }
+    return nullptr;
+}
+
+} // namespace http2
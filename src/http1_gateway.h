@@ -0,0 +1,225 @@
+#pragma once
+
+#include "http2_types.h"
+#include "http2_connection.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http2 {
+
+// HTTP/1.1 <-> HTTP/2 gateway (RFC 9112 message syntax, RFC 9113 Section 8.2.2 / 8.3 mapping).
+//
+// Http1RequestParser is a streaming HTTP/1.1 request parser: bytes can be fed in arbitrary pieces.
+// The request head is collected into a reusable buffer and parsed in place (header names are
+// lowercased inside that buffer and exposed as string_views), so a warmed-up parser does not
+// allocate per request. Body bytes (Content-Length or chunked) are delivered as spans into the
+// fed data and are never copied by the parser.
+//
+// Http1Gateway multiplexes many HTTP/1.1 client sessions onto one upstream Http2Connection.
+
+constexpr size_t HTTP1_DEFAULT_MAX_HEAD_SIZE = 64 * 1024;
+
+enum class Http1Error {
+    OK,
+    INVALID_REQUEST_LINE,
+    INVALID_HEADER,
+    HEAD_TOO_LARGE,
+    INVALID_CONTENT_LENGTH,
+    AMBIGUOUS_BODY_LENGTH,        // Both Transfer-Encoding and Content-Length (request smuggling guard)
+    UNSUPPORTED_TRANSFER_ENCODING, // Only "chunked" (as the final coding) is understood
+    INVALID_CHUNK,
+    UNKNOWN_SESSION,
+    UPSTREAM_REFUSED,             // No stream id left or the upstream rejected HEADERS
+};
+
+struct Http1HeaderView {
+    std::string_view name;  // Lowercased
+    std::string_view value; // Surrounding whitespace stripped
+};
+
+// Views are valid only for the duration of the request-head callback.
+struct Http1RequestHead {
+    std::string_view method;
+    std::string_view target;
+    int version_minor = 1; // HTTP/1.<version_minor>
+    std::span<const Http1HeaderView> headers;
+    std::optional<uint64_t> content_length;
+    bool chunked = false;
+    bool keep_alive = true;
+
+    bool has_body() const { return chunked || content_length.value_or(0) > 0; }
+    std::optional<std::string_view> find_header(std::string_view lowercase_name) const;
+};
+
+class Http1RequestParser {
+public:
+    using RequestHeadCallback = std::function<void(const Http1RequestHead& head)>;
+    using BodyCallback = std::function<void(std::span<const std::byte> data)>;
+    using MessageCompleteCallback = std::function<void()>;
+
+    explicit Http1RequestParser(size_t max_head_size = HTTP1_DEFAULT_MAX_HEAD_SIZE);
+
+    void set_request_head_callback(RequestHeadCallback cb) { head_cb_ = std::move(cb); }
+    void set_body_callback(BodyCallback cb) { body_cb_ = std::move(cb); }
+    void set_message_complete_callback(MessageCompleteCallback cb) { complete_cb_ = std::move(cb); }
+
+    // Parses as much of `data` as possible. Several pipelined requests may complete in one call.
+    // Returns the number of bytes consumed and an error; the parser must be reset() after an error.
+    std::pair<size_t, Http1Error> feed(std::span<const std::byte> data);
+
+    void reset();
+    bool is_idle() const { return state_ == State::REQUEST_HEAD && head_buffer_.empty(); }
+
+private:
+    enum class State {
+        REQUEST_HEAD,
+        BODY_IDENTITY,
+        CHUNK_SIZE,
+        CHUNK_DATA,
+        CHUNK_DATA_END, // CRLF after chunk data
+        TRAILERS,
+    };
+
+    Http1Error parse_head();
+    Http1Error begin_body(const Http1RequestHead& head);
+    void finish_message();
+
+    size_t max_head_size_;
+    RequestHeadCallback head_cb_;
+    BodyCallback body_cb_;
+    MessageCompleteCallback complete_cb_;
+
+    State state_ = State::REQUEST_HEAD;
+    std::string head_buffer_;                  // Reused across requests
+    std::vector<Http1HeaderView> header_views_; // Reused across requests
+    int head_terminator_match_ = 0;            // Progress through "\r\n\r\n"
+
+    uint64_t body_remaining_ = 0;   // Identity body bytes, or bytes left in the current chunk
+    bool chunk_size_seen_digit_ = false;
+    bool chunk_in_extension_ = false;
+    bool chunk_line_cr_ = false;    // The chunk-size line's CR was seen; only LF may follow
+    size_t trailer_line_length_ = 0;
+};
+
+// HTTP/1.1 response serialization helpers, used for HTTP/2 -> HTTP/1.1 translation.
+namespace Http1Serializer {
+
+// Appends the status line and headers (terminated by the empty line). Pseudo-headers and
+// HTTP/2-only fields are skipped. If `chunked`, "transfer-encoding: chunked" is added; if
+// `connection_close`, "connection: close".
+void write_response_head(std::vector<std::byte>& buffer, int status, const std::vector<HttpHeader>& headers, bool chunked,
+                         bool connection_close = false);
+
+// Chunk framing around a body piece: "<hex size>\r\n" and "\r\n".
+void write_chunk_header(std::vector<std::byte>& buffer, size_t chunk_size);
+void write_chunk_trailer(std::vector<std::byte>& buffer);
+// "0\r\n" + trailer fields + "\r\n".
+void write_last_chunk(std::vector<std::byte>& buffer, const std::vector<HttpHeader>& trailers);
+
+std::string_view reason_phrase(int status);
+
+} // namespace Http1Serializer
+
+// Translates HTTP/1.1 client sessions into streams on one upstream Http2Connection and the
+// upstream responses back into HTTP/1.1.
+//
+// Request bodies are forwarded as spans (send_data) when the upstream windows allow; only the part
+// that has to wait for window is copied into the stream's send queue. Response bodies are moved
+// out of the received DATA frames and handed to the client as spans, with chunk framing written
+// around them instead of copying the body into a new buffer.
+//
+// A request without keep-alive (HTTP/1.0 by default, or "connection: close") is the session's last:
+// later pipelined requests are ignored and the client close callback follows its response. HTTP/1.0
+// clients do not understand chunked framing, so a response of unknown length is sent to them
+// close-delimited.
+//
+// The gateway owns the upstream's frame and data callbacks and its stream events.
+class Http1Gateway {
+public:
+    using SessionId = uint64_t;
+    // Bytes to write to an HTTP/1.1 client. Called several times per response piece
+    // (e.g. chunk header, body, chunk trailer); spans are valid only during the call.
+    using ClientSendCallback = std::function<void(SessionId session, std::span<const std::byte> bytes)>;
+    // The client connection is to be closed once the bytes sent so far are written. close_session()
+    // may be called from it.
+    using ClientCloseCallback = std::function<void(SessionId session)>;
+
+    explicit Http1Gateway(Http2Connection& upstream, std::string scheme = "http");
+    ~Http1Gateway();
+
+    Http1Gateway(const Http1Gateway&) = delete;
+    Http1Gateway& operator=(const Http1Gateway&) = delete;
+
+    void set_client_send_callback(ClientSendCallback cb) { client_send_cb_ = std::move(cb); }
+    void set_client_close_callback(ClientCloseCallback cb) { client_close_cb_ = std::move(cb); }
+
+    SessionId open_session();
+    // Bytes received from the HTTP/1.1 client.
+    Http1Error on_client_data(SessionId session, std::span<const std::byte> data);
+    // The client went away: in-flight upstream streams are cancelled.
+    void close_session(SessionId session);
+
+    size_t get_session_count() const { return sessions_.size(); }
+    size_t get_active_stream_count() const { return stream_to_session_.size(); }
+
+private:
+    struct PendingResponse {
+        stream_id_t stream_id = 0;
+        bool head_request = false;       // HEAD: no response body
+        bool head_written = false;
+        bool chunked = false;
+        bool http1_0 = false;            // No chunked framing: an unknown length is close-delimited
+        bool close_connection = false;   // Last response of the session
+        bool complete = false;
+        std::vector<std::byte> buffered; // Output held back behind an earlier pipelined response
+    };
+
+    struct Session {
+        Http1RequestParser parser;
+        std::deque<PendingResponse> responses; // Pipelined requests, in request order
+        stream_id_t request_stream_id = 0;     // Stream of the request whose body is being parsed
+        bool closing = false;                  // A request without keep-alive was forwarded
+        Http1Error error = Http1Error::OK;
+    };
+
+    void on_request_head(SessionId session_id, Session& session, const Http1RequestHead& head);
+    void on_request_body(Session& session, std::span<const std::byte> data);
+    void on_request_complete(Session& session);
+
+    void on_upstream_frame(const AnyHttp2Frame& frame);
+    void on_upstream_trailers(stream_id_t stream_id, const std::vector<HttpHeader>& trailers);
+    void on_upstream_data(stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream);
+    void on_response_headers(stream_id_t stream_id, const std::vector<HttpHeader>& headers, bool end_stream);
+    void finish_response(SessionId session_id, Session& session, PendingResponse& response,
+                         const std::vector<HttpHeader>& trailers);
+
+    // Writes to the client, or buffers if `response` is not at the front of the pipeline.
+    void emit(SessionId session_id, Session& session, PendingResponse& response, std::span<const std::byte> bytes);
+    // Pops completed responses from the front and flushes the next one's buffered output. Returns
+    // right after the client close callback, which may have destroyed `session`.
+    void advance_pipeline(SessionId session_id, Session& session);
+
+    PendingResponse* find_response(stream_id_t stream_id, SessionId* session_id_out, Session** session_out);
+
+    Http2Connection& upstream_;
+    std::string scheme_;
+    ClientSendCallback client_send_cb_;
+    ClientCloseCallback client_close_cb_;
+
+    SessionId next_session_id_ = 1;
+    std::map<SessionId, Session> sessions_;
+    std::map<stream_id_t, SessionId> stream_to_session_;
+    std::vector<HttpHeader> scratch_headers_;
+    std::vector<std::byte> scratch_output_;
+};
+
+} // namespace http2
@@ -1,8 +1,11 @@
 #include "http2_connection.h"
+#include "http2_memory_governor.h"
 #include "http2_parser.h" // Full definition needed
 #include "http2_frame_serializer.h"
 #include <algorithm> // for std::remove_if for stream cleanup
+#include <cctype>
 #include <iostream> // For debugging
+#include <string_view>
 
 // Helper to convert uint32_t to big-endian byte vector (length 4)
 std::vector<std::byte> uint32_to_bytes_big_endian(uint32_t val) {
@@ -24,6 +27,82 @@ std::vector<std::byte> uint16_to_bytes_big_endian(uint16_t val) {
 
 namespace http2 {
 
+namespace {
+
+// Bound on PRIORITY_UPDATEs kept for streams that have not been opened yet.
+constexpr size_t MAX_PENDING_PRIORITY_UPDATES = 128;
+
+const std::string* find_header_value(const std::vector<HttpHeader>& headers, std::string_view name) {
+    for (const auto& h : headers) {
+        if (h.name == name) return &h.value;
+    }
+    return nullptr;
+}
+
+bool is_connect_request(const std::vector<HttpHeader>& headers) {
+    const std::string* method = find_header_value(headers, ":method");
+    return method && *method == "CONNECT";
+}
+
+bool has_2xx_status(const std::vector<HttpHeader>& headers) {
+    const std::string* status = find_header_value(headers, ":status");
+    return status && status->size() == 3 && (*status)[0] == '2';
+}
+
+// An interim (1xx) response; the final response headers follow it (RFC 9113 Section 8.1).
+bool has_1xx_status(const std::vector<HttpHeader>& headers) {
+    const std::string* status = find_header_value(headers, ":status");
+    return status && status->size() == 3 && (*status)[0] == '1';
+}
+
+// Pseudo-header rules for CONNECT requests: RFC 9113 Section 8.5 for plain CONNECT (only
+// :method and :authority) and RFC 8441 Section 4 for extended CONNECT (:protocol, which
+// also needs :scheme and :path, and must have been enabled by the server).
+bool is_valid_connect_usage(const std::vector<HttpHeader>& headers, bool connect_protocol_enabled) {
+    bool has_protocol = find_header_value(headers, ":protocol") != nullptr;
+    if (!is_connect_request(headers)) {
+        return !has_protocol;
+    }
+    bool has_authority = find_header_value(headers, ":authority") != nullptr;
+    bool has_scheme = find_header_value(headers, ":scheme") != nullptr;
+    bool has_path = find_header_value(headers, ":path") != nullptr;
+    if (has_protocol) {
+        return connect_protocol_enabled && has_authority && has_scheme && has_path;
+    }
+    return has_authority && !has_scheme && !has_path;
+}
+
+} // namespace
+
+bool is_extended_connect_request(const std::vector<HttpHeader>& headers) {
+    return is_connect_request(headers) && find_header_value(headers, ":protocol") != nullptr;
+}
+
+std::string make_origin(std::string_view scheme, std::string_view authority) {
+    std::string origin;
+    origin.reserve(scheme.size() + 3 + authority.size());
+    for (char c : scheme) origin.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+    origin += "://";
+    size_t host_start = origin.size();
+    for (char c : authority) origin.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(c))));
+
+    std::string_view lower_scheme = std::string_view(origin).substr(0, scheme.size());
+    std::string_view default_port = lower_scheme == "https" ? ":443" : lower_scheme == "http" ? ":80" : "";
+    if (!default_port.empty() && origin.size() - host_start > default_port.size() &&
+        std::string_view(origin).ends_with(default_port)) {
+        origin.resize(origin.size() - default_port.size());
+    }
+    return origin;
+}
+
+std::string normalize_origin(std::string_view origin) {
+    size_t separator = origin.find("://");
+    if (separator == std::string_view::npos) return std::string(origin);
+    std::string_view authority = origin.substr(separator + 3);
+    if (!authority.empty() && authority.back() == '/') authority.remove_suffix(1);
+    return make_origin(origin.substr(0, separator), authority);
+}
+
 Http2Connection::Http2Connection(bool is_server_connection)
     : is_server_(is_server_connection),
       hpack_decoder_(DEFAULT_HEADER_TABLE_SIZE), // Initial default, peer can change via SETTINGS
@@ -50,6 +129,19 @@ Http2Connection::Http2Connection(bool is_server_connection)
 
 Http2Connection::~Http2Connection() {
     // Cleanup, streams will be destroyed by map dtor.
+    if (governor_) governor_->detach(*this);
+}
+
+bool Http2Connection::register_extension_frame_handler(uint8_t type, Http2Parser::ExtensionFrameHandler handler) {
+    return parser_->register_extension_frame_handler(type, std::move(handler));
+}
+
+bool Http2Connection::register_extension_chunk_handler(uint8_t type, Http2Parser::ExtensionChunkHandler handler) {
+    return parser_->register_extension_chunk_handler(type, std::move(handler));
+}
+
+void Http2Connection::unregister_extension_handler(uint8_t type) {
+    parser_->unregister_extension_handler(type);
 }
 
 void Http2Connection::set_frame_callback(FrameCallback cb) {
@@ -64,13 +156,22 @@ void Http2Connection::set_ping_ack_callback(PingAckCallback cb) {
 void Http2Connection::set_goaway_callback(GoAwayCallback cb) {
     goaway_cb_ = std::move(cb);
 }
+void Http2Connection::set_data_callback(DataCallback cb) {
+    data_cb_ = std::move(cb);
+}
+void Http2Connection::set_data_sent_callback(DataSentCallback cb) {
+    data_sent_cb_ = std::move(cb);
+}
 
 
 size_t Http2Connection::process_incoming_data(std::span<const std::byte> data) {
     // TODO: Handle connection preface (client sends "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n", server validates)
     // For now, assume preface is handled and we are processing frames.
 
+    ++input_depth_;
     auto [consumed_bytes, error] = parser_->parse(data);
+    deliver_pending_data(); // The batch ends with the read
+    --input_depth_;
 
     if (error != ParserError::OK) {
         // Handle parsing error. This often means sending a GOAWAY frame.
@@ -117,6 +218,10 @@ size_t Http2Connection::process_incoming_data(std::span<const std::byte> data) {
         // Consumed bytes might be 0 or partial if error occurred mid-frame.
         // The parser itself stops on error.
     }
+    if (input_depth_ == 0) flush_window_updates();
+    if (flush_policy_.flush_after_input && cork_depth_ == 0) {
+        flush_output(); // End of the event-loop turn: write whatever the callbacks sent
+    }
     return consumed_bytes;
 }
 
@@ -131,12 +236,11 @@ Http2Stream& Http2Connection::get_or_create_stream(stream_id_t stream_id) {
 
     auto it = streams_.find(stream_id);
     if (it == streams_.end()) {
-        // Create new stream. Initial window sizes come from remote settings for local window,
-        // and local settings for remote window.
-        // This is subtle: our local_settings_.initial_window_size determines how much *we* can send initially on a new stream.
-        // remote_settings_.initial_window_size determines how much *peer* can send initially on a new stream.
-        uint32_t initial_local_win = remote_settings_.initial_window_size;
-        uint32_t initial_remote_win = local_settings_.initial_window_size;
+        // Create new stream. The stream's local (receive) window starts at the
+        // SETTINGS_INITIAL_WINDOW_SIZE we advertised; its remote (send) window at the one the
+        // peer advertised, which is how much *we* can send initially on a new stream.
+        uint32_t initial_local_win = local_settings_.initial_window_size;
+        uint32_t initial_remote_win = remote_settings_.initial_window_size;
 
         // Check stream ID validity for creation
         // Client creates odd, server creates even (for push)
@@ -169,6 +273,7 @@ Http2Stream& Http2Connection::get_or_create_stream(stream_id_t stream_id) {
 
 
         auto [new_it, inserted] = streams_.try_emplace(stream_id, stream_id, initial_local_win, initial_remote_win);
+        new_it->second.set_write_coalescing(default_write_coalescing_);
         // Initial state is IDLE. It will transition based on frames.
         return new_it->second;
     }
@@ -184,11 +289,25 @@ Http2Stream* Http2Connection::get_stream(stream_id_t stream_id) {
     return &it->second;
 }
 
+bool Http2Connection::set_stream_user_data(stream_id_t stream_id, void* user_data) {
+    Http2Stream* stream = get_stream(stream_id);
+    if (!stream) return false;
+    stream->set_user_data(user_data);
+    return true;
+}
+
 
 void Http2Connection::handle_parsed_frame(AnyHttp2Frame any_frame) {
     // Dispatch to specific handlers
     // These handlers will update stream states, connection states, and call user callbacks.
 
+    // A pending DATA batch ends at the first frame that does not extend it, and is delivered
+    // before anything is reported about that frame.
+    if (pending_data_stream_ != 0 &&
+        (any_frame.stream_id() != pending_data_stream_ || !std::holds_alternative<DataFrame>(any_frame.frame_variant))) {
+        deliver_pending_data();
+    }
+
     // First, call the generic frame callback if set
     if (frame_cb_) {
         frame_cb_(any_frame);
@@ -217,25 +336,53 @@ void Http2Connection::handle_parsed_frame(AnyHttp2Frame any_frame) {
             handle_window_update_frame(typed_frame);
         } else if constexpr (std::is_same_v<T, ContinuationFrame>) {
             handle_continuation_frame(typed_frame); // Already mostly handled by parser context
+        } else if constexpr (std::is_same_v<T, AltSvcFrame>) {
+            handle_altsvc_frame(typed_frame);
+        } else if constexpr (std::is_same_v<T, OriginFrame>) {
+            handle_origin_frame(typed_frame);
+        } else if constexpr (std::is_same_v<T, PriorityUpdateFrame>) {
+            handle_priority_update_frame(typed_frame);
         }
     }, any_frame.frame_variant);
 
-    // After handling, check for closed streams to clean up
-    // This is a simple cleanup. More robust might be ref-counting or delayed cleanup.
-    std::erase_if(streams_, [](const auto& item){
-        return item.second.get_state() == StreamState::CLOSED;
-    });
+    // After handling, clean up closed streams. Only streams that may have closed are looked at
+    // (this frame's, and those closed by our own sends since the last frame), so the cost does not
+    // grow with the number of open streams.
+    note_stream_closing(any_frame.stream_id());
+    for (stream_id_t id : stream_cleanup_candidates_) {
+        auto it = streams_.find(id);
+        if (it != streams_.end() && it->second.get_state() == StreamState::CLOSED) {
+            void* user_data = it->second.get_user_data();
+            bool report = it->second.was_opened();
+            streams_.erase(it);
+            if (report && stream_events_.on_close) stream_events_.on_close(id, user_data);
+        }
+    }
+    stream_cleanup_candidates_.clear();
+}
+
+void Http2Connection::deliver_pending_data(bool end_stream) {
+    if (pending_data_stream_ == 0) return;
+    stream_id_t stream_id = pending_data_stream_;
+    std::vector<std::vector<std::byte>> chunks;
+    chunks.swap(pending_data_chunks_);
+    pending_data_stream_ = 0;
+    if (data_batch_cb_) data_batch_cb_(stream_id, std::move(chunks), end_stream);
+}
+
+void Http2Connection::note_stream_closing(stream_id_t stream_id) {
+    if (stream_id != 0) stream_cleanup_candidates_.push_back(stream_id);
 }
 
 
 // --- Individual Frame Handlers ---
 
-void Http2Connection::handle_data_frame(const DataFrame& frame) {
+void Http2Connection::handle_data_frame(DataFrame& frame) {
     if (frame.header.stream_id == 0) { /* Protocol error */ return; }
     Http2Stream& stream = get_or_create_stream(frame.header.stream_id);
 
-    // Check stream state: Must be OPEN or HALF_CLOSED_REMOTE to receive DATA
-    if (stream.get_state() != StreamState::OPEN && stream.get_state() != StreamState::HALF_CLOSED_REMOTE) {
+    // Check stream state: Must be OPEN or HALF_CLOSED_LOCAL (we are done sending, the peer is not) to receive DATA
+    if (stream.get_state() != StreamState::OPEN && stream.get_state() != StreamState::HALF_CLOSED_LOCAL) {
         if (on_send_rst_stream_) {
             on_send_rst_stream_(frame.header.stream_id, ErrorCode::STREAM_CLOSED);
         } else {
@@ -293,18 +440,32 @@ void Http2Connection::handle_data_frame(const DataFrame& frame) {
     }
 
 
-    // TODO: Pass data to application associated with the stream.
-
     if (frame.has_end_stream_flag()) {
         stream.transition_to_half_closed_remote(); // Peer has finished sending
         if (stream.get_state() == StreamState::CLOSED) {
             // Stream is now fully closed, will be cleaned up.
         }
     }
+
+    // Pass data to the application. The frame is ours (handle_parsed_frame owns it and the
+    // generic frame callback has already seen it), so the payload buffer is moved, not copied.
+    if (!frame.data.empty()) {
+        unconsumed_bytes_ += frame.data.size();
+        if (governor_) governor_->record_buffered(frame.data.size());
+    }
+    if (stream_events_.on_data) {
+        stream_events_.on_data(frame.header.get_stream_id(), stream.get_user_data(), std::move(frame.data), frame.has_end_stream_flag());
+    } else if (data_batch_cb_) {
+        pending_data_stream_ = frame.header.get_stream_id();
+        if (!frame.data.empty()) pending_data_chunks_.push_back(std::move(frame.data));
+        if (frame.has_end_stream_flag()) deliver_pending_data(true);
+    } else if (data_cb_) {
+        data_cb_(frame.header.get_stream_id(), std::move(frame.data), frame.has_end_stream_flag());
+    }
 }
 
-void Http2Connection::handle_headers_frame(const HeadersFrame& frame) {
-    if (frame.header.stream_id == 0) { /* Protocol error */ return; }
+void Http2Connection::handle_headers_frame(HeadersFrame& frame) {
+    if (frame.header.stream_id == 0) { /* Protocol error */ discard_header_block(0, frame.header_block_fragment); return; }
     Http2Stream& stream = get_or_create_stream(frame.header.stream_id);
 
     // State checks:
@@ -313,11 +474,10 @@ void Http2Connection::handle_headers_frame(const HeadersFrame& frame) {
     // OPEN -> no state change on HEADERS itself (unless END_STREAM for trailers)
     // HALF_CLOSED_REMOTE -> no state change (unless END_STREAM for trailers)
 
-    bool is_trailers = false; // Determine if these are trailing headers
+    // Trailing headers follow the request or the final response on the same stream.
+    bool is_trailers = stream.has_received_headers();
     if (stream.get_state() == StreamState::OPEN || stream.get_state() == StreamState::HALF_CLOSED_REMOTE) {
         // If already received END_STREAM on data, these must be trailers.
-        // This requires more state on the stream (e.g. `received_end_stream_data_flag`)
-        // For now, let's assume if stream is HALF_CLOSED_REMOTE, these are trailers.
         if (stream.get_state() == StreamState::HALF_CLOSED_REMOTE) {
             is_trailers = true;
         }
@@ -326,6 +486,7 @@ void Http2Connection::handle_headers_frame(const HeadersFrame& frame) {
 
     if (stream.get_state() == StreamState::IDLE) {
         stream.transition_to_open();
+        if (stream_events_.on_open) stream.set_user_data(stream_events_.on_open(frame.header.stream_id));
     } else if (stream.get_state() == StreamState::RESERVED_REMOTE) { // Server receiving HEADERS for a PUSH_PROMISE it sent
         stream.transition_to_half_closed_local();
     } else if (stream.get_state() == StreamState::RESERVED_LOCAL) { // Client receiving HEADERS for a PUSH_PROMISE it received
@@ -338,14 +499,16 @@ void Http2Connection::handle_headers_frame(const HeadersFrame& frame) {
                                                   // Client stream state should go to OPEN or HALF_CLOSED_REMOTE if END_STREAM is on these HEADERS.
         stream.transition_to_open(); // Simplified: receiving HEADERS on reserved stream opens it.
     }
-     else if (stream.get_state() != StreamState::OPEN && stream.get_state() != StreamState::HALF_CLOSED_REMOTE) {
-        // Receiving HEADERS in other states (e.g. HALF_CLOSED_LOCAL, CLOSED) is a PROTOCOL_ERROR
+     else if (stream.get_state() != StreamState::OPEN && stream.get_state() != StreamState::HALF_CLOSED_REMOTE &&
+              stream.get_state() != StreamState::HALF_CLOSED_LOCAL) { // HALF_CLOSED_LOCAL: response to a finished request
+        // Receiving HEADERS in other states (e.g. CLOSED) is a PROTOCOL_ERROR
         if (on_send_rst_stream_) {
             on_send_rst_stream_(frame.header.stream_id, ErrorCode::PROTOCOL_ERROR);
         } else {
              std::cerr << "CONN: HEADERS on invalid stream " << frame.header.stream_id << " state " << static_cast<int>(stream.get_state()) << ". Action: RST_STREAM(PROTOCOL_ERROR)" << std::endl;
         }
         stream.transition_to_closed();
+        discard_header_block(frame.header.stream_id, frame.header_block_fragment);
         return;
     }
 
@@ -359,18 +522,80 @@ void Http2Connection::handle_headers_frame(const HeadersFrame& frame) {
         // PROTOCOL_ERROR: Trailers must have END_STREAM
         if (on_send_rst_stream_) on_send_rst_stream_(frame.header.stream_id, ErrorCode::PROTOCOL_ERROR);
         stream.transition_to_closed();
+        discard_header_block(frame.header.stream_id, frame.header_block_fragment);
         return;
     }
 
-
     if (frame.has_priority_flag()) {
         // Apply priority info: frame.stream_dependency, frame.exclusive_dependency, frame.weight
         // This is complex, involves updating dependency tree.
     }
 
+    // A block continued in CONTINUATION frames is reported once complete (handle_continuation_frame),
+    // and END_STREAM takes effect then: the stream must survive until its last CONTINUATION.
+    if (frame.has_end_headers_flag()) report_header_block(stream, frame, is_trailers);
+}
+
+void Http2Connection::report_header_block(Http2Stream& stream, HeadersFrame& frame, bool is_trailers) {
+    // Checks on header values run here, where the block is complete even if CONTINUATION frames
+    // carried part of it.
+
+    // CONNECT: validate the request, then only the response HEADERS may follow on the tunnel.
+    bool is_request = is_server_ && !is_trailers;
+    bool connect_error = false;
+    if (is_request) {
+        connect_error = !is_valid_connect_usage(frame.headers, local_settings_.enable_connect_protocol);
+        if (!connect_error && is_connect_request(frame.headers)) stream.mark_tunnel();
+    } else if (stream.is_tunnel()) {
+        connect_error = is_server_ || stream.is_tunnel_established();
+        if (!connect_error && has_2xx_status(frame.headers)) stream.mark_tunnel_established();
+    }
+    if (connect_error) {
+        if (on_send_rst_stream_) {
+            on_send_rst_stream_(frame.header.stream_id, ErrorCode::PROTOCOL_ERROR);
+        } else {
+            std::cerr << "CONN: invalid CONNECT HEADERS on stream " << frame.header.stream_id << ". Action: RST_STREAM(PROTOCOL_ERROR)" << std::endl;
+        }
+        stream.transition_to_closed();
+        discard_header_block(frame.header.stream_id, frame.header_block_fragment);
+        return;
+    }
+
+    if (is_request) {
+        // RFC 9218 Section 7.1: a PRIORITY_UPDATE that arrived before the request wins over its
+        // priority header. An unparsable header leaves the defaults.
+        StreamPriority priority;
+        auto pending = pending_priority_updates_.find(frame.header.stream_id);
+        if (pending != pending_priority_updates_.end()) {
+            priority = pending->second;
+            pending_priority_updates_.erase(pending);
+        } else if (const std::string* value = find_header_value(frame.headers, "priority")) {
+            parse_priority_field(*value, priority);
+        }
+        stream.set_priority(priority);
+    }
+
     if (frame.has_end_stream_flag()) {
         stream.transition_to_half_closed_remote();
     }
+
+    if (!is_trailers && (is_server_ || !has_1xx_status(frame.headers))) stream.mark_headers_received();
+    if (header_block_cb_) {
+        header_block_cb_({.stream_id = frame.header.stream_id, .end_stream = frame.has_end_stream_flag(),
+                          .trailers = is_trailers, .max_table_size = hpack_decoder_.get_max_dynamic_table_size(),
+                          .block = std::move(frame.header_block_fragment)});
+    } else if (is_trailers) {
+        if (stream_events_.on_trailers) stream_events_.on_trailers(frame.header.stream_id, stream.get_user_data(), frame.headers);
+    } else if (stream_events_.on_headers) {
+        stream_events_.on_headers(frame.header.stream_id, stream.get_user_data(), frame.headers, frame.has_end_stream_flag());
+    }
+}
+
+void Http2Connection::discard_header_block(stream_id_t stream_id, std::vector<std::byte>& block) {
+    if (header_block_cb_) {
+        header_block_cb_({.stream_id = stream_id, .decode_only = true,
+                          .max_table_size = hpack_decoder_.get_max_dynamic_table_size(), .block = std::move(block)});
+    }
 }
 
 void Http2Connection::handle_priority_frame(const PriorityFrame& frame) {
@@ -402,7 +627,7 @@ void Http2Connection::handle_rst_stream_frame(const RstStreamFrame& frame) {
     }
 
     stream_ptr->transition_to_closed();
-    // TODO: Notify application about the stream reset with frame.error_code.
+    if (stream_events_.on_reset) stream_events_.on_reset(frame.header.stream_id, stream_ptr->get_user_data(), frame.error_code);
     // Stream will be cleaned up from the map.
 }
 
@@ -458,11 +683,20 @@ void Http2Connection::apply_remote_setting(const SettingsFrame::Setting& setting
                 /* Protocol error */ return;
             }
             remote_settings_.max_frame_size = setting.value;
-            // This value is used by the parser to check incoming frame sizes.
+            // Caps the frames we send; incoming frames are checked against local_settings_.
             break;
         case SettingsFrame::SETTINGS_MAX_HEADER_LIST_SIZE:
             remote_settings_.max_header_list_size = setting.value;
             break;
+        case SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL:
+            if (setting.value > 1) { /* Protocol error */ return; }
+            // RFC 8441 Section 3: once enabled it cannot be withdrawn.
+            remote_settings_.enable_connect_protocol = remote_settings_.enable_connect_protocol || setting.value == 1;
+            break;
+        case SettingsFrame::SETTINGS_NO_RFC7540_PRIORITIES:
+            if (setting.value > 1) { /* Protocol error */ return; }
+            remote_settings_.no_rfc7540_priorities = (setting.value == 1);
+            break;
         default:
             // Unknown setting identifiers are ignored (RFC 7540 Section 6.5.2)
             break;
@@ -487,11 +721,17 @@ void Http2Connection::apply_remote_setting(const SettingsFrame::Setting& setting
                                                     // The stream method should cap at 2^31-1.
             }
         }
+        if (delta > 0) {
+            flush_all_queued_data();
+        }
     }
 }
 
 
-void Http2Connection::handle_push_promise_frame(const PushPromiseFrame& frame) {
+void Http2Connection::handle_push_promise_frame(PushPromiseFrame& frame) {
+    // Deferred decoding is for servers, which refuse every PUSH_PROMISE. A block continued in
+    // CONTINUATION frames is discarded once complete (handle_continuation_frame).
+    if (frame.has_end_headers_flag()) discard_header_block(frame.header.stream_id, frame.header_block_fragment);
     if (frame.header.stream_id == 0) { /* Protocol error */ return; }
     if (!is_server_ && !local_settings_.enable_push) { /* Protocol error: client received PUSH_PROMISE but push disabled */ return;}
     if (is_server_) { /* Protocol error: server cannot receive PUSH_PROMISE */ return; }
@@ -511,6 +751,7 @@ void Http2Connection::handle_push_promise_frame(const PushPromiseFrame& frame) {
         return;
     }
     promised_stream.transition_to_reserved_remote(); // Client reserves it
+    if (stream_events_.on_open) promised_stream.set_user_data(stream_events_.on_open(frame.promised_stream_id));
 
     // TODO: Process promised headers (frame.headers). Application might decide to accept/reject the push.
     // If rejected, client sends RST_STREAM on the promised_stream_id.
@@ -547,6 +788,79 @@ void Http2Connection::handle_goaway_frame(const GoAwayFrame& frame) {
     }
 }
 
+void Http2Connection::handle_altsvc_frame(const AltSvcFrame& frame) {
+    // RFC 7838 Section 4: only servers send ALTSVC. On stream 0 the origin must be named; on a
+    // stream it must not be. Anything else is ignored.
+    if (is_server_) return;
+    bool on_connection = frame.header.stream_id == 0;
+    if (on_connection == frame.origin.empty()) return;
+    if (altsvc_cb_) {
+        altsvc_cb_(frame);
+    }
+}
+
+void Http2Connection::handle_origin_frame(const OriginFrame& frame) {
+    // RFC 8336 Section 2.1: servers and non-zero streams ignore ORIGIN.
+    if (is_server_ || frame.header.stream_id != 0) return;
+    origin_frame_received_ = true;
+    for (const auto& origin : frame.origins) {
+        std::string normalized = normalize_origin(origin);
+        if (std::find(origin_set_.begin(), origin_set_.end(), normalized) == origin_set_.end()) {
+            origin_set_.push_back(std::move(normalized));
+        }
+    }
+}
+
+void Http2Connection::handle_priority_update_frame(const PriorityUpdateFrame& frame) {
+    // RFC 9218 Section 7.1: only clients send PRIORITY_UPDATE, and never for stream 0.
+    if (!is_server_ || frame.prioritized_stream_id == 0) {
+        if (on_send_goaway_) {
+            on_send_goaway_(last_processed_stream_id_, ErrorCode::PROTOCOL_ERROR, "Invalid PRIORITY_UPDATE");
+        } else {
+            std::cerr << "CONN: invalid PRIORITY_UPDATE. Action: GOAWAY(PROTOCOL_ERROR)" << std::endl;
+        }
+        return;
+    }
+
+    // The update replaces the whole priority: members it leaves out go back to their defaults.
+    StreamPriority priority;
+    if (!parse_priority_field(frame.priority_field_value, priority)) return;
+
+    stream_id_t stream_id = frame.prioritized_stream_id;
+    if (get_stream(stream_id)) {
+        set_stream_priority(stream_id, priority);
+        return;
+    }
+    if (stream_id % 2 == 0 || stream_id <= last_processed_stream_id_) {
+        return; // Closed (or never promised): nothing left to schedule
+    }
+    // The request itself has not arrived yet; keep the update for its HEADERS.
+    if (pending_priority_updates_.size() < MAX_PENDING_PRIORITY_UPDATES || pending_priority_updates_.contains(stream_id)) {
+        pending_priority_updates_[stream_id] = priority;
+    }
+}
+
+bool Http2Connection::set_stream_priority(stream_id_t stream_id, const StreamPriority& priority) {
+    Http2Stream* stream = get_stream(stream_id);
+    if (!stream || priority.urgency >= PRIORITY_URGENCY_LEVELS) return false;
+    bool queued = queued_streams_by_urgency_[stream->get_priority().urgency].erase(stream_id) > 0;
+    stream->set_priority(priority);
+    if (queued) track_queued_stream(*stream);
+    return true;
+}
+
+void Http2Connection::set_origin(std::string_view origin) {
+    std::string normalized = normalize_origin(origin);
+    if (std::find(origin_set_.begin(), origin_set_.end(), normalized) == origin_set_.end()) {
+        origin_set_.insert(origin_set_.begin(), std::move(normalized));
+    }
+}
+
+bool Http2Connection::is_authoritative_for(std::string_view origin) const {
+    std::string normalized = normalize_origin(origin);
+    return std::find(origin_set_.begin(), origin_set_.end(), normalized) != origin_set_.end();
+}
+
 void Http2Connection::handle_window_update_frame(const WindowUpdateFrame& frame) {
     if (frame.window_size_increment == 0) {
         // RFC 7540 Section 6.9: "A WINDOW_UPDATE frame with a flow-control window increment of 0 MUST be
@@ -570,6 +884,7 @@ void Http2Connection::handle_window_update_frame(const WindowUpdateFrame& frame)
             return;
         }
         remote_connection_window_size_ += frame.window_size_increment;
+        flush_all_queued_data();
     } else { // Stream-specific window update
         Http2Stream* stream_ptr = get_stream(frame.header.stream_id);
         if (!stream_ptr || stream_ptr->get_state() == StreamState::IDLE) { // Also ignore for RESERVED states
@@ -593,7 +908,9 @@ void Http2Connection::handle_window_update_frame(const WindowUpdateFrame& frame)
                 on_send_rst_stream_(frame.header.stream_id, ErrorCode::FLOW_CONTROL_ERROR);
             }
             stream_ptr->transition_to_closed();
+            return;
         }
+        flush_queued_data(frame.header.stream_id);
     }
 }
 
@@ -636,8 +953,21 @@ void Http2Connection::handle_continuation_frame(const ContinuationFrame& frame)
     // END_HEADERS has been processed.
 
     // If this CONTINUATION frame itself has END_HEADERS, the connection's `finish_continuation`
-    // (called by parser) would have finalized the header block.
+    // (called by parser) would have finalized the header block, which is reported now.
     // If not, we just wait for more.
+    if (!frame.has_end_headers_flag() || !completed_header_initiator_frame_) return;
+    AnyHttp2Frame initiator = std::move(*completed_header_initiator_frame_);
+    completed_header_initiator_frame_.reset();
+    if (auto* headers_frame = std::get_if<HeadersFrame>(&initiator.frame_variant)) {
+        Http2Stream* stream = get_stream(headers_frame->header.stream_id);
+        if (stream && stream->get_state() != StreamState::IDLE && stream->get_state() != StreamState::CLOSED) {
+            report_header_block(*stream, *headers_frame, stream->has_received_headers());
+        } else {
+            discard_header_block(headers_frame->header.stream_id, headers_frame->header_block_fragment);
+        }
+    } else if (auto* push_promise = std::get_if<PushPromiseFrame>(&initiator.frame_variant)) {
+        discard_header_block(push_promise->header.stream_id, push_promise->header_block_fragment);
+    }
 }
 
 
@@ -653,12 +983,14 @@ void Http2Connection::expect_continuation_for_stream(stream_id_t stream_id, Fram
     expected_continuation_stream_id_ = stream_id;
     header_sequence_initiator_type_ = initiator_type;
     pending_header_initiator_frame_ = std::move(initiator_frame);
+    completed_header_initiator_frame_.reset();
     // Header block buffer is NOT cleared here, it's appended to by the parser.
 }
 
 void Http2Connection::finish_continuation() {
     expected_continuation_stream_id_.reset();
     header_sequence_initiator_type_.reset();
+    completed_header_initiator_frame_ = std::move(pending_header_initiator_frame_);
     pending_header_initiator_frame_.reset();
     clear_header_block_buffer();
 }
@@ -673,12 +1005,13 @@ void Http2Connection::clear_header_block_buffer() {
     header_block_buffer_.clear();
 }
 
-void Http2Connection::populate_pending_headers(std::vector<HttpHeader> headers) {
+void Http2Connection::populate_pending_headers(std::vector<HttpHeader> headers, std::vector<std::byte> encoded_block) {
     if (pending_header_initiator_frame_.has_value()) {
         std::visit([&](auto& frame_variant){
             using T = std::decay_t<decltype(frame_variant)>;
             if constexpr (std::is_same_v<T, HeadersFrame> || std::is_same_v<T, PushPromiseFrame>) {
                 frame_variant.headers = std::move(headers);
+                frame_variant.header_block_fragment = std::move(encoded_block);
             }
         }, pending_header_initiator_frame_->frame_variant);
     }
@@ -726,15 +1059,25 @@ stream_id_t Http2Connection::get_next_available_stream_id() {
     return id;
 }
 
+uint32_t Http2Connection::get_remaining_stream_id_count() const {
+    if (is_server_ || next_client_stream_id_ > MAX_STREAM_ID - 2) {
+        return 0;
+    }
+    return (MAX_STREAM_ID - 2 - next_client_stream_id_) / 2 + 1;
+}
+
 
 // --- Frame Sending API Implementations ---
 
 bool Http2Connection::send_settings(const std::vector<SettingsFrame::Setting>& settings) {
     SettingsFrame sf;
+    sf.header.type = FrameType::SETTINGS;
+    sf.header.flags = 0;
+    sf.header.stream_id = 0;
     sf.settings = settings;
     auto frame_bytes = FrameSerializer::serialize_settings_frame(sf);
     if(on_send_bytes_) {
-        on_send_bytes_(frame_bytes);
+        write_output(frame_bytes);
     }
     return true;
 }
@@ -753,7 +1096,7 @@ bool Http2Connection::send_settings_ack_action() {
      if (frame_bytes.empty()) { // Should not happen for ACK unless serializer is broken
         return false;
     }
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
     return true;
 }
 
@@ -770,7 +1113,7 @@ bool Http2Connection::send_ping(const std::array<std::byte, 8>& opaque_data, boo
 
     auto frame_bytes = FrameSerializer::serialize_ping_frame(pf);
     if (frame_bytes.empty()) return false; // Serialization error
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
     return true;
 }
 
@@ -813,15 +1156,63 @@ bool Http2Connection::send_rst_stream_frame_action(stream_id_t stream_id, ErrorC
 
     auto frame_bytes = FrameSerializer::serialize_rst_stream_frame(rsf);
     if (frame_bytes.empty()) return false;
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
 
     // Update local stream state to closed
     if (stream) {
         stream->transition_to_closed();
+        note_stream_closing(stream_id);
     }
     return true;
 }
 
+bool Http2Connection::send_origin(const std::vector<std::string>& origins) {
+    if (!on_send_bytes_ || !is_server_) return false;
+    OriginFrame frame;
+    frame.header.stream_id = 0;
+    frame.origins = origins;
+    auto frame_bytes = FrameSerializer::serialize_origin_frame(frame);
+    if (frame_bytes.empty() || frame_bytes.size() - FRAME_HEADER_SIZE > remote_settings_.max_frame_size) return false;
+    write_output(std::move(frame_bytes));
+    return true;
+}
+
+bool Http2Connection::send_extension_frame(uint8_t type, uint8_t flags, stream_id_t stream_id, std::span<const std::byte> payload) {
+    if (!on_send_bytes_ || is_known_frame_type(type)) return false;
+    if (payload.size() > remote_settings_.max_frame_size) return false;
+    FrameHeader header;
+    header.type = static_cast<FrameType>(type);
+    header.flags = flags;
+    header.stream_id = stream_id;
+    write_output(FrameSerializer::serialize_extension_frame(header, payload));
+    return true;
+}
+
+bool Http2Connection::send_priority_update(stream_id_t stream_id, const StreamPriority& priority) {
+    if (!on_send_bytes_ || is_server_ || stream_id == 0) return false;
+    if (priority.urgency >= PRIORITY_URGENCY_LEVELS) return false;
+    PriorityUpdateFrame frame;
+    frame.header.stream_id = 0;
+    frame.prioritized_stream_id = stream_id;
+    frame.priority_field_value = format_priority_field(priority);
+    write_output(FrameSerializer::serialize_priority_update_frame(frame));
+    set_stream_priority(stream_id, priority); // The stream may not be open yet
+    return true;
+}
+
+bool Http2Connection::send_altsvc(stream_id_t stream_id, std::string_view origin, std::string_view field_value) {
+    if (!on_send_bytes_ || !is_server_) return false;
+    if ((stream_id == 0) == origin.empty()) return false; // See handle_altsvc_frame()
+    AltSvcFrame frame;
+    frame.header.stream_id = stream_id;
+    frame.origin = origin;
+    frame.field_value = field_value;
+    auto frame_bytes = FrameSerializer::serialize_altsvc_frame(frame);
+    if (frame_bytes.empty() || frame_bytes.size() - FRAME_HEADER_SIZE > remote_settings_.max_frame_size) return false;
+    write_output(std::move(frame_bytes));
+    return true;
+}
+
 bool Http2Connection::send_goaway_action(stream_id_t last_stream_id, ErrorCode error_code, const std::string& debug_data) {
     if (!on_send_bytes_) return false;
 
@@ -836,7 +1227,7 @@ bool Http2Connection::send_goaway_action(stream_id_t last_stream_id, ErrorCode e
 
     auto frame_bytes = FrameSerializer::serialize_goaway_frame(gaf);
     if (frame_bytes.empty()) return false;
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
 
     this->going_away_ = true; // Mark connection as going away from our side.
     // Further stream creation might be blocked based on this flag.
@@ -855,7 +1246,7 @@ bool Http2Connection::send_window_update_action(stream_id_t stream_id, uint32_t
 
     auto frame_bytes = FrameSerializer::serialize_window_update_frame(wuf);
     if (frame_bytes.empty()) return false;
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
 
     // We sent a WINDOW_UPDATE, this means we are increasing *our* local window for the peer.
     // So, the peer can send us more data. This affects local_window_size_ on stream/connection.
@@ -870,9 +1261,8 @@ bool Http2Connection::send_window_update_action(stream_id_t stream_id, uint32_t
     } else {
         Http2Stream* stream = get_stream(stream_id);
         if (stream) {
-            // stream->local_window_size_ += increment; // Similar logic as above.
-            // This function just sends the frame. The window variable itself
-            // should be incremented by logic that decides to send this frame.
+            // Same as the connection window above: the peer may now send `increment` more bytes on this stream.
+            stream->update_local_window(increment);
         } else {
             return false; // Cannot send WU for unknown stream
         }
@@ -891,6 +1281,38 @@ bool Http2Connection::send_data(stream_id_t stream_id, std::span<const std::byte
         // Cannot send DATA on idle, closed, or locally half-closed streams
         return false;
     }
+    if (stream->has_queued_trailers()) {
+        return false; // Trailers waiting behind queued DATA end it
+    }
+
+    const WriteCoalescing& coalescing = stream->get_write_coalescing();
+    if (!end_stream && stream->get_coalesced_data().size() + data.size() < coalescing.min_frame_payload) {
+        stream->append_coalesced_data(data);
+        coalescing_streams_.insert(stream_id);
+        if (coalescing.max_delay.count() != 0 &&
+            std::chrono::steady_clock::now() - stream->get_coalesced_since() >= coalescing.max_delay) {
+            flush_stream_coalesced_data(*stream);
+        }
+        return true;
+    }
+    if (!stream->get_coalesced_data().empty()) {
+        std::vector<std::byte> merged = stream->take_coalesced_data();
+        coalescing_streams_.erase(stream_id);
+        merged.insert(merged.end(), data.begin(), data.end());
+        // The held bytes were already accepted: whatever the windows refuse has to wait in the queue.
+        return queue_data(stream_id, std::move(merged), end_stream);
+    }
+    return send_stream_data(*stream, data, end_stream);
+}
+
+bool Http2Connection::send_stream_data(Http2Stream& stream_ref, std::span<const std::byte> data, bool end_stream) {
+    Http2Stream* stream = &stream_ref;
+    stream_id_t stream_id = stream->get_id();
+
+    // Keep ordering with DATA already waiting in the queue_data() queue.
+    if (stream->has_outgoing_data()) {
+        return queue_data(stream_id, std::vector<std::byte>(data.begin(), data.end()), end_stream);
+    }
 
     // Flow Control and Segmentation
     size_t data_offset = 0;
@@ -915,8 +1337,8 @@ bool Http2Connection::send_data(stream_id_t stream_id, std::span<const std::byte
         size_t remaining_data_size = data.size() - data_offset;
         uint32_t current_chunk_size = static_cast<uint32_t>(remaining_data_size);
 
-        // Limit chunk size by peer's max frame size
-        current_chunk_size = std::min(current_chunk_size, remote_settings_.max_frame_size);
+        // Limit chunk size by peer's max frame size and the DATA sizing policy
+        current_chunk_size = std::min(current_chunk_size, get_data_frame_payload_limit());
 
         // Limit by flow control windows
         current_chunk_size = std::min(current_chunk_size, available_stream_window);
@@ -933,35 +1355,16 @@ bool Http2Connection::send_data(stream_id_t stream_id, std::span<const std::byte
         }
 
 
-        DataFrame df;
-        df.header.type = FrameType::DATA;
-        df.header.stream_id = stream_id;
         // Padding not implemented in this send_data yet.
-
-        df.data.assign(data.begin() + data_offset, data.begin() + data_offset + current_chunk_size);
+        auto chunk = data.subspan(data_offset, current_chunk_size);
         data_offset += current_chunk_size;
         all_data_sent = (data_offset == data.size());
 
-        df.header.flags = (end_stream && all_data_sent) ? DataFrame::END_STREAM_FLAG : 0;
-        // df.header.length is set by serializer
-
-        auto frame_bytes = FrameSerializer::serialize_data_frame(df);
-        // Serialization error for DATA is unlikely unless extreme memory issues, but check:
-        if (frame_bytes.empty() && (current_chunk_size > 0 || (data.empty() && end_stream))) {
+        if (!emit_data_frame(*stream, chunk, end_stream && all_data_sent)) {
             std::cerr << "CONN: send_data serialization failed for stream " << stream_id << std::endl;
             return data_offset > current_chunk_size; // Return true if previous chunks were sent
         }
 
-        on_send_bytes_(std::move(frame_bytes));
-
-        // Update flow control windows
-        stream->record_data_sent(current_chunk_size);
-        record_connection_data_sent(current_chunk_size);
-
-        if (end_stream && all_data_sent) {
-            stream->transition_to_half_closed_local();
-        }
-
         if (data.empty() && data_offset == 0 && end_stream) { // Sent the one empty DATA frame
             break;
         }
@@ -975,11 +1378,29 @@ bool Http2Connection::send_headers(stream_id_t stream_id,
                                  bool end_stream,
                                  std::optional<PriorityData> priority,
                                  std::optional<uint8_t> padding) {
-    if (!is_server_) { // Is a client
-        if ((stream_id % 2) == 0 || stream_id < next_client_stream_id_) { // Stream ID must be odd and increasing
+    return send_headers(stream_id, {}, headers, {}, end_stream, priority, padding);
+}
+
+bool Http2Connection::send_headers(stream_id_t stream_id,
+                                 std::span<const std::byte> encoded_prefix,
+                                 const std::vector<HttpHeader>& headers,
+                                 std::span<const std::byte> encoded_suffix,
+                                 bool end_stream,
+                                 std::optional<PriorityData> priority,
+                                 std::optional<uint8_t> padding) {
+    if (!is_server_ && !get_stream(stream_id)) { // Client opening a new stream (not trailers)
+        // Stream ID must be odd and increasing. It may have been reserved by get_next_available_stream_id().
+        if ((stream_id % 2) == 0 || stream_id <= last_local_stream_id_) {
             return false; // PROTOCOL_ERROR
         }
-        next_client_stream_id_ = stream_id + 2;
+        if (!is_valid_connect_usage(headers, remote_settings_.enable_connect_protocol)) {
+            return false; // e.g. :protocol before the server sent SETTINGS_ENABLE_CONNECT_PROTOCOL
+        }
+        last_local_stream_id_ = stream_id;
+        next_client_stream_id_ = std::max(next_client_stream_id_, stream_id + 2);
+    }
+    if (remote_settings_.no_rfc7540_priorities) {
+        priority.reset(); // The peer ignores RFC 7540 priority signals (RFC 9218 Section 2.1)
     }
 
     // Create stream
@@ -987,15 +1408,53 @@ bool Http2Connection::send_headers(stream_id_t stream_id,
     if (stream.get_state() == StreamState::CLOSED) {
         return false; // Cannot send HEADERS on a closed stream
     }
+    if (!stream.get_coalesced_data().empty()) {
+        flush_stream_coalesced_data(stream); // Trailers follow the DATA written before them
+    }
+    if (stream.get_state() == StreamState::IDLE && !is_server_) {
+        // Our request body is scheduled by the same priority we ask the server to use.
+        StreamPriority own_priority;
+        if (const std::string* value = find_header_value(headers, "priority")) {
+            parse_priority_field(*value, own_priority);
+        }
+        stream.set_priority(own_priority);
+    }
+    if (stream.get_state() == StreamState::IDLE && !is_server_ && is_connect_request(headers)) {
+        stream.mark_tunnel();
+    } else if (stream.is_tunnel()) {
+        // No trailers on a tunnel: the client's request and the server's response are the only HEADERS.
+        if (!is_server_ || stream.is_tunnel_established()) return false;
+        if (has_2xx_status(headers)) stream.mark_tunnel_established();
+    }
+    if (stream.has_outgoing_data() || stream.has_queued_trailers()) {
+        // Trailers must not overtake DATA still waiting for window; flush_stream_queue() sends them.
+        if (stream.is_outgoing_end_stream_pending() || stream.has_queued_trailers()) return false;
+        stream.queue_trailers({.encoded_prefix = {encoded_prefix.begin(), encoded_prefix.end()},
+                               .headers = headers,
+                               .encoded_suffix = {encoded_suffix.begin(), encoded_suffix.end()},
+                               .end_stream = end_stream,
+                               .priority = priority,
+                               .padding = padding});
+        return true;
+    }
+    return write_stream_headers(stream, encoded_prefix, headers, encoded_suffix, end_stream, priority, padding);
+}
 
+bool Http2Connection::write_stream_headers(Http2Stream& stream,
+                                           std::span<const std::byte> encoded_prefix,
+                                           const std::vector<HttpHeader>& headers,
+                                           std::span<const std::byte> encoded_suffix,
+                                           bool end_stream,
+                                           std::optional<PriorityData> priority,
+                                           std::optional<uint8_t> padding) {
     FrameHeader initial_header;
     initial_header.type = FrameType::HEADERS;
-    initial_header.stream_id = stream_id;
+    initial_header.stream_id = stream.get_id();
     initial_header.flags = 0;
     if (end_stream) initial_header.flags |= HeadersFrame::END_STREAM_FLAG;
     if (padding.has_value()) initial_header.flags |= HeadersFrame::PADDED_FLAG;
     if (priority.has_value()) initial_header.flags |= HeadersFrame::PRIORITY_FLAG;
-    // END_HEADERS will be set by serialize_header_block_with_continuation on the last frame.
+    // END_HEADERS will be set by write_header_block on the last frame.
 
     // Construct the HeadersFrame object for the serializer (even if it gets split)
     // The serializer helper will use parts of this.
@@ -1007,22 +1466,15 @@ bool Http2Connection::send_headers(stream_id_t stream_id,
         hf_template.stream_dependency = priority.value().stream_dependency;
         hf_template.weight = priority.value().weight;
     }
-    // hf_template.headers is not used by serialize_header_block_with_continuation, it takes headers_to_encode separately.
+    // hf_template.headers is not used by write_header_block, it takes the headers separately.
 
-    auto sequence = FrameSerializer::serialize_header_block_with_continuation(
-        hf_template.header, // Pass the header with flags for padding/priority
-        headers,
-        hpack_encoder_,
-        remote_settings_.max_frame_size, // Peer's max frame size
-        false // is_push_promise
-    );
-
-    if (sequence.headers_frame_bytes.empty()) return false; // Serialization or HPACK error
-
-    on_send_bytes_(std::move(sequence.headers_frame_bytes));
-    for (auto& cont_bytes : sequence.continuation_frames_bytes) {
-        on_send_bytes_(std::move(cont_bytes));
+    // HEADERS and any CONTINUATION frames are written into one buffer and handed over in one write.
+    std::vector<std::byte> frames;
+    if (!FrameSerializer::write_header_block(frames, hf_template, headers, hpack_encoder_,
+                                             remote_settings_.max_frame_size, encoded_prefix, encoded_suffix)) {
+        return false; // Serialization or HPACK error
     }
+    write_output(std::move(frames));
 
     // Update stream state
     if (stream.get_state() == StreamState::IDLE) { // Client sending initial HEADERS
@@ -1033,6 +1485,7 @@ bool Http2Connection::send_headers(stream_id_t stream_id,
 
     if (end_stream) {
         stream.transition_to_half_closed_local();
+        note_stream_closing(stream.get_id());
     }
     return true;
 }
@@ -1040,6 +1493,7 @@ bool Http2Connection::send_headers(stream_id_t stream_id,
 bool Http2Connection::send_priority(stream_id_t stream_id, const PriorityData& priority_data) {
     if (stream_id == 0) return false;
     if (!on_send_bytes_) return false;
+    if (remote_settings_.no_rfc7540_priorities) return false; // Would be ignored by the peer
 
     // PRIORITY can be sent for idle streams to register them.
     Http2Stream* stream = get_stream(stream_id);
@@ -1061,7 +1515,7 @@ bool Http2Connection::send_priority(stream_id_t stream_id, const PriorityData& p
 
     auto frame_bytes = FrameSerializer::serialize_priority_frame(pf);
     if (frame_bytes.empty()) return false;
-    on_send_bytes_(std::move(frame_bytes));
+    write_output(std::move(frame_bytes));
     return true;
 }
 
@@ -1095,31 +1549,20 @@ bool Http2Connection::send_push_promise(stream_id_t associated_stream_id,
     initial_header.flags = 0; // END_HEADERS handled by serializer helper
     if (padding_length.has_value()) initial_header.flags |= PushPromiseFrame::PADDED_FLAG;
 
-    // Similar to send_headers, use serialize_header_block_with_continuation
+    // Similar to send_headers, use write_header_block
     PushPromiseFrame ppf_template;
     ppf_template.header = initial_header;
     if (padding_length.has_value()) ppf_template.pad_length = padding_length.value();
     ppf_template.promised_stream_id = promised_stream_id;
-    // ppf_template.headers not used by helper, takes headers_to_encode separately.
-
-    auto sequence = FrameSerializer::serialize_header_block_with_continuation(
-        ppf_template.header,
-        headers,
-        hpack_encoder_,
-        remote_settings_.max_frame_size,
-        true, // is_push_promise = true
-        promised_stream_id
-    );
-
-    if (sequence.headers_frame_bytes.empty()) {
+    // ppf_template.headers not used by helper, takes the headers separately.
+
+    std::vector<std::byte> frames;
+    if (!FrameSerializer::write_header_block(frames, ppf_template, headers, hpack_encoder_, remote_settings_.max_frame_size)) {
         promised_s->transition_to_closed(); // Clean up reserved stream if PUSH_PROMISE fails to send
+        note_stream_closing(promised_stream_id);
         return false;
     }
-
-    on_send_bytes_(std::move(sequence.headers_frame_bytes));
-    for (auto& cont_bytes : sequence.continuation_frames_bytes) {
-        on_send_bytes_(std::move(cont_bytes));
-    }
+    write_output(std::move(frames));
 
     return true;
 }
@@ -1162,10 +1605,381 @@ void Http2Connection::apply_local_setting(const SettingsFrame::Setting& setting)
         case SettingsFrame::SETTINGS_MAX_HEADER_LIST_SIZE:
             local_settings_.max_header_list_size = setting.value;
             break;
+        case SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL:
+            // Advertised by a server that accepts extended CONNECT; has no meaning from a client.
+            if (is_server_ && setting.value <= 1) {
+                local_settings_.enable_connect_protocol = local_settings_.enable_connect_protocol || setting.value == 1;
+            }
+            break;
+        case SettingsFrame::SETTINGS_NO_RFC7540_PRIORITIES:
+            if (setting.value <= 1) {
+                local_settings_.no_rfc7540_priorities = (setting.value == 1);
+            }
+            break;
         default:
             // Ignore unknown settings
             break;
     }
 }
 
+// --- Queued DATA and Credit Return ---
+
+bool Http2Connection::emit_data_frame(Http2Stream& stream, std::span<const std::byte> chunk, bool end_stream) {
+    // The payload goes straight from `chunk` into the wire buffer (no intermediate DataFrame).
+    auto frame_bytes = FrameSerializer::serialize_data_frame(stream.get_id(), chunk, end_stream ? DataFrame::END_STREAM_FLAG : 0);
+    if (frame_bytes.empty()) return false;
+    write_output(std::move(frame_bytes));
+
+    // Update flow control windows
+    stream.record_data_sent(chunk.size());
+    record_connection_data_sent(chunk.size());
+    ++data_frames_sent_;
+    data_bytes_sent_ += chunk.size();
+
+    if (end_stream) {
+        stream.transition_to_half_closed_local();
+        note_stream_closing(stream.get_id());
+    }
+    return true;
+}
+
+uint32_t Http2Connection::get_data_frame_payload_limit() const {
+    uint32_t frame_size = data_frame_sizing_.steady_frame_size;
+    if (data_bytes_sent_ < data_frame_sizing_.warmup_bytes && data_frame_sizing_.warmup_frame_size != 0) {
+        frame_size = data_frame_sizing_.warmup_frame_size;
+    }
+    if (frame_size == 0) return remote_settings_.max_frame_size;
+    uint32_t payload = frame_size > FRAME_HEADER_SIZE ? frame_size - static_cast<uint32_t>(FRAME_HEADER_SIZE) : 1;
+    return std::min(payload, remote_settings_.max_frame_size);
+}
+
+size_t Http2Connection::get_sendable_data_size(const Http2Stream& stream) const {
+    int32_t window = std::min(stream.get_remote_window_size(), remote_connection_window_size_);
+    return static_cast<size_t>(std::max(0, window));
+}
+
+bool Http2Connection::queue_data(stream_id_t stream_id, std::vector<std::byte> data, bool end_stream) {
+    if (stream_id == 0) return false; // DATA must be on a non-zero stream
+    if (!on_send_bytes_) return false;
+
+    Http2Stream* stream = get_stream(stream_id);
+    if (!stream || (stream->get_state() != StreamState::OPEN && stream->get_state() != StreamState::HALF_CLOSED_REMOTE)) {
+        return false;
+    }
+    if (stream->is_outgoing_end_stream_pending() || stream->has_queued_trailers()) {
+        return false; // END_STREAM or trailers already queued
+    }
+    if (!stream->get_coalesced_data().empty()) {
+        stream->enqueue_outgoing_data(stream->take_coalesced_data(), false);
+        coalescing_streams_.erase(stream_id);
+    }
+
+    stream->enqueue_outgoing_data(std::move(data), end_stream);
+    flush_queued_data(stream_id);
+    if (stream->has_outgoing_data()) {
+        track_queued_stream(*stream);
+    }
+    return true;
+}
+
+size_t Http2Connection::flush_queued_data(stream_id_t stream_id) {
+    return flush_stream_queue(stream_id, SIZE_MAX);
+}
+
+size_t Http2Connection::flush_stream_queue(stream_id_t stream_id, size_t byte_limit) {
+    Http2Stream* stream = get_stream(stream_id);
+    if (!stream || !stream->has_outgoing_data()) {
+        untrack_queued_stream(stream_id);
+        return 0;
+    }
+    if (!on_send_bytes_) return 0;
+
+    size_t bytes_sent = 0;
+    while (stream->has_outgoing_data() && bytes_sent < byte_limit) {
+        auto chunk = stream->front_outgoing_data();
+        if (chunk.empty()) {
+            // Only END_STREAM is left; an empty DATA frame needs no window.
+            stream->clear_outgoing_data();
+            emit_data_frame(*stream, {}, true);
+            break;
+        }
+
+        size_t chunk_size = std::min({chunk.size(),
+                                      static_cast<size_t>(get_data_frame_payload_limit()),
+                                      get_sendable_data_size(*stream)});
+        if (chunk_size == 0) {
+            break; // Blocked by flow control, resumed by the next WINDOW_UPDATE
+        }
+
+        bool last = stream->is_outgoing_end_stream_pending() && chunk_size == stream->get_outgoing_data_size();
+        if (!emit_data_frame(*stream, chunk.first(chunk_size), last)) {
+            break;
+        }
+        stream->pop_outgoing_data(chunk_size);
+        bytes_sent += chunk_size;
+        if (last) {
+            stream->clear_outgoing_data();
+        }
+    }
+
+    if (!stream->has_outgoing_data()) {
+        untrack_queued_stream(stream_id);
+        if (stream->has_queued_trailers()) {
+            Http2Stream::QueuedHeaders trailers = stream->take_queued_trailers();
+            write_stream_headers(*stream, trailers.encoded_prefix, trailers.headers, trailers.encoded_suffix,
+                                 trailers.end_stream, trailers.priority, trailers.padding);
+        }
+    }
+    if (bytes_sent > 0 && data_sent_cb_) {
+        data_sent_cb_(stream_id, bytes_sent);
+    }
+    return bytes_sent;
+}
+
+void Http2Connection::flush_all_queued_data() {
+    // Most urgent first. Within an urgency, one pass sends everything the windows allow for
+    // non-incremental streams (in id order) and one frame for each incremental stream; passes
+    // repeat while incremental streams make progress. Walk by id rather than by iterator: the
+    // data-sent callback may queue data, close streams or change priorities. Stops as soon as the
+    // connection window is used up, so a WINDOW_UPDATE costs only as much as the streams it lets send.
+    for (auto& queued : queued_streams_by_urgency_) {
+        bool progress = true;
+        while (progress && remote_connection_window_size_ > 0) {
+            progress = false;
+            stream_id_t last_id = 0;
+            while (remote_connection_window_size_ > 0) {
+                auto it = queued.upper_bound(last_id);
+                if (it == queued.end()) break;
+                last_id = *it;
+                const Http2Stream* stream = get_stream(last_id);
+                bool incremental = stream && stream->get_priority().incremental;
+                size_t sent = flush_stream_queue(last_id, incremental ? get_data_frame_payload_limit() : SIZE_MAX);
+                progress = progress || (incremental && sent > 0);
+            }
+        }
+        if (remote_connection_window_size_ <= 0) break;
+    }
+}
+
+void Http2Connection::track_queued_stream(const Http2Stream& stream) {
+    queued_streams_by_urgency_[stream.get_priority().urgency].insert(stream.get_id());
+}
+
+void Http2Connection::untrack_queued_stream(stream_id_t stream_id) {
+    if (const Http2Stream* stream = get_stream(stream_id)) {
+        queued_streams_by_urgency_[stream->get_priority().urgency].erase(stream_id);
+        return;
+    }
+    for (auto& queued : queued_streams_by_urgency_) queued.erase(stream_id);
+}
+
+void Http2Connection::set_output_flush_policy(const OutputFlushPolicy& policy) {
+    flush_policy_ = policy;
+    if (!flush_policy_.enabled && cork_depth_ == 0) flush_output();
+}
+
+void Http2Connection::uncork() {
+    if (cork_depth_ > 0 && --cork_depth_ == 0) flush_output();
+}
+
+void Http2Connection::flush_output() {
+    if (output_buffer_.empty() || !on_send_bytes_) return;
+    std::vector<std::byte> bytes;
+    bytes.swap(output_buffer_);
+    ++output_writes_;
+    on_send_bytes_(std::move(bytes));
+}
+
+void Http2Connection::poll_output() {
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = coalescing_streams_.begin(); it != coalescing_streams_.end();) {
+        stream_id_t stream_id = *it++; // Flushing erases the current entry
+        Http2Stream* stream = get_stream(stream_id);
+        if (!stream || stream->get_coalesced_data().empty()) {
+            coalescing_streams_.erase(stream_id);
+            continue;
+        }
+        const WriteCoalescing& coalescing = stream->get_write_coalescing();
+        if (coalescing.max_delay.count() != 0 && now - stream->get_coalesced_since() >= coalescing.max_delay) {
+            flush_stream_coalesced_data(*stream);
+        }
+    }
+    if (output_buffer_.empty() || cork_depth_ > 0 || flush_policy_.latency_budget.count() == 0) return;
+    if (now - output_buffered_since_ >= flush_policy_.latency_budget) flush_output();
+}
+
+std::optional<std::chrono::steady_clock::time_point> Http2Connection::get_output_deadline() const {
+    std::optional<std::chrono::steady_clock::time_point> deadline;
+    auto consider = [&](std::chrono::steady_clock::time_point t) { if (!deadline || t < *deadline) deadline = t; };
+    for (stream_id_t stream_id : coalescing_streams_) {
+        auto it = streams_.find(stream_id);
+        if (it == streams_.end() || it->second.get_coalesced_data().empty()) continue;
+        const WriteCoalescing& coalescing = it->second.get_write_coalescing();
+        if (coalescing.max_delay.count() != 0) consider(it->second.get_coalesced_since() + coalescing.max_delay);
+    }
+    if (!output_buffer_.empty() && cork_depth_ == 0 && flush_policy_.latency_budget.count() != 0) {
+        consider(output_buffered_since_ + flush_policy_.latency_budget);
+    }
+    return deadline;
+}
+
+void Http2Connection::set_write_coalescing(stream_id_t stream_id, const WriteCoalescing& coalescing) {
+    Http2Stream* stream = get_stream(stream_id);
+    if (!stream) return;
+    stream->set_write_coalescing(coalescing);
+    if (stream->get_coalesced_data().size() >= coalescing.min_frame_payload) flush_stream_coalesced_data(*stream);
+}
+
+void Http2Connection::flush_coalesced_data(stream_id_t stream_id) {
+    if (stream_id != 0) {
+        if (Http2Stream* stream = get_stream(stream_id)) flush_stream_coalesced_data(*stream);
+        return;
+    }
+    while (!coalescing_streams_.empty()) {
+        Http2Stream* stream = get_stream(*coalescing_streams_.begin());
+        if (stream) {
+            flush_stream_coalesced_data(*stream);
+        } else {
+            coalescing_streams_.erase(coalescing_streams_.begin());
+        }
+    }
+}
+
+void Http2Connection::flush_stream_coalesced_data(Http2Stream& stream) {
+    coalescing_streams_.erase(stream.get_id());
+    if (stream.get_coalesced_data().empty()) return;
+    // Through the stream's queue: what the windows do not allow now waits for WINDOW_UPDATE.
+    stream.enqueue_outgoing_data(stream.take_coalesced_data(), false);
+    flush_queued_data(stream.get_id());
+    if (stream.has_outgoing_data()) track_queued_stream(stream);
+}
+
+void Http2Connection::write_output(std::vector<std::byte> bytes) {
+    if (!flush_policy_.enabled && cork_depth_ == 0) {
+        ++output_writes_;
+        on_send_bytes_(std::move(bytes));
+        return;
+    }
+    bool timed = flush_policy_.latency_budget.count() != 0;
+    if (output_buffer_.empty()) {
+        output_buffer_ = std::move(bytes); // Steal the frame's buffer instead of copying it
+        if (timed) output_buffered_since_ = std::chrono::steady_clock::now();
+    } else {
+        output_buffer_.insert(output_buffer_.end(), bytes.begin(), bytes.end());
+    }
+    if (output_buffer_.size() >= flush_policy_.max_buffered_bytes) {
+        flush_output();
+    } else if (timed && cork_depth_ == 0 &&
+               std::chrono::steady_clock::now() - output_buffered_since_ >= flush_policy_.latency_budget) {
+        flush_output();
+    }
+}
+
+bool Http2Connection::consume_data(stream_id_t stream_id, uint32_t size) {
+    if (size == 0) return false;
+    // No point in stream credit once the peer has finished sending on the stream.
+    Http2Stream* stream = get_stream(stream_id);
+    bool stream_credit = stream && (stream->get_state() == StreamState::OPEN || stream->get_state() == StreamState::HALF_CLOSED_LOCAL);
+    // The buffered-data accounting follows only once the credit is accepted.
+    auto release = [this, size] {
+        uint64_t released = std::min<uint64_t>(size, unconsumed_bytes_);
+        unconsumed_bytes_ -= released;
+        if (governor_ && released) governor_->record_released(static_cast<size_t>(released));
+    };
+
+    if (credit_policy_.batched || receive_caps_) {
+        if (size > MAX_ALLOWED_WINDOW_SIZE - pending_connection_credit_) return false;
+        release();
+        pending_connection_credit_ += size;
+        if (stream_credit) {
+            stream->add_pending_credit(size);
+            streams_with_pending_credit_.insert(stream_id);
+        }
+        if (input_depth_ == 0) flush_window_updates();
+        return true;
+    }
+
+    if (!send_window_update_action(0, size)) return false;
+    release();
+    return !stream_credit || send_window_update_action(stream_id, size);
+}
+
+void Http2Connection::set_credit_return_policy(const CreditReturnPolicy& policy) {
+    credit_policy_ = policy;
+    if (!credit_policy_.batched) flush_window_updates(true);
+}
+
+void Http2Connection::set_receive_window_caps(std::optional<ReceiveWindowCaps> caps) {
+    bool was_capped = receive_caps_.has_value();
+    if (!was_capped && caps) uncapped_max_concurrent_streams_ = local_settings_.max_concurrent_streams;
+    receive_caps_ = caps;
+
+    uint32_t max_streams = caps ? std::min(caps->max_concurrent_streams, uncapped_max_concurrent_streams_)
+                                : uncapped_max_concurrent_streams_;
+    if ((was_capped || caps) && max_streams != local_settings_.max_concurrent_streams) {
+        SettingsFrame::Setting setting{SettingsFrame::SETTINGS_MAX_CONCURRENT_STREAMS, max_streams};
+        apply_local_setting(setting);
+        if (on_send_bytes_) send_settings({setting});
+    }
+    // Lifting or raising the caps may free withheld credit.
+    flush_window_updates(!credit_policy_.batched);
+}
+
+uint32_t Http2Connection::get_returnable_credit(uint32_t credit, int32_t window_left, uint32_t min_increment, uint32_t cap, bool all) const {
+    if (credit == 0) return 0;
+    uint32_t grant = credit;
+    if (receive_caps_) {
+        int64_t room = static_cast<int64_t>(cap) - window_left;
+        if (room <= 0) return 0;
+        grant = static_cast<uint32_t>(std::min<int64_t>(grant, room));
+    }
+    if (all || !credit_policy_.batched) return grant;
+    bool due = min_increment != 0 ? grant >= min_increment : static_cast<int64_t>(grant) >= window_left;
+    return due ? grant : 0;
+}
+
+void Http2Connection::flush_window_updates(bool all) {
+    if (!on_send_bytes_) return;
+    uint32_t stream_cap = receive_caps_ ? receive_caps_->stream_window : 0;
+    uint32_t connection_cap = receive_caps_ ? receive_caps_->connection_window : 0;
+
+    // All due WINDOW_UPDATEs go out back to back in a single write.
+    std::vector<std::byte> out;
+    auto append = [&out](stream_id_t stream_id, uint32_t increment) {
+        WindowUpdateFrame wuf;
+        wuf.header.type = FrameType::WINDOW_UPDATE;
+        wuf.header.flags = 0;
+        wuf.header.stream_id = stream_id;
+        wuf.window_size_increment = increment;
+        auto frame_bytes = FrameSerializer::serialize_window_update_frame(wuf);
+        out.insert(out.end(), frame_bytes.begin(), frame_bytes.end());
+    };
+
+    if (uint32_t credit = get_returnable_credit(pending_connection_credit_, local_connection_window_size_,
+                                                credit_policy_.min_connection_increment, connection_cap, all)) {
+        append(0, credit);
+        local_connection_window_size_ += static_cast<int32_t>(credit);
+        pending_connection_credit_ -= credit;
+    }
+    for (auto it = streams_with_pending_credit_.begin(); it != streams_with_pending_credit_.end();) {
+        Http2Stream* stream = get_stream(*it);
+        if (!stream || (stream->get_state() != StreamState::OPEN && stream->get_state() != StreamState::HALF_CLOSED_LOCAL)) {
+            it = streams_with_pending_credit_.erase(it); // The peer has stopped sending: credit is moot
+            continue;
+        }
+        if (uint32_t credit = get_returnable_credit(stream->get_pending_credit(), stream->get_local_window_size(),
+                                                    credit_policy_.min_stream_increment, stream_cap, all)) {
+            stream->remove_pending_credit(credit);
+            append(stream->get_id(), credit);
+            stream->update_local_window(credit);
+        }
+        if (stream->get_pending_credit() == 0) {
+            it = streams_with_pending_credit_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    if (!out.empty()) write_output(std::move(out));
+}
+
 } // namespace http2
@@ -3,19 +3,27 @@
 #include "http2_types.h"
 #include "http2_stream.h"
 #include "http2_frame.h" // For HttpHeader, SettingsFrame etc.
+#include "http2_priority.h"
 #include "hpack_decoder.h"
 #include "hpack_encoder.h" // Assuming an HpackEncoder will be created for sending headers
+#include "http2_parser.h" // For the extension frame handler types
 
+#include <array>
+#include <chrono>
 #include <map>
+#include <set>
 #include <vector>
 #include <functional>
 #include <optional>
 #include <span>
+#include <string>
+#include <string_view>
 
 namespace http2 {
 
 // Forward declaration
 class Http2Parser;
+class MemoryGovernor;
 
 // Default connection settings (RFC 7540 Section 6.5.2)
 constexpr uint32_t DEFAULT_HEADER_TABLE_SIZE = 4096;
@@ -33,8 +41,111 @@ struct ConnectionSettings {
     uint32_t initial_window_size = DEFAULT_INITIAL_WINDOW_SIZE;
     uint32_t max_frame_size = DEFAULT_MAX_FRAME_SIZE;
     uint32_t max_header_list_size = DEFAULT_MAX_HEADER_LIST_SIZE; // Optional setting
+    bool enable_connect_protocol = false; // RFC 8441: server accepts extended CONNECT (:protocol)
+    bool no_rfc7540_priorities = false;   // RFC 9218: sender ignores RFC 7540 PRIORITY signals
 };
 
+// How DATA is cut into frames. Frames never exceed the peer's SETTINGS_MAX_FRAME_SIZE or the
+// flow-control windows; within that, each DATA frame (9-byte header included) is kept to the
+// size below. The defaults (0) mean "as large as the peer allows". Advertising a larger
+// SETTINGS_MAX_FRAME_SIZE (apply_local_setting() + send_settings()) lets the peer do the same.
+//
+// Sizes that match the transport's writes avoid frames straddling them: e.g. 16384 puts each
+// frame in exactly one full TLS record. A small warm-up size (about one TCP segment, 1400) gets
+// the first bytes of a response decrypted and used before the congestion window has opened up;
+// after warmup_bytes of DATA the connection switches to steady_frame_size.
+struct DataFrameSizing {
+    uint32_t warmup_frame_size = 0; // Frame size while cold; 0 = use steady_frame_size
+    uint64_t warmup_bytes = 0;      // DATA bytes sent on the connection before it counts as warm
+    uint32_t steady_frame_size = 0; // Frame size once warm; 0 = peer's SETTINGS_MAX_FRAME_SIZE
+};
+
+// When buffered output is handed to on_send_bytes. With the policy disabled (the default) and the
+// connection uncorked, every frame is written as soon as it is built. Otherwise frames from all
+// streams are appended to one buffer and written together, turning a handler's HEADERS and
+// handful of small DATA frames into a single write (one syscall / TLS record instead of many).
+//
+// The buffer is written when it reaches max_buffered_bytes, when process_incoming_data() returns
+// (the end of the event-loop turn that triggered the sends), and once the oldest buffered byte has
+// waited latency_budget. The budget is checked on every write and by poll_output(), which an event
+// loop calls from a timer armed for get_output_deadline(). flush_output() writes immediately.
+struct OutputFlushPolicy {
+    bool enabled = false;
+    size_t max_buffered_bytes = 16384;              // Write once this much is buffered
+    bool flush_after_input = true;                  // Write when process_incoming_data() returns
+    std::chrono::microseconds latency_budget{1000}; // Longest a byte may wait; 0 = no budget
+};
+
+// How consume_data() returns flow-control credit. Unbatched (the default), each call sends a
+// WINDOW_UPDATE for the stream and one for the connection. Batched, credit is added up per stream
+// and for the connection and only returned once it is worth a frame: by default when it has
+// reached what is left of the window, i.e. the peer has used half of it. WINDOW_UPDATEs that fall
+// due while process_incoming_data() runs are written together, back to back in one write, when
+// the read ends; outside a read they are written straight away.
+struct CreditReturnPolicy {
+    bool batched = false;
+    uint32_t min_stream_increment = 0;     // 0 = once the credit reaches the remaining stream window
+    uint32_t min_connection_increment = 0; // 0 = the same rule for the connection window
+};
+
+// Upper bounds on what the peer is allowed to send us, imposed while memory is short (see
+// MemoryGovernor). The windows are capped by withholding credit: consume_data() keeps back what
+// would take a window above its cap and returns it once the caps are lifted. This is the only way
+// to shrink the connection window, and unlike a lower SETTINGS_INITIAL_WINDOW_SIZE it cannot make
+// DATA already in flight a flow-control error. The stream limit is advertised with SETTINGS.
+struct ReceiveWindowCaps {
+    uint32_t stream_window = 16384;
+    uint32_t connection_window = DEFAULT_INITIAL_WINDOW_SIZE;
+    uint32_t max_concurrent_streams = 10;
+};
+
+// A CONNECT request carrying the :protocol pseudo-header (RFC 8441), e.g. a WebSocket over HTTP/2.
+bool is_extended_connect_request(const std::vector<HttpHeader>& headers);
+
+// ASCII serialization of an origin (RFC 6454): lowercased, default port (443/80) dropped,
+// e.g. make_origin("HTTPS", "Example.com:443") == "https://example.com".
+std::string make_origin(std::string_view scheme, std::string_view authority);
+// Same normalization for an already serialized origin such as an ORIGIN frame entry.
+std::string normalize_origin(std::string_view origin);
+
+
+// Per-stream lifecycle events. Each carries the stream's user data (Http2Stream::set_user_data),
+// so an application can keep its request object there instead of in a map keyed by stream id.
+// Unset handlers are skipped.
+struct StreamEvents {
+    // The peer opened a stream: a request on a server, a PUSH_PROMISE on a client (for the promised
+    // stream). Called before any other event for it; the result becomes the stream's user data.
+    // Streams we open ourselves are not reported; use set_stream_user_data() after send_headers().
+    std::function<void*(stream_id_t stream_id)> on_open;
+    // A request or response header block, once any CONTINUATION has arrived. Each interim (1xx)
+    // response is a call of its own.
+    std::function<void(stream_id_t stream_id, void* user_data, const std::vector<HttpHeader>& headers, bool end_stream)> on_headers;
+    // Received DATA, one call per frame. While set, DATA goes here instead of the data callbacks.
+    std::function<void(stream_id_t stream_id, void* user_data, std::vector<std::byte>&& data, bool end_stream)> on_data;
+    // Trailing HEADERS; they always end the stream.
+    std::function<void(stream_id_t stream_id, void* user_data, const std::vector<HttpHeader>& trailers)> on_trailers;
+    // The peer sent RST_STREAM. on_close follows.
+    std::function<void(stream_id_t stream_id, void* user_data, ErrorCode error_code)> on_reset;
+    // The stream is closed and removed, whichever side ended it; the last event for a stream that
+    // was opened or reserved. Not called for streams still open when the connection is destroyed.
+    std::function<void(stream_id_t stream_id, void* user_data)> on_close;
+};
+
+// A complete request header block handed over still HPACK-encoded, for decoding elsewhere (see
+// Http2Connection::set_header_block_callback()). Blocks arrive in wire order, and every one of
+// them must be decoded in that order to keep the HPACK dynamic table in step with the peer's.
+struct EncodedHeaderBlock {
+    stream_id_t stream_id = 0;
+    bool end_stream = false;
+    bool trailers = false;
+    // The frame was rejected (e.g. HEADERS on a closed stream, or a PUSH_PROMISE sent to a
+    // server): decode the block for the table's sake only, and do not deliver it.
+    bool decode_only = false;
+    // Dynamic table size limit set on the connection's own (idle) decoder by SETTINGS. Apply it to
+    // the decoder doing the work whenever it changes, before decoding the block.
+    uint32_t max_table_size = DEFAULT_HEADER_TABLE_SIZE;
+    std::vector<std::byte> block;
+};
 
 class Http2Connection {
 public:
@@ -43,6 +154,16 @@ public:
     using SettingsAckCallback = std::function<void()>; // When SETTINGS ACK is received
     using PingAckCallback = std::function<void(const PingFrame& ping_ack_frame)>; // When PING ACK is received
     using GoAwayCallback = std::function<void(const GoAwayFrame& goaway_frame)>;
+    // Received DATA payload, handed over by value so it can be forwarded without copying.
+    using DataCallback = std::function<void(stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream)>;
+    // DATA of back-to-back frames on one stream, received within one process_incoming_data() call,
+    // as the frames' payload buffers in order. end_stream is set on the batch ending the stream.
+    using DataBatchCallback = std::function<void(stream_id_t stream_id, std::vector<std::vector<std::byte>>&& chunks, bool end_stream)>;
+    // Bytes from the queue_data() queue that have actually been written as DATA frames.
+    using DataSentCallback = std::function<void(stream_id_t stream_id, size_t bytes_sent)>;
+    // ALTSVC received by a client (RFC 7838). Frames the RFC says to ignore are not reported.
+    using AltSvcCallback = std::function<void(const AltSvcFrame& frame)>;
+    using HeaderBlockCallback = std::function<void(EncodedHeaderBlock&& block)>;
     // Add more callbacks as needed: e.g., for new stream, stream close, errors
 
     Http2Connection(bool is_server_connection);
@@ -53,8 +174,28 @@ public:
     void set_settings_ack_callback(SettingsAckCallback cb);
     void set_ping_ack_callback(PingAckCallback cb);
     void set_goaway_callback(GoAwayCallback cb);
-    // void set_new_stream_callback(...)
-    // void set_stream_closed_callback(...)
+    void set_data_callback(DataCallback cb);
+    // Replaces the data callback while set: one call per batch instead of one per DATA frame, so a
+    // chatty peer costs one delivery (and one consume_data() WINDOW_UPDATE pair) per read.
+    void set_data_batch_callback(DataBatchCallback cb) { data_batch_cb_ = std::move(cb); }
+    void set_data_sent_callback(DataSentCallback cb);
+    void set_altsvc_callback(AltSvcCallback cb) { altsvc_cb_ = std::move(cb); }
+    void set_stream_events(StreamEvents events) { stream_events_ = std::move(events); }
+    // Server connections only. While set, the parser leaves header blocks HPACK-encoded and each
+    // complete block goes here instead of to StreamEvents::on_headers / on_trailers, so decoding
+    // can be moved off the I/O thread (see Http2Pipeline). Framing, stream states and flow control
+    // are unaffected; checks that need header values (CONNECT rules, the priority header) are
+    // skipped, and the frame callback sees HEADERS with an empty header list.
+    void set_header_block_callback(HeaderBlockCallback cb) { header_block_cb_ = std::move(cb); }
+    bool is_header_decoding_deferred() const { return static_cast<bool>(header_block_cb_); }
+
+    // --- Extension Frames (RFC 9113 Section 5.5) ---
+    // Handlers for frame types the library does not implement, e.g. private frames between our
+    // own peers. They are called from process_incoming_data() with a view of the payload and
+    // bypass the frame callback. See Http2Parser for the two handler kinds.
+    bool register_extension_frame_handler(uint8_t type, Http2Parser::ExtensionFrameHandler handler);
+    bool register_extension_chunk_handler(uint8_t type, Http2Parser::ExtensionChunkHandler handler);
+    void unregister_extension_handler(uint8_t type);
 
     // --- Data Processing ---
     // Process incoming raw bytes from the transport layer
@@ -75,10 +216,21 @@ public:
 
     // --- Stream Management ---
     Http2Stream* get_stream(stream_id_t stream_id);
+    // Attaches application data to an existing stream; false if there is no such stream.
+    bool set_stream_user_data(stream_id_t stream_id, void* user_data);
     // Http2Stream* create_stream(); // For client initiating a stream
     // Http2Stream* create_pushed_stream(stream_id_t parent_stream_id); // For server pushing a stream
 
 
+    // --- Write Coalescing ---
+    // Merges small send_data() writes on a stream into fewer DATA frames (see WriteCoalescing).
+    // The default applies to streams created afterwards. Held-back bytes go out before anything
+    // else sent on their stream (queue_data(), trailers), and on flush_coalesced_data().
+    void set_write_coalescing(stream_id_t stream_id, const WriteCoalescing& coalescing);
+    void set_default_write_coalescing(const WriteCoalescing& coalescing) { default_write_coalescing_ = coalescing; }
+    // Frames the held-back writes of one stream, or of every stream for stream_id 0.
+    void flush_coalesced_data(stream_id_t stream_id = 0);
+
     // --- Settings Management ---
     const ConnectionSettings& get_local_settings() const;
     const ConnectionSettings& get_remote_settings() const;
@@ -99,40 +251,103 @@ public:
     void expect_continuation_for_stream(stream_id_t stream_id, FrameType initiator_type, AnyHttp2Frame initiator_frame);
     void finish_continuation();
     void append_to_header_block_buffer(std::span<const std::byte> fragment);
-    void populate_pending_headers(std::vector<HttpHeader> headers);
+    // Completes the pending HEADERS/PUSH_PROMISE with its decoded headers, or with the still
+    // encoded block while header decoding is deferred.
+    void populate_pending_headers(std::vector<HttpHeader> headers, std::vector<std::byte> encoded_block = {});
     std::span<const std::byte> get_header_block_buffer_span() const;
     void clear_header_block_buffer();
 
+    // --- Origin Set (RFC 8336 Section 2.3) ---
+    // Origins a client connection may carry requests for. It starts with the origin the
+    // connection was opened for and grows with every ORIGIN frame from the server. Whether the
+    // server's certificate also covers an origin is for the TLS layer to check.
+    void set_origin(std::string_view origin);
+    const std::vector<std::string>& get_origin_set() const { return origin_set_; }
+    bool is_authoritative_for(std::string_view origin) const;
+    bool has_received_origin_frame() const { return origin_frame_received_; }
+
+    // --- Stream Priority (RFC 9218) ---
+    // Queued DATA (queue_data()) is sent in order of urgency. Within one urgency, non-incremental
+    // streams go one after another in stream id order, while incremental streams share the
+    // window a frame at a time. A server takes each request's priority from its `priority` header
+    // and later PRIORITY_UPDATE frames; a client from the `priority` header it sends. This
+    // overrides it locally, without telling the peer.
+    bool set_stream_priority(stream_id_t stream_id, const StreamPriority& priority);
+    // Both sides sent SETTINGS_NO_RFC7540_PRIORITIES = 1: PRIORITY frames and the HEADERS
+    // priority fields carry no meaning on this connection.
+    bool is_rfc7540_priority_disabled() const {
+        return local_settings_.no_rfc7540_priorities && remote_settings_.no_rfc7540_priorities;
+    }
+
     // --- State Information ---
     bool is_server() const { return is_server_; }
     bool is_going_away() const { return going_away_; }
     stream_id_t get_next_available_stream_id(); // For client to create new streams
+    // How many more ids get_next_available_stream_id() can hand out (0 on a server).
+    uint32_t get_remaining_stream_id_count() const;
     uint32_t get_max_frame_size_remote() const { return remote_settings_.max_frame_size; }
     uint32_t get_max_frame_size_local() const { return local_settings_.max_frame_size; }
 
+    // --- DATA Framing ---
+    void set_data_frame_sizing(const DataFrameSizing& sizing) { data_frame_sizing_ = sizing; }
+    const DataFrameSizing& get_data_frame_sizing() const { return data_frame_sizing_; }
+    // Largest DATA payload the next frame may carry under the sizing policy (windows aside).
+    uint32_t get_data_frame_payload_limit() const;
+    // DATA frames and payload bytes sent so far; frames * FRAME_HEADER_SIZE is the framing overhead.
+    uint64_t get_data_frames_sent() const { return data_frames_sent_; }
+    uint64_t get_data_bytes_sent() const { return data_bytes_sent_; }
+
 
 private:
     friend class Http2Parser; // Allow parser to call private methods like handle_parsed_frame
 
     void handle_parsed_frame(AnyHttp2Frame frame);
-    void handle_data_frame(const DataFrame& frame);
-    void handle_headers_frame(const HeadersFrame& frame);
+    void handle_data_frame(DataFrame& frame);
+    void handle_headers_frame(HeadersFrame& frame);
     void handle_priority_frame(const PriorityFrame& frame);
     void handle_rst_stream_frame(const RstStreamFrame& frame);
     void handle_settings_frame(const SettingsFrame& frame);
-    void handle_push_promise_frame(const PushPromiseFrame& frame);
+    void handle_push_promise_frame(PushPromiseFrame& frame);
     void handle_ping_frame(const PingFrame& frame);
     void handle_goaway_frame(const GoAwayFrame& frame);
     void handle_window_update_frame(const WindowUpdateFrame& frame);
     void handle_continuation_frame(const ContinuationFrame& frame);
+    // Reports a complete header block to the stream events (on_headers / on_trailers).
+    void report_header_block(Http2Stream& stream, HeadersFrame& frame, bool is_trailers);
+    // Hands a deferred header block of a rejected frame to the header block callback (decode_only).
+    void discard_header_block(stream_id_t stream_id, std::vector<std::byte>& block);
+    void handle_altsvc_frame(const AltSvcFrame& frame);
+    void handle_origin_frame(const OriginFrame& frame);
+    void handle_priority_update_frame(const PriorityUpdateFrame& frame);
 
     // Helper to get or create a stream
     Http2Stream& get_or_create_stream(stream_id_t stream_id);
 
+    // Writes one DATA frame for `stream` and charges the flow-control windows.
+    bool emit_data_frame(Http2Stream& stream, std::span<const std::byte> chunk, bool end_stream);
+    // How many DATA bytes the stream and connection windows currently allow.
+    size_t get_sendable_data_size(const Http2Stream& stream) const;
+    // Drains the queue_data() queues of all streams in priority order, e.g. after a
+    // connection-level WINDOW_UPDATE.
+    void flush_all_queued_data();
+    // flush_queued_data() that stops after about `byte_limit` bytes (whole frames).
+    size_t flush_stream_queue(stream_id_t stream_id, size_t byte_limit);
+    // Files a stream with queued DATA under its urgency, or removes it.
+    void track_queued_stream(const Http2Stream& stream);
+    void untrack_queued_stream(stream_id_t stream_id);
+    // Remembers a stream that may have reached CLOSED, for removal after the current frame.
+    void note_stream_closing(stream_id_t stream_id);
+
 
     bool is_server_;
     std::map<stream_id_t, Http2Stream> streams_;
+    // Streams with queue_data() bytes waiting for window, by urgency (see set_stream_priority()).
+    std::array<std::set<stream_id_t>, PRIORITY_URGENCY_LEVELS> queued_streams_by_urgency_;
+    // PRIORITY_UPDATEs received for streams the client has not opened yet (RFC 9218 Section 7.1).
+    std::map<stream_id_t, StreamPriority> pending_priority_updates_;
+    std::vector<stream_id_t> stream_cleanup_candidates_; // See note_stream_closing()
     stream_id_t next_client_stream_id_ = 1; // For client-initiated streams (odd numbers)
+    stream_id_t last_local_stream_id_ = 0;  // Highest stream id we have opened with HEADERS
     stream_id_t next_server_stream_id_ = 2; // For server-initiated streams (push promise, even numbers)
     stream_id_t last_processed_stream_id_ = 0; // For GOAWAY processing
     bool going_away_ = false; // Set to true when GOAWAY has been sent or received
@@ -152,11 +367,62 @@ private:
     SettingsAckCallback settings_ack_cb_;
     PingAckCallback ping_ack_cb_;
     GoAwayCallback goaway_cb_;
+    DataCallback data_cb_;
+    DataBatchCallback data_batch_cb_;
+    // DATA received for data_batch_cb_ and not delivered yet (see deliver_pending_data()).
+    stream_id_t pending_data_stream_ = 0;
+    std::vector<std::vector<std::byte>> pending_data_chunks_;
+    void deliver_pending_data(bool end_stream = false);
+    DataSentCallback data_sent_cb_;
+    AltSvcCallback altsvc_cb_;
+    StreamEvents stream_events_;
+    HeaderBlockCallback header_block_cb_;
+
+    OutputFlushPolicy flush_policy_;
+    int cork_depth_ = 0;
+    std::vector<std::byte> output_buffer_;
+    std::chrono::steady_clock::time_point output_buffered_since_;
+    uint64_t output_writes_ = 0;
+    // Hands serialized frames to on_send_bytes_, or buffers them per the flush policy.
+    void write_output(std::vector<std::byte> bytes);
+
+    WriteCoalescing default_write_coalescing_;
+    std::set<stream_id_t> coalescing_streams_; // Streams holding back send_data() bytes
+    void flush_stream_coalesced_data(Http2Stream& stream);
+    // send_data() after state checks and coalescing.
+    bool send_stream_data(Http2Stream& stream, std::span<const std::byte> data, bool end_stream);
+    // send_headers() after state checks: writes the header block and updates the stream state.
+    bool write_stream_headers(Http2Stream& stream,
+                              std::span<const std::byte> encoded_prefix,
+                              const std::vector<HttpHeader>& headers,
+                              std::span<const std::byte> encoded_suffix,
+                              bool end_stream,
+                              std::optional<PriorityData> priority,
+                              std::optional<uint8_t> padding);
+
+    DataFrameSizing data_frame_sizing_;
+    uint64_t data_frames_sent_ = 0;
+    uint64_t data_bytes_sent_ = 0;
+
+    std::vector<std::string> origin_set_; // Normalized, see make_origin()
+    bool origin_frame_received_ = false;
 
     // Connection-level flow control windows (RFC 7540 Section 6.9.1)
     // These are separate from stream-level windows.
     // They apply to data sent on stream 0 (which is implicitly all streams for DATA frames)
     int32_t local_connection_window_size_;
+
+    CreditReturnPolicy credit_policy_;
+    uint32_t pending_connection_credit_ = 0;
+    std::set<stream_id_t> streams_with_pending_credit_;
+    int input_depth_ = 0; // Nested process_incoming_data() calls in progress
+    // Credit consume_data() may return now: all of it, the part under the cap, or 0 if not yet due.
+    uint32_t get_returnable_credit(uint32_t credit, int32_t window_left, uint32_t min_increment, uint32_t cap, bool all) const;
+
+    std::optional<ReceiveWindowCaps> receive_caps_;
+    uint32_t uncapped_max_concurrent_streams_ = DEFAULT_MAX_CONCURRENT_STREAMS; // Restored when caps are lifted
+    uint64_t unconsumed_bytes_ = 0;
+    MemoryGovernor* governor_ = nullptr;
     int32_t remote_connection_window_size_;
 
 
@@ -173,6 +439,8 @@ private:
     // Store the original HeadersFrame/PushPromiseFrame (or its relevant parts)
     // This is a simplification. A more robust way might involve storing a variant or pointer.
     std::optional<AnyHttp2Frame> pending_header_initiator_frame_;
+    // The initiator once its last CONTINUATION has been decoded, until handle_continuation_frame().
+    std::optional<AnyHttp2Frame> completed_header_initiator_frame_;
 
 
     // Max dynamic table size signaled by peer, to configure HPACK decoder
@@ -200,17 +468,51 @@ public:
     void set_on_send_window_update(std::function<void(stream_id_t, uint32_t)> cb) { on_send_window_update_ = std::move(cb); }
     void set_on_send_bytes(std::function<void(std::vector<std::byte>)> cb) { on_send_bytes_ = std::move(cb); }
 
+    // --- Output Buffering ---
+    // cork() holds all output (apart from max_buffered_bytes overflow) until the matching
+    // uncork(), whatever the flush policy; corks nest. Bytes still buffered when the connection is
+    // destroyed are dropped, so flush_output() first if they matter.
+    void set_output_flush_policy(const OutputFlushPolicy& policy);
+    const OutputFlushPolicy& get_output_flush_policy() const { return flush_policy_; }
+    void cork() { ++cork_depth_; }
+    void uncork();
+    bool is_corked() const { return cork_depth_ > 0; }
+    void flush_output();
+    // Writes the buffer if its latency budget has run out, and frames coalesced stream writes
+    // whose max_delay has.
+    void poll_output();
+    // When poll_output() must run next; nullopt while nothing is held back or there is no budget.
+    std::optional<std::chrono::steady_clock::time_point> get_output_deadline() const;
+    size_t get_buffered_output_size() const { return output_buffer_.size(); }
+    // Calls made to on_send_bytes so far.
+    uint64_t get_output_write_count() const { return output_writes_; }
+
     // --- Frame Sending API ---
     // Return bool indicating success/failure or specific error codes. For now, bool.
     // These methods will construct the frame, serialize it, and call on_send_bytes_.
 
     bool send_data(stream_id_t stream_id, std::span<const std::byte> data, bool end_stream);
 
+    // While the stream has DATA waiting for window (queue_data(), coalesced writes the windows
+    // refused), trailers are queued behind it and sent once it is out; the call still returns true.
+    // Fails if DATA with END_STREAM or other trailers are already queued.
     bool send_headers(stream_id_t stream_id,
                       const std::vector<HttpHeader>& headers,
                       bool end_stream,
                       std::optional<PriorityData> priority = std::nullopt,
                       std::optional<uint8_t> padding = std::nullopt);
+    // Same, with fields encoded ahead of time (typically by Hpack::static_encode) placed before and
+    // after `headers`. Pseudo-header fields must come first (RFC 9113 Section 8.3): when `headers`
+    // has any, the prefix may only hold pseudo-header fields, and regular fields go in the suffix.
+    // Both are sent as is and are not inspected, so keep :method CONNECT, :protocol and priority
+    // out of them.
+    bool send_headers(stream_id_t stream_id,
+                      std::span<const std::byte> encoded_prefix,
+                      const std::vector<HttpHeader>& headers,
+                      std::span<const std::byte> encoded_suffix,
+                      bool end_stream,
+                      std::optional<PriorityData> priority = std::nullopt,
+                      std::optional<uint8_t> padding = std::nullopt);
 
     bool send_priority(stream_id_t stream_id, const PriorityData& priority);
 
@@ -226,6 +528,46 @@ public:
 
     bool send_window_update_action(stream_id_t stream_id, uint32_t increment); // Renamed
 
+    // Server: advertise additional origins for this connection (RFC 8336).
+    bool send_origin(const std::vector<std::string>& origins);
+    // Server: advertise an alternative service. On stream 0 `origin` names the origin; on a
+    // request stream it must be empty and the stream's origin is implied (RFC 7838 Section 4).
+    bool send_altsvc(stream_id_t stream_id, std::string_view origin, std::string_view field_value);
+    // Sends an extension frame of a type the library does not implement. The payload must fit the
+    // peer's SETTINGS_MAX_FRAME_SIZE; the peer ignores the frame unless it understands the type.
+    bool send_extension_frame(uint8_t type, uint8_t flags, stream_id_t stream_id, std::span<const std::byte> payload);
+    // Client: reprioritize a request (RFC 9218). Also applied to our own view of the stream.
+    bool send_priority_update(stream_id_t stream_id, const StreamPriority& priority);
+
+    // Queues DATA, taking ownership of the buffer. Whatever the flow-control windows allow is sent
+    // right away; the rest stays on the stream and goes out as WINDOW_UPDATEs arrive. Progress is
+    // reported through the data-sent callback.
+    bool queue_data(stream_id_t stream_id, std::vector<std::byte> data, bool end_stream);
+    // Sends as much queued DATA for the stream as the windows allow. Returns the bytes sent.
+    size_t flush_queued_data(stream_id_t stream_id);
+
+    // Returns receive-window credit for `size` bytes of DATA the application has consumed:
+    // WINDOW_UPDATE for the connection and, while the peer may still send on it, for the stream.
+    // Subject to the credit return policy.
+    bool consume_data(stream_id_t stream_id, uint32_t size);
+    void set_credit_return_policy(const CreditReturnPolicy& policy);
+    const CreditReturnPolicy& get_credit_return_policy() const { return credit_policy_; }
+    // Sends the batched credit that has reached its threshold, or all of it with `all`.
+    void flush_window_updates(bool all = false);
+    uint32_t get_pending_connection_credit() const { return pending_connection_credit_; }
+
+    // --- Memory Pressure ---
+    // Caps the receive windows and advertised stream limit; nullopt lifts the caps again.
+    void set_receive_window_caps(std::optional<ReceiveWindowCaps> caps);
+    const std::optional<ReceiveWindowCaps>& get_receive_window_caps() const { return receive_caps_; }
+    // DATA received and not yet released with consume_data().
+    uint64_t get_unconsumed_data_size() const { return unconsumed_bytes_; }
+    // Set by MemoryGovernor::attach()/detach().
+    void set_memory_governor(MemoryGovernor* governor) { governor_ = governor; }
+    // Shares the strings of the HPACK decoder's dynamic table with other connections (see
+    // HeaderInternPool). The pool must outlive the connection.
+    void set_header_intern_pool(HeaderInternPool* pool) { hpack_decoder_.set_intern_pool(pool); }
+
     bool send_push_promise(stream_id_t associated_stream_id,
                            stream_id_t promised_stream_id,
                            const std::vector<HttpHeader>& headers,
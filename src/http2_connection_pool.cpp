@@ -0,0 +1,230 @@
+#include "http2_connection_pool.h"
+
+#include <algorithm>
+#include <iostream>
+
+namespace http2 {
+
+Http2ConnectionPool::Http2ConnectionPool(ConnectionFactory factory, ConnectionPoolOptions options)
+    : factory_(std::move(factory)), options_(options) {}
+
+Http2ConnectionPool::~Http2ConnectionPool() = default;
+
+Http2ConnectionPool::RequestId Http2ConnectionPool::submit(std::vector<HttpHeader> headers, std::vector<std::byte> body) {
+    Request request;
+    request.id = next_request_id_++;
+    std::string_view scheme = "https", authority;
+    for (const auto& h : headers) {
+        if (h.name == ":scheme") scheme = h.value;
+        else if (h.name == ":authority") authority = h.value;
+    }
+    if (!authority.empty()) request.origin = make_origin(scheme, authority);
+    request.headers = std::move(headers);
+    request.body = std::move(body);
+    RequestId id = request.id;
+
+    if (!pending_.empty()) { // Keep FIFO order behind requests already waiting
+        pending_.push_back(std::move(request));
+        dispatch_pending();
+        return id;
+    }
+    if (dispatch(request) == DispatchResult::NO_CAPACITY) {
+        pending_.push_back(std::move(request));
+    }
+    return id;
+}
+
+void Http2ConnectionPool::maintain() {
+    for (auto it = connections_.begin(); it != connections_.end();) {
+        PooledConnection& pooled = it->second;
+        reap_finished_streams(pooled);
+        if ((pooled.draining || pooled.retiring) && pooled.in_flight.empty()) {
+            if (!pooled.connection->is_going_away()) {
+                // Our own graceful shutdown; a client has no peer-initiated streams to report.
+                pooled.connection->send_goaway_action(0, ErrorCode::NO_ERROR, "");
+            }
+            if (closed_cb_) closed_cb_(it->first, *pooled.connection);
+            it = connections_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    dispatch_pending();
+}
+
+Http2Connection* Http2ConnectionPool::get_connection(ConnectionId id) {
+    auto it = connections_.find(id);
+    return it == connections_.end() ? nullptr : it->second.connection.get();
+}
+
+size_t Http2ConnectionPool::get_draining_connection_count() const {
+    return static_cast<size_t>(std::count_if(connections_.begin(), connections_.end(),
+                                             [](const auto& entry) { return entry.second.draining; }));
+}
+
+size_t Http2ConnectionPool::get_retiring_connection_count() const {
+    return static_cast<size_t>(std::count_if(connections_.begin(), connections_.end(),
+                                             [](const auto& entry) { return entry.second.retiring && !entry.second.draining; }));
+}
+
+size_t Http2ConnectionPool::get_in_flight_request_count() const {
+    size_t count = 0;
+    for (const auto& [id, pooled] : connections_) count += pooled.in_flight.size();
+    return count;
+}
+
+size_t Http2ConnectionPool::get_open_connection_count(const std::string& origin) const {
+    return static_cast<size_t>(std::count_if(connections_.begin(), connections_.end(), [&](const auto& entry) {
+        return !entry.second.draining && !entry.second.retiring && entry.second.origin == origin;
+    }));
+}
+
+bool Http2ConnectionPool::can_serve(const PooledConnection& pooled, const std::string& origin) {
+    const auto& origin_set = pooled.connection->get_origin_set();
+    return origin.empty() || origin_set.empty() || pooled.connection->is_authoritative_for(origin);
+}
+
+size_t Http2ConnectionPool::get_spare_streams(const PooledConnection& pooled) const {
+    if (pooled.draining) return 0;
+    size_t limit = std::min(pooled.connection->get_remote_settings().max_concurrent_streams,
+                            options_.max_streams_per_connection);
+    return pooled.in_flight.size() >= limit ? 0 : limit - pooled.in_flight.size();
+}
+
+void Http2ConnectionPool::reap_finished_streams(PooledConnection& pooled) {
+    for (auto it = pooled.in_flight.begin(); it != pooled.in_flight.end();) {
+        const Http2Stream* stream = pooled.connection->get_stream(it->first);
+        if (!stream || stream->get_state() == StreamState::CLOSED) {
+            it = pooled.in_flight.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+Http2ConnectionPool::PooledConnection* Http2ConnectionPool::select_connection(const std::string& origin, bool include_retiring) {
+    // Stream states are only re-checked when every connection looks full, so the common case
+    // costs one pass over the connections and no per-stream lookups.
+    for (int pass = 0; pass < 2; ++pass) {
+        PooledConnection* best = nullptr;
+        size_t best_spare = 0;
+        for (auto& [id, pooled] : connections_) {
+            if (pooled.retiring && !include_retiring) continue;
+            size_t spare = get_spare_streams(pooled);
+            if (spare == 0 || !can_serve(pooled, origin)) continue;
+            if (!best || spare > best_spare ||
+                (spare == best_spare && pooled.connection->get_remote_connection_window() >
+                                            best->connection->get_remote_connection_window())) {
+                best = &pooled;
+                best_spare = spare;
+            }
+        }
+        if (best) return best;
+        if (pass == 0) {
+            for (auto& [id, pooled] : connections_) reap_finished_streams(pooled);
+        }
+    }
+    return nullptr;
+}
+
+Http2ConnectionPool::PooledConnection* Http2ConnectionPool::open_connection(const std::string& origin) {
+    if (!factory_ || get_open_connection_count(origin) >= options_.max_connections) return nullptr;
+
+    ConnectionId id = next_connection_id_;
+    std::unique_ptr<Http2Connection> connection = factory_(id, origin);
+    if (!connection || connection->is_server()) return nullptr;
+    ++next_connection_id_;
+    if (!origin.empty()) connection->set_origin(origin);
+
+    connection->set_goaway_callback([this, id](const GoAwayFrame& frame) { on_goaway(id, frame); });
+    auto [it, inserted] = connections_.try_emplace(id);
+    it->second.connection = std::move(connection);
+    it->second.origin = origin;
+    return &it->second;
+}
+
+Http2ConnectionPool::DispatchResult Http2ConnectionPool::dispatch(Request& request) {
+    while (true) {
+        PooledConnection* target = select_connection(request.origin, false);
+        if (!target) target = open_connection(request.origin);
+        if (!target) target = select_connection(request.origin, true);
+        if (!target) return DispatchResult::NO_CAPACITY;
+
+        Http2Connection& connection = *target->connection;
+        stream_id_t stream_id = connection.get_next_available_stream_id();
+        if (stream_id == 0) { // Client stream ids exhausted: let it drain, try elsewhere
+            target->draining = true;
+            continue;
+        }
+
+        ++request.attempts;
+        bool has_body = !request.body.empty();
+        bool sent = connection.send_headers(stream_id, request.headers, !has_body);
+        if (sent && has_body) {
+            sent = connection.queue_data(stream_id, request.body, true);
+        }
+        if (!sent) {
+            std::cerr << "POOL: failed to send request " << request.id << " on stream " << stream_id << std::endl;
+            if (failed_cb_) failed_cb_(request.id);
+            return DispatchResult::FAILED;
+        }
+
+        if (!request.origin.empty() && request.origin != target->origin) ++coalesced_requests_;
+        RequestId request_id = request.id;
+        target->in_flight.emplace(stream_id, std::move(request));
+        if (assigned_cb_) assigned_cb_(request_id, connection, stream_id);
+
+        if (!target->retiring && connection.get_remaining_stream_id_count() <= options_.stream_id_reserve) {
+            // Warm up the replacement now, while this connection can still take streams.
+            target->retiring = true;
+            open_connection(target->origin);
+        }
+        return DispatchResult::SENT;
+    }
+}
+
+void Http2ConnectionPool::dispatch_pending() {
+    // FIFO per origin: once a request for an origin finds no room, later requests for the same
+    // origin wait behind it, while requests for other origins may still go out.
+    std::vector<std::string> blocked_origins;
+    for (auto it = pending_.begin(); it != pending_.end();) {
+        if (std::find(blocked_origins.begin(), blocked_origins.end(), it->origin) != blocked_origins.end()) {
+            ++it;
+            continue;
+        }
+        if (dispatch(*it) == DispatchResult::NO_CAPACITY) {
+            blocked_origins.push_back(it->origin);
+            ++it;
+        } else {
+            it = pending_.erase(it);
+        }
+    }
+}
+
+void Http2ConnectionPool::on_goaway(ConnectionId id, const GoAwayFrame& frame) {
+    auto it = connections_.find(id);
+    if (it == connections_.end()) return;
+    PooledConnection& pooled = it->second;
+    pooled.draining = true;
+
+    // Streams above last_stream_id were never processed by the peer and are safe to replay.
+    // The connection itself is kept until maintain(): we are inside its process_incoming_data().
+    std::vector<Request> replay;
+    for (auto stream_it = pooled.in_flight.upper_bound(frame.last_stream_id); stream_it != pooled.in_flight.end();) {
+        replay.push_back(std::move(stream_it->second));
+        stream_it = pooled.in_flight.erase(stream_it);
+    }
+
+    // Replays go ahead of newer pending requests, in their original order.
+    for (auto request_it = replay.rbegin(); request_it != replay.rend(); ++request_it) {
+        if (request_it->attempts >= options_.max_attempts) {
+            if (failed_cb_) failed_cb_(request_it->id);
+            continue;
+        }
+        ++retried_requests_;
+        pending_.push_front(std::move(*request_it));
+    }
+    dispatch_pending();
+}
+
+} // namespace http2
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "http2_types.h"
+#include "http2_connection.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace http2 {
+
+// Client-side pool of Http2Connections.
+//
+// Each request belongs to the origin named by its :scheme and :authority. It may be placed on any
+// connection whose origin set (Http2Connection::get_origin_set) contains that origin: the one it
+// was opened for, plus whatever the server added with ORIGIN frames (RFC 8336). Requests for
+// several hostnames served by one server are therefore coalesced onto its existing connections
+// instead of each paying for a new connection. Connections whose origin set is empty (not set by
+// the factory or the pool) accept requests for any origin.
+//
+// Requests are placed on the connection with the most spare stream capacity (the peer's
+// SETTINGS_MAX_CONCURRENT_STREAMS, capped by ConnectionPoolOptions::max_streams_per_connection,
+// minus the streams the pool has in flight there), ties going to the larger connection send
+// window. A new connection is opened through the factory only when no open connection for the
+// origin has spare capacity; requests that fit nowhere wait in a pending queue.
+//
+// On GOAWAY the connection is drained: it takes no new streams, and the requests whose stream id
+// is above the GOAWAY last_stream_id (which the peer guarantees it did not process, RFC 9113
+// Section 6.8) are replayed on another connection. The pool keeps a copy of every request until
+// its stream closes for that purpose. Drained connections are destroyed by maintain() once their
+// remaining streams have finished.
+//
+// Client stream ids are finite (2^30 per connection). When a connection gets within
+// stream_id_reserve ids of the end it is retired: a replacement is opened right away, while the
+// old connection still has ids left, and new requests go to the replacement. The retiring
+// connection keeps serving its in-flight streams (and takes overflow if nothing else has room),
+// then maintain() sends it a GOAWAY and releases it. Callers never see the
+// get_next_available_stream_id() == 0 cliff and the reconnect that used to follow it.
+//
+// The pool owns each connection's GOAWAY callback. Everything else (transport, connection
+// preface and initial SETTINGS, frame and data callbacks for the responses) is wired by the
+// factory, so a replacement has finished that setup before the first request is placed on it.
+struct ConnectionPoolOptions {
+    size_t max_connections = 4;              // Open (non-draining, non-retiring) connections per origin
+    uint32_t max_streams_per_connection = 100; // Upper bound on top of the peer's limit
+    int max_attempts = 3;                    // Sends per request, including GOAWAY replays
+    uint32_t stream_id_reserve = 1u << 20;   // Retire a connection with this few ids left
+};
+
+class Http2ConnectionPool {
+public:
+    using ConnectionId = uint64_t;
+    using RequestId = uint64_t;
+    // Creates and wires a client connection to `origin` (empty for requests without :authority).
+    // Returning nullptr leaves requests pending.
+    using ConnectionFactory = std::function<std::unique_ptr<Http2Connection>(ConnectionId id, const std::string& origin)>;
+    // A request was sent as `stream_id` on `connection`. Called again if the request is replayed
+    // after a GOAWAY; responses for the earlier stream will not arrive.
+    using StreamAssignedCallback = std::function<void(RequestId request, Http2Connection& connection, stream_id_t stream_id)>;
+    // A request could not be sent, or ran out of attempts.
+    using RequestFailedCallback = std::function<void(RequestId request)>;
+    // The pool is about to destroy a drained or retired connection; close its transport here.
+    using ConnectionClosedCallback = std::function<void(ConnectionId id, Http2Connection& connection)>;
+
+    explicit Http2ConnectionPool(ConnectionFactory factory, ConnectionPoolOptions options = {});
+    ~Http2ConnectionPool();
+
+    Http2ConnectionPool(const Http2ConnectionPool&) = delete;
+    Http2ConnectionPool& operator=(const Http2ConnectionPool&) = delete;
+
+    void set_stream_assigned_callback(StreamAssignedCallback cb) { assigned_cb_ = std::move(cb); }
+    void set_request_failed_callback(RequestFailedCallback cb) { failed_cb_ = std::move(cb); }
+    void set_connection_closed_callback(ConnectionClosedCallback cb) { closed_cb_ = std::move(cb); }
+
+    // Sends the request now if a connection has room, otherwise queues it. An empty body sends
+    // HEADERS with END_STREAM.
+    RequestId submit(std::vector<HttpHeader> headers, std::vector<std::byte> body = {});
+
+    // Call after feeding incoming bytes to the pool's connections: forgets finished streams,
+    // destroys drained connections and dispatches pending requests into freed capacity.
+    void maintain();
+
+    Http2Connection* get_connection(ConnectionId id);
+    size_t get_connection_count() const { return connections_.size(); }
+    size_t get_draining_connection_count() const;
+    size_t get_retiring_connection_count() const;
+    size_t get_pending_request_count() const { return pending_.size(); }
+    size_t get_in_flight_request_count() const;
+    uint64_t get_retried_request_count() const { return retried_requests_; }
+    // Requests placed on a connection opened for a different origin.
+    uint64_t get_coalesced_request_count() const { return coalesced_requests_; }
+
+private:
+    struct Request {
+        RequestId id = 0;
+        std::string origin; // From :scheme and :authority
+        std::vector<HttpHeader> headers;
+        std::vector<std::byte> body;
+        int attempts = 0;
+    };
+
+    struct PooledConnection {
+        std::unique_ptr<Http2Connection> connection;
+        std::string origin; // The origin it was opened for
+        std::map<stream_id_t, Request> in_flight;
+        bool draining = false; // GOAWAY received or ids exhausted: no new streams
+        bool retiring = false; // Ids running low: new streams only if nothing else has room
+    };
+
+    enum class DispatchResult {
+        SENT,
+        NO_CAPACITY, // Request left untouched for the caller to queue
+        FAILED,      // Request dropped and reported through the failed callback
+    };
+
+    // Sends `request` on the best connection, opening one if allowed.
+    DispatchResult dispatch(Request& request);
+    PooledConnection* select_connection(const std::string& origin, bool include_retiring);
+    PooledConnection* open_connection(const std::string& origin);
+    size_t get_spare_streams(const PooledConnection& pooled) const;
+    static bool can_serve(const PooledConnection& pooled, const std::string& origin);
+    // Connections to `origin` counted against max_connections: neither draining nor retiring.
+    size_t get_open_connection_count(const std::string& origin) const;
+    // Drops in-flight entries whose stream has closed.
+    void reap_finished_streams(PooledConnection& pooled);
+    void dispatch_pending();
+    void on_goaway(ConnectionId id, const GoAwayFrame& frame);
+
+    ConnectionFactory factory_;
+    ConnectionPoolOptions options_;
+    StreamAssignedCallback assigned_cb_;
+    RequestFailedCallback failed_cb_;
+    ConnectionClosedCallback closed_cb_;
+
+    std::map<ConnectionId, PooledConnection> connections_;
+    std::deque<Request> pending_;
+    ConnectionId next_connection_id_ = 1;
+    RequestId next_request_id_ = 1;
+    uint64_t retried_requests_ = 0;
+    uint64_t coalesced_requests_ = 0;
+};
+
+} // namespace http2
@@ -0,0 +1,205 @@
+#include "http2_executor.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace http2 {
+
+namespace {
+
+thread_local size_t current_worker_index = StreamExecutor::npos;
+
+} // namespace
+
+// --- SubmissionQueue ---
+
+void SubmissionQueue::post(Command command) {
+    bool was_empty;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        was_empty = commands_.empty();
+        commands_.push_back(std::move(command));
+    }
+    if (was_empty && wakeup_) wakeup_();
+}
+
+size_t SubmissionQueue::run(Http2Connection& connection) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        running_.swap(commands_);
+    }
+    for (auto& command : running_) command(connection);
+    size_t count = running_.size();
+    running_.clear();
+    return count;
+}
+
+size_t SubmissionQueue::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return commands_.size();
+}
+
+// --- StreamExecutor ---
+
+StreamExecutor::StreamExecutor(ExecutorOptions options) : options_(options) {
+    size_t count = options_.worker_count;
+    if (count == 0) count = std::max(1u, std::thread::hardware_concurrency());
+    workers_.reserve(count);
+    for (size_t i = 0; i < count; ++i) workers_.push_back(std::make_unique<Worker>());
+    // Threads start once every Worker exists, as they look at each other's queues.
+    for (size_t i = 0; i < count; ++i) workers_[i]->thread = std::thread([this, i] { run(i); });
+}
+
+StreamExecutor::~StreamExecutor() {
+    wait_idle();
+    stopping_.store(true);
+    for (auto& worker : workers_) {
+        { std::lock_guard<std::mutex> lock(worker->mutex); }
+        worker->wakeup.notify_one();
+    }
+    for (auto& worker : workers_) worker->thread.join();
+}
+
+size_t StreamExecutor::assign_home() {
+    return next_home_.fetch_add(1, std::memory_order_relaxed) % workers_.size();
+}
+
+size_t StreamExecutor::current_worker() {
+    return current_worker_index;
+}
+
+void StreamExecutor::submit(size_t home, Task task) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    Worker& worker = *workers_[home];
+    size_t queued;
+    bool sleeping;
+    {
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.tasks.push_back(std::move(task));
+        queued = worker.tasks.size();
+        worker.queued.store(queued);
+        sleeping = worker.sleeping;
+    }
+    if (sleeping) worker.wakeup.notify_one();
+    if (queued > options_.steal_threshold) hint_thief(home);
+}
+
+void StreamExecutor::wait_idle() {
+    uint64_t pending;
+    while ((pending = pending_.load(std::memory_order_acquire)) != 0) pending_.wait(pending, std::memory_order_acquire);
+}
+
+void StreamExecutor::run(size_t index) {
+    current_worker_index = index;
+    Worker& self = *workers_[index];
+    Task task;
+    while (true) {
+        if (pop_local(self, task) || steal(index, task)) {
+            task();
+            task = nullptr;
+            self.executed.fetch_add(1, std::memory_order_relaxed);
+            if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1) pending_.notify_all();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(self.mutex);
+        if (stopping_.load()) return;
+        // Marked asleep before the last look at the other backlogs: a submit that pushes one past
+        // the threshold after this either is seen here or finds this worker asleep and hints it.
+        self.sleeping = true;
+        sleeping_count_.fetch_add(1);
+        bool backlog = false;
+        for (size_t i = 0; i < workers_.size() && !backlog; ++i) {
+            backlog = i != index && workers_[i]->queued.load() > options_.steal_threshold;
+        }
+        if (!backlog) {
+            self.wakeup.wait(lock, [&] { return !self.tasks.empty() || self.steal_hint || stopping_.load(); });
+        }
+        self.sleeping = false;
+        sleeping_count_.fetch_sub(1);
+        self.steal_hint = false;
+    }
+}
+
+bool StreamExecutor::pop_local(Worker& worker, Task& task) {
+    if (worker.queued.load(std::memory_order_relaxed) == 0) return false;
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.front());
+    worker.tasks.pop_front();
+    worker.queued.store(worker.tasks.size());
+    return true;
+}
+
+bool StreamExecutor::steal(size_t thief, Task& task) {
+    // The longest backlog over the threshold, judged without locking.
+    size_t victim = npos;
+    size_t longest = options_.steal_threshold;
+    for (size_t i = 0; i < workers_.size(); ++i) {
+        size_t queued = workers_[i]->queued.load(std::memory_order_relaxed);
+        if (i != thief && queued > longest) {
+            victim = i;
+            longest = queued;
+        }
+    }
+    if (victim == npos) return false;
+
+    Worker& worker = *workers_[victim];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.size() <= options_.steal_threshold) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    worker.queued.store(worker.tasks.size());
+    steals_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void StreamExecutor::hint_thief(size_t busy) {
+    if (sleeping_count_.load() == 0) return; // Everyone is busy; nobody to hand work to
+    for (size_t n = 1; n < workers_.size(); ++n) {
+        Worker& worker = *workers_[(busy + n) % workers_.size()];
+        bool hinted = false;
+        {
+            std::lock_guard<std::mutex> lock(worker.mutex);
+            if (worker.sleeping && !worker.steal_hint) {
+                worker.steal_hint = true;
+                hinted = true;
+            }
+        }
+        if (hinted) {
+            worker.wakeup.notify_one();
+            return;
+        }
+    }
+}
+
+// --- Strand ---
+
+void Strand::submit(StreamExecutor::Task task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        if (scheduled_) return; // The running run() picks it up
+        scheduled_ = true;
+    }
+    executor_.submit(home_, [this] { run(); });
+}
+
+void Strand::run() {
+    StreamExecutor::Task task;
+    while (true) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (tasks_.empty()) {
+                scheduled_ = false;
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+        task = nullptr;
+    }
+}
+
+} // namespace http2
@@ -0,0 +1,143 @@
+#pragma once
+
+#include "http2_connection.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace http2 {
+
+// Commands for one connection, posted from any thread and run on the thread that owns the
+// connection, e.g. responses produced by handlers on a StreamExecutor. The owner calls run() from
+// its event loop; the wakeup callback (an eventfd write, say) tells it there is something to run.
+class SubmissionQueue {
+public:
+    using Command = std::function<void(Http2Connection& connection)>;
+
+    // Any thread.
+    void post(Command command);
+    // Owning thread. Runs the commands posted so far, in order. Returns how many ran.
+    size_t run(Http2Connection& connection);
+    size_t size() const;
+
+    // Called after each post() that finds the queue empty, i.e. once per batch.
+    void set_wakeup(std::function<void()> wakeup) { wakeup_ = std::move(wakeup); }
+
+private:
+    mutable std::mutex mutex_;
+    std::vector<Command> commands_;
+    std::vector<Command> running_; // Swapped with commands_ by run(); keeps its capacity
+    std::function<void()> wakeup_;
+};
+
+struct ExecutorOptions {
+    size_t worker_count = 0;     // 0 = std::thread::hardware_concurrency()
+    // An idle worker steals only from a worker with more than this many queued tasks. Small
+    // backlogs stay on their own worker, whose caches hold the connection's state; 0 steals
+    // whenever another worker has anything queued.
+    size_t steal_threshold = 4;
+};
+
+// Thread pool for stream handlers that keeps each connection's work on one worker.
+//
+// Every connection is given a home worker (assign_home()) and its handler tasks go to that
+// worker's own deque, so a connection's streams, buffers and allocator caches stay on one core
+// instead of bouncing between the cores of a shared-queue pool. The owner runs its tasks in
+// submission order. A worker that runs dry steals from the worker with the longest backlog, but
+// only once that backlog exceeds steal_threshold, and from the back (the tasks that would wait
+// longest), so balance is restored under skewed load without giving up affinity in the common
+// case. Handlers send results back with the connection's SubmissionQueue.
+//
+// Stealing gives up ordering: a stolen task runs on the thief while the home worker carries on
+// with the front of the deque, so once stealing kicks in one connection's tasks, even one
+// stream's, may run in parallel and out of submission order. Tasks that must not overlap go
+// through a Strand.
+class StreamExecutor {
+public:
+    using Task = std::function<void()>;
+
+    explicit StreamExecutor(ExecutorOptions options = {});
+    // Runs every task already submitted, then joins the workers.
+    ~StreamExecutor();
+
+    StreamExecutor(const StreamExecutor&) = delete;
+    StreamExecutor& operator=(const StreamExecutor&) = delete;
+
+    size_t get_worker_count() const { return workers_.size(); }
+    // Home worker for a new connection, round robin.
+    size_t assign_home();
+    // Queues `task` on worker `home`. Any thread.
+    void submit(size_t home, Task task);
+    // Blocks until every task submitted so far has run.
+    void wait_idle();
+
+    // Worker running the calling thread, or npos outside the executor.
+    static size_t current_worker();
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    uint64_t get_executed_count(size_t worker) const { return workers_[worker]->executed.load(std::memory_order_relaxed); }
+    uint64_t get_steal_count() const { return steals_.load(std::memory_order_relaxed); }
+    size_t get_queued_count(size_t worker) const { return workers_[worker]->queued.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::condition_variable wakeup;
+        std::deque<Task> tasks;
+        std::atomic<size_t> queued{0}; // tasks.size(), readable without the lock
+        std::atomic<uint64_t> executed{0};
+        bool sleeping = false;
+        bool steal_hint = false; // Another worker's backlog passed the threshold
+        std::thread thread;
+    };
+
+    void run(size_t index);
+    bool pop_local(Worker& worker, Task& task);
+    bool steal(size_t thief, Task& task);
+    // Wakes one sleeping worker other than `busy` to steal from it.
+    void hint_thief(size_t busy);
+
+    ExecutorOptions options_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::atomic<size_t> next_home_{0};
+    std::atomic<uint64_t> pending_{0}; // Submitted and not finished
+    std::atomic<uint64_t> steals_{0};
+    std::atomic<size_t> sleeping_count_{0};
+    std::atomic<bool> stopping_{false};
+};
+
+// Runs the tasks submitted to it one at a time and in submission order, on a StreamExecutor,
+// e.g. one strand per stream whose handler tasks must see each other's effects. The strand has
+// at most one task of its own on the executor, which runs whatever has been queued; stealing can
+// move that task to another worker but never splits the queue.
+//
+// A strand must outlive the tasks submitted to it (StreamExecutor::wait_idle()).
+class Strand {
+public:
+    Strand(StreamExecutor& executor, size_t home) : executor_(executor), home_(home) {}
+
+    Strand(const Strand&) = delete;
+    Strand& operator=(const Strand&) = delete;
+
+    // Any thread.
+    void submit(StreamExecutor::Task task);
+
+private:
+    void run();
+
+    StreamExecutor& executor_;
+    size_t home_;
+    std::mutex mutex_;
+    std::deque<StreamExecutor::Task> tasks_;
+    bool scheduled_ = false; // A run() is on the executor
+};
+
+} // namespace http2
@@ -99,6 +99,8 @@ struct SettingsFrame {
     static constexpr uint16_t SETTINGS_INITIAL_WINDOW_SIZE = 0x4;
     static constexpr uint16_t SETTINGS_MAX_FRAME_SIZE = 0x5;
     static constexpr uint16_t SETTINGS_MAX_HEADER_LIST_SIZE = 0x6;
+    static constexpr uint16_t SETTINGS_ENABLE_CONNECT_PROTOCOL = 0x8; // RFC 8441
+    static constexpr uint16_t SETTINGS_NO_RFC7540_PRIORITIES = 0x9;   // RFC 9218
 
 
     FrameHeader header;
@@ -117,6 +119,7 @@ struct PushPromiseFrame {
     std::optional<uint8_t> pad_length; // Present if PADDED_FLAG is set
     stream_id_t promised_stream_id; // R bit must be 0
     std::vector<HttpHeader> headers; // Decoded headers (header block fragment)
+    std::vector<std::byte> header_block_fragment; // Raw HPACK data, kept only while decoding is deferred
 
     bool has_end_headers_flag() const { return header.flags & END_HEADERS_FLAG; }
     bool has_padded_flag() const { return header.flags & PADDED_FLAG; }
@@ -163,6 +166,37 @@ struct ContinuationFrame {
     bool has_end_headers_flag() const { return header.flags & END_HEADERS_FLAG; }
 };
 
+// ALTSVC (RFC 7838 Section 4): an alternative service for the origin. On stream 0 the origin is
+// named in the frame; on a request stream it is the origin of that stream and `origin` is empty.
+struct AltSvcFrame {
+    static constexpr FrameType TYPE = FrameType::ALTSVC;
+    // No flags defined for ALTSVC frame
+
+    FrameHeader header;
+    std::string origin;
+    std::string field_value; // Alt-Svc header field value, e.g. h3=":443"; ma=3600
+};
+
+// ORIGIN (RFC 8336): origins the server is authoritative for on this connection. Stream 0 only.
+struct OriginFrame {
+    static constexpr FrameType TYPE = FrameType::ORIGIN;
+    // No flags defined for ORIGIN frame
+
+    FrameHeader header;
+    std::vector<std::string> origins; // ASCII serialization, e.g. "https://cdn.example.com"
+};
+
+// PRIORITY_UPDATE (RFC 9218 Section 7.1): new priority for a request stream, sent by clients on
+// stream 0. The value is a Priority Field Value, see parse_priority_field().
+struct PriorityUpdateFrame {
+    static constexpr FrameType TYPE = FrameType::PRIORITY_UPDATE;
+    // No flags defined for PRIORITY_UPDATE frame
+
+    FrameHeader header;
+    stream_id_t prioritized_stream_id; // R bit must be 0
+    std::string priority_field_value;
+};
+
 struct UnknownFrame {
     FrameHeader header;
     std::vector<std::byte> payload;
@@ -180,6 +214,9 @@ using Http2FrameVariant = std::variant<
     GoAwayFrame,
     WindowUpdateFrame,
     ContinuationFrame,
+    AltSvcFrame,
+    OriginFrame,
+    PriorityUpdateFrame,
     UnknownFrame
     // Potentially std::monostate if a default "empty" state is needed
     // or a specific "UnknownFrame" type for extensibility.
@@ -1,5 +1,6 @@
 #include "http2_frame_serializer.h"
 #include <algorithm> // for std::copy, std::min
+#include <cstring> // for std::memmove
 #include <vector>
 
 namespace http2 {
@@ -34,6 +35,21 @@ void write_frame_header(std::vector<std::byte>& buffer, const FrameHeader& heade
     write_uint32_big_endian(buffer, header.stream_id & 0x7FFFFFFF); // Mask R bit (must be 0 when sending)
 }
 
+size_t write_frame_header(std::span<std::byte> out, const FrameHeader& header) {
+    if (out.size() < FRAME_HEADER_SIZE) return 0;
+    uint32_t stream_id = header.stream_id & 0x7FFFFFFF;
+    out[0] = static_cast<std::byte>((header.length >> 16) & 0xFF);
+    out[1] = static_cast<std::byte>((header.length >> 8) & 0xFF);
+    out[2] = static_cast<std::byte>(header.length & 0xFF);
+    out[3] = static_cast<std::byte>(header.type);
+    out[4] = static_cast<std::byte>(header.flags);
+    out[5] = static_cast<std::byte>((stream_id >> 24) & 0xFF);
+    out[6] = static_cast<std::byte>((stream_id >> 16) & 0xFF);
+    out[7] = static_cast<std::byte>((stream_id >> 8) & 0xFF);
+    out[8] = static_cast<std::byte>(stream_id & 0xFF);
+    return FRAME_HEADER_SIZE;
+}
+
 std::vector<std::byte> serialize_data_frame(const DataFrame& frame) {
     std::vector<std::byte> buffer;
     // FrameHeader needs its length field calculated based on payload.
@@ -62,6 +78,19 @@ std::vector<std::byte> serialize_data_frame(const DataFrame& frame) {
     return buffer;
 }
 
+std::vector<std::byte> serialize_data_frame(stream_id_t stream_id, std::span<const std::byte> data, uint8_t flags) {
+    std::vector<std::byte> buffer;
+    buffer.reserve(FRAME_HEADER_SIZE + data.size());
+    FrameHeader header;
+    header.length = static_cast<uint32_t>(data.size());
+    header.type = FrameType::DATA;
+    header.flags = flags & DataFrame::END_STREAM_FLAG; // PADDED is not supported here
+    header.stream_id = stream_id;
+    write_frame_header(buffer, header);
+    buffer.insert(buffer.end(), data.begin(), data.end());
+    return buffer;
+}
+
 std::vector<std::byte> serialize_headers_frame(const HeadersFrame& frame, HpackEncoder& hpack_encoder) {
     std::vector<std::byte> buffer;
     FrameHeader header_to_write = frame.header; // Copy to modify length
@@ -214,6 +243,71 @@ std::vector<std::byte> serialize_window_update_frame(const WindowUpdateFrame& fr
     return buffer;
 }
 
+std::vector<std::byte> serialize_altsvc_frame(const AltSvcFrame& frame) {
+    std::vector<std::byte> buffer;
+    if (frame.origin.size() > 0xFFFF) return buffer; // Origin-Len is 16 bits
+    FrameHeader header_to_write = frame.header;
+    header_to_write.type = FrameType::ALTSVC;
+    header_to_write.flags = 0;
+    header_to_write.length = static_cast<uint32_t>(2 + frame.origin.size() + frame.field_value.size());
+    buffer.reserve(FRAME_HEADER_SIZE + header_to_write.length);
+    write_frame_header(buffer, header_to_write);
+    write_uint16_big_endian(buffer, static_cast<uint16_t>(frame.origin.size()));
+    const auto* origin = reinterpret_cast<const std::byte*>(frame.origin.data());
+    buffer.insert(buffer.end(), origin, origin + frame.origin.size());
+    const auto* value = reinterpret_cast<const std::byte*>(frame.field_value.data());
+    buffer.insert(buffer.end(), value, value + frame.field_value.size());
+    return buffer;
+}
+
+std::vector<std::byte> serialize_origin_frame(const OriginFrame& frame) {
+    std::vector<std::byte> buffer;
+    size_t payload_size = 0;
+    for (const auto& origin : frame.origins) {
+        if (origin.size() > 0xFFFF) return {}; // Origin-Len is 16 bits
+        payload_size += 2 + origin.size();
+    }
+    FrameHeader header_to_write = frame.header;
+    header_to_write.type = FrameType::ORIGIN;
+    header_to_write.flags = 0;
+    header_to_write.stream_id = 0; // ORIGIN is only defined on stream 0
+    header_to_write.length = static_cast<uint32_t>(payload_size);
+    buffer.reserve(FRAME_HEADER_SIZE + payload_size);
+    write_frame_header(buffer, header_to_write);
+    for (const auto& origin : frame.origins) {
+        write_uint16_big_endian(buffer, static_cast<uint16_t>(origin.size()));
+        const auto* bytes = reinterpret_cast<const std::byte*>(origin.data());
+        buffer.insert(buffer.end(), bytes, bytes + origin.size());
+    }
+    return buffer;
+}
+
+std::vector<std::byte> serialize_priority_update_frame(const PriorityUpdateFrame& frame) {
+    std::vector<std::byte> buffer;
+    FrameHeader header_to_write = frame.header;
+    header_to_write.type = FrameType::PRIORITY_UPDATE;
+    header_to_write.flags = 0;
+    header_to_write.stream_id = 0; // PRIORITY_UPDATE is only defined on stream 0
+    header_to_write.length = static_cast<uint32_t>(4 + frame.priority_field_value.size());
+    buffer.reserve(FRAME_HEADER_SIZE + header_to_write.length);
+    write_frame_header(buffer, header_to_write);
+    write_uint32_big_endian(buffer, frame.prioritized_stream_id & 0x7FFFFFFF);
+    const auto* value = reinterpret_cast<const std::byte*>(frame.priority_field_value.data());
+    buffer.insert(buffer.end(), value, value + frame.priority_field_value.size());
+    return buffer;
+}
+
+std::vector<std::byte> serialize_extension_frame(const FrameHeader& header, std::span<const std::byte> payload) {
+    std::vector<std::byte> buffer;
+    if (payload.size() > MAX_ALLOWED_FRAME_SIZE) return buffer; // Length is 24 bits
+    FrameHeader header_to_write = header;
+    header_to_write.length = static_cast<uint32_t>(payload.size());
+    buffer.resize(FRAME_HEADER_SIZE + payload.size());
+    write_frame_header(std::span<std::byte>(buffer), header_to_write);
+    std::copy(payload.begin(), payload.end(), buffer.begin() + FRAME_HEADER_SIZE);
+    return buffer;
+}
+
 std::vector<std::byte> serialize_continuation_frame(const ContinuationFrame& frame) {
     std::vector<std::byte> buffer;
     FrameHeader header_to_write = frame.header;
@@ -225,86 +319,133 @@ std::vector<std::byte> serialize_continuation_frame(const ContinuationFrame& fra
 }
 
 
+// Shared by the HEADERS and PUSH_PROMISE writers. `fields` are the bytes that precede the header
+// block fragment in the first frame (Pad Length, priority or Promised Stream ID).
+static bool write_header_block_frames(std::vector<std::byte>& out, FrameHeader first_header, std::span<const std::byte> fields,
+                                      size_t pad_length, const std::vector<HttpHeader>& headers, HpackEncoder& hpack_encoder,
+                                      uint32_t max_frame_size, std::span<const std::byte> encoded_prefix,
+                                      std::span<const std::byte> encoded_suffix) {
+    if (max_frame_size == 0 || fields.size() + pad_length > max_frame_size) return false;
+    const size_t start = out.size();
+    out.resize(start + FRAME_HEADER_SIZE); // Back-patched below
+    out.insert(out.end(), fields.begin(), fields.end());
+    const size_t block_start = out.size();
+    out.insert(out.end(), encoded_prefix.begin(), encoded_prefix.end());
+    if (hpack_encoder.encode_into(out, headers) != HpackEncodingError::OK) {
+        out.resize(start);
+        return false;
+    }
+    out.insert(out.end(), encoded_suffix.begin(), encoded_suffix.end());
+    const size_t block_size = out.size() - block_start;
+
+    const size_t first_chunk = std::min(block_size, max_frame_size - fields.size() - pad_length);
+    const size_t rest = block_size - first_chunk;
+    const size_t continuations = (rest + max_frame_size - 1) / max_frame_size;
+    out.resize(out.size() + pad_length + continuations * FRAME_HEADER_SIZE);
+    std::byte* base = out.data();
+
+    // Move the CONTINUATION chunks to their final place, last one first, so nothing is overwritten
+    // before it has been moved.
+    size_t write_end = out.size();
+    for (size_t i = continuations; i-- > 0;) {
+        size_t chunk_offset = first_chunk + i * max_frame_size;
+        size_t chunk_size = std::min<size_t>(max_frame_size, block_size - chunk_offset);
+        size_t dest = write_end - chunk_size;
+        std::memmove(base + dest, base + block_start + chunk_offset, chunk_size);
+        FrameHeader continuation_header;
+        continuation_header.length = static_cast<uint32_t>(chunk_size);
+        continuation_header.type = FrameType::CONTINUATION;
+        continuation_header.flags = (i + 1 == continuations) ? ContinuationFrame::END_HEADERS_FLAG : 0;
+        continuation_header.stream_id = first_header.stream_id;
+        write_frame_header(std::span<std::byte>(base + dest - FRAME_HEADER_SIZE, FRAME_HEADER_SIZE), continuation_header);
+        write_end = dest - FRAME_HEADER_SIZE;
+    }
+    std::fill(base + block_start + first_chunk, base + block_start + first_chunk + pad_length, std::byte{0});
+
+    first_header.length = static_cast<uint32_t>(fields.size() + first_chunk + pad_length);
+    first_header.flags &= ~HeadersFrame::END_HEADERS_FLAG;
+    if (continuations == 0) first_header.flags |= HeadersFrame::END_HEADERS_FLAG;
+    write_frame_header(std::span<std::byte>(base + start, FRAME_HEADER_SIZE), first_header);
+    return true;
+}
+
+bool write_header_block(std::vector<std::byte>& out, const HeadersFrame& first_frame, const std::vector<HttpHeader>& headers,
+                        HpackEncoder& hpack_encoder, uint32_t max_frame_size, std::span<const std::byte> encoded_prefix,
+                        std::span<const std::byte> encoded_suffix) {
+    std::vector<std::byte> fields;
+    size_t pad_length = 0;
+    if (first_frame.has_padded_flag()) {
+        pad_length = first_frame.pad_length.value_or(0);
+        fields.push_back(static_cast<std::byte>(pad_length));
+    }
+    if (first_frame.has_priority_flag()) {
+        uint32_t stream_dep_val = first_frame.stream_dependency.value_or(0) & 0x7FFFFFFF;
+        if (first_frame.exclusive_dependency.value_or(false)) {
+            stream_dep_val |= (1U << 31);
+        }
+        write_uint32_big_endian(fields, stream_dep_val);
+        fields.push_back(static_cast<std::byte>(first_frame.weight.value_or(0)));
+    }
+    FrameHeader header = first_frame.header;
+    header.type = FrameType::HEADERS;
+    return write_header_block_frames(out, header, fields, pad_length, headers, hpack_encoder, max_frame_size, encoded_prefix,
+                                     encoded_suffix);
+}
+
+bool write_header_block(std::vector<std::byte>& out, const PushPromiseFrame& first_frame, const std::vector<HttpHeader>& headers,
+                        HpackEncoder& hpack_encoder, uint32_t max_frame_size, std::span<const std::byte> encoded_prefix,
+                        std::span<const std::byte> encoded_suffix) {
+    std::vector<std::byte> fields;
+    size_t pad_length = 0;
+    if (first_frame.has_padded_flag()) {
+        pad_length = first_frame.pad_length.value_or(0);
+        fields.push_back(static_cast<std::byte>(pad_length));
+    }
+    write_uint32_big_endian(fields, first_frame.promised_stream_id & 0x7FFFFFFF);
+    FrameHeader header = first_frame.header;
+    header.type = FrameType::PUSH_PROMISE;
+    return write_header_block_frames(out, header, fields, pad_length, headers, hpack_encoder, max_frame_size, encoded_prefix,
+                                     encoded_suffix);
+}
+
 SerializedHeaderSequence serialize_header_block_with_continuation(
     const FrameHeader& initial_header_template, // Base header for the first (HEADERS/PUSH_PROMISE) frame
     const std::vector<HttpHeader>& headers_to_encode,
     HpackEncoder& hpack_encoder,
     uint32_t peer_max_frame_size,
     bool is_push_promise,
-    stream_id_t promised_stream_id_if_push) {
+    stream_id_t promised_stream_id_if_push,
+    std::span<const std::byte> encoded_prefix) {
 
     SerializedHeaderSequence result;
-    auto [full_hpack_block, hpack_err] = hpack_encoder.encode(headers_to_encode);
-    if (hpack_err != HpackEncodingError::OK) {
-        // Handle error, perhaps return empty or throw
-        return result;
-    }
-
-    FrameHeader current_header = initial_header_template; // Copy base
-    current_header.flags &= ~HeadersFrame::END_HEADERS_FLAG; // Clear END_HEADERS initially
-
-    size_t initial_payload_offset = 0;
-    std::vector<std::byte> initial_payload_prefix;
-
-    // Handle PUSH_PROMISE specific fields (Promised Stream ID)
-    // Also PADDED and PRIORITY flags for both HEADERS and PUSH_PROMISE (not implemented here for simplicity)
-    // This simplified version assumes no PADDING or PRIORITY on initial frame for now.
+    std::vector<std::byte> block;
+    bool written;
     if (is_push_promise) {
-        // Add Promised Stream ID to the payload prefix
-        write_uint32_big_endian(initial_payload_prefix, promised_stream_id_if_push & 0x7FFFFFFF);
-        initial_payload_offset = 4; // Size of Promised Stream ID
-    }
-
-    size_t remaining_hpack_size = full_hpack_block.size();
-    size_t hpack_offset = 0;
-
-    // Max payload for the first frame (HEADERS or PUSH_PROMISE)
-    uint32_t max_first_frame_payload = peer_max_frame_size - static_cast<uint32_t>(initial_payload_prefix.size());
-
-    size_t first_frame_hpack_chunk_size = std::min(remaining_hpack_size, static_cast<size_t>(max_first_frame_payload));
-
-    std::vector<std::byte> first_frame_payload = initial_payload_prefix;
-    first_frame_payload.insert(first_frame_payload.end(),
-                               full_hpack_block.begin() + hpack_offset,
-                               full_hpack_block.begin() + hpack_offset + first_frame_hpack_chunk_size);
-
-    current_header.length = static_cast<uint32_t>(first_frame_payload.size());
-    hpack_offset += first_frame_hpack_chunk_size;
-    remaining_hpack_size -= first_frame_hpack_chunk_size;
-
-    if (remaining_hpack_size == 0) {
-        current_header.flags |= HeadersFrame::END_HEADERS_FLAG;
+        PushPromiseFrame first_frame;
+        first_frame.header = initial_header_template;
+        first_frame.promised_stream_id = promised_stream_id_if_push;
+        written = write_header_block(block, first_frame, headers_to_encode, hpack_encoder, peer_max_frame_size, encoded_prefix);
+    } else {
+        HeadersFrame first_frame;
+        first_frame.header = initial_header_template;
+        written = write_header_block(block, first_frame, headers_to_encode, hpack_encoder, peer_max_frame_size, encoded_prefix);
     }
-
-    // Serialize the first frame (HEADERS or PUSH_PROMISE)
-    write_frame_header(result.headers_frame_bytes, current_header);
-    result.headers_frame_bytes.insert(result.headers_frame_bytes.end(), first_frame_payload.begin(), first_frame_payload.end());
-
-    // Serialize CONTINUATION frames if any
-    while (remaining_hpack_size > 0) {
-        ContinuationFrame cont_frame_obj;
-        cont_frame_obj.header.type = FrameType::CONTINUATION;
-        cont_frame_obj.header.stream_id = initial_header_template.stream_id; // Must be same stream
-        cont_frame_obj.header.flags = 0; // Clear END_HEADERS initially for continuation
-
-        size_t continuation_hpack_chunk_size = std::min(remaining_hpack_size, static_cast<size_t>(peer_max_frame_size));
-
-        cont_frame_obj.header_block_fragment.assign(
-            full_hpack_block.begin() + hpack_offset,
-            full_hpack_block.begin() + hpack_offset + continuation_hpack_chunk_size
-        );
-
-        hpack_offset += continuation_hpack_chunk_size;
-        remaining_hpack_size -= continuation_hpack_chunk_size;
-
-        if (remaining_hpack_size == 0) {
-            cont_frame_obj.header.flags |= ContinuationFrame::END_HEADERS_FLAG;
+    if (!written) return result;
+
+    // Split the contiguous sequence back into one buffer per frame.
+    size_t offset = 0;
+    while (offset < block.size()) {
+        size_t frame_size = FRAME_HEADER_SIZE + ((static_cast<size_t>(block[offset]) << 16) |
+                                                 (static_cast<size_t>(block[offset + 1]) << 8) |
+                                                 static_cast<size_t>(block[offset + 2]));
+        std::vector<std::byte> frame(block.begin() + offset, block.begin() + offset + frame_size);
+        if (offset == 0) {
+            result.headers_frame_bytes = std::move(frame);
+        } else {
+            result.continuation_frames_bytes.push_back(std::move(frame));
         }
-        cont_frame_obj.header.length = static_cast<uint32_t>(cont_frame_obj.header_block_fragment.size());
-
-        result.continuation_frames_bytes.push_back(serialize_continuation_frame(cont_frame_obj));
+        offset += frame_size;
     }
-
     return result;
 }
 
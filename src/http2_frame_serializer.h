@@ -4,6 +4,7 @@
 #include "hpack_encoder.h" // Needed for serializing frames with headers
 #include <vector>
 #include <cstddef> // for std::byte
+#include <span>
 
 namespace http2 {
 
@@ -14,11 +15,16 @@ namespace FrameSerializer {
 
 // --- Helper to write the 9-byte frame header ---
 void write_frame_header(std::vector<std::byte>& buffer, const FrameHeader& header);
+// Same, into caller-owned memory (at least FRAME_HEADER_SIZE bytes). Returns the bytes written,
+// 0 if `out` is too small.
+size_t write_frame_header(std::span<std::byte> out, const FrameHeader& header);
 
 // --- Serialization functions for each frame type ---
 
 // DATA Frame (RFC 7540 Section 6.1)
 std::vector<std::byte> serialize_data_frame(const DataFrame& frame);
+// Unpadded DATA frame written straight from a payload view, without building a DataFrame first.
+std::vector<std::byte> serialize_data_frame(stream_id_t stream_id, std::span<const std::byte> data, uint8_t flags);
 
 // HEADERS Frame (RFC 7540 Section 6.2)
 // Requires an HPACK encoder instance.
@@ -46,6 +52,21 @@ std::vector<std::byte> serialize_goaway_frame(const GoAwayFrame& frame);
 // WINDOW_UPDATE Frame (RFC 7540 Section 6.9)
 std::vector<std::byte> serialize_window_update_frame(const WindowUpdateFrame& frame);
 
+// ALTSVC Frame (RFC 7838 Section 4)
+std::vector<std::byte> serialize_altsvc_frame(const AltSvcFrame& frame);
+
+// ORIGIN Frame (RFC 8336 Section 2). Always written on stream 0.
+std::vector<std::byte> serialize_origin_frame(const OriginFrame& frame);
+
+// PRIORITY_UPDATE Frame (RFC 9218 Section 7.1). Always written on stream 0.
+std::vector<std::byte> serialize_priority_update_frame(const PriorityUpdateFrame& frame);
+
+// Extension frame (RFC 9113 Section 5.5) of any type, payload taken from the caller's buffer.
+// header.length is set from the payload. Empty result if the payload does not fit in 24 bits.
+// To send a large payload without copying it, write only the header with write_frame_header()
+// and hand the payload to the transport separately (e.g. writev).
+std::vector<std::byte> serialize_extension_frame(const FrameHeader& header, std::span<const std::byte> payload);
+
 // CONTINUATION Frame (RFC 7540 Section 6.10)
 // Requires the header block fragment (already HPACKed) to be passed in,
 // as CONTINUATION frames don't invoke HPACK themselves but carry its output.
@@ -53,11 +74,30 @@ std::vector<std::byte> serialize_window_update_frame(const WindowUpdateFrame& fr
 std::vector<std::byte> serialize_continuation_frame(const ContinuationFrame& frame);
 
 
+// --- Single-pass header block writer ---
+// Appends a complete header block to `out`: the HEADERS (or PUSH_PROMISE) frame followed by as
+// many CONTINUATION frames as max_frame_size requires. `first_frame` supplies the stream id, the
+// flags (END_STREAM, PADDED, PRIORITY; END_HEADERS is set here) and the pad length, priority and
+// promised stream id fields; its `headers` member is ignored in favour of `headers`.
+// The HPACK output (`encoded_prefix`, `headers` encoded by `hpack_encoder`, then `encoded_suffix`) is written
+// directly after a reserved frame header. If it does not fit in one frame, the frame headers of
+// the CONTINUATION frames (and the first frame's padding) are opened up inside the buffer
+// afterwards, so the block is never copied into intermediate buffers.
+// Returns false, leaving `out` as it was, on an HPACK error or if the fields and padding of the
+// first frame alone exceed max_frame_size.
+bool write_header_block(std::vector<std::byte>& out, const HeadersFrame& first_frame, const std::vector<HttpHeader>& headers,
+                        HpackEncoder& hpack_encoder, uint32_t max_frame_size, std::span<const std::byte> encoded_prefix = {},
+                        std::span<const std::byte> encoded_suffix = {});
+bool write_header_block(std::vector<std::byte>& out, const PushPromiseFrame& first_frame, const std::vector<HttpHeader>& headers,
+                        HpackEncoder& hpack_encoder, uint32_t max_frame_size, std::span<const std::byte> encoded_prefix = {},
+                        std::span<const std::byte> encoded_suffix = {});
+
 // --- Helper for splitting large header blocks into HEADERS + CONTINUATION(s) ---
 // Takes a fully populated HeadersFrame (with all HttpHeader objects) and peer's max frame size.
 // Returns a vector of byte vectors, where the first is the HEADERS frame,
 // and subsequent are CONTINUATION frames.
-// The HpackEncoder is used internally here.
+// The HpackEncoder is used internally here. Built on write_header_block(), which is cheaper when
+// the frames are sent together anyway.
 struct SerializedHeaderSequence {
     std::vector<std::byte> headers_frame_bytes;
     std::vector<std::vector<std::byte>> continuation_frames_bytes;
@@ -69,8 +109,9 @@ SerializedHeaderSequence serialize_header_block_with_continuation(
     HpackEncoder& hpack_encoder,
     uint32_t peer_max_frame_size,
     bool is_push_promise = false, // To determine if it's HEADERS or PUSH_PROMISE specific fields
-    stream_id_t promised_stream_id_if_push = 0 // Only if is_push_promise
+    stream_id_t promised_stream_id_if_push = 0, // Only if is_push_promise
     // Potentially add padding fields if PADDED flag is intended for HEADERS/PUSH_PROMISE
+    std::span<const std::byte> encoded_prefix = {} // Already-encoded fields placed before headers_to_encode
 );
 
 
@@ -0,0 +1,47 @@
+#include "http2_header_list.h"
+
+namespace http2 {
+
+HeaderList::HeaderList(std::initializer_list<HttpHeader> headers) {
+    for (const auto& h : headers) add(h.name, h.value, h.sensitive);
+}
+
+HeaderList::HeaderList(const std::vector<HttpHeader>& headers) {
+    size_t bytes = 0;
+    for (const auto& h : headers) bytes += h.name.size() + h.value.size();
+    reserve(headers.size(), bytes);
+    for (const auto& h : headers) add(h.name, h.value, h.sensitive);
+}
+
+void HeaderList::add(std::string_view name, std::string_view value, bool sensitive) {
+    entries_.push_back({static_cast<uint32_t>(bytes_.size()), static_cast<uint32_t>(name.size()),
+                        static_cast<uint32_t>(value.size()), sensitive});
+    bytes_.append(name);
+    bytes_.append(value);
+}
+
+void HeaderList::reserve(size_t headers, size_t bytes) {
+    entries_.reserve(headers);
+    bytes_.reserve(bytes);
+}
+
+void HeaderList::clear() {
+    entries_.clear();
+    bytes_.clear();
+}
+
+std::optional<std::string_view> HeaderList::find(std::string_view name) const {
+    for (HeaderView h : *this) {
+        if (h.name == name) return h.value;
+    }
+    return std::nullopt;
+}
+
+std::vector<HttpHeader> HeaderList::to_vector() const {
+    std::vector<HttpHeader> headers;
+    headers.reserve(size());
+    for (HeaderView h : *this) headers.push_back(h.to_header());
+    return headers;
+}
+
+} // namespace http2
@@ -0,0 +1,104 @@
+#pragma once
+
+#include "http2_types.h"
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http2 {
+
+// Read-only view of one header in a HeaderList. Members mirror HttpHeader, so code written for
+// `h.name == "..."`, `h.value` and `h.sensitive` works with either.
+struct HeaderView {
+    std::string_view name;
+    std::string_view value;
+    bool sensitive = false;
+
+    HttpHeader to_header() const { return {std::string(name), std::string(value), sensitive}; }
+};
+
+// A header block stored compactly: all names and values back to back in one byte buffer, plus a
+// small index of offsets and lengths. Allocations grow with the block's size (two buffers,
+// doubling) rather than with its header count, as they do for std::vector<HttpHeader> (one per
+// long name or value, 72 bytes of vector storage per header), and a reused list allocates nothing
+// once warm. HpackDecoder::decode_into() fills one directly and HpackEncoder accepts one. Views
+// stay valid until the list is modified.
+class HeaderList {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = HeaderView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = HeaderView;
+
+        const_iterator() = default;
+        const_iterator(const HeaderList* list, size_t index) : list_(list), index_(index) {}
+
+        HeaderView operator*() const { return (*list_)[index_]; }
+        HeaderView operator[](difference_type n) const { return (*list_)[index_ + n]; }
+        const_iterator& operator++() { ++index_; return *this; }
+        const_iterator operator++(int) { auto it = *this; ++index_; return it; }
+        const_iterator& operator--() { --index_; return *this; }
+        const_iterator operator--(int) { auto it = *this; --index_; return it; }
+        const_iterator& operator+=(difference_type n) { index_ += n; return *this; }
+        const_iterator& operator-=(difference_type n) { index_ -= n; return *this; }
+        friend const_iterator operator+(const_iterator it, difference_type n) { return it += n; }
+        friend const_iterator operator+(difference_type n, const_iterator it) { return it += n; }
+        friend const_iterator operator-(const_iterator it, difference_type n) { return it -= n; }
+        friend difference_type operator-(const const_iterator& a, const const_iterator& b) {
+            return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+        }
+        friend bool operator==(const const_iterator& a, const const_iterator& b) { return a.index_ == b.index_; }
+        friend auto operator<=>(const const_iterator& a, const const_iterator& b) { return a.index_ <=> b.index_; }
+
+    private:
+        const HeaderList* list_ = nullptr;
+        size_t index_ = 0;
+    };
+
+    HeaderList() = default;
+    HeaderList(std::initializer_list<HttpHeader> headers);
+    explicit HeaderList(const std::vector<HttpHeader>& headers);
+
+    void add(std::string_view name, std::string_view value, bool sensitive = false);
+    void reserve(size_t headers, size_t bytes);
+    void clear();
+
+    size_t size() const { return entries_.size(); }
+    bool empty() const { return entries_.empty(); }
+    HeaderView operator[](size_t index) const {
+        const Entry& e = entries_[index];
+        const char* base = bytes_.data() + e.offset;
+        return {std::string_view(base, e.name_length), std::string_view(base + e.name_length, e.value_length), e.sensitive};
+    }
+    const_iterator begin() const { return {this, 0}; }
+    const_iterator end() const { return {this, entries_.size()}; }
+
+    // Value of the first header with this name.
+    std::optional<std::string_view> find(std::string_view name) const;
+    // Sum of name and value lengths.
+    size_t get_byte_size() const { return bytes_.size(); }
+    std::vector<HttpHeader> to_vector() const;
+
+private:
+    struct Entry {
+        uint32_t offset;       // Name starts here; the value follows it directly
+        uint32_t name_length;
+        uint32_t value_length;
+        bool sensitive;
+    };
+
+    std::string bytes_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace http2
@@ -0,0 +1,50 @@
+#include "http2_memory_governor.h"
+
+#include <algorithm>
+
+namespace http2 {
+
+MemoryGovernor::MemoryGovernor(MemoryGovernorOptions options) : options_(options) {}
+
+MemoryGovernor::~MemoryGovernor() {
+    for (Http2Connection* connection : connections_) connection->set_memory_governor(nullptr);
+}
+
+void MemoryGovernor::attach(Http2Connection& connection) {
+    if (std::find(connections_.begin(), connections_.end(), &connection) != connections_.end()) return;
+    connections_.push_back(&connection);
+    connection.set_memory_governor(this);
+    if (under_pressure_) connection.set_receive_window_caps(options_.caps);
+    record_buffered(static_cast<size_t>(connection.get_unconsumed_data_size()));
+}
+
+void MemoryGovernor::detach(Http2Connection& connection) {
+    auto it = std::find(connections_.begin(), connections_.end(), &connection);
+    if (it == connections_.end()) return;
+    connections_.erase(it);
+    connection.set_memory_governor(nullptr);
+    record_released(static_cast<size_t>(connection.get_unconsumed_data_size()));
+}
+
+void MemoryGovernor::record_buffered(size_t bytes) {
+    buffered_bytes_ += bytes;
+    update_pressure();
+}
+
+void MemoryGovernor::record_released(size_t bytes) {
+    buffered_bytes_ -= std::min(bytes, buffered_bytes_);
+    update_pressure();
+}
+
+void MemoryGovernor::update_pressure() {
+    if (!under_pressure_ && buffered_bytes_ >= options_.high_watermark) {
+        under_pressure_ = true;
+        ++pressure_episodes_;
+        for (Http2Connection* connection : connections_) connection->set_receive_window_caps(options_.caps);
+    } else if (under_pressure_ && buffered_bytes_ <= options_.low_watermark) {
+        under_pressure_ = false;
+        for (Http2Connection* connection : connections_) connection->set_receive_window_caps(std::nullopt);
+    }
+}
+
+} // namespace http2
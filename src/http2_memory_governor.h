@@ -0,0 +1,63 @@
+#pragma once
+
+#include "http2_connection.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace http2 {
+
+// Bounds the memory a set of connections can be asked to buffer for received DATA.
+//
+// Every connection advertises its windows on its own, so a traffic spike can leave the process
+// holding `connections x streams x window` bytes that the application has not consumed yet. The
+// governor adds up those bytes (DATA received and not yet released with consume_data()) across
+// the connections attached to it. When the total reaches high_watermark, every connection gets
+// ReceiveWindowCaps: windows stop growing past the caps and fewer concurrent streams are
+// advertised, so peers slow down instead of the process running out of memory or rejecting
+// connections. Once the total has dropped to low_watermark the caps are lifted and the withheld
+// credit is returned.
+//
+// Not thread-safe: use one governor per event-loop thread (per shard), with its memory budget,
+// and attach only connections driven by that thread.
+struct MemoryGovernorOptions {
+    size_t high_watermark = 64u << 20; // Unconsumed bytes at which the caps are applied
+    size_t low_watermark = 32u << 20;  // ...and at which they are lifted again
+    ReceiveWindowCaps caps;
+};
+
+class MemoryGovernor {
+public:
+    explicit MemoryGovernor(MemoryGovernorOptions options = {});
+    ~MemoryGovernor();
+
+    MemoryGovernor(const MemoryGovernor&) = delete;
+    MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+    // Starts accounting for the connection. It detaches itself when destroyed.
+    void attach(Http2Connection& connection);
+    // Stops accounting for the connection and forgets its unconsumed bytes.
+    void detach(Http2Connection& connection);
+
+    // Called by attached connections as DATA arrives and is consumed.
+    void record_buffered(size_t bytes);
+    void record_released(size_t bytes);
+
+    size_t get_buffered_bytes() const { return buffered_bytes_; }
+    bool is_under_pressure() const { return under_pressure_; }
+    size_t get_connection_count() const { return connections_.size(); }
+    // Times the caps have been applied.
+    uint64_t get_pressure_episode_count() const { return pressure_episodes_; }
+
+private:
+    void update_pressure();
+
+    MemoryGovernorOptions options_;
+    std::vector<Http2Connection*> connections_;
+    size_t buffered_bytes_ = 0;
+    bool under_pressure_ = false;
+    uint64_t pressure_episodes_ = 0;
+};
+
+} // namespace http2
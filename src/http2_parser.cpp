@@ -41,12 +41,50 @@ Http2Parser::Http2Parser(HpackDecoder& hpack_decoder, Http2Connection& connectio
 void Http2Parser::reset() {
     current_state_ = State::READING_FRAME_HEADER;
     buffer_.clear();
+    streaming_extension_payload_ = false;
+    extension_payload_delivered_ = 0;
     // Does not reset HPACK decoder; that's connection's responsibility.
 }
 
-uint32_t Http2Parser::get_remote_max_frame_size() const {
-    // Get this from connection context, which knows remote settings
-    return connection_context_.get_remote_settings().max_frame_size;
+bool Http2Parser::register_extension_frame_handler(uint8_t type, ExtensionFrameHandler handler) {
+    if (is_known_frame_type(type) || !handler) return false;
+    extension_handlers_[type] = ExtensionHandlers{std::move(handler), {}};
+    return true;
+}
+
+bool Http2Parser::register_extension_chunk_handler(uint8_t type, ExtensionChunkHandler handler) {
+    if (is_known_frame_type(type) || !handler) return false;
+    extension_handlers_[type] = ExtensionHandlers{{}, std::move(handler)};
+    return true;
+}
+
+void Http2Parser::unregister_extension_handler(uint8_t type) {
+    extension_handlers_.erase(type);
+}
+
+std::pair<size_t, ParserError> Http2Parser::stream_extension_payload(size_t offset) {
+    size_t remaining = pending_frame_header_.length - extension_payload_delivered_;
+    size_t available = std::min(remaining, buffer_.size() - offset);
+    if (available == 0 && remaining > 0) return {0, ParserError::OK}; // Wait for more bytes
+
+    bool last = available == remaining;
+    ParserError err = ParserError::OK;
+    auto it = extension_handlers_.find(static_cast<uint8_t>(pending_frame_header_.type));
+    if (it != extension_handlers_.end() && it->second.chunk_handler) {
+        err = it->second.chunk_handler(pending_frame_header_, std::span<const std::byte>(buffer_.data() + offset, available),
+                                       extension_payload_delivered_, last);
+    }
+    extension_payload_delivered_ += available;
+    if (last) {
+        streaming_extension_payload_ = false;
+        current_state_ = State::READING_FRAME_HEADER;
+    }
+    return {available, err};
+}
+
+uint32_t Http2Parser::get_local_max_frame_size() const {
+    // Frames we receive are bounded by what we advertised, not by what the peer accepts.
+    return connection_context_.get_local_settings().max_frame_size;
 }
 
 
@@ -63,8 +101,8 @@ std::optional<FrameHeader> Http2Parser::read_frame_header(std::span<const std::b
     header.stream_id = read_uint32_big_endian(data.data() + 5) & 0x7FFFFFFF; // Mask out R bit
 
     // Basic validation
-    // Max frame size check against remote peer's SETTINGS_MAX_FRAME_SIZE
-    if (header.length > get_remote_max_frame_size()) {
+    // Max frame size check against our own SETTINGS_MAX_FRAME_SIZE
+    if (header.length > get_local_max_frame_size()) {
         // This is a FRAME_SIZE_ERROR, connection should handle.
         // For now, the parser notes it by returning an error later.
         // Or, parser could have an error state.
@@ -80,36 +118,67 @@ std::pair<size_t, ParserError> Http2Parser::parse(std::span<const std::byte> dat
     
     // Append new data to internal buffer
     buffer_.insert(buffer_.end(), data.begin(), data.end());
+    // Start of the unparsed bytes. Consumed frames are dropped from buffer_ once, on return,
+    // instead of shifting the buffer after every frame.
+    size_t offset = 0;
 
     while (true) {
         if (current_state_ == State::READING_FRAME_HEADER) {
-            if (buffer_.size() < 9) { // Not enough data for a header
+            if (buffer_.size() - offset < 9) { // Not enough data for a header
                 break; // Exit loop, wait for more data
             }
             
-            std::span<const std::byte> header_span(buffer_.data(), 9);
+            std::span<const std::byte> header_span(buffer_.data() + offset, 9);
             auto header_opt = read_frame_header(header_span);
 
             if (!header_opt) { 
+                buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
                 return {total_consumed_bytes, ParserError::INTERNAL_ERROR}; // Should not happen
             }
             pending_frame_header_ = header_opt.value();
 
-            if (pending_frame_header_.length > connection_context_.get_remote_settings().max_frame_size) {
+            if (pending_frame_header_.length > get_local_max_frame_size()) {
+                buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
                 return {total_consumed_bytes, ParserError::FRAME_SIZE_LIMIT_EXCEEDED};
             }
 
             current_state_ = State::READING_FRAME_PAYLOAD;
+
+            // Chunk-handled extension frames are delivered as their bytes arrive instead of
+            // being collected here first.
+            auto extension = extension_handlers_.find(static_cast<uint8_t>(pending_frame_header_.type));
+            if (extension != extension_handlers_.end() && extension->second.chunk_handler) {
+                if (connection_context_.is_expecting_continuation()) {
+                    buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
+                    return {total_consumed_bytes, ParserError::CONTINUATION_EXPECTED};
+                }
+                offset += 9;
+                total_consumed_bytes += 9;
+                streaming_extension_payload_ = true;
+                extension_payload_delivered_ = 0;
+            }
+        }
+
+        if (current_state_ == State::READING_FRAME_PAYLOAD && streaming_extension_payload_) {
+            auto [consumed, err] = stream_extension_payload(offset);
+            offset += consumed;
+            total_consumed_bytes += consumed;
+            if (err != ParserError::OK) {
+                buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
+                return {total_consumed_bytes, err};
+            }
+            if (streaming_extension_payload_) break; // Rest of the payload has not arrived yet
+            continue;
         }
 
         if (current_state_ == State::READING_FRAME_PAYLOAD) {
             size_t frame_total_size = 9 + pending_frame_header_.length;
-            if (buffer_.size() < frame_total_size) { // Not enough data for the full frame
+            if (buffer_.size() - offset < frame_total_size) { // Not enough data for the full frame
                 break; // Exit loop, wait for more data
             }
 
             // We have the full frame now.
-            std::span<const std::byte> payload_span(buffer_.data() + 9, pending_frame_header_.length);
+            std::span<const std::byte> payload_span(buffer_.data() + offset + 9, pending_frame_header_.length);
             ParserError parse_payload_error = ParserError::OK;
 
             // --- Frame Type Dispatch ---
@@ -204,22 +273,59 @@ std::pair<size_t, ParserError> Http2Parser::parse(std::span<const std::byte> dat
                     parse_payload_error = err;
                     break;
                 }
+                case FrameType::ALTSVC: {
+                    auto [frame, err] = parse_altsvc_payload(pending_frame_header_, payload_span);
+                    if (err == ParserError::OK && frame_callback_) {
+                        std::vector<std::byte> payload_copy(payload_span.begin(), payload_span.end());
+                        frame_callback_(std::move(frame), std::move(payload_copy));
+                    }
+                    parse_payload_error = err;
+                    break;
+                }
+                case FrameType::ORIGIN: {
+                    auto [frame, err] = parse_origin_payload(pending_frame_header_, payload_span);
+                    if (err == ParserError::OK && frame_callback_) {
+                        std::vector<std::byte> payload_copy(payload_span.begin(), payload_span.end());
+                        frame_callback_(std::move(frame), std::move(payload_copy));
+                    }
+                    parse_payload_error = err;
+                    break;
+                }
+                case FrameType::PRIORITY_UPDATE: {
+                    auto [frame, err] = parse_priority_update_payload(pending_frame_header_, payload_span);
+                    if (err == ParserError::OK && frame_callback_) {
+                        std::vector<std::byte> payload_copy(payload_span.begin(), payload_span.end());
+                        frame_callback_(std::move(frame), std::move(payload_copy));
+                    }
+                    parse_payload_error = err;
+                    break;
+                }
                 default: {
-                    AnyHttp2Frame unknown_frame(UnknownFrame{pending_frame_header_, std::vector<std::byte>(payload_span.begin(), payload_span.end())});
-                    if (frame_callback_) {
+                    auto extension = extension_handlers_.find(static_cast<uint8_t>(pending_frame_header_.type));
+                    if (extension != extension_handlers_.end() && extension->second.frame_handler) {
+                        parse_payload_error = connection_context_.is_expecting_continuation()
+                                                  ? ParserError::CONTINUATION_EXPECTED
+                                                  : extension->second.frame_handler(pending_frame_header_, payload_span);
+                        break;
+                    }
+                    // Unknown frame types are ignored (RFC 9113 Section 4.1), except in the middle
+                    // of a header block, where only CONTINUATION may appear.
+                    auto [frame, err] = parse_unknown_payload(pending_frame_header_, payload_span);
+                    if (err == ParserError::OK && frame_callback_) {
                          std::vector<std::byte> payload_copy(payload_span.begin(), payload_span.end());
-                         frame_callback_(unknown_frame, std::move(payload_copy));
+                         frame_callback_(std::move(frame), std::move(payload_copy));
                     }
-                    parse_payload_error = ParserError::INVALID_FRAME_TYPE;
+                    parse_payload_error = err;
                 }
             }
             
             if (parse_payload_error != ParserError::OK) {
+                 buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
                  return {total_consumed_bytes, parse_payload_error}; // Stop on error
             }
             
             // Consume the frame from the buffer
-            buffer_.erase(buffer_.begin(), buffer_.begin() + frame_total_size);
+            offset += frame_total_size;
             total_consumed_bytes += frame_total_size;
 
             // Reset for the next frame
@@ -227,6 +333,7 @@ std::pair<size_t, ParserError> Http2Parser::parse(std::span<const std::byte> dat
 
         } // end if READING_FRAME_PAYLOAD
     } // end while(true)
+    buffer_.erase(buffer_.begin(), buffer_.begin() + offset);
 
     // Return the total bytes consumed from the input `data` span.
     // Note: this implementation consumes from an internal buffer, so the relationship
@@ -298,6 +405,15 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_headers_payload(const F
 
     std::span<const std::byte> hpack_payload = payload.subspan(current_offset, header_block_fragment_len);
 
+    if (frame.has_end_headers_flag() && !connection_context_.is_expecting_continuation()) {
+        // The whole header block is in this frame (nearly all requests): decode it in place
+        // instead of copying it through the reassembly buffer.
+        if (take_header_block(hpack_payload, frame.headers, frame.header_block_fragment) != ParserError::OK) {
+            return {AnyHttp2Frame(frame), ParserError::HPACK_DECOMPRESSION_FAILED};
+        }
+        return {AnyHttp2Frame(std::move(frame)), ParserError::OK};
+    }
+
     // The Http2Parser itself doesn't maintain the "current header block".
     // It passes the fragment to the connection, which manages HPACK decoding across CONTINUATIONs.
     // For now, let's assume Http2Connection handles this logic.
@@ -325,13 +441,11 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_headers_payload(const F
     connection_context_.append_to_header_block_buffer(hpack_payload);
 
     if (frame.has_end_headers_flag()) {
-        auto [decoded_headers, hpack_err] = hpack_decoder_.decode(connection_context_.get_header_block_buffer_span());
-        if (hpack_err != HpackError::OK) {
+        if (take_header_block(connection_context_.get_header_block_buffer_span(), frame.headers, frame.header_block_fragment) != ParserError::OK) {
             connection_context_.clear_header_block_buffer(); // Clear buffer on error
             connection_context_.finish_continuation();       // Reset continuation state
             return {AnyHttp2Frame(frame), ParserError::HPACK_DECOMPRESSION_FAILED};
         }
-        frame.headers = std::move(decoded_headers);
         connection_context_.clear_header_block_buffer();
         connection_context_.finish_continuation();
     } else {
@@ -382,19 +496,50 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_settings_payload(const
     return {AnyHttp2Frame(frame), ParserError::OK};
 }
 
+ParserError Http2Parser::take_header_block(std::span<const std::byte> block, std::vector<HttpHeader>& headers, std::vector<std::byte>& encoded) {
+    if (connection_context_.is_header_decoding_deferred()) {
+        encoded.assign(block.begin(), block.end());
+        return ParserError::OK;
+    }
+    auto [decoded_headers, hpack_err] = hpack_decoder_.decode(block);
+    if (hpack_err != HpackError::OK) return ParserError::HPACK_DECOMPRESSION_FAILED;
+    headers = std::move(decoded_headers);
+    return ParserError::OK;
+}
+
 std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_push_promise_payload(const FrameHeader& header, std::span<const std::byte> payload) {
     PushPromiseFrame frame{header};
-    // Basic validation
-    if (payload.size() < 4) return {AnyHttp2Frame(frame), ParserError::INVALID_FRAME_SIZE};
-    
-    frame.promised_stream_id = read_uint32_big_endian(payload.data()) & 0x7FFFFFFF;
-    
-    auto hpack_payload = payload.subspan(4);
-    // frame.header_block_fragment = hpack_payload; // This member doesn't exist. Headers are decoded.
-                                                  // HPACK decoding logic is complex and happens in connection context.
-                                                  // For now, we just parse the promised stream ID.
+    if (header.stream_id == 0) return {AnyHttp2Frame(frame), ParserError::INVALID_STREAM_ID};
+    if (connection_context_.is_expecting_continuation()) {
+        return {AnyHttp2Frame(frame), ParserError::CONTINUATION_EXPECTED};
+    }
 
-    return {AnyHttp2Frame(frame), ParserError::OK};
+    size_t current_offset = 0;
+    if (frame.has_padded_flag()) {
+        if (payload.empty()) return {AnyHttp2Frame(frame), ParserError::INVALID_PADDING};
+        frame.pad_length = static_cast<uint8_t>(payload[0]);
+        current_offset += 1;
+    }
+    if (payload.size() - current_offset < 4) return {AnyHttp2Frame(frame), ParserError::INVALID_FRAME_SIZE};
+    frame.promised_stream_id = read_uint32_big_endian(payload.data() + current_offset) & 0x7FFFFFFF;
+    current_offset += 4;
+    if (frame.pad_length.value_or(0) > payload.size() - current_offset) {
+        return {AnyHttp2Frame(frame), ParserError::INVALID_PADDING};
+    }
+    auto hpack_payload = payload.subspan(current_offset, payload.size() - current_offset - frame.pad_length.value_or(0));
+
+    // Same as HEADERS: a complete block is decoded in place, otherwise it is reassembled from the
+    // CONTINUATION frames that follow.
+    if (frame.has_end_headers_flag()) {
+        if (take_header_block(hpack_payload, frame.headers, frame.header_block_fragment) != ParserError::OK) {
+            return {AnyHttp2Frame(frame), ParserError::HPACK_DECOMPRESSION_FAILED};
+        }
+    } else {
+        connection_context_.clear_header_block_buffer();
+        connection_context_.append_to_header_block_buffer(hpack_payload);
+        connection_context_.expect_continuation_for_stream(header.get_stream_id(), FrameType::PUSH_PROMISE, AnyHttp2Frame(frame));
+    }
+    return {AnyHttp2Frame(std::move(frame)), ParserError::OK};
 }
 
 std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_ping_payload(const FrameHeader& header, std::span<const std::byte> payload) {
@@ -426,6 +571,69 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_window_update_payload(c
     return {AnyHttp2Frame(frame), ParserError::OK};
 }
 
+std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_altsvc_payload(const FrameHeader& header, std::span<const std::byte> payload) {
+    if (connection_context_.is_expecting_continuation()) {
+        return {AnyHttp2Frame(UnknownFrame{header, {}}), ParserError::CONTINUATION_EXPECTED};
+    }
+    // Origin-Len (16) | Origin | Alt-Svc-Field-Value. A malformed frame is passed on as an
+    // UnknownFrame, i.e. ignored, like any extension frame the endpoint does not understand.
+    if (payload.size() < 2) return parse_unknown_payload(header, payload);
+    uint16_t origin_length = read_uint16_big_endian(payload.data());
+    if (origin_length > payload.size() - 2) return parse_unknown_payload(header, payload);
+
+    AltSvcFrame frame;
+    frame.header = header;
+    const char* chars = reinterpret_cast<const char*>(payload.data());
+    frame.origin.assign(chars + 2, origin_length);
+    frame.field_value.assign(chars + 2 + origin_length, payload.size() - 2 - origin_length);
+    return {AnyHttp2Frame(std::move(frame)), ParserError::OK};
+}
+
+std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_origin_payload(const FrameHeader& header, std::span<const std::byte> payload) {
+    if (connection_context_.is_expecting_continuation()) {
+        return {AnyHttp2Frame(UnknownFrame{header, {}}), ParserError::CONTINUATION_EXPECTED};
+    }
+    // Sequence of Origin-Len (16) | ASCII-Origin.
+    OriginFrame frame;
+    frame.header = header;
+    size_t offset = 0;
+    while (offset < payload.size()) {
+        if (payload.size() - offset < 2) return parse_unknown_payload(header, payload);
+        uint16_t origin_length = read_uint16_big_endian(payload.data() + offset);
+        offset += 2;
+        if (origin_length > payload.size() - offset) return parse_unknown_payload(header, payload);
+        frame.origins.emplace_back(reinterpret_cast<const char*>(payload.data() + offset), origin_length);
+        offset += origin_length;
+    }
+    return {AnyHttp2Frame(std::move(frame)), ParserError::OK};
+}
+
+std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_priority_update_payload(const FrameHeader& header, std::span<const std::byte> payload) {
+    if (connection_context_.is_expecting_continuation()) {
+        return {AnyHttp2Frame(UnknownFrame{header, {}}), ParserError::CONTINUATION_EXPECTED};
+    }
+    // R (1) | Prioritized Stream ID (31) | Priority Field Value. Unlike ALTSVC/ORIGIN, RFC 9218
+    // Section 7.1 makes a misplaced or short frame a connection error.
+    PriorityUpdateFrame frame;
+    frame.header = header;
+    if (header.stream_id != 0) {
+        return {AnyHttp2Frame(std::move(frame)), ParserError::INVALID_STREAM_ID};
+    }
+    if (payload.size() < 4) {
+        return {AnyHttp2Frame(std::move(frame)), ParserError::INVALID_FRAME_SIZE};
+    }
+    frame.prioritized_stream_id = read_uint32_big_endian(payload.data()) & 0x7FFFFFFF;
+    frame.priority_field_value.assign(reinterpret_cast<const char*>(payload.data()) + 4, payload.size() - 4);
+    return {AnyHttp2Frame(std::move(frame)), ParserError::OK};
+}
+
+std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_unknown_payload(const FrameHeader& header, std::span<const std::byte> payload) {
+    if (connection_context_.is_expecting_continuation()) {
+        return {AnyHttp2Frame(UnknownFrame{header, {}}), ParserError::CONTINUATION_EXPECTED};
+    }
+    return {AnyHttp2Frame(UnknownFrame{header, std::vector<std::byte>(payload.begin(), payload.end())}), ParserError::OK};
+}
+
 std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_continuation_payload(const FrameHeader& header, std::span<const std::byte> payload) {
     ContinuationFrame frame;
     frame.header = header;
@@ -444,8 +652,9 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_continuation_payload(co
     connection_context_.append_to_header_block_buffer(payload);
 
     if (frame.has_end_headers_flag()) {
-        auto [decoded_headers, hpack_err] = hpack_decoder_.decode(connection_context_.get_header_block_buffer_span());
-         if (hpack_err != HpackError::OK) {
+        std::vector<HttpHeader> decoded_headers;
+        std::vector<std::byte> encoded_block; // Filled instead when decoding is deferred
+        if (take_header_block(connection_context_.get_header_block_buffer_span(), decoded_headers, encoded_block) != ParserError::OK) {
             return {AnyHttp2Frame(frame), ParserError::HPACK_DECOMPRESSION_FAILED};
         }
         // The decoded headers are associated with the original HEADERS/PUSH_PROMISE frame,
@@ -457,7 +666,7 @@ std::pair<AnyHttp2Frame, ParserError> Http2Parser::parse_continuation_payload(co
 
         // The HttpConnection needs to be notified to populate its original HeadersFrame/PushPromiseFrame
     // The `populate_pending_headers` method will update the stored initiator frame.
-    connection_context_.populate_pending_headers(std::move(decoded_headers));
+    connection_context_.populate_pending_headers(std::move(decoded_headers), std::move(encoded_block));
     connection_context_.clear_header_block_buffer();
     // finish_continuation also triggers the callback for the now-complete initiator frame.
     connection_context_.finish_continuation();
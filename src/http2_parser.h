@@ -6,6 +6,7 @@
 
 #include <vector>
 #include <functional>
+#include <map>
 #include <optional>
 #include <span> // C++20
 
@@ -44,6 +45,19 @@ public:
     // However, the parser might have a callback for when a complete frame is parsed.
     using FrameCallback = std::function<void(AnyHttp2Frame, std::vector<std::byte>)>;
 
+    // Extension frames: handlers for frame types the parser does not implement itself (see
+    // is_known_frame_type()). They see the payload in place, as a view into the parser's buffer
+    // that is only valid during the call; no AnyHttp2Frame/UnknownFrame is built and nothing is
+    // copied. Returning anything but OK fails the parse like a malformed frame would.
+    //
+    // Whole-frame handler: called once the complete payload has arrived.
+    using ExtensionFrameHandler = std::function<ParserError(const FrameHeader& header, std::span<const std::byte> payload)>;
+    // Chunk handler: called with each piece of the payload as it arrives, so large frames are
+    // never buffered. `offset` is the position of `chunk` in the payload; `last` marks the final
+    // piece (which is empty for a zero-length frame).
+    using ExtensionChunkHandler = std::function<ParserError(const FrameHeader& header, std::span<const std::byte> chunk,
+                                                            size_t offset, bool last)>;
+
     // The parser needs access to the HPACK decoder, which is typically managed by the connection
     // due to its statefulness and SETTINGS_HEADER_TABLE_SIZE updates.
     Http2Parser(HpackDecoder& hpack_decoder, Http2Connection& connection_context);
@@ -57,6 +71,13 @@ public:
 
     void set_frame_callback(FrameCallback cb) { frame_callback_ = std::move(cb); }
 
+    // Register a handler for an extension frame type, replacing any earlier one for that type.
+    // Fails for types the parser implements. Handlers must not (un)register handlers themselves.
+    bool register_extension_frame_handler(uint8_t type, ExtensionFrameHandler handler);
+    bool register_extension_chunk_handler(uint8_t type, ExtensionChunkHandler handler);
+    // Frames of an unregistered type go back to being ignored.
+    void unregister_extension_handler(uint8_t type);
+
     // Resets parser state, e.g., if the connection is reset.
     // Does not reset HPACK decoder state, as that's managed by Http2Connection.
     void reset();
@@ -74,6 +95,16 @@ private:
 
     FrameHeader pending_frame_header_; // Header of the frame currently being parsed
 
+    struct ExtensionHandlers {
+        ExtensionFrameHandler frame_handler; // Exactly one of the two is set
+        ExtensionChunkHandler chunk_handler;
+    };
+    std::map<uint8_t, ExtensionHandlers> extension_handlers_;
+    // Set while the payload of pending_frame_header_ is being streamed to a chunk handler; the
+    // frame header has then already been consumed from buffer_.
+    bool streaming_extension_payload_ = false;
+    size_t extension_payload_delivered_ = 0;
+
     // Reference to the connection's HPACK decoder
     HpackDecoder& hpack_decoder_;
     // Reference to the connection context for settings like max_frame_size
@@ -94,18 +125,28 @@ private:
     std::pair<AnyHttp2Frame, ParserError> parse_priority_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_rst_stream_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_settings_payload(const FrameHeader& header, std::span<const std::byte> payload);
+    // Decodes a complete header block into `headers`, or copies it to `encoded` instead while the
+    // connection defers header decoding.
+    ParserError take_header_block(std::span<const std::byte> block, std::vector<HttpHeader>& headers, std::vector<std::byte>& encoded);
     std::pair<AnyHttp2Frame, ParserError> parse_push_promise_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_ping_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_goaway_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_window_update_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_continuation_payload(const FrameHeader& header, std::span<const std::byte> payload);
+    std::pair<AnyHttp2Frame, ParserError> parse_altsvc_payload(const FrameHeader& header, std::span<const std::byte> payload);
+    std::pair<AnyHttp2Frame, ParserError> parse_origin_payload(const FrameHeader& header, std::span<const std::byte> payload);
+    std::pair<AnyHttp2Frame, ParserError> parse_priority_update_payload(const FrameHeader& header, std::span<const std::byte> payload);
     std::pair<AnyHttp2Frame, ParserError> parse_unknown_payload(const FrameHeader& header, std::span<const std::byte> payload);
 
+    // Delivers what has arrived of a chunk-handled payload starting at buffer_[offset]. Returns
+    // the bytes consumed; the frame is finished once streaming_extension_payload_ is cleared.
+    std::pair<size_t, ParserError> stream_extension_payload(size_t offset);
+
     // Helper to read the 9-byte frame header
     std::optional<FrameHeader> read_frame_header(std::span<const std::byte>& data);
 
-    // Max frame size allowed by the peer (obtained from connection settings)
-    uint32_t get_remote_max_frame_size() const;
+    // Largest frame we accept: the SETTINGS_MAX_FRAME_SIZE we advertised (local settings)
+    uint32_t get_local_max_frame_size() const;
 };
 
 } // namespace http2
@@ -0,0 +1,197 @@
+#include "http2_pipeline.h"
+
+#include <utility>
+
+namespace http2 {
+
+Http2Pipeline::Http2Pipeline(Http2Connection& connection, StreamEvents events, PipelineOptions options)
+    : connection_(connection),
+      events_(std::move(events)),
+      event_queue_(options.event_queue_capacity),
+      command_queue_(options.command_queue_capacity) {
+    StreamEvents stage1;
+    stage1.on_open = [this](stream_id_t stream_id) -> void* {
+        push({.kind = Event::Kind::OPEN, .end_stream = false, .error_code = ErrorCode::NO_ERROR, .stream_id = stream_id,
+              .max_table_size = 0, .payload = {}});
+        return nullptr;
+    };
+    stage1.on_data = [this](stream_id_t stream_id, void*, std::vector<std::byte>&& data, bool end_stream) {
+        push({.kind = Event::Kind::DATA, .end_stream = end_stream, .error_code = ErrorCode::NO_ERROR, .stream_id = stream_id,
+              .max_table_size = 0, .payload = std::move(data)});
+    };
+    stage1.on_reset = [this](stream_id_t stream_id, void*, ErrorCode error_code) {
+        push({.kind = Event::Kind::RESET, .end_stream = false, .error_code = error_code, .stream_id = stream_id,
+              .max_table_size = 0, .payload = {}});
+    };
+    stage1.on_close = [this](stream_id_t stream_id, void*) {
+        push({.kind = Event::Kind::CLOSE, .end_stream = false, .error_code = ErrorCode::NO_ERROR, .stream_id = stream_id,
+              .max_table_size = 0, .payload = {}});
+    };
+    connection_.set_stream_events(std::move(stage1));
+    connection_.set_header_block_callback([this](EncodedHeaderBlock&& block) {
+        Event::Kind kind = block.decode_only ? Event::Kind::DECODE_ONLY
+                         : block.trailers    ? Event::Kind::TRAILERS
+                                             : Event::Kind::HEADERS;
+        push({.kind = kind, .end_stream = block.end_stream, .error_code = ErrorCode::NO_ERROR, .stream_id = block.stream_id,
+              .max_table_size = block.max_table_size, .payload = std::move(block.block)});
+    });
+
+    handler_thread_ = std::thread([this] { run(); });
+}
+
+Http2Pipeline::~Http2Pipeline() {
+    stopping_.store(true, std::memory_order_release);
+    publish();
+    handler_thread_.join();
+    connection_.set_stream_events({});
+    connection_.set_header_block_callback(nullptr);
+}
+
+// --- Stage 1 ---
+
+size_t Http2Pipeline::process_incoming_data(std::span<const std::byte> data) {
+    run_commands();
+    size_t consumed = connection_.process_incoming_data(data);
+    publish();
+    if (!deferred_commands_.empty()) run_commands(); // Set aside by push() during this read
+    return consumed;
+}
+
+size_t Http2Pipeline::run_commands() {
+    size_t count = 0;
+    Command command;
+    while (true) {
+        // Commands set aside by push() were posted before those still queued. The batch is moved
+        // out first, as running it may set more aside.
+        if (!deferred_commands_.empty()) {
+            std::vector<Command> batch;
+            batch.swap(deferred_commands_);
+            for (auto& deferred : batch) deferred(connection_);
+            count += batch.size();
+            continue;
+        }
+        if (!command_queue_.try_pop(command)) break;
+        command(connection_);
+        ++count;
+    }
+    return count;
+}
+
+void Http2Pipeline::drain() {
+    publish();
+    while (dispatched_.load(std::memory_order_acquire) != pushed_) {
+        if (run_commands() == 0) std::this_thread::yield();
+    }
+    run_commands();
+}
+
+void Http2Pipeline::push(Event&& event) {
+    // A full queue means the handler thread is behind: wake it and keep room in the command queue
+    // (it may itself be waiting in post()) until there is room again. The commands are only set
+    // aside: push() runs inside the connection's callbacks, where it must not be re-entered.
+    while (!event_queue_.try_push(std::move(event))) {
+        publish();
+        Command command;
+        bool moved = false;
+        while (command_queue_.try_pop(command)) {
+            deferred_commands_.push_back(std::move(command));
+            moved = true;
+        }
+        if (!moved) std::this_thread::yield();
+    }
+    ++pushed_;
+}
+
+void Http2Pipeline::publish() {
+    // One wakeup per read rather than per event; the handler drains whatever has been queued.
+    published_.fetch_add(1, std::memory_order_release);
+    published_.notify_one();
+}
+
+// --- Stage 2 ---
+
+void Http2Pipeline::post(Command command) {
+    while (!command_queue_.try_push(std::move(command))) {
+        if (command_wakeup_) command_wakeup_();
+        std::this_thread::yield();
+    }
+    if (command_wakeup_) command_wakeup_();
+}
+
+void Http2Pipeline::consume_data(stream_id_t stream_id, uint32_t size) {
+    post([stream_id, size](Http2Connection& connection) { connection.consume_data(stream_id, size); });
+}
+
+void Http2Pipeline::run() {
+    Event event;
+    while (true) {
+        // Read the counter before draining: anything published after the queue looked empty
+        // changes it, so the wait below returns at once instead of missing the wakeup.
+        uint64_t seen = published_.load(std::memory_order_acquire);
+        bool stopping = stopping_.load(std::memory_order_acquire);
+        while (event_queue_.try_pop(event)) {
+            if (!failed_.load(std::memory_order_relaxed)) dispatch(event);
+            event.payload = {};
+            dispatched_.fetch_add(1, std::memory_order_release);
+        }
+        if (stopping) return;
+        published_.wait(seen, std::memory_order_acquire);
+    }
+}
+
+void Http2Pipeline::dispatch(Event& event) {
+    stream_id_t stream_id = event.stream_id;
+    switch (event.kind) {
+        case Event::Kind::OPEN:
+            user_data_[stream_id] = events_.on_open ? events_.on_open(stream_id) : nullptr;
+            return;
+        case Event::Kind::HEADERS:
+        case Event::Kind::TRAILERS:
+        case Event::Kind::DECODE_ONLY: {
+            // Blocks are decoded in wire order, rejected ones included, so this decoder's dynamic
+            // table follows the peer's encoder exactly as the connection's own would.
+            if (event.max_table_size != connection_table_size_) {
+                connection_table_size_ = event.max_table_size;
+                decoder_.set_max_dynamic_table_size(connection_table_size_);
+            }
+            auto [headers, err] = decoder_.decode(event.payload);
+            if (err != HpackError::OK) {
+                // RFC 9113 Section 4.3: a decoding error is a connection error.
+                failed_.store(true, std::memory_order_release);
+                post([](Http2Connection& connection) {
+                    connection.send_goaway_action(0, ErrorCode::COMPRESSION_ERROR, "HPACK decoding failed");
+                });
+                return;
+            }
+            auto it = user_data_.find(stream_id);
+            void* user_data = it != user_data_.end() ? it->second : nullptr;
+            if (event.kind == Event::Kind::HEADERS && events_.on_headers) {
+                events_.on_headers(stream_id, user_data, headers, event.end_stream);
+            } else if (event.kind == Event::Kind::TRAILERS && events_.on_trailers) {
+                events_.on_trailers(stream_id, user_data, headers);
+            }
+            return;
+        }
+        case Event::Kind::DATA:
+            if (events_.on_data) {
+                auto it = user_data_.find(stream_id);
+                events_.on_data(stream_id, it != user_data_.end() ? it->second : nullptr, std::move(event.payload), event.end_stream);
+            }
+            return;
+        case Event::Kind::RESET:
+            if (events_.on_reset) {
+                auto it = user_data_.find(stream_id);
+                events_.on_reset(stream_id, it != user_data_.end() ? it->second : nullptr, event.error_code);
+            }
+            return;
+        case Event::Kind::CLOSE: {
+            auto it = user_data_.find(stream_id);
+            void* user_data = it != user_data_.end() ? it->second : nullptr;
+            if (it != user_data_.end()) user_data_.erase(it);
+            if (events_.on_close) events_.on_close(stream_id, user_data);
+            return;
+        }
+    }
+}
+
+} // namespace http2
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "http2_types.h"
+#include "http2_connection.h"
+#include "hpack_decoder.h"
+#include "http2_spsc_queue.h"
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace http2 {
+
+struct PipelineOptions {
+    size_t event_queue_capacity = 4096;   // Events in flight from the I/O thread to the handler thread
+    size_t command_queue_capacity = 1024; // Commands in flight back to the I/O thread
+};
+
+// Splits a server connection's receive path over two threads.
+//
+// Stage 1 runs on the I/O thread: process_incoming_data() frames the input, validates it, keeps
+// stream states and flow control, and hands DATA payloads over as they are. Header blocks are left
+// HPACK-encoded (Http2Connection::set_header_block_callback). Everything the application is to see
+// goes into a lock-free single-producer/single-consumer queue, in wire order.
+//
+// Stage 2 is a thread of the pipeline's own. It decodes the header blocks with an HPACK decoder
+// of its own, in order, and calls the application's StreamEvents, so decoding and request handling
+// no longer hold up reading and framing. The StreamEvents work as with
+// Http2Connection::set_stream_events(); the user data returned by on_open is kept by the pipeline.
+//
+// The connection itself stays single-threaded: handlers must not touch it, but post() commands
+// that stage 1 runs before its next read (run_commands(), also called by
+// process_incoming_data()). A wakeup callback lets an idle event loop pick commands up promptly.
+//
+// A pipeline takes over the connection's stream events and header block callback for good and
+// must outlive its use of the connection; destroy it only once no more input is processed.
+class Http2Pipeline {
+public:
+    using Command = std::function<void(Http2Connection& connection)>;
+
+    Http2Pipeline(Http2Connection& connection, StreamEvents events, PipelineOptions options = {});
+    // Stops the handler thread once it has dispatched everything already received. Commands it
+    // posts meanwhile are not run.
+    ~Http2Pipeline();
+
+    Http2Pipeline(const Http2Pipeline&) = delete;
+    Http2Pipeline& operator=(const Http2Pipeline&) = delete;
+
+    // --- Stage 1 (I/O thread) ---
+    // Runs pending commands, then feeds `data` to the connection and wakes the handler thread.
+    // Commands taken off the queue while the connection was busy run once it has returned.
+    size_t process_incoming_data(std::span<const std::byte> data);
+    // Runs the commands posted so far. Returns how many ran.
+    size_t run_commands();
+    // Waits until the handler thread has dispatched every event so far, running commands meanwhile
+    // and once more at the end (for those posted by the last handlers).
+    void drain();
+
+    // --- Stage 2 (handler thread, from within StreamEvents) ---
+    // Queues a command for the I/O thread; blocks while the command queue is full.
+    void post(Command command);
+    // Returns flow-control credit for consumed DATA (Http2Connection::consume_data) via post().
+    void consume_data(stream_id_t stream_id, uint32_t size);
+
+    // Called on the handler thread after each post(), e.g. to write to an eventfd the I/O loop
+    // polls. Set before any input is processed.
+    void set_command_wakeup(std::function<void()> wakeup) { command_wakeup_ = std::move(wakeup); }
+
+    // Events dispatched by the handler thread so far.
+    uint64_t get_dispatched_count() const { return dispatched_.load(std::memory_order_acquire); }
+    // An HPACK decoding error made the pipeline send GOAWAY(COMPRESSION_ERROR) and stop dispatching.
+    bool has_failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+    struct Event {
+        enum class Kind : uint8_t { OPEN, HEADERS, TRAILERS, DECODE_ONLY, DATA, RESET, CLOSE };
+        Kind kind = Kind::OPEN;
+        bool end_stream = false;
+        ErrorCode error_code = ErrorCode::NO_ERROR;
+        stream_id_t stream_id = 0;
+        uint32_t max_table_size = 0; // Header blocks only
+        std::vector<std::byte> payload; // Encoded header block or DATA payload
+    };
+
+    void push(Event&& event);
+    void publish();
+    void run();
+    void dispatch(Event& event);
+
+    Http2Connection& connection_;
+    StreamEvents events_;
+
+    SpscQueue<Event> event_queue_;
+    SpscQueue<Command> command_queue_;
+    uint64_t pushed_ = 0; // Stage 1 only
+    std::vector<Command> deferred_commands_; // Stage 1 only: taken off a full command queue by push()
+    std::atomic<uint64_t> published_{0}; // Bumped (and waited on) to wake the handler thread
+    std::atomic<uint64_t> dispatched_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<bool> failed_{false};
+    std::function<void()> command_wakeup_;
+
+    // Stage 2 only
+    HpackDecoder decoder_;
+    uint32_t connection_table_size_ = DEFAULT_HEADER_TABLE_SIZE;
+    std::unordered_map<stream_id_t, void*> user_data_;
+
+    std::thread handler_thread_;
+};
+
+} // namespace http2
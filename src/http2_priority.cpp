@@ -0,0 +1,202 @@
+#include "http2_priority.h"
+
+#include <optional>
+
+namespace http2 {
+
+namespace {
+
+// Just enough of an RFC 8941 parser to walk a Dictionary: every value type is recognized so that
+// it can be skipped, but only Integers and Booleans are ever decoded.
+class FieldCursor {
+public:
+    explicit FieldCursor(std::string_view input) : input_(input) {}
+
+    bool at_end() const { return pos_ >= input_.size(); }
+    char peek() const { return at_end() ? '\0' : input_[pos_]; }
+    bool consume(char c) {
+        if (peek() != c) return false;
+        ++pos_;
+        return true;
+    }
+    void skip_sp() { while (peek() == ' ') ++pos_; }
+    void skip_ows() { while (peek() == ' ' || peek() == '\t') ++pos_; }
+
+    // key = ( lcalpha / "*" ) *( lcalpha / DIGIT / "_" / "-" / "." / "*" )
+    std::optional<std::string_view> parse_key() {
+        size_t start = pos_;
+        char c = peek();
+        if (!is_lcalpha(c) && c != '*') return std::nullopt;
+        while (!at_end()) {
+            c = peek();
+            if (!is_lcalpha(c) && !is_digit(c) && c != '_' && c != '-' && c != '.' && c != '*') break;
+            ++pos_;
+        }
+        return input_.substr(start, pos_ - start);
+    }
+
+    // bare-item. Integers and Booleans are returned through the out-parameters; other types
+    // (including Decimals) are only validated.
+    bool parse_bare_item(std::optional<int64_t>& integer, std::optional<bool>& boolean) {
+        char c = peek();
+        if (c == '-' || is_digit(c)) return parse_number(integer);
+        if (c == '"') return skip_string();
+        if (c == ':') return skip_byte_sequence();
+        if (c == '?') {
+            ++pos_;
+            if (peek() != '0' && peek() != '1') return false;
+            boolean = peek() == '1';
+            ++pos_;
+            return true;
+        }
+        if (is_alpha(c) || c == '*') return skip_token();
+        return false;
+    }
+
+    // parameters = *( ";" *SP parameter-key [ "=" bare-item ] ). Values are not needed.
+    bool skip_parameters() {
+        while (consume(';')) {
+            skip_sp();
+            if (!parse_key()) return false;
+            if (consume('=')) {
+                std::optional<int64_t> integer;
+                std::optional<bool> boolean;
+                if (!parse_bare_item(integer, boolean)) return false;
+            }
+        }
+        return true;
+    }
+
+    // inner-list = "(" *SP [ sf-item *( 1*SP sf-item ) *SP ] ")" parameters
+    bool skip_inner_list() {
+        if (!consume('(')) return false;
+        while (true) {
+            skip_sp();
+            if (consume(')')) return skip_parameters();
+            std::optional<int64_t> integer;
+            std::optional<bool> boolean;
+            if (!parse_bare_item(integer, boolean) || !skip_parameters()) return false;
+            if (peek() != ' ' && peek() != ')') return false;
+        }
+    }
+
+private:
+    static bool is_lcalpha(char c) { return c >= 'a' && c <= 'z'; }
+    static bool is_alpha(char c) { return is_lcalpha(c) || (c >= 'A' && c <= 'Z'); }
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+    static bool is_tchar(char c) {
+        return is_alpha(c) || is_digit(c) || std::string_view("!#$%&'*+-.^_`|~").find(c) != std::string_view::npos;
+    }
+
+    bool parse_number(std::optional<int64_t>& integer) {
+        bool negative = consume('-');
+        int64_t value = 0;
+        size_t digits = 0;
+        while (is_digit(peek())) {
+            if (++digits > 15) return false;
+            value = value * 10 + (peek() - '0');
+            ++pos_;
+        }
+        if (digits == 0) return false;
+        if (consume('.')) { // Decimal: at most 12 integer and 3 fractional digits
+            size_t fraction = 0;
+            while (is_digit(peek())) {
+                ++fraction;
+                ++pos_;
+            }
+            return digits <= 12 && fraction >= 1 && fraction <= 3;
+        }
+        integer = negative ? -value : value;
+        return true;
+    }
+
+    bool skip_string() {
+        ++pos_; // Opening DQUOTE
+        while (!at_end()) {
+            char c = input_[pos_++];
+            if (c == '"') return true;
+            if (c == '\\') {
+                if (peek() != '"' && peek() != '\\') return false;
+                ++pos_;
+            } else if (c < 0x20 || c > 0x7e) {
+                return false;
+            }
+        }
+        return false; // Unterminated
+    }
+
+    bool skip_token() {
+        ++pos_;
+        while (is_tchar(peek()) || peek() == ':' || peek() == '/') ++pos_;
+        return true;
+    }
+
+    bool skip_byte_sequence() {
+        ++pos_;
+        while (!at_end()) {
+            char c = input_[pos_++];
+            if (c == ':') return true;
+            if (!is_alpha(c) && !is_digit(c) && c != '+' && c != '/' && c != '=') return false;
+        }
+        return false;
+    }
+
+    std::string_view input_;
+    size_t pos_ = 0;
+};
+
+} // namespace
+
+bool parse_priority_field(std::string_view value, StreamPriority& priority) {
+    StreamPriority parsed = priority;
+    FieldCursor cursor(value);
+    cursor.skip_sp();
+    while (!cursor.at_end()) {
+        auto key = cursor.parse_key();
+        if (!key) return false;
+
+        // A member without "=" is Boolean true (RFC 8941 Section 3.2), e.g. plain "i".
+        std::optional<int64_t> integer;
+        std::optional<bool> boolean;
+        if (cursor.consume('=')) {
+            if (cursor.peek() == '(') {
+                if (!cursor.skip_inner_list()) return false;
+            } else if (!cursor.parse_bare_item(integer, boolean) || !cursor.skip_parameters()) {
+                return false;
+            }
+        } else {
+            boolean = true;
+            if (!cursor.skip_parameters()) return false;
+        }
+
+        // Later members override earlier ones with the same key; bad values are ignored.
+        if (*key == "u" && integer && *integer >= 0 && *integer < PRIORITY_URGENCY_LEVELS) {
+            parsed.urgency = static_cast<uint8_t>(*integer);
+        } else if (*key == "i" && boolean) {
+            parsed.incremental = *boolean;
+        }
+
+        cursor.skip_ows();
+        if (cursor.at_end()) break;
+        if (!cursor.consume(',')) return false;
+        cursor.skip_ows();
+        if (cursor.at_end()) return false; // Trailing comma
+    }
+    priority = parsed;
+    return true;
+}
+
+std::string format_priority_field(const StreamPriority& priority) {
+    std::string value;
+    if (priority.urgency != DEFAULT_PRIORITY_URGENCY) {
+        value = "u=";
+        value += static_cast<char>('0' + priority.urgency);
+    }
+    if (priority.incremental) {
+        if (!value.empty()) value += ", ";
+        value += "i";
+    }
+    return value;
+}
+
+} // namespace http2
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace http2 {
+
+// Extensible Prioritization Scheme for HTTP (RFC 9218).
+// A request's priority is carried in the `priority` header field and may be changed later with
+// PRIORITY_UPDATE frames. Both use the same Structured Field Dictionary (RFC 8941), e.g.
+//   priority: u=1, i
+constexpr uint8_t DEFAULT_PRIORITY_URGENCY = 3;
+constexpr uint8_t PRIORITY_URGENCY_LEVELS = 8; // Urgency 0 (highest) to 7 (lowest)
+
+struct StreamPriority {
+    uint8_t urgency = DEFAULT_PRIORITY_URGENCY;
+    bool incremental = false; // Response can be used in pieces: interleave with equal urgency
+
+    bool operator==(const StreamPriority&) const = default;
+};
+
+// Parses a Priority Field Value into `priority`, starting from the values already in it. Members
+// other than u and i, parameters, and u/i values of the wrong type or range are ignored
+// (RFC 9218 Section 4). Returns false, leaving `priority` untouched, if `value` is not a valid
+// Structured Field Dictionary. Works on the string_view in place; nothing is allocated.
+bool parse_priority_field(std::string_view value, StreamPriority& priority);
+
+// The shortest field value for `priority`: defaults are omitted, so the default priority gives "".
+std::string format_priority_field(const StreamPriority& priority);
+
+} // namespace http2
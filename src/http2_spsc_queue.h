@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace http2 {
+
+// Bounded lock-free queue for exactly one producer thread and one consumer thread.
+//
+// A ring of power-of-two size indexed by two free-running counters: the producer owns tail_, the
+// consumer head_. Each side also keeps a cached copy of the other's counter and only reloads it
+// (an acquire load of a line the other core is writing) when the cached value says the ring is
+// full or empty, so in steady state a push or pop touches no shared cache line besides the slot.
+// The producer's and consumer's members live on separate cache lines to avoid false sharing.
+template <typename T>
+class SpscQueue {
+public:
+    // Capacity is rounded up to a power of two.
+    explicit SpscQueue(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) size <<= 1;
+        mask_ = size - 1;
+        slots_ = std::make_unique<T[]>(size);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer only. Moves from `item` only when there is room.
+    bool try_push(T&& item) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - producer_cached_head_ > mask_) {
+            producer_cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail - producer_cached_head_ > mask_) return false;
+        }
+        slots_[tail & mask_] = std::move(item);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. The slot is left moved-from.
+    bool try_pop(T& item) {
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head == consumer_cached_tail_) {
+            consumer_cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head == consumer_cached_tail_) return false;
+        }
+        item = std::move(slots_[head & mask_]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate unless called from one of the two threads while the other is idle.
+    size_t size() const {
+        return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire));
+    }
+    bool empty() const { return size() == 0; }
+    size_t capacity() const { return mask_ + 1; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    size_t mask_ = 0;
+    std::unique_ptr<T[]> slots_;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail_{0};
+    uint64_t producer_cached_head_ = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head_{0};
+    uint64_t consumer_cached_tail_ = 0;
+};
+
+} // namespace http2
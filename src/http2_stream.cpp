@@ -102,6 +102,67 @@ int32_t Http2Stream::get_remote_window_size() const {
 }
 
 
+// --- Outgoing Data Queue ---
+
+void Http2Stream::enqueue_outgoing_data(std::vector<std::byte> data, bool end_stream) {
+    if (!data.empty()) {
+        outgoing_data_size_ += data.size();
+        outgoing_data_.push_back(std::move(data));
+    }
+    if (end_stream) {
+        outgoing_end_stream_ = true;
+    }
+}
+
+std::span<const std::byte> Http2Stream::front_outgoing_data() const {
+    if (outgoing_data_.empty()) {
+        return {};
+    }
+    return std::span<const std::byte>(outgoing_data_.front()).subspan(outgoing_front_offset_);
+}
+
+void Http2Stream::pop_outgoing_data(size_t size) {
+    while (size > 0 && !outgoing_data_.empty()) {
+        size_t available = outgoing_data_.front().size() - outgoing_front_offset_;
+        size_t n = std::min(size, available);
+        outgoing_front_offset_ += n;
+        outgoing_data_size_ -= n;
+        size -= n;
+        if (outgoing_front_offset_ == outgoing_data_.front().size()) {
+            outgoing_data_.pop_front();
+            outgoing_front_offset_ = 0;
+        }
+    }
+}
+
+void Http2Stream::clear_outgoing_data() {
+    outgoing_data_.clear();
+    outgoing_front_offset_ = 0;
+    outgoing_data_size_ = 0;
+    outgoing_end_stream_ = false;
+}
+
+Http2Stream::QueuedHeaders Http2Stream::take_queued_trailers() {
+    QueuedHeaders trailers = std::move(*queued_trailers_);
+    queued_trailers_.reset();
+    return trailers;
+}
+
+void Http2Stream::append_coalesced_data(std::span<const std::byte> data) {
+    if (coalesced_data_.empty()) {
+        coalesced_data_.reserve(write_coalescing_.min_frame_payload); // Typically filled up to the threshold
+        coalesced_since_ = std::chrono::steady_clock::now();
+    }
+    coalesced_data_.insert(coalesced_data_.end(), data.begin(), data.end());
+}
+
+std::vector<std::byte> Http2Stream::take_coalesced_data() {
+    std::vector<std::byte> data;
+    data.swap(coalesced_data_);
+    return data;
+}
+
+
 // --- State Transitions ---
 
 void Http2Stream::transition_to_open() {
@@ -110,6 +171,7 @@ void Http2Stream::transition_to_open() {
     //                  RESERVED_REMOTE -> OPEN (on receiving HEADERS for the promise)
     if (state_ == StreamState::IDLE || state_ == StreamState::RESERVED_LOCAL || state_ == StreamState::RESERVED_REMOTE) {
         state_ = StreamState::OPEN;
+        was_opened_ = true;
     }
     // Other transitions to OPEN are protocol errors.
 }
@@ -148,12 +210,16 @@ void Http2Stream::transition_to_closed() {
     // Flow control windows are irrelevant.
     local_window_size_ = 0;
     remote_window_size_ = 0;
+    clear_outgoing_data(); // Nothing more may be sent on a closed stream
+    queued_trailers_.reset();
+    coalesced_data_.clear();
 }
 
 void Http2Stream::transition_to_reserved_local() {
     // Valid transition: IDLE -> RESERVED_LOCAL (on sending PUSH_PROMISE)
     if (state_ == StreamState::IDLE) {
         state_ = StreamState::RESERVED_LOCAL;
+        was_opened_ = true;
     }
 }
 
@@ -161,6 +227,7 @@ void Http2Stream::transition_to_reserved_remote() {
     // Valid transition: IDLE -> RESERVED_REMOTE (on receiving PUSH_PROMISE)
     if (state_ == StreamState::IDLE) {
         state_ = StreamState::RESERVED_REMOTE;
+        was_opened_ = true;
     }
 }
 
@@ -2,11 +2,15 @@
 
 #include "http2_types.h"
 #include "http2_frame.h" // For HttpHeader, though ideally stream might not directly parse frames
+#include "http2_priority.h"
+#include <chrono>
 #include <cstdint>
 #include <vector>
 #include <string>
 #include <deque>
+#include <optional>
 #include <functional> // For callbacks, if needed at this level
+#include <span>
 
 namespace http2 {
 
@@ -21,6 +25,14 @@ enum class StreamState {
     CLOSED
 };
 
+// Merging of small send_data() writes into fewer DATA frames (Http2Connection::set_write_coalescing).
+// Writes are held back until together they reach min_frame_payload bytes, END_STREAM is sent,
+// the stream is flushed, or the oldest held byte has waited max_delay.
+struct WriteCoalescing {
+    size_t min_frame_payload = 0;                // 0 = disabled: every write is framed at once
+    std::chrono::microseconds max_delay{1000};   // Longest a byte may be held back
+};
+
 class Http2Stream {
 public:
     Http2Stream(stream_id_t id, uint32_t initial_local_window, uint32_t initial_remote_window);
@@ -52,6 +64,11 @@ public:
     int32_t get_local_window_size() const;
     int32_t get_remote_window_size() const; // Renamed from send_window_ for clarity
 
+    // Credit for consumed DATA not yet returned to the peer (batched consume_data()).
+    void add_pending_credit(uint32_t credit) { pending_credit_ += credit; }
+    uint32_t get_pending_credit() const { return pending_credit_; }
+    void remove_pending_credit(uint32_t credit) { pending_credit_ -= credit; } // Returned to the peer
+
     // --- State Transitions ---
     // These methods would be called by the Http2Connection or Http2Parser
     // when specific frames are sent or received.
@@ -66,11 +83,70 @@ public:
     void transition_to_reserved_remote(); // On receiving PUSH_PROMISE
 
 
-    // --- Data Handling (Conceptual) ---
-    // The stream might queue incoming data frames or outgoing data frames.
-    // This is a simplified view; actual data handling might be more complex.
-    // void enqueue_incoming_data(DataFrame data_frame);
-    // std::optional<DataFrame> dequeue_outgoing_data();
+    // --- Outgoing Data Queue ---
+    // DATA handed to Http2Connection::queue_data() that could not be sent yet because of flow control.
+    // The queue owns the buffers; they are framed directly from here once the windows open.
+    void enqueue_outgoing_data(std::vector<std::byte> data, bool end_stream);
+    // Unsent bytes of the oldest queued buffer (empty if no bytes are queued).
+    std::span<const std::byte> front_outgoing_data() const;
+    // Marks `size` bytes from the front of the queue as sent.
+    void pop_outgoing_data(size_t size);
+    bool has_outgoing_data() const { return outgoing_data_size_ > 0 || outgoing_end_stream_; }
+    size_t get_outgoing_data_size() const { return outgoing_data_size_; }
+    bool is_outgoing_end_stream_pending() const { return outgoing_end_stream_; }
+    void clear_outgoing_data();
+
+    // --- Queued Trailers ---
+    // A trailing HEADERS block handed to Http2Connection::send_headers() while DATA was still
+    // queued. It goes out once the queue drains. The fields stay unencoded until then so HPACK
+    // sees header blocks in wire order.
+    struct QueuedHeaders {
+        std::vector<std::byte> encoded_prefix;
+        std::vector<HttpHeader> headers;
+        std::vector<std::byte> encoded_suffix;
+        bool end_stream = false;
+        std::optional<PriorityData> priority;
+        std::optional<uint8_t> padding;
+    };
+    void queue_trailers(QueuedHeaders trailers) { queued_trailers_ = std::move(trailers); }
+    bool has_queued_trailers() const { return queued_trailers_.has_value(); }
+    QueuedHeaders take_queued_trailers();
+
+    // --- Write Coalescing ---
+    // Bytes from send_data() held back to be framed together with the next writes.
+    const WriteCoalescing& get_write_coalescing() const { return write_coalescing_; }
+    void set_write_coalescing(const WriteCoalescing& coalescing) { write_coalescing_ = coalescing; }
+    void append_coalesced_data(std::span<const std::byte> data);
+    std::vector<std::byte> take_coalesced_data();
+    const std::vector<std::byte>& get_coalesced_data() const { return coalesced_data_; }
+    // When the oldest held byte was written; meaningful only while get_coalesced_data() is non-empty.
+    std::chrono::steady_clock::time_point get_coalesced_since() const { return coalesced_since_; }
+
+    // --- CONNECT Tunnels (RFC 9113 Section 8.5, RFC 8441) ---
+    // A CONNECT stream carries only DATA after the request/response HEADERS exchange.
+    void mark_tunnel() { tunnel_ = true; }
+    void mark_tunnel_established() { tunnel_established_ = true; } // 2xx response sent/received
+    bool is_tunnel() const { return tunnel_; }
+    bool is_tunnel_established() const { return tunnel_established_; }
+
+    // --- Priority (RFC 9218) ---
+    // Orders this stream's queued DATA against other streams; see Http2Connection::set_stream_priority().
+    const StreamPriority& get_priority() const { return priority_; }
+    void set_priority(const StreamPriority& priority) { priority_ = priority; }
+
+    // The request (server) or final response (client) header block has arrived; any further
+    // HEADERS are trailers.
+    void mark_headers_received() { headers_received_ = true; }
+    bool has_received_headers() const { return headers_received_; }
+
+    // --- Application Context ---
+    // Opaque pointer owned by the application, e.g. its request object. It is handed to every
+    // Http2Connection stream event (see StreamEvents) so no stream-id lookup is needed per frame.
+    void* get_user_data() const { return user_data_; }
+    void set_user_data(void* user_data) { user_data_ = user_data; }
+    // Whether the stream ever left IDLE (opened or reserved), i.e. whether it is reported to
+    // StreamEvents::on_close when it goes away.
+    bool was_opened() const { return was_opened_; }
 
     // --- Header Handling (Conceptual) ---
     // Store received headers, potentially in a structured way.
@@ -90,11 +166,27 @@ private:
     // Remote window: controlled by peer, limits data we can send on this stream.
     // Peer sends WINDOW_UPDATE to increase it.
     int32_t remote_window_size_;
+    uint32_t pending_credit_ = 0;
+
+    // Outgoing DATA waiting for flow-control window.
+    std::deque<std::vector<std::byte>> outgoing_data_;
+    size_t outgoing_front_offset_ = 0; // Bytes of outgoing_data_.front() already sent
+    size_t outgoing_data_size_ = 0;    // Unsent bytes across the whole queue
+    bool outgoing_end_stream_ = false; // END_STREAM goes out with the last queued byte
+    std::optional<QueuedHeaders> queued_trailers_;
+
+    WriteCoalescing write_coalescing_;
+    std::vector<std::byte> coalesced_data_;
+    std::chrono::steady_clock::time_point coalesced_since_;
+
+    void* user_data_ = nullptr;
+    bool was_opened_ = false;
+
+    bool headers_received_ = false;
+    bool tunnel_ = false;
+    bool tunnel_established_ = false;
 
-    // Other stream-specific properties:
-    // - Priority information
-    // - Queued frames (incoming/outgoing)
-    // - Application-specific data associated with the stream
+    StreamPriority priority_;
 };
 
 } // namespace http2
@@ -0,0 +1,87 @@
+#include "http2_stream_splicer.h"
+
+namespace http2 {
+
+StreamSplicer::StreamSplicer(Http2Connection& source, Http2Connection& destination)
+    : source_(source), destination_(destination) {
+    source_.set_data_callback([this](stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream) {
+        on_source_data(stream_id, std::move(data), end_stream);
+    });
+    destination_.set_data_sent_callback([this](stream_id_t stream_id, size_t bytes_sent) {
+        on_destination_data_sent(stream_id, bytes_sent);
+    });
+}
+
+StreamSplicer::~StreamSplicer() {
+    source_.set_data_callback(nullptr);
+    destination_.set_data_sent_callback(nullptr);
+}
+
+void StreamSplicer::splice(stream_id_t source_stream_id, stream_id_t destination_stream_id) {
+    unsplice(source_stream_id);
+    splices_[source_stream_id] = Splice{destination_stream_id};
+    destination_to_source_[destination_stream_id] = source_stream_id;
+}
+
+void StreamSplicer::unsplice(stream_id_t source_stream_id) {
+    auto it = splices_.find(source_stream_id);
+    if (it == splices_.end()) return;
+    destination_to_source_.erase(it->second.destination_stream_id);
+    splices_.erase(it);
+}
+
+bool StreamSplicer::is_spliced(stream_id_t source_stream_id) const {
+    return splices_.contains(source_stream_id);
+}
+
+void StreamSplicer::on_source_data(stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream) {
+    auto it = splices_.find(stream_id);
+    if (it == splices_.end()) {
+        if (unspliced_data_cb_) unspliced_data_cb_(stream_id, std::move(data), end_stream);
+        return;
+    }
+
+    size_t size = data.size();
+    bytes_forwarded_ += size;
+    if (!destination_.queue_data(it->second.destination_stream_id, std::move(data), end_stream)) {
+        // The destination stream is gone (reset or closed): give back the connection credit
+        // so other streams are not starved, and cancel the source stream.
+        if (size > 0) {
+            source_.send_window_update_action(0, static_cast<uint32_t>(size));
+        }
+        source_.send_rst_stream_frame_action(stream_id, ErrorCode::CANCEL);
+        unsplice(stream_id);
+        return;
+    }
+
+    if (end_stream) {
+        // queue_data may already have flushed everything and re-entered on_destination_data_sent.
+        it = splices_.find(stream_id);
+        if (it == splices_.end()) return;
+        it->second.source_ended = true;
+        release_if_drained(stream_id);
+    }
+}
+
+void StreamSplicer::on_destination_data_sent(stream_id_t stream_id, size_t bytes_sent) {
+    auto it = destination_to_source_.find(stream_id);
+    if (it == destination_to_source_.end()) return;
+    stream_id_t source_stream_id = it->second;
+
+    // The destination peer accepted these bytes, so the source peer may send as many again.
+    source_.consume_data(source_stream_id, static_cast<uint32_t>(bytes_sent));
+    bytes_credited_ += bytes_sent;
+    release_if_drained(source_stream_id);
+}
+
+void StreamSplicer::release_if_drained(stream_id_t source_stream_id) {
+    auto it = splices_.find(source_stream_id);
+    if (it == splices_.end() || !it->second.source_ended) return;
+
+    const Http2Stream* destination_stream = destination_.get_stream(it->second.destination_stream_id);
+    if (!destination_stream || !destination_stream->has_outgoing_data()) {
+        unsplice(source_stream_id);
+    }
+}
+
+} // namespace http2
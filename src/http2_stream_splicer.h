@@ -0,0 +1,67 @@
+#pragma once
+
+#include "http2_types.h"
+#include "http2_connection.h"
+
+#include <map>
+#include <vector>
+#include <cstdint>
+
+namespace http2 {
+
+// Splices streams of one connection onto streams of another, e.g. for a reverse proxy forwarding
+// request bodies from the downstream (client-facing) connection to an upstream one.
+//
+// Received DATA payload buffers are moved from `source` into the `destination` stream's send queue
+// (Http2Connection::queue_data), so the payload is not copied on its way through the proxy.
+// Flow control is coupled: credit for spliced bytes is returned to the source peer
+// (Http2Connection::consume_data) only once the destination connection has actually sent them,
+// i.e. once the destination peer has opened its window. A slow upstream therefore back-pressures
+// the downstream sender instead of growing the proxy's buffers.
+//
+// A splicer owns the source's data callback and the destination's data-sent callback. For a
+// bidirectional proxy use two splicers, one per direction.
+class StreamSplicer {
+public:
+    StreamSplicer(Http2Connection& source, Http2Connection& destination);
+    ~StreamSplicer();
+
+    StreamSplicer(const StreamSplicer&) = delete;
+    StreamSplicer& operator=(const StreamSplicer&) = delete;
+
+    // Forwards DATA of source_stream_id to destination_stream_id. The destination stream must
+    // already be open (HEADERS sent) on the destination connection.
+    void splice(stream_id_t source_stream_id, stream_id_t destination_stream_id);
+    void unsplice(stream_id_t source_stream_id);
+    bool is_spliced(stream_id_t source_stream_id) const;
+    size_t get_spliced_stream_count() const { return splices_.size(); }
+
+    // DATA received on streams that are not spliced is passed on to this callback.
+    void set_unspliced_data_callback(Http2Connection::DataCallback cb) { unspliced_data_cb_ = std::move(cb); }
+
+    // Accounting, mainly for benchmarks and tests.
+    uint64_t get_bytes_forwarded() const { return bytes_forwarded_; }
+    uint64_t get_bytes_credited() const { return bytes_credited_; }
+
+private:
+    struct Splice {
+        stream_id_t destination_stream_id;
+        bool source_ended = false; // END_STREAM received and queued on the destination
+    };
+
+    void on_source_data(stream_id_t stream_id, std::vector<std::byte>&& data, bool end_stream);
+    void on_destination_data_sent(stream_id_t stream_id, size_t bytes_sent);
+    // Drops a splice once END_STREAM has been forwarded and nothing is left to send.
+    void release_if_drained(stream_id_t source_stream_id);
+
+    Http2Connection& source_;
+    Http2Connection& destination_;
+    std::map<stream_id_t, Splice> splices_;                  // By source stream id
+    std::map<stream_id_t, stream_id_t> destination_to_source_;
+    Http2Connection::DataCallback unspliced_data_cb_;
+
+    uint64_t bytes_forwarded_ = 0;
+    uint64_t bytes_credited_ = 0;
+};
+
+} // namespace http2
@@ -27,9 +27,18 @@ enum class FrameType : uint8_t {
     GOAWAY = 0x7,
     WINDOW_UPDATE = 0x8,
     CONTINUATION = 0x9,
-    // Add others if needed, e.g. ALTSVC, ORIGIN
+    ALTSVC = 0xa,  // RFC 7838 Section 4
+    ORIGIN = 0xc,  // RFC 8336
+    PRIORITY_UPDATE = 0x10, // RFC 9218 Section 7.1
 };
 
+// Frame types the library parses itself. Any other type is an extension frame (RFC 9113
+// Section 5.5): ignored, unless a handler for it is registered with the parser.
+constexpr bool is_known_frame_type(uint8_t type) {
+    return type <= static_cast<uint8_t>(FrameType::CONTINUATION) || type == static_cast<uint8_t>(FrameType::ALTSVC) ||
+           type == static_cast<uint8_t>(FrameType::ORIGIN) || type == static_cast<uint8_t>(FrameType::PRIORITY_UPDATE);
+}
+
 // Error Codes (RFC 7540 Section 7)
 enum class ErrorCode : uint32_t {
     NO_ERROR = 0x0,
@@ -54,6 +63,9 @@ struct HttpHeader {
     bool sensitive = false; // For HPACK
 };
 
+// Every frame starts with a 9-byte header: Length (24) | Type (8) | Flags (8) | R + Stream Identifier (32)
+constexpr size_t FRAME_HEADER_SIZE = 9;
+
 // Max frame size default and limits
 constexpr uint32_t DEFAULT_MAX_FRAME_SIZE = 16384; // 2^14
 constexpr uint32_t MAX_ALLOWED_FRAME_SIZE = 16777215; // 2^24 - 1
@@ -0,0 +1,162 @@
+#include "gtest/gtest.h"
+#include "grpc_message.h"
+#include <vector>
+#include <string>
+
+using namespace http2;
+
+namespace {
+
+std::vector<std::byte> to_bytes(const std::string& s) {
+    std::vector<std::byte> out;
+    for (char c : s) out.push_back(static_cast<std::byte>(c));
+    return out;
+}
+
+std::string to_string(std::span<const std::byte> bytes) {
+    std::string out;
+    for (std::byte b : bytes) out += static_cast<char>(b);
+    return out;
+}
+
+} // namespace
+
+class GrpcMessageDecoderTest : public ::testing::Test {
+protected:
+    GrpcMessageDecoder decoder;
+    std::vector<std::string> messages;
+    std::vector<bool> compressed_flags;
+    std::vector<const std::byte*> payload_pointers;
+
+    void SetUp() override {
+        decoder.set_message_callback([this](const GrpcMessage& message) {
+            messages.push_back(to_string(message.payload));
+            compressed_flags.push_back(message.compressed);
+            payload_pointers.push_back(message.payload.data());
+        });
+    }
+};
+
+TEST(GrpcMessageEncoderTest, EncodeMessagePrefix) {
+    auto bytes = GrpcMessageEncoder::encode_message(to_bytes("abc"), true);
+    ASSERT_EQ(bytes.size(), 8u);
+    EXPECT_EQ(bytes[0], std::byte(0x01));
+    EXPECT_EQ(bytes[1], std::byte(0x00));
+    EXPECT_EQ(bytes[4], std::byte(0x03));
+    EXPECT_EQ(to_string(std::span(bytes).subspan(5)), "abc");
+}
+
+TEST_F(GrpcMessageDecoderTest, ContiguousMessagesAreZeroCopy) {
+    std::vector<std::byte> data_payload;
+    GrpcMessageEncoder::encode_message_into(data_payload, to_bytes("hello"));
+    GrpcMessageEncoder::encode_message_into(data_payload, to_bytes("world"), true);
+
+    EXPECT_EQ(decoder.feed(data_payload), GrpcError::OK);
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0], "hello");
+    EXPECT_EQ(messages[1], "world");
+    EXPECT_FALSE(compressed_flags[0]);
+    EXPECT_TRUE(compressed_flags[1]);
+    // Spans point straight into the DATA payload.
+    EXPECT_EQ(payload_pointers[0], data_payload.data() + 5);
+    EXPECT_EQ(payload_pointers[1], data_payload.data() + 15);
+    EXPECT_EQ(decoder.get_bytes_copied(), 0u);
+    EXPECT_EQ(decoder.finish(), GrpcError::OK);
+}
+
+TEST_F(GrpcMessageDecoderTest, MessageStraddlingFramesIsReassembled) {
+    std::vector<std::byte> wire;
+    GrpcMessageEncoder::encode_message_into(wire, to_bytes("first"));
+    GrpcMessageEncoder::encode_message_into(wire, to_bytes("straddling-message"));
+
+    // Split in the middle of the second prefix, and again inside its body.
+    std::span<const std::byte> all(wire);
+    EXPECT_EQ(decoder.feed(all.first(12)), GrpcError::OK);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_TRUE(decoder.has_partial_message());
+    EXPECT_EQ(decoder.feed(all.subspan(12, 6)), GrpcError::OK);
+    EXPECT_EQ(decoder.finish(), GrpcError::INCOMPLETE_MESSAGE);
+    EXPECT_EQ(decoder.feed(all.subspan(18)), GrpcError::OK);
+
+    ASSERT_EQ(messages.size(), 2u);
+    EXPECT_EQ(messages[0], "first");
+    EXPECT_EQ(messages[1], "straddling-message");
+    EXPECT_EQ(decoder.get_messages_reassembled(), 1u);
+    EXPECT_EQ(decoder.get_bytes_copied(), std::string("straddling-message").size());
+    EXPECT_FALSE(decoder.has_partial_message());
+}
+
+TEST_F(GrpcMessageDecoderTest, EmptyMessageAcrossFrames) {
+    auto wire = GrpcMessageEncoder::encode_message({});
+    std::span<const std::byte> all(wire);
+    EXPECT_EQ(decoder.feed(all.first(3)), GrpcError::OK);
+    EXPECT_EQ(decoder.feed(all.subspan(3)), GrpcError::OK);
+    ASSERT_EQ(messages.size(), 1u);
+    EXPECT_TRUE(messages[0].empty());
+}
+
+TEST_F(GrpcMessageDecoderTest, RejectsInvalidPrefix) {
+    std::vector<std::byte> bad_flag = {std::byte(0x02), std::byte(0), std::byte(0), std::byte(0), std::byte(0)};
+    EXPECT_EQ(decoder.feed(bad_flag), GrpcError::INVALID_COMPRESSED_FLAG);
+
+    GrpcMessageDecoder small_decoder(4);
+    EXPECT_EQ(small_decoder.feed(GrpcMessageEncoder::encode_message(to_bytes("too long"))), GrpcError::MESSAGE_TOO_LARGE);
+}
+
+TEST_F(GrpcMessageDecoderTest, ReassemblyBufferGrowsWithReceivedBytes) {
+    // A prefix announcing a 4 MiB message and nothing else must not allocate 4 MiB.
+    std::vector<std::byte> prefix;
+    GrpcMessageEncoder::write_message_prefix(prefix, false, GRPC_DEFAULT_MAX_MESSAGE_SIZE);
+    ASSERT_EQ(decoder.feed(prefix), GrpcError::OK);
+    EXPECT_TRUE(decoder.has_partial_message());
+    EXPECT_LT(decoder.get_reassembly_capacity(), 1024u);
+
+    ASSERT_EQ(decoder.feed(std::vector<std::byte>(100, std::byte{'a'})), GrpcError::OK);
+    EXPECT_LT(decoder.get_reassembly_capacity(), 1024u);
+}
+
+TEST(GrpcStreamReaderTest, CloseStreamFromMessageCallback) {
+    GrpcStreamReader reader;
+    std::vector<std::string> received;
+    reader.set_message_callback([&](stream_id_t sid, const GrpcMessage& message) {
+        received.push_back(to_string(message.payload));
+        reader.close_stream(sid); // E.g. the handler rejects the call after its first message
+    });
+
+    std::vector<std::byte> data;
+    GrpcMessageEncoder::encode_message_into(data, to_bytes("first"));
+    GrpcMessageEncoder::encode_message_into(data, to_bytes("second"));
+    EXPECT_EQ(reader.on_data(1, data, false), GrpcError::OK);
+    EXPECT_EQ(received, (std::vector<std::string>{"first"}));
+    EXPECT_EQ(reader.get_active_stream_count(), 0u);
+
+    // A later stream starts from scratch.
+    EXPECT_EQ(reader.on_data(3, data, true), GrpcError::OK);
+    EXPECT_EQ(received.size(), 2u);
+}
+
+TEST(GrpcStreamReaderTest, DemultiplexesStreams) {
+    GrpcStreamReader reader;
+    std::vector<std::pair<stream_id_t, std::string>> received;
+    reader.set_message_callback([&](stream_id_t sid, const GrpcMessage& message) {
+        received.emplace_back(sid, to_string(message.payload));
+    });
+
+    auto a = GrpcMessageEncoder::encode_message(to_bytes("on-one"));
+    auto b = GrpcMessageEncoder::encode_message(to_bytes("on-three"));
+    std::span<const std::byte> a_span(a);
+
+    EXPECT_EQ(reader.on_data(1, a_span.first(7), false), GrpcError::OK);
+    EXPECT_EQ(reader.on_data(3, b, false), GrpcError::OK);
+    EXPECT_EQ(reader.get_active_stream_count(), 2u);
+    EXPECT_EQ(reader.on_data(1, a_span.subspan(7), true), GrpcError::OK);
+    EXPECT_EQ(reader.get_active_stream_count(), 1u);
+
+    ASSERT_EQ(received.size(), 2u);
+    EXPECT_EQ(received[0], std::make_pair(stream_id_t{3}, std::string("on-three")));
+    EXPECT_EQ(received[1], std::make_pair(stream_id_t{1}, std::string("on-one")));
+
+    // END_STREAM in the middle of a message is reported.
+    EXPECT_EQ(reader.on_data(3, a_span.first(4), true), GrpcError::INCOMPLETE_MESSAGE);
+    EXPECT_EQ(reader.get_active_stream_count(), 0u);
+}
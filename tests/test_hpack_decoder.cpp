@@ -228,6 +228,19 @@ TEST_F(HpackDecoderTest, DecodeIndexedHeaderFieldStatic) {
     EXPECT_FALSE(headers[0].sensitive);
 }
 
+TEST_F(HpackDecoderTest, StaticTableIsUsableAtCompileTime) {
+    static_assert(Hpack::STATIC_TABLE.size() == 61);
+    static_assert(Hpack::STATIC_TABLE[1].name == ":method" && Hpack::STATIC_TABLE[1].value == "GET");
+    static_assert(Hpack::find_in_static_table(":status", "404") == std::pair<int, bool>{13, true});
+    static_assert(Hpack::find_in_static_table(":status", "201") == std::pair<int, bool>{8, false});
+    static_assert(Hpack::find_in_static_table("x-custom", "") == std::pair<int, bool>{0, false});
+
+    auto header = Hpack::get_static_header(61);
+    ASSERT_TRUE(header.has_value());
+    EXPECT_EQ(header->name, "www-authenticate");
+    EXPECT_FALSE(Hpack::get_static_header(62).has_value());
+}
+
 TEST_F(HpackDecoderTest, DecodeIndexedHeaderFieldDynamic) {
     // First, add an entry to dynamic table: custom-key: custom-value
     // Literal with incremental indexing: 40 0A 637573746f6d2d6b6579 0C 637573746f6d2d76616c7565
@@ -533,6 +546,28 @@ TEST_F(HpackDecoderTest, DecodeErrorIndexOutOfBoundStatic) {
     EXPECT_EQ(err, HpackError::INDEX_OUT_OF_BOUNDS);
 }
 
+TEST_F(HpackDecoderTest, DecodeFullyIndexedBlock) {
+    // custom-key: custom-value goes into the dynamic table (index 62).
+    auto [setup_headers, setup_err] = decoder.decode(hex_to_bytes("400A637573746f6d2d6b65790C637573746f6d2d76616c7565"));
+    ASSERT_EQ(setup_err, HpackError::OK);
+
+    // A run of one-byte indices mixing static and dynamic entries, then a multi-byte one.
+    uint8_t data_arr[] = {0x82, 0x87, 0xBE, 0x84, 0xBE, 0x3F, 0xE1, 0x1F}; // ..., 0x3F.. is a size update: invalid here
+    auto [headers, err] = decoder.decode(make_byte_span(data_arr).first(5));
+    ASSERT_EQ(err, HpackError::OK);
+    check_headers(headers, {{":method", "GET"}, {":scheme", "https"}, {"custom-key", "custom-value"},
+                            {":path", "/"}, {"custom-key", "custom-value"}});
+    auto [rejected, update_err] = decoder.decode(make_byte_span(data_arr));
+    EXPECT_EQ(update_err, HpackError::COMPRESSION_ERROR);
+    EXPECT_EQ(rejected.size(), 5u);
+
+    // An index past the dynamic table stops the run.
+    uint8_t bad_arr[] = {0x82, 0xBF, 0x84};
+    auto [partial, bad_err] = decoder.decode(make_byte_span(bad_arr));
+    EXPECT_EQ(bad_err, HpackError::INDEX_OUT_OF_BOUNDS);
+    EXPECT_EQ(partial.size(), 1u);
+}
+
 TEST_F(HpackDecoderTest, DecodeErrorDynamicTableUpdateNotAtStart) {
     // Add a header first
     std::vector<std::byte> h1_bytes = hex_to_bytes("40056e616d65310676616c756531"); // name1:value1
@@ -2,6 +2,8 @@
 #include "hpack_encoder.h"
 #include "hpack_static_table.h" // For checking against static table
 #include "hpack_huffman.h"   // For huffman details
+#include "hpack_static_encode.h"
+#include "hpack_decoder.h"
 #include <vector>
 #include <string>
 #include <numeric> // for std::iota
@@ -208,6 +210,52 @@ TEST_F(HpackEncoderTest, RFCApdxD24_LiteralIncremental) {
     EXPECT_EQ(encoder.get_current_dynamic_table_size(), 57 + (32+13+8) + (32+10+12));
 }
 
+constexpr auto GRPC_REQUEST_PSEUDO = Hpack::static_encode<
+    Hpack::StaticHeader<":method", "POST">, Hpack::StaticHeader<":scheme", "https">>();
+constexpr auto GRPC_REQUEST_FIELDS = Hpack::static_encode<
+    Hpack::StaticHeader<"content-type", "application/grpc">, Hpack::StaticHeader<"te", "trailers">>();
+
+// :method POST -> 83, :scheme https -> 87, content-type (static name 31) -> 0f 10 + literal value,
+// te (no static entry) -> 00 + literal name + literal value.
+constexpr bool starts_with_bytes(std::span<const std::byte> block, std::initializer_list<uint8_t> expected) {
+    size_t i = 0;
+    for (uint8_t b : expected) {
+        if (i >= block.size() || block[i++] != static_cast<std::byte>(b)) return false;
+    }
+    return true;
+}
+static_assert(GRPC_REQUEST_PSEUDO.size() == 2);
+static_assert(starts_with_bytes(GRPC_REQUEST_PSEUDO, {0x83, 0x87}));
+static_assert(GRPC_REQUEST_FIELDS.size() == 3 + 16 + 2 + 2 + 1 + 8);
+static_assert(starts_with_bytes(GRPC_REQUEST_FIELDS, {0x0f, 0x10, 0x10, 'a'}));
+static_assert(GRPC_REQUEST_FIELDS.bytes[19] == std::byte{0x00} && GRPC_REQUEST_FIELDS.bytes[20] == std::byte{0x02});
+static_assert(Hpack::static_encode<>().size() == 0);
+static_assert(!Hpack::detail::pseudo_headers_first({"content-type", ":path"}));
+
+TEST_F(HpackEncoderTest, StaticEncodeConcatenatesWithEncoderOutput) {
+    // Pseudo-header fields first (RFC 9113 Section 8.3): the fixed ones, then the per-request ones,
+    // then the fixed regular fields.
+    auto [dynamic_part, err] = encoder.encode({{":path", "/helloworld.Greeter/SayHello"}, {":authority", "example.com"}});
+    ASSERT_EQ(err, HpackEncodingError::OK);
+    std::vector<std::byte> block(GRPC_REQUEST_PSEUDO.bytes.begin(), GRPC_REQUEST_PSEUDO.bytes.end());
+    block.insert(block.end(), dynamic_part.begin(), dynamic_part.end());
+    block.insert(block.end(), GRPC_REQUEST_FIELDS.bytes.begin(), GRPC_REQUEST_FIELDS.bytes.end());
+
+    HpackDecoder decoder;
+    auto [headers, decode_err] = decoder.decode(block);
+    ASSERT_EQ(decode_err, HpackError::OK);
+    ASSERT_EQ(headers.size(), 6u);
+    EXPECT_EQ(headers[0].value, "POST");
+    EXPECT_EQ(headers[2].value, "/helloworld.Greeter/SayHello");
+    EXPECT_EQ(headers[3].value, "example.com");
+    EXPECT_EQ(headers[4].name, "content-type");
+    EXPECT_EQ(headers[4].value, "application/grpc");
+    EXPECT_EQ(headers[5].name, "te");
+    EXPECT_EQ(headers[5].value, "trailers");
+    // The prefix never touches the dynamic table; only the encoder's own entries are there.
+    EXPECT_EQ(decoder.get_current_dynamic_table_size(), encoder.get_current_dynamic_table_size());
+}
+
 // Add more tests, especially for Huffman decision making and edge cases for table sizes.
 
 // This main is needed if we build this test file as a standalone executable.
@@ -0,0 +1,63 @@
+#include "gtest/gtest.h"
+#include "hpack_intern_pool.h"
+#include "hpack_decoder.h"
+#include <string>
+#include <vector>
+
+using namespace http2;
+
+namespace {
+
+// Literal Header Field with Incremental Indexing, new name (strings shorter than 127 bytes).
+std::vector<std::byte> indexed_literal(const std::string& name, const std::string& value) {
+    std::vector<std::byte> out = {std::byte{0x40}, static_cast<std::byte>(name.size())};
+    for (char c : name) out.push_back(static_cast<std::byte>(c));
+    out.push_back(static_cast<std::byte>(value.size()));
+    for (char c : value) out.push_back(static_cast<std::byte>(c));
+    return out;
+}
+
+} // namespace
+
+TEST(HeaderInternPoolTest, DecodersShareDynamicTableStrings) {
+    HeaderInternPool pool({.max_string_length = 64});
+    const std::string user_agent = "grpc-go/1.62.0";
+    const std::string long_value(100, 'x');
+    auto block = indexed_literal("user-agent", user_agent);
+    auto long_entry = indexed_literal("x-trace", long_value);
+    block.insert(block.end(), long_entry.begin(), long_entry.end());
+
+    std::vector<HpackDecoder> decoders(3);
+    for (auto& decoder : decoders) {
+        decoder.set_intern_pool(&pool);
+        auto [headers, err] = decoder.decode(block);
+        ASSERT_EQ(err, HpackError::OK);
+        ASSERT_EQ(headers.size(), 2u);
+        EXPECT_EQ(headers[0].value, user_agent);
+    }
+
+    // One copy each of "user-agent", the user agent and "x-trace"; the long value is not pooled.
+    EXPECT_EQ(pool.get_entry_count(), 3u);
+    EXPECT_EQ(pool.get_pooled_bytes(), 10u + user_agent.size() + 7u);
+    EXPECT_EQ(pool.get_saved_bytes(), 2 * (10u + user_agent.size() + 7u));
+    EXPECT_EQ(pool.get_hit_count(), 6u);
+
+    // Indexed references resolve through the pooled strings.
+    const uint8_t indexed[] = {0xBE, 0xBF}; // 62: x-trace, 63: user-agent
+    auto [headers, err] = decoders[0].decode(std::as_bytes(std::span<const uint8_t>(indexed)));
+    ASSERT_EQ(err, HpackError::OK);
+    ASSERT_EQ(headers.size(), 2u);
+    EXPECT_EQ(headers[0].value, long_value);
+    EXPECT_EQ(headers[1].name, "user-agent");
+    EXPECT_EQ(headers[1].value, user_agent);
+
+    // Strings stay pooled while any table refers to them.
+    EXPECT_EQ(pool.collect(), 0u);
+    decoders.pop_back();
+    decoders.pop_back();
+    EXPECT_EQ(pool.collect(), 0u);
+    decoders[0].set_max_dynamic_table_size(0); // Evicts everything
+    EXPECT_EQ(pool.collect(), 3u);
+    EXPECT_EQ(pool.get_entry_count(), 0u);
+    EXPECT_EQ(pool.get_pooled_bytes(), 0u);
+}
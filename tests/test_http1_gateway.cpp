@@ -0,0 +1,271 @@
+#include "gtest/gtest.h"
+#include "http1_gateway.h"
+#include "http2_connection.h"
+#include <string>
+#include <vector>
+
+using namespace http2;
+
+namespace {
+
+std::span<const std::byte> as_bytes(std::string_view s) {
+    return {reinterpret_cast<const std::byte*>(s.data()), s.size()};
+}
+
+std::string to_string(std::span<const std::byte> bytes) {
+    return std::string(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+}
+
+} // namespace
+
+class Http1RequestParserTest : public ::testing::Test {
+protected:
+    Http1RequestParser parser;
+    std::vector<std::string> heads; // "METHOD target name=value;..."
+    std::string body;
+    std::vector<const std::byte*> body_pointers;
+    int completed = 0;
+
+    void SetUp() override {
+        parser.set_request_head_callback([this](const Http1RequestHead& head) {
+            std::string s = std::string(head.method) + " " + std::string(head.target);
+            for (const auto& h : head.headers) {
+                s += " " + std::string(h.name) + "=" + std::string(h.value) + ";";
+            }
+            heads.push_back(s);
+        });
+        parser.set_body_callback([this](std::span<const std::byte> data) {
+            body += to_string(data);
+            body_pointers.push_back(data.data());
+        });
+        parser.set_message_complete_callback([this]() { ++completed; });
+    }
+};
+
+TEST_F(Http1RequestParserTest, ContentLengthBodyIsNotCopied) {
+    std::string_view request = "POST /upload HTTP/1.1\r\nHost: example.com\r\nContent-Length: 5\r\nX-Trace:  abc \r\n\r\nhello";
+    auto [consumed, err] = parser.feed(as_bytes(request));
+    EXPECT_EQ(err, Http1Error::OK);
+    EXPECT_EQ(consumed, request.size());
+    ASSERT_EQ(heads.size(), 1u);
+    EXPECT_EQ(heads[0], "POST /upload host=example.com; content-length=5; x-trace=abc;");
+    EXPECT_EQ(body, "hello");
+    ASSERT_EQ(body_pointers.size(), 1u);
+    EXPECT_EQ(body_pointers[0], as_bytes(request).data() + request.size() - 5);
+    EXPECT_EQ(completed, 1);
+    EXPECT_TRUE(parser.is_idle());
+}
+
+TEST_F(Http1RequestParserTest, ChunkedBodyFedByteByByte) {
+    std::string_view request =
+        "PUT /x HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+        "5;ext=1\r\nhello\r\nA\r\n, world!!!\r\n0\r\nTrailer: t\r\n\r\n"
+        "GET /next HTTP/1.1\r\n\r\n"; // Pipelined
+    for (size_t i = 0; i < request.size(); ++i) {
+        auto [consumed, err] = parser.feed(as_bytes(request.substr(i, 1)));
+        ASSERT_EQ(err, Http1Error::OK) << "at offset " << i;
+    }
+    ASSERT_EQ(heads.size(), 2u);
+    EXPECT_EQ(heads[0], "PUT /x transfer-encoding=chunked;");
+    EXPECT_EQ(heads[1], "GET /next");
+    EXPECT_EQ(body, "hello, world!!!");
+    EXPECT_EQ(completed, 2);
+}
+
+TEST_F(Http1RequestParserTest, RejectsAmbiguousFraming) {
+    auto [c1, e1] = parser.feed(as_bytes("POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n"));
+    EXPECT_EQ(e1, Http1Error::AMBIGUOUS_BODY_LENGTH);
+
+    parser.reset();
+    auto [c2, e2] = parser.feed(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n"));
+    EXPECT_EQ(e2, Http1Error::INVALID_CHUNK);
+
+    parser.reset();
+    auto [c3, e3] = parser.feed(as_bytes("GET / HTTP/2.0\r\n\r\n"));
+    EXPECT_EQ(e3, Http1Error::INVALID_REQUEST_LINE);
+}
+
+TEST_F(Http1RequestParserTest, RejectsCrInsideChunkSizeLine) {
+    // Read leniently, "1\r2" would be chunk size 0x12 here and 1 elsewhere.
+    auto [c1, e1] = parser.feed(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r2\r\n"));
+    EXPECT_EQ(e1, Http1Error::INVALID_CHUNK);
+
+    parser.reset();
+    auto [c2, e2] = parser.feed(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1\r"));
+    EXPECT_EQ(e2, Http1Error::OK);
+    auto [c3, e3] = parser.feed(as_bytes("2\r\n")); // CR and the next byte in separate reads
+    EXPECT_EQ(e3, Http1Error::INVALID_CHUNK);
+
+    parser.reset();
+    auto [c4, e4] = parser.feed(as_bytes("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n1;a=\rb\r\n"));
+    EXPECT_EQ(e4, Http1Error::INVALID_CHUNK);
+}
+
+TEST_F(Http1RequestParserTest, RejectsControlCharactersInValuesAndTarget) {
+    // A bare LF would smuggle a second field into the upstream HEADERS.
+    auto [c1, e1] = parser.feed(as_bytes("POST / HTTP/1.1\r\nX: a\nTransfer-Encoding: chunked\r\n\r\n"));
+    EXPECT_EQ(e1, Http1Error::INVALID_HEADER);
+
+    parser.reset();
+    auto [c2, e2] = parser.feed(as_bytes("GET / HTTP/1.1\r\nX: a\rb\r\n\r\n"));
+    EXPECT_EQ(e2, Http1Error::INVALID_HEADER);
+
+    parser.reset();
+    std::string nul_value = "GET / HTTP/1.1\r\nX: a";
+    nul_value += '\0';
+    nul_value += "b\r\n\r\n";
+    auto [c3, e3] = parser.feed(as_bytes(nul_value));
+    EXPECT_EQ(e3, Http1Error::INVALID_HEADER);
+
+    parser.reset();
+    auto [c4, e4] = parser.feed(as_bytes("GET /a\nb HTTP/1.1\r\n\r\n"));
+    EXPECT_EQ(e4, Http1Error::INVALID_REQUEST_LINE);
+
+    parser.reset();
+    std::string nul_target = "GET /a";
+    nul_target += '\0';
+    nul_target += " HTTP/1.1\r\n\r\n";
+    auto [c5, e5] = parser.feed(as_bytes(nul_target));
+    EXPECT_EQ(e5, Http1Error::INVALID_REQUEST_LINE);
+}
+
+TEST(Http1SerializerTest, ResponseHeadSkipsPseudoHeaders) {
+    std::vector<std::byte> out;
+    Http1Serializer::write_response_head(out, 404, {{":status", "404"}, {"content-type", "text/plain"}}, true);
+    EXPECT_EQ(to_string(out), "HTTP/1.1 404 Not Found\r\ncontent-type: text/plain\r\ntransfer-encoding: chunked\r\n\r\n");
+
+    out.clear();
+    Http1Serializer::write_chunk_header(out, 255);
+    Http1Serializer::write_last_chunk(out, {});
+    EXPECT_EQ(to_string(out), "ff\r\n0\r\n\r\n");
+}
+
+TEST(Http1GatewayTest, TranslatesRequestAndResponse) {
+    Http2Connection upstream(false);
+    Http2Connection origin(true);
+    std::vector<std::byte> to_origin, to_gateway;
+    upstream.set_on_send_bytes([&](std::vector<std::byte> b) { to_origin.insert(to_origin.end(), b.begin(), b.end()); });
+    origin.set_on_send_bytes([&](std::vector<std::byte> b) { to_gateway.insert(to_gateway.end(), b.begin(), b.end()); });
+
+    std::vector<HttpHeader> origin_request_headers;
+    std::string origin_body;
+    origin.set_frame_callback([&](const AnyHttp2Frame& frame) {
+        if (const auto* hf = frame.get_if<HeadersFrame>()) origin_request_headers = hf->headers;
+        if (const auto* df = frame.get_if<DataFrame>()) origin_body += to_string(df->data);
+    });
+
+    Http1Gateway gateway(upstream);
+    std::string client_output;
+    gateway.set_client_send_callback([&](Http1Gateway::SessionId, std::span<const std::byte> bytes) {
+        client_output += to_string(bytes);
+    });
+
+    auto session = gateway.open_session();
+    EXPECT_EQ(gateway.on_client_data(session, as_bytes(
+        "POST /api HTTP/1.1\r\nHost: backend\r\nConnection: keep-alive, x-hop\r\nX-Hop: 1\r\nAccept: */*\r\nContent-Length: 4\r\n\r\nping")),
+        Http1Error::OK);
+    origin.process_incoming_data(to_origin);
+    to_origin.clear();
+
+    std::vector<std::pair<std::string, std::string>> got;
+    for (const auto& h : origin_request_headers) got.emplace_back(h.name, h.value);
+    std::vector<std::pair<std::string, std::string>> expected = {
+        {":method", "POST"}, {":scheme", "http"}, {":path", "/api"}, {":authority", "backend"},
+        {"accept", "*/*"}, {"content-length", "4"}};
+    EXPECT_EQ(got, expected);
+    EXPECT_EQ(origin_body, "ping");
+    EXPECT_EQ(gateway.get_active_stream_count(), 1u);
+
+    // Response without content-length becomes chunked.
+    ASSERT_TRUE(origin.send_headers(1, {{":status", "200"}, {"server", "origin"}}, false));
+    std::vector<std::byte> pong = {std::byte('p'), std::byte('o'), std::byte('n'), std::byte('g')};
+    ASSERT_TRUE(origin.send_data(1, pong, true));
+    upstream.process_incoming_data(to_gateway);
+
+    EXPECT_EQ(client_output, "HTTP/1.1 200 OK\r\nserver: origin\r\ntransfer-encoding: chunked\r\n\r\n4\r\npong\r\n0\r\n\r\n");
+    EXPECT_EQ(gateway.get_active_stream_count(), 0u);
+}
+
+class Http1GatewayOriginTest : public ::testing::Test {
+protected:
+    Http2Connection upstream{false};
+    Http2Connection origin{true};
+    Http1Gateway gateway{upstream};
+    std::vector<std::byte> to_origin, to_gateway;
+    std::vector<stream_id_t> origin_streams;
+    std::string client_output;
+    int client_closes = 0;
+
+    void SetUp() override {
+        upstream.set_on_send_bytes([this](std::vector<std::byte> b) { to_origin.insert(to_origin.end(), b.begin(), b.end()); });
+        origin.set_on_send_bytes([this](std::vector<std::byte> b) { to_gateway.insert(to_gateway.end(), b.begin(), b.end()); });
+        origin.set_stream_events({
+            .on_headers = [this](stream_id_t sid, void*, const std::vector<HttpHeader>&, bool) { origin_streams.push_back(sid); },
+        });
+        gateway.set_client_send_callback([this](Http1Gateway::SessionId, std::span<const std::byte> bytes) {
+            client_output += to_string(bytes);
+        });
+        gateway.set_client_close_callback([this](Http1Gateway::SessionId session) {
+            ++client_closes;
+            gateway.close_session(session);
+        });
+    }
+
+    void to_origin_side() { origin.process_incoming_data(to_origin); to_origin.clear(); }
+    void to_gateway_side() { upstream.process_incoming_data(to_gateway); to_gateway.clear(); }
+};
+
+TEST_F(Http1GatewayOriginTest, ResponseHeadersSplitOverContinuation) {
+    auto session = gateway.open_session();
+    ASSERT_EQ(gateway.on_client_data(session, as_bytes("GET / HTTP/1.1\r\nHost: backend\r\n\r\n")), Http1Error::OK);
+    to_origin_side();
+    ASSERT_EQ(origin_streams, (std::vector<stream_id_t>{1}));
+
+    std::string cookie(2 * DEFAULT_MAX_FRAME_SIZE, 'c'); // HEADERS + CONTINUATION
+    ASSERT_TRUE(origin.send_headers(1, {{":status", "200"}, {"set-cookie", cookie}, {"content-length", "0"}}, true));
+    ASSERT_GT(to_gateway.size(), 9 + DEFAULT_MAX_FRAME_SIZE + 9);
+    EXPECT_EQ(to_gateway[9 + DEFAULT_MAX_FRAME_SIZE + 3], static_cast<std::byte>(FrameType::CONTINUATION));
+    to_gateway_side();
+
+    EXPECT_EQ(client_output, "HTTP/1.1 200 OK\r\nset-cookie: " + cookie + "\r\ncontent-length: 0\r\n\r\n");
+    EXPECT_EQ(gateway.get_active_stream_count(), 0u);
+}
+
+TEST_F(Http1GatewayOriginTest, Http10ResponseIsCloseDelimited) {
+    auto session = gateway.open_session();
+    // HTTP/1.0 without keep-alive: the second request is never forwarded.
+    ASSERT_EQ(gateway.on_client_data(session, as_bytes("GET /a HTTP/1.0\r\nHost: b\r\n\r\nGET /b HTTP/1.0\r\nHost: b\r\n\r\n")),
+              Http1Error::OK);
+    to_origin_side();
+    EXPECT_EQ(origin_streams, (std::vector<stream_id_t>{1}));
+
+    ASSERT_TRUE(origin.send_headers(1, {{":status", "200"}}, false));
+    std::vector<std::byte> body = {std::byte('o'), std::byte('k')};
+    ASSERT_TRUE(origin.send_data(1, body, true));
+    to_gateway_side();
+
+    EXPECT_EQ(client_output, "HTTP/1.1 200 OK\r\nconnection: close\r\n\r\nok");
+    EXPECT_EQ(client_closes, 1);
+    EXPECT_EQ(gateway.get_session_count(), 0u);
+}
+
+TEST_F(Http1GatewayOriginTest, ConnectionCloseEndsSessionAfterResponse) {
+    auto session = gateway.open_session();
+    ASSERT_EQ(gateway.on_client_data(session, as_bytes(
+        "GET /a HTTP/1.1\r\nHost: b\r\n\r\nGET /b HTTP/1.1\r\nHost: b\r\nConnection: close\r\n\r\nGET /c HTTP/1.1\r\nHost: b\r\n\r\n")),
+        Http1Error::OK);
+    to_origin_side();
+    EXPECT_EQ(origin_streams, (std::vector<stream_id_t>{1, 3}));
+
+    // The second response arrives first and waits behind the first; chunked stays available to HTTP/1.1.
+    ASSERT_TRUE(origin.send_headers(3, {{":status", "200"}}, true));
+    to_gateway_side();
+    EXPECT_EQ(client_output, "");
+    ASSERT_TRUE(origin.send_headers(1, {{":status", "204"}}, true));
+    to_gateway_side();
+
+    EXPECT_EQ(client_output, "HTTP/1.1 204 No Content\r\n\r\n"
+                             "HTTP/1.1 200 OK\r\ntransfer-encoding: chunked\r\nconnection: close\r\n\r\n0\r\n\r\n");
+    EXPECT_EQ(client_closes, 1);
+    EXPECT_EQ(gateway.get_session_count(), 0u);
+}
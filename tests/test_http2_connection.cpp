@@ -4,8 +4,10 @@
 #include "http2_parser.h" // For ParserError enum if needed
 #include <vector>
 #include <cstring> // for memcpy
+#include <memory>
 #include <numeric>
 #include "http2_frame_serializer.h"
+#include "hpack_static_encode.h"
 
 using namespace http2;
 
@@ -822,8 +824,664 @@ TEST_F(Http2ConnectionTest, PushPromise) {
     EXPECT_EQ(promised_stream->get_state(), StreamState::CLOSED);
 }
 
+TEST_F(Http2ConnectionTest, QueuedDataResumesOnWindowUpdate) {
+    std::vector<FrameSentInfo> sent_frames_capture;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> bytes){
+        sent_frames_capture.emplace_back(bytes);
+    });
+    size_t reported_sent = 0;
+    client_conn.set_data_sent_callback([&](stream_id_t sid, size_t bytes_sent){
+        EXPECT_EQ(sid, 1u);
+        reported_sent += bytes_sent;
+    });
+
+    client_conn.send_headers(1, make_headers_for_test({{":method", "POST"}}), false);
+    sent_frames_capture.clear();
+
+    // 70000 bytes against a 65535 window: the tail waits on the stream.
+    ASSERT_TRUE(client_conn.queue_data(1, std::vector<std::byte>(70000, std::byte{0x61}), true));
+    EXPECT_EQ(reported_sent, DEFAULT_INITIAL_WINDOW_SIZE);
+    ASSERT_NE(client_conn.get_stream(1), nullptr);
+    EXPECT_EQ(client_conn.get_stream(1)->get_outgoing_data_size(), 70000u - DEFAULT_INITIAL_WINDOW_SIZE);
+    for (const auto& fi : sent_frames_capture) {
+        EXPECT_EQ(fi.type, FrameType::DATA);
+        EXPECT_EQ(fi.flags & DataFrame::END_STREAM_FLAG, 0);
+    }
+    sent_frames_capture.clear();
+
+    // Peer opens both windows.
+    std::vector<std::byte> increment = {std::byte(0x00), std::byte(0x00), std::byte(0x27), std::byte(0x10)}; // 10000
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 0, increment));
+    EXPECT_TRUE(sent_frames_capture.empty()); // Stream window still closed
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 1, increment));
+
+    ASSERT_EQ(sent_frames_capture.size(), 1u);
+    EXPECT_EQ(sent_frames_capture[0].payload.size(), 70000u - DEFAULT_INITIAL_WINDOW_SIZE);
+    EXPECT_TRUE(sent_frames_capture[0].flags & DataFrame::END_STREAM_FLAG);
+    EXPECT_EQ(reported_sent, 70000u);
+}
+
+TEST_F(Http2ConnectionTest, ConsumeDataReturnsCredit) {
+    server_conn.set_on_send_bytes([this](std::vector<std::byte> bytes){
+        on_send_bytes_data.push_back(std::move(bytes));
+    });
+    server_conn.process_incoming_data(
+        construct_frame_bytes(1, FrameType::HEADERS, HeadersFrame::END_HEADERS_FLAG, 1, {std::byte(0x82)}));
+    std::vector<std::byte> data_payload(100, std::byte{0x00});
+    server_conn.process_incoming_data(construct_frame_bytes(100, FrameType::DATA, 0, 1, data_payload));
+    ASSERT_EQ(server_conn.get_local_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE - 100));
+    EXPECT_EQ(server_conn.get_unconsumed_data_size(), 100u);
+
+    // Credit beyond the largest window is refused and the data stays accounted as unconsumed.
+    EXPECT_FALSE(server_conn.consume_data(1, MAX_ALLOWED_WINDOW_SIZE + 1u));
+    EXPECT_EQ(server_conn.get_unconsumed_data_size(), 100u);
+    EXPECT_TRUE(on_send_bytes_data.empty());
+
+    ASSERT_TRUE(server_conn.consume_data(1, 100));
+    EXPECT_EQ(server_conn.get_unconsumed_data_size(), 0u);
+    ASSERT_EQ(on_send_bytes_data.size(), 2u); // Connection + stream WINDOW_UPDATE
+    EXPECT_EQ(server_conn.get_local_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE));
+    EXPECT_EQ(server_conn.get_stream(1)->get_local_window_size(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE));
+}
+
+TEST_F(Http2ConnectionTest, ExtendedConnectTunnel) {
+    std::vector<std::byte> to_server, to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+    std::vector<ErrorCode> server_resets;
+    server_conn.set_on_send_rst_stream([&](stream_id_t, ErrorCode code) { server_resets.push_back(code); });
+    auto deliver = [](std::vector<std::byte>& pipe, Http2Connection& to) {
+        std::vector<std::byte> bytes;
+        bytes.swap(pipe);
+        to.process_incoming_data(bytes);
+    };
+
+    std::vector<HttpHeader> websocket = {{":method", "CONNECT"}, {":protocol", "websocket"}, {":scheme", "https"},
+                                         {":path", "/chat"}, {":authority", "example.com"}};
+    ASSERT_TRUE(is_extended_connect_request(websocket));
+
+    // :protocol is refused until the server has advertised SETTINGS_ENABLE_CONNECT_PROTOCOL.
+    EXPECT_FALSE(client_conn.send_headers(1, websocket, false));
+    server_conn.apply_local_setting({SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL, 1});
+    ASSERT_TRUE(server_conn.send_settings({{SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL, 1}}));
+    deliver(to_client, client_conn);
+    EXPECT_TRUE(client_conn.get_remote_settings().enable_connect_protocol);
+
+    ASSERT_TRUE(client_conn.send_headers(1, websocket, false));
+    deliver(to_server, server_conn);
+    ASSERT_NE(server_conn.get_stream(1), nullptr);
+    EXPECT_TRUE(server_conn.get_stream(1)->is_tunnel());
+    ASSERT_TRUE(server_conn.send_headers(1, {{":status", "200"}}, false));
+    deliver(to_client, client_conn);
+    EXPECT_TRUE(client_conn.get_stream(1)->is_tunnel_established());
+
+    // Both directions carry DATA; further HEADERS are not allowed on the tunnel.
+    std::string client_received, server_received;
+    client_conn.set_data_callback([&](stream_id_t, std::vector<std::byte>&& d, bool) { client_received.append(reinterpret_cast<const char*>(d.data()), d.size()); });
+    server_conn.set_data_callback([&](stream_id_t, std::vector<std::byte>&& d, bool) { server_received.append(reinterpret_cast<const char*>(d.data()), d.size()); });
+    std::vector<std::byte> ping = {std::byte('p'), std::byte('i'), std::byte('n'), std::byte('g')};
+    std::vector<std::byte> pong = {std::byte('p'), std::byte('o'), std::byte('n'), std::byte('g')};
+    ASSERT_TRUE(client_conn.send_data(1, ping, false));
+    ASSERT_TRUE(server_conn.send_data(1, pong, false));
+    deliver(to_server, server_conn);
+    deliver(to_client, client_conn);
+    EXPECT_EQ(server_received, "ping");
+    EXPECT_EQ(client_received, "pong");
+    EXPECT_FALSE(client_conn.send_headers(1, {{"x-trailer", "1"}}, true));
+    EXPECT_FALSE(server_conn.send_headers(1, {{"x-trailer", "1"}}, true));
+    EXPECT_TRUE(server_resets.empty());
+
+    // Plain CONNECT must not carry :scheme or :path.
+    std::vector<HttpHeader> bad_connect = {{":method", "CONNECT"}, {":authority", "example.com:443"}, {":path", "/"}};
+    EXPECT_FALSE(client_conn.send_headers(3, bad_connect, false));
+
+    // A server that never enabled the extension resets extended CONNECT streams.
+    Http2Connection other_client(false), other_server(true);
+    std::vector<std::byte> to_other_server;
+    other_client.set_on_send_bytes([&](std::vector<std::byte> b) { to_other_server.insert(to_other_server.end(), b.begin(), b.end()); });
+    other_server.set_on_send_rst_stream([&](stream_id_t, ErrorCode code) { server_resets.push_back(code); });
+    other_client.apply_remote_setting({SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL, 1});
+    ASSERT_TRUE(other_client.send_headers(1, websocket, false));
+    deliver(to_other_server, other_server);
+    EXPECT_EQ(server_resets, std::vector<ErrorCode>{ErrorCode::PROTOCOL_ERROR});
+}
+
 // Main is in test_hpack_decoder.cpp or test_http2_parser.cpp
 // int main(int argc, char **argv) {
 //     ::testing::InitGoogleTest(&argc, argv);
 //     return RUN_ALL_TESTS();
 // }
+
+TEST_F(Http2ConnectionTest, OriginFrameExtendsOriginSet) {
+    std::vector<std::byte> to_client;
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+    std::vector<std::string> alt_services;
+    client_conn.set_altsvc_callback([&](const AltSvcFrame& frame) { alt_services.push_back(frame.field_value); });
+
+    EXPECT_EQ(make_origin("HTTPS", "Example.COM:443"), "https://example.com");
+    EXPECT_EQ(make_origin("http", "example.com:8080"), "http://example.com:8080");
+
+    client_conn.set_origin("https://example.com");
+    EXPECT_TRUE(client_conn.is_authoritative_for("https://example.com:443"));
+    EXPECT_FALSE(client_conn.is_authoritative_for("https://cdn.example.com"));
+
+    // Only servers send ORIGIN/ALTSVC, and ALTSVC on stream 0 must name its origin.
+    EXPECT_FALSE(client_conn.send_origin({"https://other.example"}));
+    EXPECT_FALSE(server_conn.send_altsvc(0, "", "h3=\":443\""));
+    ASSERT_TRUE(server_conn.send_origin({"https://CDN.example.com/", "https://example.com"}));
+    ASSERT_TRUE(server_conn.send_altsvc(0, "https://example.com", "h3=\":443\""));
+    client_conn.process_incoming_data(to_client);
+
+    EXPECT_TRUE(client_conn.has_received_origin_frame());
+    EXPECT_TRUE(client_conn.is_authoritative_for("https://cdn.example.com"));
+    EXPECT_EQ(client_conn.get_origin_set(), (std::vector<std::string>{"https://example.com", "https://cdn.example.com"}));
+    EXPECT_EQ(alt_services, (std::vector<std::string>{"h3=\":443\""}));
+}
+
+TEST_F(Http2ConnectionTest, QueuedDataIsSentByUrgency) {
+    std::vector<std::byte> to_server, to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+    std::vector<std::pair<stream_id_t, size_t>> sent;
+    server_conn.set_data_sent_callback([&](stream_id_t sid, size_t bytes) { sent.emplace_back(sid, bytes); });
+
+    // Stream 1 uses up the connection window; the rest has to wait for the next WINDOW_UPDATE.
+    const std::pair<stream_id_t, const char*> requests[] = {{1, ""}, {3, "u=5"}, {5, "u=1"}, {7, "u=1, i"}, {9, "i, u=1"}};
+    for (const auto& [sid, priority] : requests) {
+        std::vector<HttpHeader> headers = {{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "example.com"}};
+        if (*priority) headers.push_back({"priority", priority});
+        ASSERT_TRUE(client_conn.send_headers(sid, headers, true));
+    }
+    server_conn.process_incoming_data(to_server);
+    to_server.clear();
+    EXPECT_EQ(server_conn.get_stream(7)->get_priority(), (StreamPriority{1, true}));
+
+    ASSERT_TRUE(server_conn.queue_data(1, std::vector<std::byte>(DEFAULT_INITIAL_WINDOW_SIZE), true));
+    for (stream_id_t sid : {3, 5, 7, 9}) ASSERT_TRUE(server_conn.queue_data(sid, std::vector<std::byte>(20000), true));
+    EXPECT_EQ(server_conn.get_remote_connection_window(), 0);
+    sent.clear();
+
+    ASSERT_TRUE(client_conn.send_window_update_action(0, 100000));
+    server_conn.process_incoming_data(to_server);
+    // Urgency 1 first: stream 5 in one go, then 7 and 9 interleaved a frame at a time; then 3.
+    std::vector<std::pair<stream_id_t, size_t>> expected = {
+        {5, 20000}, {7, 16384}, {9, 16384}, {7, 3616}, {9, 3616}, {3, 20000}};
+    EXPECT_EQ(sent, expected);
+}
+
+TEST_F(Http2ConnectionTest, PriorityUpdateReprioritizesStreams) {
+    std::vector<std::byte> to_server, to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+    std::vector<ErrorCode> goaways;
+    server_conn.set_on_send_goaway([&](stream_id_t, ErrorCode code, const std::string&) { goaways.push_back(code); });
+
+    std::vector<HttpHeader> request = {{":method", "GET"}, {":scheme", "https"}, {":path", "/"},
+                                       {":authority", "example.com"}, {"priority", "u=4"}};
+    ASSERT_TRUE(client_conn.send_headers(1, request, true));
+    server_conn.process_incoming_data(to_server);
+    to_server.clear();
+    EXPECT_EQ(server_conn.get_stream(1)->get_priority().urgency, 4);
+
+    // For an open stream, and ahead of the request: the update wins over the priority header.
+    ASSERT_TRUE(client_conn.send_priority_update(1, {0, false}));
+    ASSERT_TRUE(client_conn.send_priority_update(3, {6, true}));
+    ASSERT_TRUE(client_conn.send_headers(3, request, true));
+    server_conn.process_incoming_data(to_server);
+    to_server.clear();
+    EXPECT_EQ(server_conn.get_stream(1)->get_priority(), (StreamPriority{0, false}));
+    EXPECT_EQ(server_conn.get_stream(3)->get_priority(), (StreamPriority{6, true}));
+    EXPECT_TRUE(goaways.empty());
+
+    // Servers do not send PRIORITY_UPDATE; a client treats one as a connection error.
+    EXPECT_FALSE(server_conn.send_priority_update(1, {}));
+    PriorityUpdateFrame update;
+    update.header.stream_id = 0;
+    update.prioritized_stream_id = 1;
+    update.priority_field_value = "u=0";
+    client_conn.process_incoming_data(FrameSerializer::serialize_priority_update_frame(update));
+    ASSERT_EQ(on_send_goaway_data.size(), 1u);
+    EXPECT_EQ(std::get<1>(on_send_goaway_data[0]), ErrorCode::PROTOCOL_ERROR);
+}
+
+TEST_F(Http2ConnectionTest, NoRfc7540PrioritiesSetting) {
+    std::vector<std::byte> to_client;
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+
+    PriorityData weight = {false, 0, 15};
+    EXPECT_TRUE(client_conn.send_priority(1, weight));
+    client_conn.apply_local_setting({SettingsFrame::SETTINGS_NO_RFC7540_PRIORITIES, 1});
+    server_conn.apply_local_setting({SettingsFrame::SETTINGS_NO_RFC7540_PRIORITIES, 1});
+    ASSERT_TRUE(server_conn.send_settings({{SettingsFrame::SETTINGS_NO_RFC7540_PRIORITIES, 1}}));
+    client_conn.process_incoming_data(to_client);
+
+    EXPECT_TRUE(client_conn.get_remote_settings().no_rfc7540_priorities);
+    EXPECT_TRUE(client_conn.is_rfc7540_priority_disabled());
+    EXPECT_FALSE(server_conn.is_rfc7540_priority_disabled()); // Has not heard from the client yet
+    EXPECT_FALSE(client_conn.send_priority(1, weight));
+}
+
+TEST_F(Http2ConnectionTest, ExtensionFramesBetweenPeers) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+
+    std::vector<std::pair<stream_id_t, std::string>> telemetry;
+    ASSERT_TRUE(server_conn.register_extension_frame_handler(0xf0, [&](const FrameHeader& header, std::span<const std::byte> payload) {
+        telemetry.emplace_back(header.stream_id, std::string(reinterpret_cast<const char*>(payload.data()), payload.size()));
+        return ParserError::OK;
+    }));
+
+    std::string report = "rtt=12ms";
+    auto report_bytes = std::as_bytes(std::span<const char>(report));
+    EXPECT_FALSE(client_conn.send_extension_frame(static_cast<uint8_t>(FrameType::SETTINGS), 0, 0, report_bytes));
+    EXPECT_FALSE(client_conn.send_extension_frame(0xf0, 0, 0, std::vector<std::byte>(DEFAULT_MAX_FRAME_SIZE + 1)));
+    ASSERT_TRUE(client_conn.send_extension_frame(0xf0, 0, 0, report_bytes));
+    server_conn.process_incoming_data(to_server);
+
+    EXPECT_EQ(telemetry, (std::vector<std::pair<stream_id_t, std::string>>{{0, "rtt=12ms"}}));
+    EXPECT_TRUE(received_frames_server.empty()); // Handled frames skip the frame callback
+}
+
+TEST_F(Http2ConnectionTest, DataFrameSizingFollowsWarmupAndLargerFrameSize) {
+    std::vector<std::byte> to_server, to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+
+    // The client advertises 64 KiB frames and enough window for the whole body.
+    const std::vector<SettingsFrame::Setting> settings = {
+        {SettingsFrame::SETTINGS_MAX_FRAME_SIZE, 65536}, {SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, 1u << 20}};
+    for (const auto& setting : settings) client_conn.apply_local_setting(setting);
+    ASSERT_TRUE(client_conn.send_settings(settings));
+    ASSERT_TRUE(client_conn.send_window_update_action(0, 1u << 20));
+    ASSERT_TRUE(client_conn.send_headers(1, make_headers_for_test({{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "example.com"}}), true));
+    server_conn.process_incoming_data(to_server);
+    EXPECT_EQ(server_conn.get_remote_settings().max_frame_size, 65536u);
+
+    // TCP-segment sized frames until 4000 bytes are out, then as large as the peer allows.
+    server_conn.set_data_frame_sizing({.warmup_frame_size = 1400, .warmup_bytes = 4000});
+    ASSERT_TRUE(server_conn.send_data(1, std::vector<std::byte>(200000), true));
+    EXPECT_EQ(server_conn.get_data_frames_sent(), 6u);
+    EXPECT_EQ(server_conn.get_data_bytes_sent(), 200000u);
+
+    // Frames above 16 KiB are accepted because the client advertised them.
+    client_conn.process_incoming_data(to_client);
+    std::vector<size_t> frame_sizes;
+    for (const auto& frame : received_frames_client) {
+        if (const auto* df = frame.get_if<DataFrame>()) frame_sizes.push_back(df->data.size());
+    }
+    EXPECT_EQ(frame_sizes, (std::vector<size_t>{1391, 1391, 1391, 65536, 65536, 64755}));
+    EXPECT_TRUE(on_send_goaway_data.empty());
+}
+
+TEST_F(Http2ConnectionTest, CorkedOutputIsCoalescedIntoOneWrite) {
+    std::vector<std::byte> request_bytes;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { request_bytes.insert(request_bytes.end(), b.begin(), b.end()); });
+    ASSERT_TRUE(client_conn.send_headers(1, make_headers_for_test({{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "example.com"}}), true));
+    ASSERT_TRUE(client_conn.send_headers(3, make_headers_for_test({{":method", "GET"}, {":scheme", "https"}, {":path", "/b"}, {":authority", "example.com"}}), true));
+
+    std::vector<std::vector<std::byte>> writes;
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { writes.push_back(std::move(b)); });
+    server_conn.process_incoming_data(request_bytes);
+    ASSERT_TRUE(writes.empty());
+
+    // Corked: HEADERS and DATA on two streams leave as one write on uncork().
+    std::vector<std::byte> chunk(10, std::byte{0x61});
+    server_conn.cork();
+    for (stream_id_t sid : {1, 3}) {
+        ASSERT_TRUE(server_conn.send_headers(sid, make_headers_for_test({{":status", "200"}}), false));
+        ASSERT_TRUE(server_conn.send_data(sid, chunk, false));
+        ASSERT_TRUE(server_conn.send_data(sid, chunk, true));
+    }
+    EXPECT_TRUE(writes.empty());
+    EXPECT_GT(server_conn.get_buffered_output_size(), 0u);
+    server_conn.uncork();
+    ASSERT_EQ(writes.size(), 1u);
+    EXPECT_EQ(server_conn.get_buffered_output_size(), 0u);
+
+    // The peer sees all six frames.
+    client_conn.process_incoming_data(writes[0]);
+    EXPECT_EQ(received_frames_client.size(), 6u);
+
+    // With the policy on, output waits for the size threshold or the end of the input turn.
+    writes.clear();
+    server_conn.set_output_flush_policy({.enabled = true, .max_buffered_bytes = 64, .latency_budget = std::chrono::microseconds{0}});
+    ASSERT_TRUE(server_conn.send_ping({}, false));
+    EXPECT_TRUE(writes.empty());
+    EXPECT_FALSE(server_conn.get_output_deadline().has_value()); // No latency budget
+    ASSERT_TRUE(server_conn.send_ping({}, false)); // 2 * 17 bytes
+    EXPECT_TRUE(writes.empty());
+    ASSERT_TRUE(server_conn.send_ping({}, false)); // 51 bytes
+    ASSERT_TRUE(server_conn.send_ping({}, false)); // 68 bytes: over the threshold
+    EXPECT_EQ(writes.size(), 1u);
+    ASSERT_TRUE(server_conn.send_ping({}, false));
+    auto settings_bytes = FrameSerializer::serialize_settings_frame(SettingsFrame{{0, FrameType::SETTINGS, 0, 0}, {}});
+    server_conn.process_incoming_data(settings_bytes); // Ends the turn: the PING and the SETTINGS ACK leave together
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[1].size(), 2 * FRAME_HEADER_SIZE + 8);
+}
+
+TEST_F(Http2ConnectionTest, SmallWritesAreCoalescedPerStream) {
+    std::vector<std::byte> to_server, to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+    for (stream_id_t sid : {1, 3}) {
+        ASSERT_TRUE(client_conn.send_headers(sid, make_headers_for_test({{":method", "GET"}, {":scheme", "https"}, {":path", "/events"}, {":authority", "example.com"}}), true));
+    }
+    server_conn.process_incoming_data(to_server);
+    for (stream_id_t sid : {1, 3}) ASSERT_TRUE(server_conn.send_headers(sid, make_headers_for_test({{":status", "200"}}), false));
+
+    // Stream 1 merges writes into frames of at least 100 bytes; stream 3 frames every write.
+    server_conn.set_write_coalescing(1, {.min_frame_payload = 100, .max_delay = std::chrono::microseconds{0}});
+    std::vector<std::byte> event(30, std::byte{0x65});
+    for (int i = 0; i < 4; ++i) {
+        ASSERT_TRUE(server_conn.send_data(1, event, false)); // The fourth write reaches 120 bytes
+        ASSERT_TRUE(server_conn.send_data(3, event, false));
+    }
+    ASSERT_TRUE(server_conn.send_data(1, event, false));  // Held back
+    ASSERT_TRUE(server_conn.send_data(1, event, false));  // Held back
+    server_conn.flush_coalesced_data(1);                  // 60 bytes
+    ASSERT_TRUE(server_conn.send_data(1, event, false));  // Held back
+    ASSERT_TRUE(server_conn.send_headers(1, make_headers_for_test({{"grpc-status", "0"}}), true)); // Flushes before the trailers
+    EXPECT_FALSE(server_conn.get_output_deadline().has_value());
+
+    client_conn.process_incoming_data(to_client);
+    std::vector<std::pair<stream_id_t, size_t>> data_frames;
+    for (const auto& frame : received_frames_client) {
+        if (const auto* df = frame.get_if<DataFrame>()) data_frames.emplace_back(df->header.stream_id, df->data.size());
+    }
+    EXPECT_EQ(data_frames, (std::vector<std::pair<stream_id_t, size_t>>{
+        {3, 30}, {3, 30}, {3, 30}, {1, 120}, {3, 30}, {1, 60}, {1, 30}}));
+    const auto* trailers = received_frames_client.back().get_if<HeadersFrame>();
+    ASSERT_NE(trailers, nullptr);
+    EXPECT_EQ(trailers->header.stream_id, 1u);
+}
+
+TEST_F(Http2ConnectionTest, DataFramesAreDeliveredInBatchesPerRead) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    struct Batch {
+        stream_id_t stream_id;
+        size_t chunks;
+        size_t bytes;
+        bool end_stream;
+        bool operator==(const Batch&) const = default;
+    };
+    std::vector<Batch> batches;
+    server_conn.set_data_batch_callback([&](stream_id_t sid, std::vector<std::vector<std::byte>>&& chunks, bool end_stream) {
+        size_t bytes = 0;
+        for (const auto& chunk : chunks) bytes += chunk.size();
+        batches.push_back({sid, chunks.size(), bytes, end_stream});
+    });
+
+    auto post = make_headers_for_test({{":method", "POST"}, {":scheme", "https"}, {":path", "/log"}, {":authority", "example.com"}});
+    ASSERT_TRUE(client_conn.send_headers(1, post, false));
+    ASSERT_TRUE(client_conn.send_headers(3, post, false));
+    std::vector<std::byte> line(20, std::byte{0x6c});
+    for (int i = 0; i < 3; ++i) ASSERT_TRUE(client_conn.send_data(1, line, false));
+    for (int i = 0; i < 2; ++i) ASSERT_TRUE(client_conn.send_data(3, line, false));
+    ASSERT_TRUE(client_conn.send_data(1, line, true));
+    ASSERT_TRUE(client_conn.send_data(3, line, false));
+
+    // Split the bytes so the last DATA frame arrives in a second read.
+    size_t first_read = to_server.size() - (FRAME_HEADER_SIZE + line.size());
+    server_conn.process_incoming_data(std::span<const std::byte>(to_server).first(first_read));
+    EXPECT_EQ(batches, (std::vector<Batch>{{1, 3, 60, false}, {3, 2, 40, false}, {1, 1, 20, true}}));
+    server_conn.process_incoming_data(std::span<const std::byte>(to_server).subspan(first_read));
+    ASSERT_EQ(batches.size(), 4u);
+    EXPECT_EQ(batches[3], (Batch{3, 1, 20, false}));
+}
+
+TEST_F(Http2ConnectionTest, BatchedCreditReturnCoalescesWindowUpdates) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    std::vector<std::vector<std::byte>> writes;
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { writes.push_back(std::move(b)); });
+    server_conn.set_credit_return_policy({.batched = true});
+    server_conn.set_data_callback([&](stream_id_t sid, std::vector<std::byte>&& data, bool) {
+        server_conn.consume_data(sid, static_cast<uint32_t>(data.size()));
+    });
+    auto deliver = [&] {
+        server_conn.process_incoming_data(to_server);
+        to_server.clear();
+    };
+
+    auto post = make_headers_for_test({{":method", "POST"}, {":scheme", "https"}, {":path", "/upload"}, {":authority", "example.com"}});
+    ASSERT_TRUE(client_conn.send_headers(1, post, false));
+    ASSERT_TRUE(client_conn.send_headers(3, post, false));
+    ASSERT_TRUE(client_conn.send_data(1, std::vector<std::byte>(10000), false));
+    ASSERT_TRUE(client_conn.send_data(3, std::vector<std::byte>(10000), false));
+    deliver();
+    // Less than half of any window has been used: nothing is worth a WINDOW_UPDATE yet.
+    EXPECT_TRUE(writes.empty());
+    EXPECT_EQ(server_conn.get_pending_connection_credit(), 20000u);
+
+    // Stream 1 and the connection pass the halfway mark; stream 3 does not.
+    ASSERT_TRUE(client_conn.send_data(1, std::vector<std::byte>(25000), false));
+    deliver();
+    ASSERT_EQ(writes.size(), 1u);
+    client_conn.process_incoming_data(writes[0]);
+    std::vector<std::pair<stream_id_t, uint32_t>> updates;
+    for (const auto& frame : received_frames_client) {
+        if (const auto* wuf = frame.get_if<WindowUpdateFrame>()) updates.emplace_back(wuf->header.stream_id, wuf->window_size_increment);
+    }
+    EXPECT_EQ(updates, (std::vector<std::pair<stream_id_t, uint32_t>>{{0, 45000}, {1, 35000}}));
+    EXPECT_EQ(client_conn.get_remote_connection_window(), DEFAULT_INITIAL_WINDOW_SIZE);
+    EXPECT_EQ(server_conn.get_pending_connection_credit(), 0u);
+
+    // Switching batching off returns what is left.
+    server_conn.set_credit_return_policy({});
+    ASSERT_EQ(writes.size(), 2u);
+    EXPECT_EQ(writes[1].size(), FRAME_HEADER_SIZE + 4);
+}
+
+TEST_F(Http2ConnectionTest, SendHeadersWithStaticEncodedPrefix) {
+    static constexpr auto GRPC_PSEUDO = Hpack::static_encode<
+        Hpack::StaticHeader<":method", "POST">, Hpack::StaticHeader<":scheme", "https">>();
+    static constexpr auto GRPC_FIELDS = Hpack::static_encode<
+        Hpack::StaticHeader<"content-type", "application/grpc">, Hpack::StaticHeader<"te", "trailers">>();
+
+    for (stream_id_t sid : {stream_id_t{1}, stream_id_t{3}}) {
+        ASSERT_TRUE(client_conn.send_headers(sid, GRPC_PSEUDO, {{":path", "/pkg.Service/Call"}, {":authority", "example.com"}},
+                                             GRPC_FIELDS, false));
+    }
+    for (auto& bytes : on_send_bytes_data) server_conn.process_incoming_data(bytes);
+
+    std::vector<std::vector<HttpHeader>> requests;
+    for (const auto& frame : received_frames_server) {
+        if (const auto* hf = frame.get_if<HeadersFrame>()) requests.push_back(hf->headers);
+    }
+    ASSERT_EQ(requests.size(), 2u);
+    for (const auto& headers : requests) {
+        ASSERT_EQ(headers.size(), 6u);
+        EXPECT_EQ(headers[0].value, "POST");
+        EXPECT_EQ(headers[2].value, "/pkg.Service/Call");
+        EXPECT_EQ(headers[3].value, "example.com");
+        EXPECT_EQ(headers[4].name, "content-type");
+        EXPECT_EQ(headers[5].name, "te");
+    }
+    EXPECT_EQ(server_conn.get_stream(3)->get_state(), StreamState::OPEN);
+}
+
+TEST_F(Http2ConnectionTest, StreamEventsCarryUserData) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([](std::vector<std::byte>) {});
+
+    struct Request {
+        stream_id_t stream_id;
+        std::vector<std::string> events;
+    };
+    std::vector<std::unique_ptr<Request>> requests;
+    std::vector<std::string> closed;
+    server_conn.set_stream_events({
+        .on_open = [&](stream_id_t sid) -> void* {
+            requests.push_back(std::make_unique<Request>(Request{sid, {"open"}}));
+            return requests.back().get();
+        },
+        .on_headers = [&](stream_id_t sid, void* user_data, const std::vector<HttpHeader>& headers, bool end_stream) {
+            auto* request = static_cast<Request*>(user_data);
+            ASSERT_EQ(request->stream_id, sid);
+            request->events.push_back("headers " + headers[2].value + (end_stream ? " end" : ""));
+        },
+        .on_data = [&](stream_id_t sid, void* user_data, std::vector<std::byte>&& data, bool end_stream) {
+            auto* request = static_cast<Request*>(user_data);
+            ASSERT_EQ(request->stream_id, sid);
+            request->events.push_back("data " + std::to_string(data.size()) + (end_stream ? " end" : ""));
+        },
+        .on_trailers = [&](stream_id_t, void* user_data, const std::vector<HttpHeader>& trailers) {
+            static_cast<Request*>(user_data)->events.push_back("trailers " + trailers[0].name);
+        },
+        .on_reset = [&](stream_id_t, void* user_data, ErrorCode error_code) {
+            static_cast<Request*>(user_data)->events.push_back("reset " + std::to_string(static_cast<uint32_t>(error_code)));
+        },
+        .on_close = [&](stream_id_t sid, void* user_data) {
+            auto* request = static_cast<Request*>(user_data);
+            ASSERT_EQ(request->stream_id, sid);
+            request->events.push_back("close");
+        },
+    });
+
+    auto post = make_headers_for_test({{":method", "POST"}, {":scheme", "https"}, {":path", "/upload"}, {":authority", "example.com"}});
+    std::vector<std::byte> body(10, std::byte{0x61});
+    ASSERT_TRUE(client_conn.send_headers(1, post, false));
+    ASSERT_TRUE(client_conn.send_data(1, body, false));
+    ASSERT_TRUE(client_conn.send_headers(1, make_headers_for_test({{"grpc-status", "0"}}), true));
+    ASSERT_TRUE(client_conn.send_headers(3, post, false));
+    server_conn.process_incoming_data(to_server);
+    to_server.clear();
+
+    ASSERT_EQ(requests.size(), 2u);
+    EXPECT_EQ(requests[0]->events, (std::vector<std::string>{"open", "headers /upload", "data 10", "trailers grpc-status"}));
+    EXPECT_EQ(server_conn.get_stream(3)->get_user_data(), requests[1].get());
+
+    // The response ends stream 1; it is reported closed once the connection drops it.
+    ASSERT_TRUE(server_conn.send_headers(1, make_headers_for_test({{":status", "200"}}), true));
+    ASSERT_TRUE(client_conn.send_rst_stream_frame_action(3, ErrorCode::CANCEL));
+    server_conn.process_incoming_data(to_server);
+    EXPECT_EQ(requests[0]->events.back(), "close");
+    EXPECT_EQ(requests[1]->events, (std::vector<std::string>{"open", "headers /upload", "reset 8", "close"}));
+    EXPECT_EQ(server_conn.get_stream(1), nullptr);
+    EXPECT_EQ(server_conn.get_stream(3), nullptr);
+}
+
+TEST_F(Http2ConnectionTest, StreamEventsReportHeaderBlockCompletedByContinuation) {
+    std::vector<std::vector<HttpHeader>> reported;
+    server_conn.set_stream_events({
+        .on_headers = [&](stream_id_t, void*, const std::vector<HttpHeader>& headers, bool) { reported.push_back(headers); },
+    });
+
+    std::vector<std::byte> first = {std::byte{0x82}}; // :method: GET
+    server_conn.process_incoming_data(construct_frame_bytes(first.size(), FrameType::HEADERS, 0, 1, first));
+    EXPECT_TRUE(reported.empty());
+
+    std::vector<std::byte> rest = {std::byte{0x84}, std::byte{0x87}}; // :path: /, :scheme: https
+    server_conn.process_incoming_data(construct_frame_bytes(rest.size(), FrameType::CONTINUATION, ContinuationFrame::END_HEADERS_FLAG, 1, rest));
+    ASSERT_EQ(reported.size(), 1u);
+    ASSERT_EQ(reported[0].size(), 3u);
+    EXPECT_EQ(reported[0][1].name, ":path");
+    EXPECT_EQ(reported[0][2].value, "https");
+}
+
+TEST_F(Http2ConnectionTest, ConnectChecksSeeHeaderBlockCompletedByContinuation) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    std::vector<ErrorCode> server_resets;
+    server_conn.set_on_send_rst_stream([&](stream_id_t, ErrorCode code) { server_resets.push_back(code); });
+    client_conn.apply_remote_setting({SettingsFrame::SETTINGS_ENABLE_CONNECT_PROTOCOL, 1});
+    HttpHeader padding{"x-padding", std::string(2 * DEFAULT_MAX_FRAME_SIZE, 'p')}; // Needs a CONTINUATION frame
+
+    ASSERT_TRUE(client_conn.send_headers(1, {{":method", "CONNECT"}, {":authority", "proxy.example.com:443"}, padding}, false));
+    server_conn.process_incoming_data(to_server);
+    to_server.clear();
+    ASSERT_TRUE(std::holds_alternative<ContinuationFrame>(received_frames_server.back().frame_variant));
+    ASSERT_NE(server_conn.get_stream(1), nullptr);
+    EXPECT_TRUE(server_conn.get_stream(1)->is_tunnel());
+
+    // The server never enabled extended CONNECT.
+    ASSERT_TRUE(client_conn.send_headers(3, {{":method", "CONNECT"}, {":protocol", "websocket"}, {":scheme", "https"},
+                                             {":path", "/chat"}, {":authority", "example.com"}, padding}, false));
+    server_conn.process_incoming_data(to_server);
+    EXPECT_EQ(server_resets, std::vector<ErrorCode>{ErrorCode::PROTOCOL_ERROR});
+}
+
+TEST_F(Http2ConnectionTest, PriorityHeaderInContinuationFrame) {
+    std::vector<std::byte> to_server;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+
+    // The priority field comes after padding that pushes it into a CONTINUATION frame.
+    ASSERT_TRUE(client_conn.send_headers(1, {{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "example.com"},
+                                             {"x-padding", std::string(2 * DEFAULT_MAX_FRAME_SIZE, 'p')}, {"priority", "u=1, i"}}, true));
+    server_conn.process_incoming_data(to_server);
+    ASSERT_TRUE(std::holds_alternative<ContinuationFrame>(received_frames_server.back().frame_variant));
+    ASSERT_NE(server_conn.get_stream(1), nullptr);
+    EXPECT_EQ(server_conn.get_stream(1)->get_priority(), (StreamPriority{1, true}));
+}
+
+TEST_F(Http2ConnectionTest, CoalescedDataWaitsForWindow) {
+    std::vector<FrameSentInfo> sent_frames_capture;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> bytes) { sent_frames_capture.emplace_back(bytes); });
+    client_conn.apply_remote_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, 0});
+    ASSERT_TRUE(client_conn.send_headers(1, make_headers_for_test({{":method", "POST"}}), false));
+    sent_frames_capture.clear();
+
+    client_conn.set_write_coalescing(1, {.min_frame_payload = 100, .max_delay = std::chrono::microseconds{0}});
+    std::vector<std::byte> event(30, std::byte{0x65});
+    ASSERT_TRUE(client_conn.send_data(1, event, false));
+    ASSERT_TRUE(client_conn.send_data(1, event, false));
+    client_conn.flush_coalesced_data(1); // Nothing may go out on a zero window
+    EXPECT_TRUE(sent_frames_capture.empty());
+    EXPECT_EQ(client_conn.get_stream(1)->get_outgoing_data_size(), 60u);
+    // Trailers wait behind the queued DATA; nothing may follow them.
+    EXPECT_TRUE(client_conn.send_headers(1, make_headers_for_test({{"x-checksum", "1"}}), true));
+    EXPECT_TRUE(sent_frames_capture.empty());
+    EXPECT_FALSE(client_conn.send_headers(1, make_headers_for_test({{"x-checksum", "2"}}), true));
+    EXPECT_FALSE(client_conn.send_data(1, event, false));
+    EXPECT_FALSE(client_conn.queue_data(1, event, false));
+
+    std::vector<std::byte> increment = {std::byte(0x00), std::byte(0x00), std::byte(0x00), std::byte(0x28)}; // 40
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 1, increment));
+    ASSERT_EQ(sent_frames_capture.size(), 1u);
+    EXPECT_EQ(sent_frames_capture[0].type, FrameType::DATA); // 40 of 60 bytes; the trailers still wait
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 1, increment));
+    ASSERT_EQ(sent_frames_capture.size(), 3u);
+    EXPECT_EQ(sent_frames_capture[0].payload.size() + sent_frames_capture[1].payload.size(), 60u);
+    EXPECT_EQ(sent_frames_capture[1].type, FrameType::DATA);
+    EXPECT_EQ(sent_frames_capture[2].type, FrameType::HEADERS);
+    EXPECT_TRUE(sent_frames_capture[2].flags & HeadersFrame::END_STREAM_FLAG);
+    EXPECT_FALSE(client_conn.get_stream(1)->has_outgoing_data());
+    EXPECT_EQ(client_conn.get_stream(1)->get_state(), StreamState::HALF_CLOSED_LOCAL);
+}
+
+TEST_F(Http2ConnectionTest, CoalescedDataReachingThresholdWaitsForWindow) {
+    std::vector<FrameSentInfo> sent_frames_capture;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> bytes) { sent_frames_capture.emplace_back(bytes); });
+    client_conn.apply_remote_setting({SettingsFrame::SETTINGS_INITIAL_WINDOW_SIZE, 0});
+    ASSERT_TRUE(client_conn.send_headers(1, make_headers_for_test({{":method", "POST"}}), false));
+    sent_frames_capture.clear();
+
+    client_conn.set_write_coalescing(1, {.min_frame_payload = 100, .max_delay = std::chrono::microseconds{0}});
+    std::vector<std::byte> event(30, std::byte{0x65});
+    ASSERT_TRUE(client_conn.send_data(1, event, false));
+    ASSERT_TRUE(client_conn.send_data(1, event, false));
+    // Crosses the threshold: the 60 held bytes and these 50 are framed together, but the window is zero.
+    ASSERT_TRUE(client_conn.send_data(1, std::vector<std::byte>(50, std::byte{0x66}), false));
+    EXPECT_TRUE(sent_frames_capture.empty());
+    EXPECT_EQ(client_conn.get_stream(1)->get_outgoing_data_size(), 110u);
+
+    auto data_sent = [&] {
+        size_t total = 0;
+        for (const auto& fi : sent_frames_capture) {
+            if (fi.type == FrameType::DATA) total += fi.payload.size();
+        }
+        return total;
+    };
+    std::vector<std::byte> increment = {std::byte(0x00), std::byte(0x00), std::byte(0x00), std::byte(0x28)}; // 40
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 1, increment));
+    EXPECT_EQ(data_sent(), 40u); // A partial window sends part and keeps the rest queued
+    EXPECT_EQ(client_conn.get_stream(1)->get_outgoing_data_size(), 70u);
+
+    increment[3] = std::byte(0x46); // 70
+    client_conn.process_incoming_data(construct_frame_bytes(4, FrameType::WINDOW_UPDATE, 0, 1, increment));
+    EXPECT_EQ(data_sent(), 110u);
+    EXPECT_FALSE(client_conn.get_stream(1)->has_outgoing_data());
+}
@@ -0,0 +1,215 @@
+#include "gtest/gtest.h"
+#include "http2_connection_pool.h"
+#include "http2_connection.h"
+#include <memory>
+#include <vector>
+
+using namespace http2;
+
+// Every connection the pool opens is paired with an in-process origin connection.
+class Http2ConnectionPoolTest : public ::testing::Test {
+protected:
+    struct Origin {
+        Http2Connection server{true};
+        Http2Connection* client = nullptr;
+        std::vector<std::byte> to_server, to_client;
+        std::vector<stream_id_t> requests; // Streams whose request (HEADERS + body) completed
+        size_t body_bytes = 0;
+    };
+
+    std::vector<std::unique_ptr<Origin>> origins;
+    std::vector<std::pair<Http2ConnectionPool::RequestId, stream_id_t>> assignments;
+    std::vector<Http2Connection*> assigned_connections;
+    std::vector<std::string> factory_origins; // Origin passed to each factory call
+
+    Http2ConnectionPool::ConnectionFactory make_factory() {
+        return [this](Http2ConnectionPool::ConnectionId, const std::string& origin_name) {
+            factory_origins.push_back(origin_name);
+            auto client = std::make_unique<Http2Connection>(false);
+            auto origin = std::make_unique<Origin>();
+            Origin* o = origin.get();
+            o->client = client.get();
+            client->set_on_send_bytes([o](std::vector<std::byte> b) { o->to_server.insert(o->to_server.end(), b.begin(), b.end()); });
+            o->server.set_on_send_bytes([o](std::vector<std::byte> b) { o->to_client.insert(o->to_client.end(), b.begin(), b.end()); });
+            o->server.set_frame_callback([o](const AnyHttp2Frame& frame) {
+                const auto* hf = frame.get_if<HeadersFrame>();
+                if (hf && hf->has_end_stream_flag()) o->requests.push_back(hf->header.stream_id);
+            });
+            o->server.set_data_callback([o](stream_id_t sid, std::vector<std::byte>&& data, bool end_stream) {
+                o->body_bytes += data.size();
+                if (end_stream) o->requests.push_back(sid);
+            });
+            origins.push_back(std::move(origin));
+            return client;
+        };
+    }
+
+    void track(Http2ConnectionPool& pool) {
+        pool.set_stream_assigned_callback([this](Http2ConnectionPool::RequestId id, Http2Connection& c, stream_id_t sid) {
+            assignments.emplace_back(id, sid);
+            assigned_connections.push_back(&c);
+        });
+    }
+
+    // Delivers bytes in both directions until nothing is left. Connections closed by the pool
+    // have been destroyed, so nothing is delivered to those clients any more.
+    void pump(Http2ConnectionPool& pool) {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            for (auto& o : origins) {
+                if (!o->to_server.empty()) {
+                    std::vector<std::byte> bytes;
+                    bytes.swap(o->to_server);
+                    o->server.process_incoming_data(bytes);
+                    progress = true;
+                }
+                if (!o->to_client.empty() && is_alive(pool, o->client)) {
+                    std::vector<std::byte> bytes;
+                    bytes.swap(o->to_client);
+                    o->client->process_incoming_data(bytes);
+                    progress = true;
+                }
+            }
+        }
+    }
+
+    static bool is_alive(Http2ConnectionPool& pool, Http2Connection* client) {
+        for (Http2ConnectionPool::ConnectionId id = 1; id <= 16; ++id) {
+            if (pool.get_connection(id) == client) return true;
+        }
+        return false;
+    }
+
+    static void respond(Origin& origin, stream_id_t stream_id) {
+        ASSERT_TRUE(origin.server.send_headers(stream_id, {{":status", "200"}}, true));
+    }
+
+    static std::vector<HttpHeader> get_request(const char* path, const char* authority = "example.com") {
+        return {{":method", "GET"}, {":scheme", "https"}, {":path", path}, {":authority", authority}};
+    }
+};
+
+TEST_F(Http2ConnectionPoolTest, PlacesStreamsOnLeastLoadedConnection) {
+    Http2ConnectionPool pool(make_factory(), {.max_connections = 2, .max_streams_per_connection = 2});
+    track(pool);
+
+    for (const char* path : {"/a", "/b", "/c", "/d", "/e"}) pool.submit(get_request(path));
+    pump(pool);
+
+    // Two fill the first connection, the third opens a second one, the fourth takes its last
+    // slot and the fifth has to wait.
+    ASSERT_EQ(origins.size(), 2u);
+    EXPECT_EQ(pool.get_connection_count(), 2u);
+    EXPECT_EQ(pool.get_in_flight_request_count(), 4u);
+    EXPECT_EQ(pool.get_pending_request_count(), 1u);
+    EXPECT_EQ(origins[0]->requests, (std::vector<stream_id_t>{1, 3}));
+    EXPECT_EQ(origins[1]->requests, (std::vector<stream_id_t>{1, 3}));
+
+    // A response on the first connection frees a slot for the pending request.
+    respond(*origins[0], 1);
+    pump(pool);
+    pool.maintain();
+    pump(pool);
+    EXPECT_EQ(pool.get_pending_request_count(), 0u);
+    ASSERT_EQ(assignments.size(), 5u);
+    EXPECT_EQ(assignments[4], (std::pair<Http2ConnectionPool::RequestId, stream_id_t>{5, 5}));
+    EXPECT_EQ(assigned_connections[4], origins[0]->client);
+    EXPECT_EQ(origins[0]->requests, (std::vector<stream_id_t>{1, 3, 5}));
+}
+
+TEST_F(Http2ConnectionPoolTest, GoAwayReplaysUnprocessedRequests) {
+    Http2ConnectionPool pool(make_factory(), {.max_connections = 2, .max_streams_per_connection = 10});
+    track(pool);
+
+    std::vector<std::byte> body(1000, std::byte{0x55});
+    pool.submit(get_request("/processed"));
+    pool.submit(get_request("/upload"), body);
+    pump(pool);
+    ASSERT_EQ(origins.size(), 1u);
+    EXPECT_EQ(origins[0]->body_bytes, 1000u);
+
+    // The origin only takes responsibility for stream 1.
+    ASSERT_TRUE(origins[0]->server.send_goaway_action(1, ErrorCode::NO_ERROR, "restart"));
+    pump(pool);
+
+    // Request 2 was replayed, with its body, on a fresh connection.
+    ASSERT_EQ(origins.size(), 2u);
+    EXPECT_EQ(pool.get_retried_request_count(), 1u);
+    EXPECT_EQ(pool.get_draining_connection_count(), 1u);
+    ASSERT_EQ(assignments.size(), 3u);
+    EXPECT_EQ(assignments[2], (std::pair<Http2ConnectionPool::RequestId, stream_id_t>{2, 1}));
+    EXPECT_EQ(assigned_connections[2], origins[1]->client);
+    EXPECT_EQ(origins[1]->requests, (std::vector<stream_id_t>{1}));
+    EXPECT_EQ(origins[1]->body_bytes, 1000u);
+
+    // New requests avoid the draining connection.
+    pool.submit(get_request("/next"));
+    EXPECT_EQ(assigned_connections.back(), origins[1]->client);
+
+    // Once its last stream finishes, the drained connection is closed.
+    respond(*origins[0], 1);
+    pump(pool);
+    pool.maintain();
+    EXPECT_EQ(pool.get_connection_count(), 1u);
+    EXPECT_EQ(pool.get_draining_connection_count(), 0u);
+}
+
+TEST_F(Http2ConnectionPoolTest, RetiresConnectionBeforeStreamIdsRunOut) {
+    Http2ConnectionPool pool(make_factory(), {.max_connections = 1, .max_streams_per_connection = 10, .stream_id_reserve = 2});
+    track(pool);
+    std::vector<Http2ConnectionPool::ConnectionId> closed;
+    pool.set_connection_closed_callback([&](Http2ConnectionPool::ConnectionId id, Http2Connection&) { closed.push_back(id); });
+
+    pool.submit(get_request("/first"));
+    ASSERT_EQ(origins.size(), 1u);
+    // Jump to the end of the id space: three ids are left after this stream.
+    ASSERT_TRUE(origins[0]->client->send_headers(MAX_STREAM_ID - 8, get_request("/direct"), true));
+    EXPECT_EQ(origins[0]->client->get_remaining_stream_id_count(), 3u);
+
+    // Crossing the reserve retires the connection and opens its replacement straight away,
+    // even though max_connections is 1.
+    pool.submit(get_request("/second"));
+    EXPECT_EQ(assignments.back().second, MAX_STREAM_ID - 6);
+    ASSERT_EQ(origins.size(), 2u);
+    EXPECT_EQ(pool.get_retiring_connection_count(), 1u);
+
+    // New requests go to the replacement while the old streams finish.
+    pool.submit(get_request("/third"));
+    EXPECT_EQ(assigned_connections.back(), origins[1]->client);
+    EXPECT_EQ(assignments.back().second, 1u);
+    pump(pool);
+    EXPECT_EQ(origins[1]->requests, (std::vector<stream_id_t>{1}));
+
+    for (stream_id_t sid : {stream_id_t{1}, MAX_STREAM_ID - 8, MAX_STREAM_ID - 6}) respond(*origins[0], sid);
+    pump(pool);
+    pool.maintain();
+    pump(pool);
+    EXPECT_EQ(closed, (std::vector<Http2ConnectionPool::ConnectionId>{1}));
+    EXPECT_EQ(pool.get_connection_count(), 1u);
+    EXPECT_TRUE(origins[0]->server.is_going_away()); // Retired with a GOAWAY
+}
+
+TEST_F(Http2ConnectionPoolTest, CoalescesOriginsAdvertisedByOriginFrame) {
+    Http2ConnectionPool pool(make_factory(), {.max_connections = 1, .max_streams_per_connection = 10});
+    track(pool);
+
+    pool.submit(get_request("/", "example.com"));
+    ASSERT_EQ(origins.size(), 1u);
+    EXPECT_EQ(factory_origins.back(), "https://example.com");
+
+    // Without an ORIGIN frame, another hostname needs its own connection.
+    pool.submit(get_request("/img", "img.example.com"));
+    ASSERT_EQ(origins.size(), 2u);
+    EXPECT_EQ(factory_origins.back(), "https://img.example.com");
+
+    // The first server declares itself authoritative for cdn.example.com as well.
+    ASSERT_TRUE(origins[0]->server.send_origin({"https://cdn.example.com"}));
+    pump(pool);
+    pool.submit(get_request("/app.js", "cdn.example.com:443"));
+    EXPECT_EQ(origins.size(), 2u);
+    EXPECT_EQ(assigned_connections.back(), origins[0]->client);
+    EXPECT_EQ(pool.get_coalesced_request_count(), 1u);
+    pump(pool);
+    EXPECT_EQ(origins[0]->requests, (std::vector<stream_id_t>{1, 3}));
+}
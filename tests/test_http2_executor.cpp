@@ -0,0 +1,139 @@
+#include "gtest/gtest.h"
+#include "http2_executor.h"
+#include "http2_connection.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace http2;
+
+namespace {
+
+// Polls `condition` for up to a few seconds.
+template <typename Condition>
+bool eventually(Condition condition) {
+    for (int i = 0; i < 5000 && !condition(); ++i) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    return condition();
+}
+
+} // namespace
+
+TEST(StreamExecutorTest, RunsTasksOnHomeWorkerInOrder) {
+    StreamExecutor executor({.worker_count = 3, .steal_threshold = 1000});
+    EXPECT_EQ(executor.get_worker_count(), 3u);
+    EXPECT_EQ(executor.assign_home(), 0u);
+    EXPECT_EQ(executor.assign_home(), 1u);
+    EXPECT_EQ(StreamExecutor::current_worker(), StreamExecutor::npos);
+
+    std::vector<int> order; // Only touched by worker 1
+    std::atomic<bool> elsewhere{false};
+    for (int i = 0; i < 100; ++i) {
+        executor.submit(1, [&, i] {
+            if (StreamExecutor::current_worker() != 1) elsewhere = true;
+            order.push_back(i);
+        });
+    }
+    executor.wait_idle();
+    EXPECT_FALSE(elsewhere);
+    ASSERT_EQ(order.size(), 100u);
+    for (int i = 0; i < 100; ++i) EXPECT_EQ(order[i], i);
+    EXPECT_EQ(executor.get_executed_count(1), 100u);
+    EXPECT_EQ(executor.get_steal_count(), 0u);
+}
+
+TEST(StreamExecutorTest, StealsOnlyBacklogAboveThreshold) {
+    StreamExecutor executor({.worker_count = 2, .steal_threshold = 4});
+    std::atomic<bool> release{false};
+    std::atomic<int> stolen_runs{0};
+    executor.submit(0, [&] { while (!release) std::this_thread::yield(); }); // Keeps worker 0 busy
+    ASSERT_TRUE(eventually([&] { return executor.get_queued_count(0) == 0; }));
+
+    for (int i = 0; i < 10; ++i) {
+        executor.submit(0, [&] { if (StreamExecutor::current_worker() == 1) ++stolen_runs; });
+    }
+    // Worker 1 takes the backlog down to the threshold and leaves the rest to the busy home worker.
+    ASSERT_TRUE(eventually([&] { return executor.get_steal_count() == 6; }));
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(executor.get_queued_count(0), 4u);
+    release = true;
+    executor.wait_idle();
+
+    EXPECT_EQ(executor.get_steal_count(), 6u);
+    EXPECT_EQ(stolen_runs, 6);
+    EXPECT_EQ(executor.get_executed_count(0), 5u);
+}
+
+TEST(StreamExecutorTest, DestructorRunsQueuedTasks) {
+    std::atomic<int> runs{0};
+    {
+        StreamExecutor executor({.worker_count = 2});
+        for (int i = 0; i < 50; ++i) executor.submit(i % 2, [&] { ++runs; });
+    }
+    EXPECT_EQ(runs, 50);
+}
+
+TEST(StreamExecutorTest, ResultsReturnThroughSubmissionQueue) {
+    Http2Connection client_conn(false);
+    Http2Connection server_conn(true);
+    std::vector<std::byte> to_server;
+    std::vector<std::byte> to_client;
+    client_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+    server_conn.set_on_send_bytes([&](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+
+    StreamExecutor executor({.worker_count = 2});
+    size_t home = executor.assign_home();
+    SubmissionQueue submissions;
+    std::atomic<int> wakeups{0};
+    submissions.set_wakeup([&] { ++wakeups; });
+    server_conn.set_stream_events({
+        .on_headers = [&](stream_id_t sid, void*, const std::vector<HttpHeader>& headers, bool) {
+            std::string path = headers[2].value;
+            executor.submit(home, [&submissions, sid, path] {
+                submissions.post([sid, path](Http2Connection& conn) {
+                    conn.send_headers(sid, {{":status", "200"}, {"x-path", path}}, true);
+                });
+            });
+        },
+    });
+
+    for (stream_id_t sid : {1u, 3u, 5u}) {
+        ASSERT_TRUE(client_conn.send_headers(sid, {{":method", "GET"}, {":scheme", "https"},
+                                                   {":path", "/" + std::to_string(sid)}, {":authority", "a"}}, true));
+    }
+    server_conn.process_incoming_data(to_server);
+    executor.wait_idle();
+    EXPECT_GE(wakeups, 1);
+    EXPECT_EQ(submissions.size(), 3u);
+    EXPECT_EQ(submissions.run(server_conn), 3u);
+    EXPECT_EQ(submissions.size(), 0u);
+
+    std::vector<std::string> paths;
+    client_conn.set_stream_events({
+        .on_headers = [&](stream_id_t, void*, const std::vector<HttpHeader>& headers, bool) { paths.push_back(headers[1].value); },
+    });
+    client_conn.process_incoming_data(to_client);
+    EXPECT_EQ(paths, (std::vector<std::string>{"/1", "/3", "/5"}));
+}
+
+TEST(StreamExecutorTest, StrandKeepsOrderWhileStealing) {
+    StreamExecutor executor({.worker_count = 3, .steal_threshold = 0});
+    Strand strand(executor, 0);
+    std::atomic<int> running{0};
+    std::atomic<bool> overlapped{false};
+    std::vector<int> order; // Guarded by the strand
+    for (int i = 0; i < 200; ++i) {
+        // Unrelated tasks on the same worker give the others something to steal.
+        executor.submit(0, [] { std::this_thread::yield(); });
+        strand.submit([&, i] {
+            if (running.fetch_add(1) != 0) overlapped = true;
+            order.push_back(i);
+            std::this_thread::yield();
+            running.fetch_sub(1);
+        });
+    }
+    executor.wait_idle();
+    EXPECT_FALSE(overlapped);
+    ASSERT_EQ(order.size(), 200u);
+    for (int i = 0; i < 200; ++i) EXPECT_EQ(order[i], i);
+}
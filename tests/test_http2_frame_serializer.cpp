@@ -2,6 +2,7 @@
 #include "http2_frame_serializer.h"
 #include "http2_frame.h"
 #include "hpack_encoder.h" // For tests involving HEADERS/PUSH_PROMISE
+#include <array>
 #include <vector>
 #include <string>
 #include <iomanip> // For std::setfill, std::setw with ostringstream
@@ -194,6 +195,24 @@ TEST(FrameSerializerTest, SerializeContinuationFrame) {
 }
 
 
+TEST(FrameSerializerTest, SerializeExtensionFrame) {
+    FrameHeader header;
+    header.type = static_cast<FrameType>(0xf0);
+    header.flags = 0x1;
+    header.stream_id = 5;
+    header.length = 0; // Taken from the payload
+    std::vector<std::byte> payload = {std::byte(0xaa), std::byte(0xbb)};
+    // Expected: 000002 (len) f0 (type) 01 (flags) 00000005 (stream 5) aabb
+    EXPECT_EQ(bytes_to_hex_fs(serialize_extension_frame(header, payload)), "000002f00100000005aabb");
+
+    // Header only, into caller memory, for payloads sent from their own buffer.
+    std::array<std::byte, FRAME_HEADER_SIZE> out{};
+    header.length = 70000;
+    ASSERT_EQ(write_frame_header(std::span<std::byte>(out), header), FRAME_HEADER_SIZE);
+    EXPECT_EQ(bytes_to_hex_fs(std::vector<std::byte>(out.begin(), out.end())), "011170f00100000005");
+    EXPECT_EQ(write_frame_header(std::span<std::byte>(out).first(8), header), 0u);
+}
+
 TEST(FrameSerializerTest, SerializeHeaderBlockWithContinuationSmall) {
     HpackEncoder encoder;
     FrameHeader initial_header;
@@ -273,6 +292,73 @@ TEST(FrameSerializerTest, SerializeHeaderBlockWithContinuationLarge) {
 
 }
 
+TEST(FrameSerializerTest, WriteHeaderBlockSplitsInPlace) {
+    HpackEncoder encoder;
+    HeadersFrame first;
+    first.header.flags = HeadersFrame::END_STREAM_FLAG | HeadersFrame::PADDED_FLAG | HeadersFrame::PRIORITY_FLAG;
+    first.header.stream_id = 5;
+    first.pad_length = 3;
+    first.stream_dependency = 1;
+    first.exclusive_dependency = true;
+    first.weight = 15;
+    auto headers = make_headers_fs({{":method", "GET"}, {"long-header", std::string(50, 'a')}, {"x-id", "42"}});
+
+    std::vector<std::byte> out = {std::byte{0xee}}; // Appended after what is already there
+    ASSERT_TRUE(write_header_block(out, first, headers, encoder, 20));
+    ASSERT_EQ(out[0], std::byte{0xee});
+
+    struct Frame { uint32_t length; uint8_t type; uint8_t flags; uint32_t stream_id; std::span<const std::byte> payload; };
+    std::vector<Frame> frames;
+    for (size_t offset = 1; offset < out.size();) {
+        Frame f;
+        f.length = (static_cast<uint32_t>(out[offset]) << 16) | (static_cast<uint32_t>(out[offset + 1]) << 8) | static_cast<uint32_t>(out[offset + 2]);
+        f.type = static_cast<uint8_t>(out[offset + 3]);
+        f.flags = static_cast<uint8_t>(out[offset + 4]);
+        f.stream_id = static_cast<uint32_t>(out[offset + 8]);
+        ASSERT_LE(f.length, 20u);
+        ASSERT_LE(offset + 9 + f.length, out.size());
+        f.payload = std::span<const std::byte>(out).subspan(offset + 9, f.length);
+        frames.push_back(f);
+        offset += 9 + f.length;
+    }
+    ASSERT_GE(frames.size(), 3u);
+
+    // First frame: pad length, exclusive dependency on 1, weight 15, 11 bytes of block, 3 pad bytes.
+    EXPECT_EQ(frames[0].type, static_cast<uint8_t>(FrameType::HEADERS));
+    EXPECT_EQ(frames[0].flags, HeadersFrame::END_STREAM_FLAG | HeadersFrame::PADDED_FLAG | HeadersFrame::PRIORITY_FLAG);
+    EXPECT_EQ(frames[0].length, 20u);
+    EXPECT_EQ(bytes_to_hex_fs(std::vector<std::byte>(frames[0].payload.begin(), frames[0].payload.begin() + 6)), "03800000010f");
+    EXPECT_EQ(bytes_to_hex_fs(std::vector<std::byte>(frames[0].payload.end() - 3, frames[0].payload.end())), "000000");
+    std::vector<std::byte> block(frames[0].payload.begin() + 6, frames[0].payload.end() - 3);
+    for (size_t i = 1; i < frames.size(); ++i) {
+        EXPECT_EQ(frames[i].type, static_cast<uint8_t>(FrameType::CONTINUATION));
+        EXPECT_EQ(frames[i].stream_id, 5u);
+        EXPECT_EQ(frames[i].flags, i + 1 == frames.size() ? ContinuationFrame::END_HEADERS_FLAG : 0);
+        block.insert(block.end(), frames[i].payload.begin(), frames[i].payload.end());
+    }
+
+    HpackEncoder reference;
+    auto [expected_block, err] = reference.encode(headers);
+    ASSERT_EQ(err, HpackEncodingError::OK);
+    EXPECT_EQ(block, expected_block);
+
+    // Fields and padding that cannot fit in one frame are refused without touching the buffer.
+    first.pad_length = 200;
+    EXPECT_FALSE(write_header_block(out, first, headers, encoder, 100));
+    EXPECT_EQ(out.size(), 1 + frames.size() * 9 + 6 + 3 + block.size());
+}
+
+TEST(FrameSerializerTest, WriteHeaderBlockPushPromise) {
+    HpackEncoder encoder;
+    PushPromiseFrame first{};
+    first.header.stream_id = 1;
+    first.promised_stream_id = 2;
+    std::vector<std::byte> out;
+    ASSERT_TRUE(write_header_block(out, first, make_headers_fs({{":method", "GET"}, {":path", "/"}}), encoder, 16384));
+    // One frame: length 6, PUSH_PROMISE, END_HEADERS, stream 1, promised stream 2, 82 84.
+    EXPECT_EQ(bytes_to_hex_fs(out), "00000605040000000100000002" "8284");
+}
+
 // int main(int argc, char **argv) {
 //     ::testing::InitGoogleTest(&argc, argv);
 //     return RUN_ALL_TESTS();
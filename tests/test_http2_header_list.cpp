@@ -0,0 +1,109 @@
+#include "gtest/gtest.h"
+#include "http2_header_list.h"
+#include "hpack_decoder.h"
+#include "hpack_encoder.h"
+#include "hpack_static_table.h"
+#include <string>
+#include <vector>
+
+using namespace http2;
+
+TEST(HeaderListTest, StoresHeadersContiguously) {
+    HeaderList list{{":method", "GET"}, {":path", "/index.html"}, {"authorization", "secret", true}};
+
+    ASSERT_EQ(list.size(), 3u);
+    EXPECT_EQ(list[0].name, ":method");
+    EXPECT_EQ(list[1].value, "/index.html");
+    EXPECT_TRUE(list[2].sensitive);
+    EXPECT_EQ(list.get_byte_size(), std::string(":methodGET:path/index.htmlauthorizationsecret").size());
+    EXPECT_EQ(list[0].name.data() + 10, list[1].name.data()); // Back to back in one buffer
+    EXPECT_EQ(list.find(":path"), "/index.html");
+    EXPECT_FALSE(list.find("content-type").has_value());
+
+    std::vector<HttpHeader> headers = list.to_vector();
+    ASSERT_EQ(headers.size(), 3u);
+    EXPECT_EQ(headers[2].name, "authorization");
+    EXPECT_TRUE(headers[2].sensitive);
+    EXPECT_EQ(HeaderList(headers).get_byte_size(), list.get_byte_size());
+
+    size_t count = 0;
+    for (HeaderView h : list) count += h.name.empty() ? 0 : 1;
+    EXPECT_EQ(count, 3u);
+    EXPECT_EQ(list.end() - list.begin(), 3);
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_EQ(list.get_byte_size(), 0u);
+}
+
+TEST(HeaderListTest, DecodeIntoMatchesDecode) {
+    // Huffman-coded and raw literals, all three literal representations, indexed fields.
+    std::vector<std::vector<HttpHeader>> blocks = {
+        {{":method", "GET"}, {":path", "/a"}, {"user-agent", "test/1.0"}, {"x-request-id", "1"}},
+        {{":method", "GET"}, {":path", "/b"}, {"user-agent", "test/1.0"}, {"cookie", "id=42", true}},
+        {{":method", "POST"}, {"x-request-id", "2"}, {"x-large", std::string(5000, 'z')}},
+    };
+    HpackEncoder encoder;
+    HpackDecoder vector_decoder;
+    HpackDecoder list_decoder;
+    HeaderList list;
+    for (const auto& block : blocks) {
+        auto [encoded, enc_err] = encoder.encode(block);
+        ASSERT_EQ(enc_err, HpackEncodingError::OK);
+
+        auto [expected, err] = vector_decoder.decode(encoded);
+        ASSERT_EQ(err, HpackError::OK);
+        list.clear();
+        ASSERT_EQ(list_decoder.decode_into(encoded, list), HpackError::OK);
+
+        ASSERT_EQ(list.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            EXPECT_EQ(list[i].name, expected[i].name);
+            EXPECT_EQ(list[i].value, expected[i].value);
+            EXPECT_EQ(list[i].sensitive, expected[i].sensitive);
+        }
+        EXPECT_EQ(list_decoder.get_current_dynamic_table_size(), vector_decoder.get_current_dynamic_table_size());
+    }
+}
+
+TEST(HeaderListTest, DecodeIntoIndexesNameOfEvictedEntry) {
+    // Table holds exactly one entry; the second field names it and evicts it while being added.
+    HpackDecoder decoder(32 + 10);
+    const std::vector<std::byte> block = {
+        std::byte{0x40}, std::byte{0x03}, std::byte{'a'}, std::byte{'b'}, std::byte{'c'},
+        std::byte{0x03}, std::byte{'1'}, std::byte{'2'}, std::byte{'3'},               // abc: 123, indexed
+        std::byte{0x7E}, std::byte{0x04}, std::byte{'4'}, std::byte{'5'}, std::byte{'6'}, std::byte{'7'}, // name = index 62
+    };
+    HeaderList list;
+    ASSERT_EQ(decoder.decode_into(block, list), HpackError::OK);
+    ASSERT_EQ(list.size(), 2u);
+    EXPECT_EQ(list[1].name, "abc");
+    EXPECT_EQ(list[1].value, "4567");
+    auto entry = decoder.get_header_from_tables(Hpack::STATIC_TABLE.size() + 1);
+    ASSERT_TRUE(entry.has_value());
+    EXPECT_EQ(entry->name, "abc");
+    EXPECT_EQ(entry->value, "4567");
+}
+
+TEST(HeaderListTest, EncodeIntoMatchesVectorEncoding) {
+    std::vector<HttpHeader> headers = {
+        {":method", "GET"}, {":authority", "example.com"}, {"x-custom", "value"}, {"authorization", "secret", true}};
+    HpackEncoder vector_encoder;
+    HpackEncoder list_encoder;
+    for (int round = 0; round < 2; ++round) { // Second round hits the dynamic table
+        auto [expected, err] = vector_encoder.encode(headers);
+        ASSERT_EQ(err, HpackEncodingError::OK);
+        std::vector<std::byte> encoded;
+        ASSERT_EQ(list_encoder.encode_into(encoded, HeaderList(headers)), HpackEncodingError::OK);
+        EXPECT_EQ(encoded, expected);
+    }
+}
+
+TEST(HeaderListTest, DecodeIntoKeepsHeadersBeforeError) {
+    HpackDecoder decoder;
+    const std::vector<std::byte> block = {std::byte{0x82}, std::byte{0x84}, std::byte{0xBF}}; // 63: empty dynamic table
+    HeaderList list;
+    EXPECT_EQ(decoder.decode_into(block, list), HpackError::INDEX_OUT_OF_BOUNDS);
+    ASSERT_EQ(list.size(), 2u);
+    EXPECT_EQ(list[1].name, ":path");
+}
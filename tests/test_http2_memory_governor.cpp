@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "http2_memory_governor.h"
+#include "http2_connection.h"
+#include <memory>
+#include <vector>
+
+using namespace http2;
+
+// Each server connection is attached to the governor and paired with an in-process client that
+// uploads to it. The servers only consume DATA when the test says so.
+class MemoryGovernorTest : public ::testing::Test {
+protected:
+    struct Peer {
+        Http2Connection client{false};
+        Http2Connection server{true};
+        std::vector<std::byte> to_server, to_client;
+
+        Peer() {
+            client.set_on_send_bytes([this](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+            server.set_on_send_bytes([this](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+        }
+
+        void pump() {
+            while (!to_server.empty() || !to_client.empty()) {
+                std::vector<std::byte> bytes;
+                bytes.swap(to_server);
+                server.process_incoming_data(bytes);
+                bytes.clear();
+                bytes.swap(to_client);
+                client.process_incoming_data(bytes);
+            }
+        }
+
+        void upload(size_t size) {
+            ASSERT_TRUE(client.send_headers(1, {{":method", "POST"}, {":scheme", "https"}, {":path", "/upload"}, {":authority", "example.com"}}, false));
+            ASSERT_TRUE(client.send_data(1, std::vector<std::byte>(size), false));
+            pump();
+        }
+    };
+};
+
+TEST_F(MemoryGovernorTest, CapsWindowsWhileBufferedDataIsHigh) {
+    MemoryGovernor governor({.high_watermark = 60000, .low_watermark = 20000,
+                             .caps = {.stream_window = 16384, .connection_window = DEFAULT_INITIAL_WINDOW_SIZE, .max_concurrent_streams = 10}});
+    auto a = std::make_unique<Peer>();
+    auto b = std::make_unique<Peer>();
+    governor.attach(a->server);
+    governor.attach(b->server);
+
+    a->upload(35000);
+    EXPECT_FALSE(governor.is_under_pressure());
+    b->upload(35000);
+    EXPECT_EQ(governor.get_buffered_bytes(), 70000u);
+    ASSERT_TRUE(governor.is_under_pressure());
+    a->pump();
+    b->pump();
+    EXPECT_EQ(a->client.get_remote_settings().max_concurrent_streams, 10u);
+    EXPECT_EQ(b->client.get_remote_settings().max_concurrent_streams, 10u);
+
+    // Still above the low watermark: the connection window is refilled up to its cap, but the
+    // stream window is already above its cap and gets no credit.
+    ASSERT_TRUE(a->server.consume_data(1, 35000));
+    a->pump();
+    EXPECT_TRUE(governor.is_under_pressure());
+    EXPECT_EQ(a->client.get_remote_connection_window(), DEFAULT_INITIAL_WINDOW_SIZE);
+    EXPECT_EQ(a->client.get_stream(1)->get_remote_window_size(), 30535);
+
+    // Below the low watermark the caps are lifted and the withheld credit is returned.
+    ASSERT_TRUE(b->server.consume_data(1, 35000));
+    EXPECT_FALSE(governor.is_under_pressure());
+    a->pump();
+    b->pump();
+    for (Peer* peer : {a.get(), b.get()}) {
+        EXPECT_EQ(peer->client.get_remote_settings().max_concurrent_streams, DEFAULT_MAX_CONCURRENT_STREAMS);
+        EXPECT_EQ(peer->client.get_stream(1)->get_remote_window_size(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE));
+        EXPECT_EQ(peer->client.get_remote_connection_window(), DEFAULT_INITIAL_WINDOW_SIZE);
+    }
+    EXPECT_EQ(governor.get_pressure_episode_count(), 1u);
+
+    // Destroyed connections leave the governor.
+    b.reset();
+    EXPECT_EQ(governor.get_connection_count(), 1u);
+}
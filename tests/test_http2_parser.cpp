@@ -1,8 +1,10 @@
 #include "gtest/gtest.h"
 #include "http2_parser.h"
 #include "http2_connection.h"
+#include "http2_frame_serializer.h"
 #include "hpack_decoder.h"    // Parser needs hpack decoder
 #include <vector>
+#include <string>
 #include <cstring> // for memcpy
 
 using namespace http2;
@@ -391,9 +393,180 @@ TEST_F(Http2ParserTest, ErrorHeadersFrameOnStreamZero) {
     EXPECT_EQ(last_parser_error_, ParserError::INVALID_STREAM_ID);
 }
 
+TEST_F(Http2ParserTest, ParseOriginAndAltSvcFrames) {
+    OriginFrame origin;
+    origin.header.stream_id = 0;
+    origin.origins = {"https://example.com", "https://cdn.example.com"};
+    AltSvcFrame altsvc;
+    altsvc.header.stream_id = 0;
+    altsvc.origin = "https://example.com";
+    altsvc.field_value = "h3=\":443\"; ma=3600";
+
+    auto bytes = FrameSerializer::serialize_origin_frame(origin);
+    auto altsvc_bytes = FrameSerializer::serialize_altsvc_frame(altsvc);
+    bytes.insert(bytes.end(), altsvc_bytes.begin(), altsvc_bytes.end());
+    feed_parser(bytes);
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 2u);
+
+    const auto* of = std::get_if<OriginFrame>(&parsed_frames_store[0].frame_variant);
+    ASSERT_NE(of, nullptr);
+    EXPECT_EQ(of->header.type, FrameType::ORIGIN);
+    EXPECT_EQ(of->origins, origin.origins);
+
+    const auto* af = std::get_if<AltSvcFrame>(&parsed_frames_store[1].frame_variant);
+    ASSERT_NE(af, nullptr);
+    EXPECT_EQ(af->origin, "https://example.com");
+    EXPECT_EQ(af->field_value, "h3=\":443\"; ma=3600");
+}
+
+TEST_F(Http2ParserTest, UnknownFrameTypeIsIgnored) {
+    // RFC 9113 Section 4.1: frames of unknown type are discarded, not a connection error.
+    std::vector<std::byte> payload = {std::byte(0x01), std::byte(0x02), std::byte(0x03)};
+    auto frame_bytes = construct_frame(3, static_cast<FrameType>(0xfa), 0, 0, payload);
+    std::vector<std::byte> ping_payload(8, std::byte{0x11});
+    auto ping_bytes = construct_frame(8, FrameType::PING, 0, 0, ping_payload);
+    frame_bytes.insert(frame_bytes.end(), ping_bytes.begin(), ping_bytes.end());
+
+    EXPECT_EQ(feed_parser(frame_bytes), frame_bytes.size());
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 2u);
+    EXPECT_NE(std::get_if<UnknownFrame>(&parsed_frames_store[0].frame_variant), nullptr);
+    EXPECT_NE(std::get_if<PingFrame>(&parsed_frames_store[1].frame_variant), nullptr);
+
+    // A malformed ORIGIN payload (entry length past the end) is ignored the same way.
+    std::vector<std::byte> bad_origin = {std::byte(0x00), std::byte(0x10), std::byte('x')};
+    auto bad_bytes = construct_frame(3, FrameType::ORIGIN, 0, 0, bad_origin);
+    feed_parser(bad_bytes);
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 3u);
+    EXPECT_NE(std::get_if<UnknownFrame>(&parsed_frames_store[2].frame_variant), nullptr);
+}
+
+TEST_F(Http2ParserTest, ParsePriorityUpdateFrame) {
+    PriorityUpdateFrame update;
+    update.header.stream_id = 0;
+    update.prioritized_stream_id = 7;
+    update.priority_field_value = "u=1, i";
+    feed_parser(FrameSerializer::serialize_priority_update_frame(update));
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 1u);
+    const auto* pf = std::get_if<PriorityUpdateFrame>(&parsed_frames_store[0].frame_variant);
+    ASSERT_NE(pf, nullptr);
+    EXPECT_EQ(pf->prioritized_stream_id, 7u);
+    EXPECT_EQ(pf->priority_field_value, "u=1, i");
+
+    // Only valid on stream 0, and the stream id field is mandatory (RFC 9218 Section 7.1).
+    std::vector<std::byte> payload = {std::byte(0x00), std::byte(0x00), std::byte(0x00), std::byte(0x07)};
+    feed_parser(construct_frame(4, FrameType::PRIORITY_UPDATE, 0, 1, payload));
+    EXPECT_EQ(last_parser_error_, ParserError::INVALID_STREAM_ID);
+    parser.reset();
+    payload.resize(3);
+    feed_parser(construct_frame(3, FrameType::PRIORITY_UPDATE, 0, 0, payload));
+    EXPECT_EQ(last_parser_error_, ParserError::INVALID_FRAME_SIZE);
+}
+
+TEST_F(Http2ParserTest, ExtensionFrameHandlerSeesPayloadInPlace) {
+    EXPECT_FALSE(parser.register_extension_frame_handler(static_cast<uint8_t>(FrameType::PING), [](const FrameHeader&, std::span<const std::byte>) { return ParserError::OK; }));
+
+    std::vector<std::string> payloads;
+    ASSERT_TRUE(parser.register_extension_frame_handler(0xf0, [&](const FrameHeader& header, std::span<const std::byte> payload) {
+        EXPECT_EQ(header.flags, 0x1);
+        payloads.emplace_back(reinterpret_cast<const char*>(payload.data()), payload.size());
+        return ParserError::OK;
+    }));
+    std::vector<std::byte> payload = {std::byte('t'), std::byte('e'), std::byte('l')};
+    auto frame_bytes = construct_frame(3, static_cast<FrameType>(0xf0), 0x1, 0, payload);
+    feed_parser(std::span<const std::byte>(frame_bytes).first(5)); // Split mid-header
+    feed_parser(std::span<const std::byte>(frame_bytes).subspan(5));
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    EXPECT_EQ(payloads, std::vector<std::string>{"tel"});
+    EXPECT_TRUE(parsed_frames_store.empty()); // No UnknownFrame for handled types
+
+    // A handler error fails the parse; after unregistering, the type is ignored again.
+    ASSERT_TRUE(parser.register_extension_frame_handler(0xf0, [](const FrameHeader&, std::span<const std::byte>) { return ParserError::PROTOCOL_ERROR; }));
+    feed_parser(frame_bytes);
+    EXPECT_EQ(last_parser_error_, ParserError::PROTOCOL_ERROR);
+    parser.reset();
+    parser.unregister_extension_handler(0xf0);
+    feed_parser(frame_bytes);
+    EXPECT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 1u);
+    EXPECT_NE(std::get_if<UnknownFrame>(&parsed_frames_store[0].frame_variant), nullptr);
+}
+
+TEST_F(Http2ParserTest, ExtensionChunkHandlerStreamsLargeFrames) {
+    struct Chunk { size_t offset; size_t size; bool last; };
+    std::vector<Chunk> chunks;
+    std::vector<std::byte> received;
+    ASSERT_TRUE(parser.register_extension_chunk_handler(0xf1, [&](const FrameHeader& header, std::span<const std::byte> chunk, size_t offset, bool last) {
+        EXPECT_EQ(header.length, 10000u);
+        chunks.push_back({offset, chunk.size(), last});
+        received.insert(received.end(), chunk.begin(), chunk.end());
+        return ParserError::OK;
+    }));
+
+    std::vector<std::byte> payload(10000);
+    for (size_t i = 0; i < payload.size(); ++i) payload[i] = static_cast<std::byte>(i % 251);
+    auto frame_bytes = construct_frame(10000, static_cast<FrameType>(0xf1), 0, 3, payload);
+    std::vector<std::byte> ping_payload(8, std::byte{0x22});
+    auto ping_bytes = construct_frame(8, FrameType::PING, 0, 0, ping_payload);
+    frame_bytes.insert(frame_bytes.end(), ping_bytes.begin(), ping_bytes.end());
+
+    // Delivered as it arrives: nothing waits for the end of the frame.
+    std::span<const std::byte> all(frame_bytes);
+    feed_parser(all.first(4009));
+    ASSERT_EQ(chunks.size(), 1u);
+    EXPECT_EQ(chunks[0].size, 4000u);
+    feed_parser(all.subspan(4009, 4000));
+    feed_parser(all.subspan(8009));
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(chunks.size(), 3u);
+    EXPECT_EQ(chunks[1].offset, 4000u);
+    EXPECT_EQ(chunks[2].offset, 8000u);
+    EXPECT_FALSE(chunks[1].last);
+    EXPECT_TRUE(chunks[2].last);
+    EXPECT_EQ(received, payload);
+    ASSERT_EQ(parsed_frames_store.size(), 1u); // The PING after it
+    EXPECT_NE(std::get_if<PingFrame>(&parsed_frames_store[0].frame_variant), nullptr);
+}
+
+TEST_F(Http2ParserTest, PushPromiseHeaderBlockIsDecoded) {
+    // PADDED | END_HEADERS: pad length 2, promised stream 2, :method GET, :path /, two pad bytes.
+    std::vector<std::byte> payload = {std::byte{0x02}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x02},
+                                      std::byte{0x82}, std::byte{0x84}, std::byte{0x00}, std::byte{0x00}};
+    uint8_t flags = PushPromiseFrame::PADDED_FLAG | PushPromiseFrame::END_HEADERS_FLAG;
+    feed_parser(construct_frame(static_cast<uint32_t>(payload.size()), FrameType::PUSH_PROMISE, flags, 1, payload));
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    ASSERT_EQ(parsed_frames_store.size(), 1u);
+    const auto* pp = std::get_if<PushPromiseFrame>(&parsed_frames_store[0].frame_variant);
+    ASSERT_NE(pp, nullptr);
+    EXPECT_EQ(pp->promised_stream_id, 2u);
+    ASSERT_EQ(pp->headers.size(), 2u);
+    EXPECT_EQ(pp->headers[1].name, ":path");
+    EXPECT_EQ(pp->headers[1].value, "/");
+    EXPECT_FALSE(connection_context.is_expecting_continuation());
+
+    // Without END_HEADERS the fragment waits for CONTINUATION frames.
+    parser.reset();
+    parsed_frames_store.clear();
+    std::vector<std::byte> first = {std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x04}, std::byte{0x82}};
+    feed_parser(construct_frame(static_cast<uint32_t>(first.size()), FrameType::PUSH_PROMISE, 0, 1, first));
+    ASSERT_EQ(last_parser_error_, ParserError::OK);
+    EXPECT_TRUE(connection_context.is_expecting_continuation());
+    EXPECT_EQ(connection_context.get_expected_continuation_stream_id(), 1u);
+
+    // Padding longer than the remaining payload is rejected.
+    connection_context.finish_continuation();
+    parser.reset();
+    std::vector<std::byte> bad = {std::byte{0x09}, std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x06}, std::byte{0x82}};
+    feed_parser(construct_frame(static_cast<uint32_t>(bad.size()), FrameType::PUSH_PROMISE, flags, 1, bad));
+    EXPECT_EQ(last_parser_error_, ParserError::INVALID_PADDING);
+}
+
 // TODO: More tests for padding errors (pad length too large, etc.)
 // TODO: Tests for PRIORITY frame specifics
-// TODO: Tests for PUSH_PROMISE frame specifics (and server vs client context)
+// TODO: PUSH_PROMISE server vs client context
 // TODO: Tests for GOAWAY frame specifics
 // TODO: Deeper tests for CONTINUATION error scenarios (wrong stream, no preceding HEADERS, etc.)
 // TODO: Test HPACK errors propagating from HpackDecoder through Http2Parser
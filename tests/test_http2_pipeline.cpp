@@ -0,0 +1,204 @@
+#include "gtest/gtest.h"
+#include "http2_pipeline.h"
+#include "http2_spsc_queue.h"
+#include "http2_connection.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace http2;
+
+TEST(SpscQueueTest, IsBoundedFifo) {
+    SpscQueue<std::unique_ptr<int>> queue(3);
+    EXPECT_EQ(queue.capacity(), 4u); // Rounded up to a power of two
+    for (int i = 0; i < 4; ++i) ASSERT_TRUE(queue.try_push(std::make_unique<int>(i)));
+
+    auto extra = std::make_unique<int>(4);
+    EXPECT_FALSE(queue.try_push(std::move(extra)));
+    ASSERT_NE(extra, nullptr); // Not moved from when full
+    EXPECT_EQ(queue.size(), 4u);
+
+    std::unique_ptr<int> item;
+    ASSERT_TRUE(queue.try_pop(item));
+    EXPECT_EQ(*item, 0);
+    EXPECT_TRUE(queue.try_push(std::move(extra)));
+    for (int expected = 1; expected <= 4; ++expected) {
+        ASSERT_TRUE(queue.try_pop(item));
+        EXPECT_EQ(*item, expected);
+    }
+    EXPECT_FALSE(queue.try_pop(item));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, KeepsOrderAcrossThreads) {
+    constexpr uint64_t COUNT = 200000;
+    SpscQueue<uint64_t> queue(64);
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < COUNT; ++i) {
+            uint64_t value = i;
+            while (!queue.try_push(std::move(value))) std::this_thread::yield();
+        }
+    });
+    uint64_t next = 0;
+    bool in_order = true;
+    while (next < COUNT) {
+        uint64_t value;
+        if (!queue.try_pop(value)) { std::this_thread::yield(); continue; }
+        in_order = in_order && value == next;
+        ++next;
+    }
+    producer.join();
+    EXPECT_TRUE(in_order);
+}
+
+class Http2PipelineTest : public ::testing::Test {
+protected:
+    Http2Connection client_conn{false};
+    Http2Connection server_conn{true};
+    std::vector<std::byte> to_server;
+    std::vector<std::byte> to_client;
+
+    Http2PipelineTest() {
+        client_conn.set_on_send_bytes([this](std::vector<std::byte> b) { to_server.insert(to_server.end(), b.begin(), b.end()); });
+        server_conn.set_on_send_bytes([this](std::vector<std::byte> b) { to_client.insert(to_client.end(), b.begin(), b.end()); });
+        server_conn.set_on_send_rst_stream([](stream_id_t, ErrorCode) {});
+    }
+};
+
+TEST_F(Http2PipelineTest, DecodesAndDispatchesOnHandlerThread) {
+    struct Request {
+        stream_id_t stream_id;
+        std::vector<std::string> events;
+    };
+    std::vector<std::unique_ptr<Request>> requests; // Handler thread only until drain()
+    bool on_io_thread = false;
+    std::thread::id io_thread = std::this_thread::get_id();
+    std::unique_ptr<Http2Pipeline> pipeline;
+    pipeline = std::make_unique<Http2Pipeline>(server_conn, StreamEvents{
+        .on_open = [&](stream_id_t sid) -> void* {
+            on_io_thread = on_io_thread || std::this_thread::get_id() == io_thread;
+            requests.push_back(std::make_unique<Request>(Request{sid, {"open"}}));
+            return requests.back().get();
+        },
+        .on_headers = [&](stream_id_t sid, void* user_data, const std::vector<HttpHeader>& headers, bool end_stream) {
+            auto* request = static_cast<Request*>(user_data);
+            request->events.push_back("headers " + headers[2].value + " " + headers.back().value + (end_stream ? " end" : ""));
+            if (end_stream) {
+                pipeline->post([sid](Http2Connection& conn) {
+                    conn.send_headers(sid, {{":status", "200"}}, true);
+                });
+            }
+        },
+        .on_data = [&](stream_id_t sid, void* user_data, std::vector<std::byte>&& data, bool end_stream) {
+            static_cast<Request*>(user_data)->events.push_back("data " + std::to_string(data.size()) + (end_stream ? " end" : ""));
+            pipeline->consume_data(sid, static_cast<uint32_t>(data.size()));
+        },
+        .on_trailers = [&](stream_id_t, void* user_data, const std::vector<HttpHeader>& trailers) {
+            static_cast<Request*>(user_data)->events.push_back("trailers " + trailers[0].value);
+        },
+        .on_close = [&](stream_id_t sid, void* user_data) {
+            auto* request = static_cast<Request*>(user_data);
+            ASSERT_EQ(request->stream_id, sid);
+            request->events.push_back("close");
+        },
+    });
+
+    std::vector<HttpHeader> upload = {{":method", "POST"}, {":scheme", "https"}, {":path", "/upload"}, {":authority", "example.com"},
+                                      {"x-request-id", "a1"}};
+    ASSERT_TRUE(client_conn.send_headers(1, upload, false));
+    ASSERT_TRUE(client_conn.send_data(1, std::vector<std::byte>(100, std::byte{0x61}), false));
+    ASSERT_TRUE(client_conn.send_headers(1, {{"grpc-status", "0"}}, true));
+    // Not a valid request (trailers without END_STREAM): the server resets the stream, yet the
+    // block's new table entry must still be decoded for the requests that refer to it.
+    ASSERT_TRUE(client_conn.send_headers(3, upload, false));
+    ASSERT_TRUE(client_conn.send_headers(3, {{"x-rejected", "yes"}}, false));
+    std::vector<HttpHeader> get = {{":method", "GET"}, {":scheme", "https"}, {":path", "/index.html"}, {":authority", "example.com"},
+                                   {"x-rejected", "yes"}};
+    ASSERT_TRUE(client_conn.send_headers(5, get, true));
+    pipeline->process_incoming_data(to_server);
+    pipeline->drain();
+
+    EXPECT_FALSE(on_io_thread);
+    EXPECT_FALSE(pipeline->has_failed());
+    ASSERT_EQ(requests.size(), 3u);
+    EXPECT_EQ(requests[0]->events, (std::vector<std::string>{"open", "headers /upload a1", "data 100", "trailers 0"}));
+    EXPECT_EQ(requests[1]->events, (std::vector<std::string>{"open", "headers /upload a1", "close"}));
+    EXPECT_EQ(requests[2]->events, (std::vector<std::string>{"open", "headers /index.html yes end"}));
+
+    // The response went out from the I/O thread and closed stream 5 there; the stream is dropped,
+    // and its close reported, with the next frame read.
+    std::vector<std::string> statuses;
+    client_conn.set_stream_events({
+        .on_headers = [&](stream_id_t, void*, const std::vector<HttpHeader>& headers, bool) { statuses.push_back(headers[0].value); },
+    });
+    client_conn.process_incoming_data(to_client);
+    EXPECT_EQ(statuses, (std::vector<std::string>{"200"}));
+    to_server.clear();
+    client_conn.send_ping({}, false);
+    pipeline->process_incoming_data(to_server);
+    pipeline->drain();
+    EXPECT_EQ(server_conn.get_stream(5), nullptr);
+    EXPECT_EQ(requests[2]->events.back(), "close");
+}
+
+TEST_F(Http2PipelineTest, DecodingErrorSendsGoaway) {
+    std::vector<ErrorCode> goaways;
+    client_conn.set_goaway_callback([&](const GoAwayFrame& frame) { goaways.push_back(frame.error_code); });
+    int headers_seen = 0;
+    Http2Pipeline pipeline(server_conn, StreamEvents{
+        .on_headers = [&](stream_id_t, void*, const std::vector<HttpHeader>&, bool) { ++headers_seen; },
+    });
+
+    // Index 63 with an empty dynamic table, then a valid request that must no longer be dispatched.
+    std::vector<std::byte> bad = {std::byte{0x00}, std::byte{0x00}, std::byte{0x03}, std::byte{0x01}, std::byte{0x05},
+                                  std::byte{0x00}, std::byte{0x00}, std::byte{0x00}, std::byte{0x01},
+                                  std::byte{0x82}, std::byte{0x84}, std::byte{0xBF}};
+    pipeline.process_incoming_data(bad);
+    ASSERT_TRUE(client_conn.send_headers(3, {{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "a"}}, true));
+    pipeline.process_incoming_data(to_server);
+    pipeline.drain();
+    client_conn.process_incoming_data(to_client);
+
+    EXPECT_TRUE(pipeline.has_failed());
+    EXPECT_EQ(headers_seen, 0);
+    ASSERT_FALSE(goaways.empty());
+    EXPECT_EQ(goaways[0], ErrorCode::COMPRESSION_ERROR);
+}
+
+TEST_F(Http2PipelineTest, FullQueueDefersCommandsUntilReadReturns) {
+    // Tiny queues: stage 1 finds the event queue full while the handler waits for room for its
+    // commands. Those are taken off the command queue but run only after the read.
+    std::vector<std::string> io_log; // I/O thread only
+    server_conn.set_frame_callback([&](const AnyHttp2Frame&) { io_log.push_back("frame"); });
+    std::unique_ptr<Http2Pipeline> pipeline;
+    pipeline = std::make_unique<Http2Pipeline>(server_conn, StreamEvents{
+        .on_headers = [&](stream_id_t sid, void*, const std::vector<HttpHeader>&, bool) {
+            pipeline->post([&io_log, sid](Http2Connection& conn) {
+                io_log.push_back("command " + std::to_string(sid));
+                conn.send_headers(sid, {{":status", "204"}}, true);
+            });
+        },
+    }, PipelineOptions{.event_queue_capacity = 2, .command_queue_capacity = 2});
+
+    constexpr stream_id_t REQUESTS = 40;
+    for (stream_id_t i = 0; i < REQUESTS; ++i) {
+        ASSERT_TRUE(client_conn.send_headers(2 * i + 1, {{":method", "GET"}, {":scheme", "https"}, {":path", "/"}, {":authority", "a"}}, true));
+    }
+    pipeline->process_incoming_data(to_server);
+    pipeline->drain();
+
+    size_t first_command = 0;
+    while (first_command < io_log.size() && io_log[first_command] == "frame") ++first_command;
+    EXPECT_GE(first_command, REQUESTS); // No command ran in between frames
+    std::vector<std::string> commands(io_log.begin() + first_command, io_log.end());
+    ASSERT_EQ(commands.size(), REQUESTS);
+    for (stream_id_t i = 0; i < REQUESTS; ++i) EXPECT_EQ(commands[i], "command " + std::to_string(2 * i + 1));
+
+    size_t responses = 0;
+    client_conn.set_stream_events({
+        .on_headers = [&](stream_id_t, void*, const std::vector<HttpHeader>&, bool) { ++responses; },
+    });
+    client_conn.process_incoming_data(to_client);
+    EXPECT_EQ(responses, REQUESTS);
+}
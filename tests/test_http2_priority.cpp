@@ -0,0 +1,59 @@
+#include "gtest/gtest.h"
+#include "http2_priority.h"
+
+using namespace http2;
+
+TEST(PriorityFieldTest, ParsesUrgencyAndIncremental) {
+    StreamPriority priority;
+    ASSERT_TRUE(parse_priority_field("u=1, i", priority));
+    EXPECT_EQ(priority.urgency, 1);
+    EXPECT_TRUE(priority.incremental);
+
+    priority = {};
+    ASSERT_TRUE(parse_priority_field("i=?0,u=7", priority));
+    EXPECT_EQ(priority, (StreamPriority{7, false}));
+
+    // Later members win; parameters, unknown keys and values of other types are skipped.
+    priority = {};
+    ASSERT_TRUE(parse_priority_field("u=2;x=1, foo=(a \"b\" 1.5);q, bar=:YWJj:, u=5, tok=text/html", priority));
+    EXPECT_EQ(priority.urgency, 5);
+
+    priority = {};
+    ASSERT_TRUE(parse_priority_field("", priority));
+    EXPECT_EQ(priority, StreamPriority{});
+}
+
+TEST(PriorityFieldTest, IgnoresInvalidValues) {
+    // Out-of-range urgency and non-boolean i are ignored, the rest of the field still applies.
+    StreamPriority priority;
+    ASSERT_TRUE(parse_priority_field("u=8, i", priority));
+    EXPECT_EQ(priority, (StreamPriority{DEFAULT_PRIORITY_URGENCY, true}));
+    ASSERT_TRUE(parse_priority_field("u=-1, i=1", priority));
+    EXPECT_EQ(priority, (StreamPriority{DEFAULT_PRIORITY_URGENCY, true}));
+    ASSERT_TRUE(parse_priority_field("u=1.0", priority));
+    EXPECT_EQ(priority.urgency, DEFAULT_PRIORITY_URGENCY);
+
+    // Not a Structured Field Dictionary at all: nothing changes.
+    StreamPriority untouched{1, true};
+    EXPECT_FALSE(parse_priority_field("U=1", untouched));
+    EXPECT_FALSE(parse_priority_field("u=1,", untouched));
+    EXPECT_FALSE(parse_priority_field("u=1;;i", untouched));
+    EXPECT_FALSE(parse_priority_field("u=\"1", untouched));
+    EXPECT_FALSE(parse_priority_field("u=1 i", untouched));
+    EXPECT_EQ(untouched, (StreamPriority{1, true}));
+}
+
+TEST(PriorityFieldTest, FormatRoundTrips) {
+    EXPECT_EQ(format_priority_field({}), "");
+    EXPECT_EQ(format_priority_field({0, false}), "u=0");
+    EXPECT_EQ(format_priority_field({3, true}), "i");
+    EXPECT_EQ(format_priority_field({6, true}), "u=6, i");
+
+    for (uint8_t urgency = 0; urgency < PRIORITY_URGENCY_LEVELS; ++urgency) {
+        for (bool incremental : {false, true}) {
+            StreamPriority parsed;
+            ASSERT_TRUE(parse_priority_field(format_priority_field({urgency, incremental}), parsed));
+            EXPECT_EQ(parsed, (StreamPriority{urgency, incremental}));
+        }
+    }
+}
@@ -0,0 +1,118 @@
+#include "gtest/gtest.h"
+#include "http2_stream_splicer.h"
+#include "http2_connection.h"
+#include <vector>
+
+using namespace http2;
+
+// client --> [proxy_down | proxy_up] --> origin
+// DATA sent by the client on stream 1 is spliced by the proxy onto its upstream stream 1.
+class StreamSplicerTest : public ::testing::Test {
+protected:
+    Http2Connection client{false};
+    Http2Connection proxy_down{true};
+    Http2Connection proxy_up{false};
+    Http2Connection origin{true};
+
+    std::vector<std::byte> client_to_proxy, proxy_to_client, proxy_to_origin, origin_to_proxy;
+    size_t origin_bytes_received = 0;
+    bool origin_end_stream = false;
+
+    StreamSplicerTest() {
+        client.set_on_send_bytes([this](std::vector<std::byte> b) { append(client_to_proxy, b); });
+        proxy_down.set_on_send_bytes([this](std::vector<std::byte> b) { append(proxy_to_client, b); });
+        proxy_up.set_on_send_bytes([this](std::vector<std::byte> b) { append(proxy_to_origin, b); });
+        origin.set_on_send_bytes([this](std::vector<std::byte> b) { append(origin_to_proxy, b); });
+        origin.set_data_callback([this](stream_id_t, std::vector<std::byte>&& data, bool end_stream) {
+            origin_bytes_received += data.size();
+            origin_end_stream = origin_end_stream || end_stream;
+        });
+    }
+
+    static void append(std::vector<std::byte>& pipe, const std::vector<std::byte>& bytes) {
+        pipe.insert(pipe.end(), bytes.begin(), bytes.end());
+    }
+
+    static bool deliver(std::vector<std::byte>& pipe, Http2Connection& to) {
+        if (pipe.empty()) return false;
+        std::vector<std::byte> bytes;
+        bytes.swap(pipe);
+        to.process_incoming_data(bytes);
+        return true;
+    }
+
+    void pump() {
+        bool progress = true;
+        while (progress) {
+            progress = false;
+            progress |= deliver(client_to_proxy, proxy_down);
+            progress |= deliver(proxy_to_client, client);
+            progress |= deliver(proxy_to_origin, origin);
+            progress |= deliver(origin_to_proxy, proxy_up);
+        }
+    }
+
+    void open_streams() {
+        std::vector<HttpHeader> headers = {{":method", "POST"}, {":scheme", "http"}, {":path", "/"}};
+        ASSERT_TRUE(client.send_headers(1, headers, false));
+        ASSERT_TRUE(proxy_up.send_headers(1, headers, false));
+        pump();
+    }
+};
+
+TEST_F(StreamSplicerTest, CreditFollowsUpstreamWindow) {
+    StreamSplicer splicer(proxy_down, proxy_up);
+    open_streams();
+    splicer.splice(1, 1);
+
+    std::vector<std::byte> body(40000, std::byte{0x42});
+
+    // Upstream window is open: everything is forwarded and credited straight back.
+    ASSERT_TRUE(client.send_data(1, body, false));
+    pump();
+    EXPECT_EQ(origin_bytes_received, 40000u);
+    EXPECT_EQ(client.get_remote_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE));
+
+    // The origin never returns credit, so only 25535 more bytes fit upstream.
+    ASSERT_TRUE(client.send_data(1, body, false));
+    pump();
+    EXPECT_EQ(origin_bytes_received, DEFAULT_INITIAL_WINDOW_SIZE);
+    ASSERT_NE(proxy_up.get_stream(1), nullptr);
+    EXPECT_EQ(proxy_up.get_stream(1)->get_outgoing_data_size(), 80000u - DEFAULT_INITIAL_WINDOW_SIZE);
+    // The client only got credit for what actually left the proxy.
+    EXPECT_EQ(client.get_remote_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE - (80000u - DEFAULT_INITIAL_WINDOW_SIZE)));
+
+    // Origin opens its window: the queued bytes drain and the client is made whole.
+    ASSERT_TRUE(origin.consume_data(1, DEFAULT_INITIAL_WINDOW_SIZE));
+    pump();
+    EXPECT_EQ(origin_bytes_received, 80000u);
+    EXPECT_EQ(proxy_up.get_stream(1)->get_outgoing_data_size(), 0u);
+    EXPECT_EQ(client.get_remote_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE));
+    EXPECT_EQ(splicer.get_bytes_forwarded(), 80000u);
+    EXPECT_EQ(splicer.get_bytes_credited(), 80000u);
+
+    // END_STREAM is forwarded and releases the splice.
+    ASSERT_TRUE(client.send_data(1, {}, true));
+    pump();
+    EXPECT_TRUE(origin_end_stream);
+    EXPECT_EQ(splicer.get_spliced_stream_count(), 0u);
+}
+
+TEST_F(StreamSplicerTest, UnsplicedDataIsPassedThrough) {
+    StreamSplicer splicer(proxy_down, proxy_up);
+    open_streams();
+
+    size_t passed_through = 0;
+    splicer.set_unspliced_data_callback([&](stream_id_t sid, std::vector<std::byte>&& data, bool) {
+        EXPECT_EQ(sid, 1u);
+        passed_through += data.size();
+    });
+
+    std::vector<std::byte> body(100, std::byte{0x01});
+    ASSERT_TRUE(client.send_data(1, body, false));
+    pump();
+    EXPECT_EQ(passed_through, 100u);
+    EXPECT_EQ(origin_bytes_received, 0u);
+    // No splice, no automatic credit.
+    EXPECT_EQ(client.get_remote_connection_window(), static_cast<int32_t>(DEFAULT_INITIAL_WINDOW_SIZE - 100));
+}